@@ -193,9 +193,6 @@ echo >> AndroidAppSettings.cfg
 echo "# Hack for broken devices: prevent audio chopping, by sleeping a bit after pushing each audio chunk (y)/(n)" >> AndroidAppSettings.cfg
 echo CompatibilityHacksPreventAudioChopping=$CompatibilityHacksPreventAudioChopping >> AndroidAppSettings.cfg
 echo >> AndroidAppSettings.cfg
-echo "# Hack for broken apps: application ignores audio buffer size returned by SDL (y)/(n)" >> AndroidAppSettings.cfg
-echo CompatibilityHacksAppIgnoresAudioBufferSize=$CompatibilityHacksAppIgnoresAudioBufferSize >> AndroidAppSettings.cfg
-echo >> AndroidAppSettings.cfg
 echo "# Hack for VCMI: preload additional shared libraries before aplication start" >> AndroidAppSettings.cfg
 echo CompatibilityHacksAdditionalPreloadedSharedLibraries=\"$CompatibilityHacksAdditionalPreloadedSharedLibraries\" >> AndroidAppSettings.cfg
 echo >> AndroidAppSettings.cfg
@@ -203,6 +200,10 @@ echo "# Hack for Free Heroes 2, which redraws the screen inside SDL_PumpEvents()
 echo "# do not use it with accelerometer/gyroscope, or your app may freeze at random (y)/(n)" >> AndroidAppSettings.cfg
 echo CompatibilityHacksSlowCompatibleEventQueue=$CompatibilityHacksSlowCompatibleEventQueue >> AndroidAppSettings.cfg
 echo >> AndroidAppSettings.cfg
+echo "# Lock-free SDL event queue: input events from Java threads are not sent to SDL immediately, but queued" >> AndroidAppSettings.cfg
+echo "# and sent from SDL_PumpEvents(), excessive mouse/touch/joystick motion events are dropped (y)/(n)" >> AndroidAppSettings.cfg
+echo LockFreeEventQueue=$LockFreeEventQueue >> AndroidAppSettings.cfg
+echo >> AndroidAppSettings.cfg
 echo "# Save and restore OpenGL state when drawing on-screen keyboard for apps that use SDL_OPENGL" >> AndroidAppSettings.cfg
 echo CompatibilityHacksTouchscreenKeyboardSaveRestoreOpenGLState=$CompatibilityHacksTouchscreenKeyboardSaveRestoreOpenGLState >> AndroidAppSettings.cfg
 echo >> AndroidAppSettings.cfg
@@ -481,18 +482,18 @@ else
 	CompatibilityHacksPreventAudioChopping=
 fi
 
-if [ "$CompatibilityHacksAppIgnoresAudioBufferSize" = "y" ] ; then
-	CompatibilityHacksAppIgnoresAudioBufferSize=-DSDL_AUDIO_APP_IGNORES_RETURNED_BUFFER_SIZE=1
-else
-	CompatibilityHacksAppIgnoresAudioBufferSize=
-fi
-
 if [ "$CompatibilityHacksSlowCompatibleEventQueue" = "y" ]; then
 	CompatibilityHacksSlowCompatibleEventQueue=-DSDL_COMPATIBILITY_HACKS_SLOW_COMPATIBLE_EVENT_QUEUE=1
 else
 	CompatibilityHacksSlowCompatibleEventQueue=
 fi
 
+if [ "$LockFreeEventQueue" = "y" ]; then
+	LockFreeEventQueue=-DSDL_ANDROID_LOCKFREE_EVENT_QUEUE=1
+else
+	LockFreeEventQueue=
+fi
+
 if [ "$CompatibilityHacksTouchscreenKeyboardSaveRestoreOpenGLState" = "y" ]; then
 	CompatibilityHacksTouchscreenKeyboardSaveRestoreOpenGLState=-DSDL_TOUCHSCREEN_KEYBOARD_SAVE_RESTORE_OPENGL_STATE=1
 else
@@ -844,8 +845,8 @@ cat project/jni/SettingsTemplate.mk | \
 		$RedefinedKeycodesScreenKb \
 		$RedefinedKeycodesGamepad \
 		$CompatibilityHacksPreventAudioChopping \
-		$CompatibilityHacksAppIgnoresAudioBufferSize \
 		$CompatibilityHacksSlowCompatibleEventQueue \
+		$LockFreeEventQueue \
 		$CompatibilityHacksTouchscreenKeyboardSaveRestoreOpenGLState \
 		$CompatibilityHacksProperUsageOfSDL_UpdateRects^" | \
 	sed "s^APPLICATION_SUBDIRS_BUILD :=.*^APPLICATION_SUBDIRS_BUILD := $AppSubdirsBuild^" | \
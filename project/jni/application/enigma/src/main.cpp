@@ -124,6 +124,7 @@ static void usage()
            "    --data -d path  Load data from additional directory\n"
            "    --lang -l lang  Set game language\n"
            "    --pref -p file  Use filename or dirname for preferences\n"
+           "    --ticktime      Log the time of world ticks, needs --log\n"
            "\n",
            app.progCallPath.c_str()
            );
@@ -179,6 +180,7 @@ AP::AP() : ArgParser (app.args.begin(), app.args.end())
     def (&do_assert,            "assert");
     def (&dumpinfo,             "dumpinfo");
     def (&makepreview,          "makepreview");
+    def (&world::ReportTickTime, "ticktime");
     def (&force_window,         "window", 'w');
     def (OPT_GAME,              "game", true);
     def (OPT_DATA,              "data", 'd', true);
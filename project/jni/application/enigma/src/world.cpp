@@ -32,6 +32,7 @@
 #include <functional>
 #include <map>
 #include <numeric>
+#include <sys/time.h>
 
 
 
@@ -380,6 +381,7 @@ namespace
 
 enigma::Timer  world::GameTimer;
 bool           world::TrackMessages;
+bool           world::ReportTickTime = false;
 Actor         *world::CurrentCollisionActor = 0;
 
 
@@ -430,7 +432,9 @@ void Layer<T>::set(GridPos p, T *x) {
 
 World::World(int ww, int hh) 
 : fields(ww,hh),
-  preparing_level(true)
+  m_actorgrid(ww,hh),
+  preparing_level(true),
+  m_tick_count(0), m_tick_time(0), m_tick_time_max(0)
 {
     w = ww;
     h = hh;
@@ -489,6 +493,7 @@ void World::add_actor (Actor *a)
 void World::add_actor (Actor *a, const V2 &pos)
 {
     actorlist.push_back(a);
+    m_actorgrid.invalidate();
     a->get_actorinfo()->pos = pos;
     if (!preparing_level) {
         // if game is already running, call on_creation() from here
@@ -496,9 +501,20 @@ void World::add_actor (Actor *a, const V2 &pos)
     }
 }
 
+namespace {
+    /* SDL_GetTicks() counts milliseconds, too coarse for a single tick */
+    double tick_clock_ms ()
+    {
+        struct timeval tv;
+        gettimeofday (&tv, NULL);
+        return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+    }
+}
+
 void World::tick (double dtime)
 {
     // dtime is always 0.01 (cf. server.cc)
+    double start_time = ReportTickTime ? tick_clock_ms() : 0;
 
     move_actors (dtime);
     handle_delayed_impulses (dtime);
@@ -516,6 +532,26 @@ void World::tick (double dtime)
     GameTimer.tick(dtime);
 
     lasers::RecalcLightNow();   // recalculate laser beams if necessary
+
+    if (ReportTickTime)
+        report_tick_time (tick_clock_ms() - start_time);
+}
+
+/* Print the average and maximum time of a world tick once every
+   second of game time. */
+void World::report_tick_time (double ms)
+{
+    const int report_ticks = 100;
+
+    m_tick_time += ms;
+    m_tick_time_max = std::max (m_tick_time_max, ms);
+    if (++m_tick_count < report_ticks)
+        return;
+    Log << ecl::strf("World tick: %.3f ms average, %.3f ms max, %d actors\n",
+                     m_tick_time / m_tick_count, m_tick_time_max,
+                     (int)actorlist.size());
+    m_tick_count = 0;
+    m_tick_time = m_tick_time_max = 0;
 }
 
 /* ---------- Puzzle scrambling -------------------- */
@@ -845,42 +881,138 @@ void World::handle_stone_contact (StoneContact &sc)
     }
 }
 
-namespace {
-    struct ActorEntry {
-        double pos;
-        size_t idx;
+/* -------------------- ActorGrid -------------------- */
+
+ActorGrid::ActorGrid (int ww, int hh)
+: w(ww), h(hh), valid(false), cells(ww*hh)
+{}
+
+/* Actors outside the level are put into the nearest border cell, this
+   keeps actors that touch each other in adjacent cells. */
+int ActorGrid::cell_of (const Actor *a) const
+{
+    const V2 &pos = a->get_actorinfo().pos;
+    int x = std::max (0, std::min (w-1, round_down<int>(pos[0])));
+    int y = std::max (0, std::min (h-1, round_down<int>(pos[1])));
+    return y*w + x;
+}
+
+void ActorGrid::insert (size_t idx, int cell)
+{
+    cells[cell].push_back (idx);
+    actor_cells[idx] = cell;
+}
+
+void ActorGrid::erase (size_t idx, int cell)
+{
+    vector<size_t> &c = cells[cell];
+    vector<size_t>::iterator i = find (c.begin(), c.end(), idx);
+    if (i != c.end()) {
+        *i = c.back();
+        c.pop_back();
+    }
+}
+
+void ActorGrid::update (const ActorList &actors)
+{
+    size_t nactors = actors.size();
 
-        ActorEntry () { pos = 0; idx = 0; }
-        ActorEntry (double pos_, size_t idx_) { pos = pos_; idx = idx_; }
+    if (!valid || actor_cells.size() != nactors) {
+        for (size_t i=0; i<actor_cells.size(); ++i)
+            cells[actor_cells[i]].clear();
+        actor_cells.resize (nactors);
+        for (size_t i=0; i<nactors; ++i)
+            insert (i, cell_of (actors[i]));
+        valid = true;
+        return;
+    }
+    for (size_t i=0; i<nactors; ++i) {
+        int cell = cell_of (actors[i]);
+        if (cell != actor_cells[i]) {
+            erase (i, actor_cells[i]);
+            insert (i, cell);
+        }
+    }
+}
+
+void ActorGrid::find_pairs (vector<pair<size_t, size_t> > &pairs) const
+{
+    // Neighbour cells after the current one, so that every pair of
+    // cells is visited once
+    static const int dx[] = { 1, -1, 0, 1 };
+    static const int dy[] = { 0,  1, 1, 1 };
+
+    for (size_t i=0; i<actor_cells.size(); ++i) {
+        int cell = actor_cells[i];
+        int x = cell % w, y = cell / w;
+
+        const vector<size_t> &same = cells[cell];
+        for (size_t k=0; k<same.size(); ++k)
+            if (same[k] > i)
+                pairs.push_back (make_pair (i, same[k]));
+
+        for (int n=0; n<4; ++n) {
+            int nx = x + dx[n], ny = y + dy[n];
+            if (nx < 0 || nx >= w || ny >= h)
+                continue;
+            const vector<size_t> &other = cells[ny*w + nx];
+            for (size_t k=0; k<other.size(); ++k)
+                pairs.push_back (make_pair (i, other[k]));
+        }
+    }
+}
+
+namespace {
+    /* Actor pairs are handled in the order of the x coordinates of
+       both actors, like the sweep along the x axis that was used
+       before the actor grid.  That sweep stopped at the first actor
+       out of reach of the left one, and so missed a larger actor
+       further right that did touch it; the grid finds that contact,
+       so with actors of different sizes the contacts can differ. */
+    struct ActorPairLess {
+        const ActorList &actors;
+
+        ActorPairLess (const ActorList &actors_) : actors(actors_) {}
+
+        bool less (size_t a, size_t b) const {
+            double xa = actors[a]->get_actorinfo()->pos[0];
+            double xb = actors[b]->get_actorinfo()->pos[0];
+            return xa < xb || (xa == xb && a < b);
+        }
 
-        bool operator < (const ActorEntry &x) const {
-            return pos < x.pos;
+        bool operator () (const pair<size_t, size_t> &p1,
+                          const pair<size_t, size_t> &p2) const {
+            if (p1.first != p2.first)
+                return less (p1.first, p2.first);
+            return less (p1.second, p2.second);
         }
     };
 };
 
 void World::handle_actor_contacts () {
-    size_t nactors = actorlist.size();
-    vector<ActorEntry> xlist (nactors);
+    static vector<pair<size_t, size_t> > pairs;
+    ActorPairLess pair_less (actorlist);
 
-    for (size_t i=0; i<nactors; ++i) {
-        ActorInfo *ai = actorlist[i]->get_actorinfo();
-        xlist[i] = ActorEntry (ai->pos[0], i);
-    }
-    sort (xlist.begin(), xlist.end());
-    for (size_t i=0; i<nactors; ++i) {
-        size_t a1 = xlist[i].idx;
-        ActorInfo &ai1 = *actorlist[a1]->get_actorinfo();
-        double r1 = ai1.radius;
-        double x1 = ai1.pos[0];
-        for (size_t j=i+1; j<nactors; ++j) {
-            size_t a2 = xlist[j].idx;
-            if (xlist[j].pos - x1 < r1 + get_radius(actorlist[a2])) 
-                handle_actor_contact (a1, a2);
-            else
-                break;
-        }
+    pairs.clear();
+    m_actorgrid.find_pairs (pairs);
+
+    // Keep the pairs of actors that may touch, the first actor of
+    // each pair is the left one
+    size_t npairs = 0;
+    for (size_t i=0; i<pairs.size(); ++i) {
+        size_t a1 = pairs[i].first, a2 = pairs[i].second;
+        if (pair_less.less (a2, a1))
+            swap (a1, a2);
+        const ActorInfo &ai1 = *actorlist[a1]->get_actorinfo();
+        const ActorInfo &ai2 = *actorlist[a2]->get_actorinfo();
+        if (ai2.pos[0] - ai1.pos[0] < ai1.radius + ai2.radius)
+            pairs[npairs++] = make_pair (a1, a2);
     }
+    pairs.resize (npairs);
+    sort (pairs.begin(), pairs.end(), pair_less);
+
+    for (size_t i=0; i<npairs; ++i)
+        handle_actor_contact (pairs[i].first, pairs[i].second);
 }
 
 void World::handle_actor_contact (size_t i, size_t j)
@@ -980,6 +1112,9 @@ void World::move_actors (double dtime)
             ai.new_contacts.clear();
         }
         
+        // Actors are moved by advance_actor() and warped by stones and
+        // items, so the grid is updated right before it is used.
+        m_actorgrid.update (actorlist);
         handle_actor_contacts();
         for (unsigned i=0; i<nactors; ++i) 
             handle_contacts (i);
@@ -1675,6 +1810,7 @@ Actor * world::YieldActor(Actor *a)
     ActorList::iterator i=find(level->actorlist.begin(), level->actorlist.end(), a);
     if (i != level->actorlist.end()) {
         level->actorlist.erase(i);
+        level->m_actorgrid.invalidate();
         GrabActor(a);
         return a;
     }
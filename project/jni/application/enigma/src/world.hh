@@ -135,6 +135,9 @@ namespace world
     /* Output a message whenever a message is being sent. */
     extern bool TrackMessages;
 
+    /* Log the time needed for world ticks once per second. */
+    extern bool ReportTickTime;
+
     /* A hack to implement BlackBallsStone and WhiteBallsStone. */
     extern Actor *CurrentCollisionActor;
 
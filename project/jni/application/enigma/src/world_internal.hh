@@ -186,6 +186,41 @@ namespace world
 
     typedef list<DelayedImpulse> ImpulseList;
 
+/* -------------------- ActorGrid -------------------- */
+
+    /*! The broad phase of actor-actor collisions: a uniform grid with
+      one cell per field, each cell holds the indices (into
+      World::actorlist) of the actors whose center lies in it.  Actors
+      are smaller than half a field (cf. Actor::get_max_radius()), so
+      two actors can only touch if they are in the same or in adjacent
+      cells. */
+    class ActorGrid {
+    public:
+        ActorGrid (int ww, int hh);
+
+        /*! Must be called whenever actors are added to or removed from
+          the actor list, the next update() then rebuilds the grid. */
+        void invalidate () { valid = false; }
+
+        /*! Moves the actors that have left their cell since the last
+          update. */
+        void update (const ActorList &actors);
+
+        /*! Appends all pairs of actors in the same or adjacent cells
+          to `pairs', each pair once. */
+        void find_pairs (vector<pair<size_t, size_t> > &pairs) const;
+
+    private:
+        int cell_of (const Actor *a) const;
+        void insert (size_t idx, int cell);
+        void erase (size_t idx, int cell);
+
+        int                     w, h;
+        bool                    valid;
+        vector<vector<size_t> > cells;
+        vector<int>             actor_cells; // cell of each actor
+    };
+
 /* -------------------- Layer -------------------- */
 
     template <class T>
@@ -321,6 +356,7 @@ typedef list<sound::SoundDamping> SoundDampingList;
         void handle_stone_contact (StoneContact &sc);
         void handle_actor_contacts ();
         void handle_actor_contact (size_t a1, size_t a2);
+        void report_tick_time (double ms);
         void handle_contacts (unsigned actoridx);
         void handle_delayed_impulses (double dtime);
         void stone_change (GridPos p);
@@ -334,6 +370,7 @@ typedef list<sound::SoundDamping> SoundDampingList;
         int                  w, h; // Width and height of the level
         ForceList            forces;
         ActorList            actorlist; // List of movable, dynamic objects
+        ActorGrid            m_actorgrid; // Actors sorted into fields
         vector<RubberBand *> m_rubberbands;
         SignalList           m_signals;
         MouseForce           m_mouseforce;
@@ -356,6 +393,11 @@ typedef list<sound::SoundDamping> SoundDampingList;
         ecl::Dict<Object *> m_objnames; // Name -> object mapping
 
         list<Scramble> scrambles;
+
+        // Tick time statistics, see ReportTickTime
+        int    m_tick_count;
+        double m_tick_time;
+        double m_tick_time_max;
     };
 }
 
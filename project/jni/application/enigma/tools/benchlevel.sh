@@ -0,0 +1,63 @@
+#!/bin/sh
+#
+# Write an Enigma level with many marbles and rotors to stdout, for
+# measuring the time of world ticks:
+#
+#   tools/benchlevel.sh 400 > ~/.enigma/levels/auto/bench400.xml
+#   enigma --log --ticktime
+#
+# The level is in the "Auto" level pack.  The first argument is the
+# number of actors (default 400), half of them small white marbles
+# and half of them rotors that chase the black marble.
+
+NACTORS=${1:-400}
+WIDTH=58
+HEIGHT=37
+
+cat <<EOF
+<?xml version="1.0" encoding="UTF-8" standalone="no" ?>
+<el:level xmlns:el="http://enigma-game.org/schema/level/1" xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance" xsi:schemaLocation="http://enigma-game.org/schema/level/1 level.xsd">
+  <el:protected>
+    <el:info el:type="level">
+      <el:identity el:title="Actor Benchmark $NACTORS" el:id="bench_actors_$NACTORS"/>
+      <el:version el:score="1" el:release="1" el:revision="1" el:status="experimental"/>
+      <el:author>
+        <el:name>Enigma developers</el:name>
+      </el:author>
+      <el:copyright>Copyright (c) Enigma developers</el:copyright>
+      <el:license el:type="GPL v2.0 or above" el:open="true"/>
+      <el:compatibility el:enigma="0.92"/>
+      <el:modes el:easy="false" el:single="true" el:network="false"/>
+      <el:score el:easy="-" el:difficult="-"/>
+    </el:info>
+    <el:luamain><![CDATA[
+levelw = $WIDTH
+levelh = $HEIGHT
+nactors = $NACTORS
+
+create_world(levelw, levelh)
+fill_floor("fl-normal")
+draw_border("st-rock1")
+oxyd(1, 0)
+oxyd(levelw-2, levelh-1)
+
+set_actor("ac-blackball", levelw/2, levelh/2, {player=0})
+
+-- Place the actors row by row from the top, about one per field:
+-- rows are 0.9 fields apart and every other one is shifted by 0.4
+local cols = levelw - 2
+for i = 0, nactors-1 do
+    local x = 1.3 + math.fmod(i, cols) + 0.4 * math.fmod(math.floor(i / cols), 2)
+    local y = 1.3 + math.fmod(math.floor(i / cols), levelh - 2) * 0.9
+    if math.fmod(i, 2) == 0 then
+        set_actor("ac-whiteball-small", x, y, {player=0, mouseforce=1})
+    else
+        set_actor("ac-rotor", x, y, {player=0, mouseforce=0,
+                                     range=30, force=10})
+    end
+end
+]]></el:luamain>
+    <el:i18n/>
+  </el:protected>
+</el:level>
+EOF
@@ -28,6 +28,15 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 void CL_FinishTimeDemo (void);
 
+cvar_t	cl_timedemohash = {"cl_timedemohash","0"};
+cvar_t	cl_timedemostages = {"cl_timedemostages","0"};
+
+static int		td_checkstage;		// timedemocheck run in progress, 1 serial, 2 threaded
+static float	td_checkthreads;	// r_threads for the second run
+static float	td_checksaved;		// r_threads to put back
+static unsigned	td_checkhash;		// view hash of the serial run
+static char		td_checkdemo[MAX_QPATH];
+
 /*
 ==============================================================================
 
@@ -112,7 +121,10 @@ int CL_GetMessage (void)
 			// if this is the second frame, grab the real td_starttime
 			// so the bogus time on the first frame doesn't count
 				if (host_framecount == cls.td_startframe + 1)
-					cls.td_starttime = (float)realtime;
+				{
+					cls.td_starttime = (float)Sys_FloatTime ();
+					R_ClearStageTimes ();
+				}
 			}
 			else if ( /* cl.time > 0 && */ cl.time <= cl.mtime[0])
 			{
@@ -181,7 +193,10 @@ int CL_GetMessageFPM (void)
 			// if this is the second frame, grab the real td_starttime
 			// so the bogus time on the first frame doesn't count
 				if (host_framecount == cls.td_startframe + 1)
-					cls.td_starttime = (float)realtime;
+				{
+					cls.td_starttime = (float)Sys_FloatTime ();
+					R_ClearStageTimes ();
+				}
 			}
 			else if ( /* cl.time > 0 && */ clFPM.time <= clFPM.mtime[0])
 			{
@@ -417,15 +432,64 @@ void CL_FinishTimeDemo (void)
 {
 	int		frames;
 	float	time;
+	int		i;
 	
 	cls.timedemo = false;
 	
 // the first frame didn't count
 	frames = (host_framecount - cls.td_startframe) - 1;
-	time = (float)(realtime - cls.td_starttime);
+// not realtime, the main loop steps it by a fixed frame time
+	time = (float)(Sys_FloatTime () - cls.td_starttime);
 	if (!time)
 		time = 1;
 	Con_Printf ("%i frames %5.1f seconds %5.1f fps\n", frames, time, frames/time);
+	if (cl_timedemohash.value || td_checkstage)
+		Con_Printf ("view hash %08x\n", cls.td_hash);
+
+// one line of name=value pairs for scripts, stage times in ms per frame
+	if (r_timestages)
+	{
+		R_TimeStage (RS_OTHER);
+		r_timestages = false;
+		if (frames < 1)
+			frames = 1;
+#ifdef FLOAT_PIPELINE
+		Con_Printf ("benchmark pipeline=float");
+#else
+		Con_Printf ("benchmark pipeline=fixed");
+#endif
+		Con_Printf (" threads=%i frames=%i seconds=%.3f fps=%.2f",
+			(int)r_threads.value, frames, time, frames/time);
+		for (i=0 ; i<NUM_RSTAGES ; i++)
+			Con_Printf (" %s=%.3f", r_stagenames[i], r_stagetime[i] * 1000 / frames);
+		Con_Printf ("\n");
+	}
+
+	if (td_checkstage == 1)
+	{
+	// play it again with the surfaces drawn on worker threads
+		td_checkhash = cls.td_hash;
+		td_checkstage = 2;
+		Cvar_SetValue ("r_threads", td_checkthreads);
+		Cbuf_AddText (va("timedemo %s\n", td_checkdemo));
+		return;
+	}
+	if (td_checkstage == 2)
+	{
+		td_checkstage = 0;
+		Cvar_SetValue ("r_threads", td_checksaved);
+		if (cls.td_hash == td_checkhash)
+			Con_Printf ("timedemocheck: r_threads %i matches serial\n", (int)td_checkthreads);
+		else
+			Con_Printf ("timedemocheck: r_threads %i FAILED, %08x serial %08x threaded\n",
+				(int)td_checkthreads, td_checkhash, cls.td_hash);
+	}
+
+	if (COM_CheckParm ("-benchmark"))
+	{
+		Host_ShutdownServer (false);
+		Sys_Quit ();
+	}
 
 #ifdef _X86_
 	//Dan East:
@@ -471,5 +535,69 @@ void CL_TimeDemo_f (void)
 	cls.timedemo = true;
 	cls.td_startframe = host_framecount;
 	cls.td_lastframe = -1;		// get a new message this frame
+	cls.td_hash = 2166136261u;
+	if (cl_timedemohash.value || td_checkstage)
+		srand (0);	// particle effects are random, replay the same ones
+	r_timestages = cl_timedemostages.value != 0;
+}
+
+/*
+====================
+CL_TimeDemoCheck_f
+
+timedemocheck <demoname> [threads]
+
+Runs the timedemo serially and then with the surfaces drawn on worker
+threads, and reports whether the two runs drew the same views
+====================
+*/
+void CL_TimeDemoCheck_f (void)
+{
+	if (cmd_source != src_command)
+		return;
+
+	if (Cmd_Argc() != 2 && Cmd_Argc() != 3)
+	{
+		Con_Printf ("timedemocheck <demoname> [threads] : compares threaded and serial views\n");
+		return;
+	}
+
+	td_checkthreads = Cmd_Argc() == 3 ? Q_atoi (Cmd_Argv(2)) : 4;
+	if (td_checkthreads < 2)
+	{
+		Con_Printf ("timedemocheck needs at least 2 threads\n");
+		return;
+	}
+	Q_strncpyz (td_checkdemo, Cmd_Argv(1), sizeof(td_checkdemo));
+	td_checksaved = r_threads.value;
+	td_checkstage = 1;
+	Cvar_SetValue ("r_threads", 1);
+	Cbuf_InsertText (va("timedemo %s\n", td_checkdemo));
+}
+
+/*
+====================
+CL_HashTimeDemoFrame
+
+Folds the view just drawn into the hash printed at the end of a timedemo
+when cl_timedemohash is set, so renderer changes can be checked to leave
+every pixel alone
+====================
+*/
+void CL_HashTimeDemoFrame (void)
+{
+	byte	*row;
+	int		x, y;
+	unsigned	hash;
+
+	if (!cls.timedemo || (!cl_timedemohash.value && !td_checkstage) || con_forcedup)
+		return;	// no view was drawn
+
+	hash = cls.td_hash;
+	row = vid.buffer + r_refdef.vrect.y * vid.rowbytes + r_refdef.vrect.x;
+	for (y=0 ; y<r_refdef.vrect.height ; y++, row += vid.rowbytes)
+		for (x=0 ; x<r_refdef.vrect.width ; x++)
+			hash = (hash ^ row[x]) * 16777619;	// FNV-1a
+	cls.td_hash = hash;
 }
 
@@ -1252,6 +1252,8 @@ void CL_Init (void)
 	Cvar_RegisterVariable (&cl_showfps);// 2001-11-31 FPS display by QuakeForge/Muff
 	Cvar_RegisterVariable (&cl_shownet);
 	Cvar_RegisterVariable (&cl_nolerp);
+	Cvar_RegisterVariable (&cl_timedemohash);
+	Cvar_RegisterVariable (&cl_timedemostages);
 	Cvar_RegisterVariable (&lookspring);
 	Cvar_RegisterVariable (&lookstrafe);
 	Cvar_RegisterVariable (&sensitivity);
@@ -1273,5 +1275,6 @@ void CL_Init (void)
 	//	Cmd_AddCommand ("playdemo", CL_PlayDemo_silentfail);
 	Cmd_AddCommand ("playdemo", CL_PlayDemo_f);
 	Cmd_AddCommand ("timedemo", CL_TimeDemo_f);
+	Cmd_AddCommand ("timedemocheck", CL_TimeDemoCheck_f);
 }
 
@@ -163,7 +163,8 @@ typedef struct
 	FILE		*demofile;
 	int			td_lastframe;		// to meter out one message a frame
 	int			td_startframe;		// host_framecount at start
-	float		td_starttime;		// realtime at second frame of timedemo
+	float		td_starttime;		// Sys_FloatTime at second frame of timedemo
+	unsigned	td_hash;			// of the views drawn, for cl_timedemohash
 
 
 // connection information
@@ -384,6 +385,8 @@ extern  cvar_t  cl_showfps;// 2001-11-31 FPS display by QuakeForge/Muff
 extern  int     fps_count;// 2001-11-31 FPS display by QuakeForge/Muff
 extern	cvar_t	cl_shownet;
 extern	cvar_t	cl_nolerp;
+extern	cvar_t	cl_timedemohash;
+extern	cvar_t	cl_timedemostages;
 
 extern	cvar_t	cl_pitchdriftspeed;
 extern	cvar_t	lookspring;
@@ -498,6 +501,8 @@ void CL_Record_f (void);
 void CL_PlayDemo_f (void);
 void CL_PlayDemo_silentfail (void);
 void CL_TimeDemo_f (void);
+void CL_TimeDemoCheck_f (void);
+void CL_HashTimeDemoFrame (void);
 
 //
 // cl_parse.c
@@ -117,13 +117,18 @@ D_DrawSolidSurface
 // FIXME: clean this up
 
 void D_DrawSolidSurface (surf_t *surf, int color)
+{
+	D_DrawSolidSpans (surf->spans, color);
+}
+
+void D_DrawSolidSpans (espan_t *pspan, int color)
 {
 	espan_t	*span;
 	byte	*pdest;
 	int		u, u2, pix;
 	
 	pix = (color<<24) | (color<<16) | (color<<8) | color;
-	for (span=surf->spans ; span ; span=span->pnext)
+	for (span=pspan ; span ; span=span->pnext)
 	{
 		pdest = (byte *)d_viewbuffer + screenwidth*span->v;
 		u = span->u;
@@ -369,6 +374,277 @@ void D_CalcGradients (msurface_t *pface)
 }
 #endif
 */
+/*
+==============================================================================
+
+THREADED SURFACE DRAWING
+
+With r_threads above 1 the surfaces are not drawn as they are found: each
+becomes a job with a snapshot of its span state, and the surface cache fills
+it needs are queued.  D_FlushSurfaceBatch then builds the queued surfaces on
+all threads, and draws the spans of all the jobs one band of the screen per
+thread, so no two threads ever touch the same rows of the view or z buffer.
+Spans never overlap, so the picture is exactly that of the serial path.
+
+A cache block read or filled by the pending batch is stamped with
+d_surfbatch; D_SCAlloc and D_CacheSurface flush the batch before reusing
+such a block.
+
+==============================================================================
+*/
+
+#define	MAX_SURFJOBS	512
+#define	MAX_BANDS		16
+#define	BAND_SHIFT		3		// bands are interleaved strips of 8 rows
+
+enum {SJ_SOLID, SJ_SKY, SJ_TURB, SJ_SPANS};
+
+typedef struct
+{
+	int			type;
+	int			color;					// SJ_SOLID
+	spanstate_t	st;
+	espan_t		*spans[MAX_BANDS];
+} surfjob_t;
+
+static surfjob_t	surfjobs[MAX_SURFJOBS];
+static int			numsurfjobs;
+static drawsurf_t	surffills[MAX_SURFJOBS];
+static int			numsurffills;
+static int			numbands;
+
+/*
+==============
+D_QueueSurfaceFill
+
+Called by D_CacheSurface instead of R_DrawSurface while the batch is built
+==============
+*/
+void D_QueueSurfaceFill (surfcache_t *cache)
+{
+	if (numsurffills == MAX_SURFJOBS)
+		D_FlushSurfaceBatch ();
+
+	surffills[numsurffills++] = r_drawsurf;
+	cache->batch = d_surfbatch;
+}
+
+static void D_FillSurface (int i)
+{
+	unsigned	blocklights[18*18];
+
+	R_GenerateSurface (&surffills[i], blocklights);
+}
+
+static void D_DrawSurfaceBand (int band)
+{
+	surfjob_t	*job;
+	espan_t		*pspan;
+	int			i;
+
+	for (i=0, job=surfjobs ; i<numsurfjobs ; i++, job++)
+	{
+		pspan = job->spans[band];
+		if (!pspan)
+			continue;
+
+		switch (job->type)
+		{
+		case SJ_SOLID:
+			D_DrawSolidSpans (pspan, job->color);
+			break;
+		case SJ_SKY:
+		// the sky only reads the view vectors, which are not rotated for
+		// a submodel while a batch can be flushed
+			D_DrawSkyScans8 (pspan);
+			break;
+		case SJ_TURB:
+			Turbulent8_r (pspan, &job->st);
+			break;
+		default:
+			D_DrawSpans8_r (pspan, &job->st);
+			break;
+		}
+		D_DrawZSpans_r (pspan, &job->st);
+	}
+}
+
+/*
+==============
+D_FlushSurfaceBatch
+==============
+*/
+void D_FlushSurfaceBatch (void)
+{
+	int		stage;
+
+	if (numsurffills)
+	{
+		stage = R_TimeStage (RS_SURFCACHE);
+		Sys_RunParallel (numbands, numsurffills, D_FillSurface);
+		R_TimeStage (stage);
+	}
+	if (numsurfjobs)
+		Sys_RunParallel (numbands, numbands, D_DrawSurfaceBand);
+
+	numsurffills = 0;
+	numsurfjobs = 0;
+	d_surfbatch++;
+}
+
+/*
+==============
+D_AddSurfaceJob
+
+Takes the span state from the globals and deals the spans out to the bands
+==============
+*/
+static void D_AddSurfaceJob (surf_t *s, int type, int color)
+{
+	surfjob_t	*job;
+	espan_t		*span, *next;
+	int			band;
+
+	job = &surfjobs[numsurfjobs++];
+	job->type = type;
+	job->color = color;
+	D_GetSpanState (&job->st);
+
+	for (band=0 ; band<numbands ; band++)
+		job->spans[band] = NULL;
+	for (span=s->spans ; span ; span=next)
+	{
+		next = span->pnext;
+		band = (span->v >> BAND_SHIFT) % numbands;
+		span->pnext = job->spans[band];
+		job->spans[band] = span;
+	}
+}
+
+/*
+==============
+D_DrawSurfacesThreaded
+
+Same as the serial D_DrawSurfaces, but queues jobs instead of drawing
+==============
+*/
+static void D_DrawSurfacesThreaded (int threads)
+{
+	surf_t			*s;
+	msurface_t		*pface;
+	surfcache_t		*pcurrentcache;
+	texture_t		*tx;
+	vec3_t			world_transformed_modelorg;
+	vec3_t			local_modelorg;
+	extern cvar_t	r_fastsky;
+	extern cvar_t	r_skycolor;
+	extern cvar_t	r_fastturb;
+
+	numbands = threads;
+	d_deferfills = true;
+
+	currententity = &cl_entities[0];
+	TransformVector (modelorg, transformed_modelorg);
+	VectorCopy (transformed_modelorg, world_transformed_modelorg);
+
+	for (s = &surfaces[1] ; s<surface_p ; s++)
+	{
+		if (!s->spans)
+			continue;
+
+		if (numsurfjobs == MAX_SURFJOBS)
+			D_FlushSurfaceBatch ();
+
+		r_drawnpolycount++;
+
+		d_zistepu = s->d_zistepu;
+		d_zistepv = s->d_zistepv;
+		d_ziorigin = s->d_ziorigin;
+
+		if (s->flags & SURF_DRAWSKY)
+		{
+			if (r_fastsky.value)
+				D_AddSurfaceJob (s, SJ_SOLID, (int)r_skycolor.value & 0xFF);
+			else
+			{
+				if (!r_skymade)
+					R_MakeSky ();
+				D_AddSurfaceJob (s, SJ_SKY, 0);
+			}
+			continue;
+		}
+
+		if (s->flags & SURF_DRAWBACKGROUND)
+		{
+			d_zistepu = 0;
+			d_zistepv = 0;
+			d_ziorigin = (float)-0.9;
+
+			D_AddSurfaceJob (s, SJ_SOLID, (int)r_clearcolor.value & 0xFF);
+			continue;
+		}
+
+		pface = s->data;
+
+		if (s->flags & SURF_DRAWTURB)
+		{
+			tx = pface->texinfo->texture;
+			if (r_fastturb.value)
+			{
+				D_AddSurfaceJob (s, SJ_SOLID,
+					*((byte *)tx + tx->offsets[0] + ((tx->width * tx->height) >> 1)));
+				continue;
+			}
+			miplevel = 0;
+			cacheblock = (pixel_t *)((byte *)tx + tx->offsets[0]);
+			cachewidth = 64;
+		}
+		else
+		{
+		// the cache is filled before the view is rotated, so a flush
+		// from D_CacheSurface never sees a submodel's view vectors
+			if (s->insubmodel)
+				currententity = s->entity;
+
+			miplevel = D_MipLevelForScale (s->nearzi * scale_for_mip
+			* pface->texinfo->mipadjust);
+
+			pcurrentcache = D_CacheSurface (pface, miplevel);
+			pcurrentcache->batch = d_surfbatch;
+
+			cacheblock = (pixel_t *)pcurrentcache->data;
+			cachewidth = pcurrentcache->width;
+		}
+
+		if (s->insubmodel)
+		{
+			currententity = s->entity;
+			VectorSubtract (r_origin, currententity->origin, local_modelorg);
+			TransformVector (local_modelorg, transformed_modelorg);
+
+			R_RotateBmodel ();
+		}
+
+		D_CalcGradients (pface);
+		D_AddSurfaceJob (s, (s->flags & SURF_DRAWTURB) ? SJ_TURB : SJ_SPANS, 0);
+
+		if (s->insubmodel)
+		{
+		// restore the old drawing state
+			currententity = &cl_entities[0];
+			VectorCopy (world_transformed_modelorg, transformed_modelorg);
+			VectorCopy (base_vpn, vpn);
+			VectorCopy (base_vup, vup);
+			VectorCopy (base_vright, vright);
+			VectorCopy (base_modelorg, modelorg);
+			R_TransformFrustum ();
+		}
+	}
+
+	D_FlushSurfaceBatch ();
+	d_deferfills = false;
+}
+
 /*
 ==============
 D_DrawSurfaces
@@ -384,7 +660,22 @@ void D_DrawSurfaces (void)
 	surfcache_t		*pcurrentcache;
 	vec3_t			world_transformed_modelorg;
 	vec3_t			local_modelorg;
-			    
+	int				threads;
+	int				stage;
+
+	stage = R_TimeStage (RS_SPANS);
+
+#ifndef USE_PQ_OPT3
+	threads = (int)r_threads.value;
+	if (threads > MAX_BANDS)
+		threads = MAX_BANDS;
+	if (threads > 1 && !r_drawflat.value && r_pixbytes == 1)
+	{
+		D_DrawSurfacesThreaded (threads);
+		R_TimeStage (stage);
+		return;
+	}
+#endif
 
 	currententity = &cl_entities[0];
 	TransformVector (modelorg, transformed_modelorg);
@@ -575,6 +866,8 @@ void D_DrawSurfaces (void)
 			}
 		}
 	}
+
+	R_TimeStage (stage);
 }
 #else
 //JB: Optimization
@@ -158,6 +158,7 @@ typedef struct
 } zpointdesc_FPM_t;
 */
 extern cvar_t	r_drawflat;
+extern cvar_t	r_threads;
 extern int		d_spanpixcount;
 extern int		r_framecount;		// sequence # of current frame since Quake
 									//  started
@@ -278,6 +279,7 @@ extern drawsurf_t	r_drawsurf;
 //extern drawsurf_FPM_t	r_drawsurfFPM;
 
 void R_DrawSurface (void);
+void R_GenerateSurface (drawsurf_t *ds, unsigned *blocklights);
 //void R_DrawSurfaceFPM (void);
 void R_GenTile (msurface_t *psurf, void *pdest);
 
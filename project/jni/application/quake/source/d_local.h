@@ -45,6 +45,7 @@ typedef struct surfcache_s
 	unsigned			height;		// DEBUG only needed for debug
 	float				mipscale;
 	struct texture_s	*texture;	// checked for animating textures
+	int					batch;		// span batch that reads or fills it
 	byte				data[4];	// width*height elements
 } surfcache_t;
 
@@ -110,6 +111,25 @@ fixed16_t		bbextents, bbextentt;
 fixedpoint_t	sadjustFPM, tadjustFPM;
 fixedpoint_t	bbextentsFPM, bbextenttFPM;
 
+// everything the span drawers read for one surface, so that surfaces
+// can be drawn on several threads at once
+typedef struct
+{
+	float		sdivzstepu, tdivzstepu, zistepu;
+	float		sdivzstepv, tdivzstepv, zistepv;
+	float		sdivzorigin, tdivzorigin, ziorigin;
+	fixed16_t	sadjust, tadjust;
+	fixed16_t	bbextents, bbextentt;
+	pixel_t		*cacheblock;
+	int			cachewidth;
+} spanstate_t;
+
+void D_GetSpanState (spanstate_t *st);
+void D_DrawSpans8_r (espan_t *pspan, spanstate_t *st);
+void D_DrawZSpans_r (espan_t *pspan, spanstate_t *st);
+void Turbulent8_r (espan_t *pspan, spanstate_t *st);
+void D_DrawSolidSpans (espan_t *pspan, int color);
+
 
 void D_DrawSpans8 (espan_t *pspans);
 #ifdef USE_PQ_OPT
@@ -129,6 +149,11 @@ void D_DrawSkyScans16 (espan_t *pspan);
 void R_ShowSubDiv (void);
 void (*prealspandrawer)(void);
 surfcache_t	*D_CacheSurface (msurface_t *surface, int miplevel);
+void D_FlushSurfaceBatch (void);
+void D_QueueSurfaceFill (surfcache_t *cache);
+
+extern int			d_surfbatch;	// stamp of the span batch being built
+extern qboolean		d_deferfills;	// D_CacheSurface queues the fills
 //surfcache_FPM_t	*D_CacheSurfaceFPM (msurface_FPM_t *surface, int miplevel);
 
 extern int D_MipLevelForScale (float scale);
@@ -4,12 +4,47 @@
 #include "r_local.h"
 #include "d_local.h"
 
-unsigned char *r_turb_pbase, *r_turb_pdest;
-fixed16_t r_turb_s, r_turb_t, r_turb_sstep, r_turb_tstep;
-int *r_turb_turb;
-int r_turb_spancount;
+/*==============================================
+// D_GetSpanState
+// snapshots the gradients and texture the span drawers read from globals
+//============================================*/
+void D_GetSpanState (spanstate_t *st)
+{
+	st->sdivzstepu = d_sdivzstepu;
+	st->tdivzstepu = d_tdivzstepu;
+	st->zistepu = d_zistepu;
+	st->sdivzstepv = d_sdivzstepv;
+	st->tdivzstepv = d_tdivzstepv;
+	st->zistepv = d_zistepv;
+	st->sdivzorigin = d_sdivzorigin;
+	st->tdivzorigin = d_tdivzorigin;
+	st->ziorigin = d_ziorigin;
+	st->sadjust = sadjust;
+	st->tadjust = tadjust;
+	st->bbextents = bbextents;
+	st->bbextentt = bbextentt;
+	st->cacheblock = cacheblock;
+	st->cachewidth = cachewidth;
+}
 
-void D_DrawTurbulent8Span (void);
+/*==============================================
+// D_DrawSpans8
+// D_DrawZSpans
+// draw with the gradients the current surface left in the globals
+//============================================*/
+void D_DrawSpans8 (espan_t *pspan)
+{
+	spanstate_t st;
+	D_GetSpanState (&st);
+	D_DrawSpans8_r (pspan, &st);
+}
+
+void D_DrawZSpans (espan_t *pspan)
+{
+	spanstate_t st;
+	D_GetSpanState (&st);
+	D_DrawZSpans_r (pspan, &st);
+}
 
 /*==============================================
 // D_WarpScreen
@@ -57,66 +92,73 @@ void D_WarpScreen (void)
 	}
 }
 
-#if	!id386
-
 /*==============================================
 // D_DrawTurbulent8Span
 //============================================*/
-void D_DrawTurbulent8Span (void)
+static void D_DrawTurbulent8Span (unsigned char *pdest, unsigned char *pbase,
+	int *turb, fixed16_t s, fixed16_t t, fixed16_t sstep, fixed16_t tstep,
+	int spancount)
 {
 	int sturb, tturb;
 	do
 	{
-		sturb = ((r_turb_s + r_turb_turb[(r_turb_t>>16)&(CYCLE-1)])>>16)&63;
-		tturb = ((r_turb_t + r_turb_turb[(r_turb_s>>16)&(CYCLE-1)])>>16)&63;
-		*r_turb_pdest++ = *(r_turb_pbase + (tturb<<6) + sturb);
-		r_turb_s += r_turb_sstep;
-		r_turb_t += r_turb_tstep;
-	} while (--r_turb_spancount > 0);
+		sturb = ((s + turb[(t>>16)&(CYCLE-1)])>>16)&63;
+		tturb = ((t + turb[(s>>16)&(CYCLE-1)])>>16)&63;
+		*pdest++ = *(pbase + (tturb<<6) + sturb);
+		s += sstep;
+		t += tstep;
+	} while (--spancount > 0);
 }
 
-#endif	// !id386
-
 /*==============================================
 // Turbulent8
 //============================================*/
 void Turbulent8 (espan_t *pspan)
 {
-	int	count;
-	fixed16_t snext, tnext;
+	spanstate_t st;
+	D_GetSpanState (&st);
+	Turbulent8_r (pspan, &st);
+}
+
+void Turbulent8_r (espan_t *pspan, spanstate_t *st)
+{
+	int	count, spancount;
+	unsigned char *pbase, *pdest;
+	int *turb;
+	fixed16_t s, t, sstep, tstep, snext, tnext;
 	float sdivz, tdivz, zi, z, du, dv, spancountminus1;
 	float sdivz16stepu, tdivz16stepu, zi16stepu;
-	r_turb_turb = sintable + ((int)(cl.time*SPEED)&(CYCLE-1));
-	r_turb_sstep = 0;	// keep compiler happy
-	r_turb_tstep = 0;	// ditto
-	r_turb_pbase = (unsigned char *)cacheblock;
-	sdivz16stepu = d_sdivzstepu * 16;
-	tdivz16stepu = d_tdivzstepu * 16;
-	zi16stepu = d_zistepu * 16;
+	turb = sintable + ((int)(cl.time*SPEED)&(CYCLE-1));
+	sstep = 0;	// keep compiler happy
+	tstep = 0;	// ditto
+	pbase = (unsigned char *)st->cacheblock;
+	sdivz16stepu = st->sdivzstepu * 16;
+	tdivz16stepu = st->tdivzstepu * 16;
+	zi16stepu = st->zistepu * 16;
 	do
 	{
-		r_turb_pdest = (unsigned char *)((byte *)d_viewbuffer +
+		pdest = (unsigned char *)((byte *)d_viewbuffer +
 				(screenwidth * pspan->v) + pspan->u);
 		count = pspan->count;
 		// calculate the initial s/z, t/z, 1/z, s, and t and clamp
 		du = (float)pspan->u;
 		dv = (float)pspan->v;
-		sdivz = d_sdivzorigin + dv*d_sdivzstepv + du*d_sdivzstepu;
-		tdivz = d_tdivzorigin + dv*d_tdivzstepv + du*d_tdivzstepu;
-		zi = d_ziorigin + dv*d_zistepv + du*d_zistepu;
+		sdivz = st->sdivzorigin + dv*st->sdivzstepv + du*st->sdivzstepu;
+		tdivz = st->tdivzorigin + dv*st->tdivzstepv + du*st->tdivzstepu;
+		zi = st->ziorigin + dv*st->zistepv + du*st->zistepu;
 		z = (float)0x10000 / zi;	// prescale to 16.16 fixed-point
-		r_turb_s = (int)(sdivz * z) + sadjust;
-		if (r_turb_s > bbextents) r_turb_s = bbextents;
-		else if (r_turb_s < 0) r_turb_s = 0;
-		r_turb_t = (int)(tdivz * z) + tadjust;
-		if (r_turb_t > bbextentt) r_turb_t = bbextentt;
-		else if (r_turb_t < 0) r_turb_t = 0;
+		s = (int)(sdivz * z) + st->sadjust;
+		if (s > st->bbextents) s = st->bbextents;
+		else if (s < 0) s = 0;
+		t = (int)(tdivz * z) + st->tadjust;
+		if (t > st->bbextentt) t = st->bbextentt;
+		else if (t < 0) t = 0;
 		do
 		{
 		// calculate s and t at the far end of the span
-			if (count >= 16) r_turb_spancount = 16;
-			else r_turb_spancount = count;
-			count -= r_turb_spancount;
+			if (count >= 16) spancount = 16;
+			else spancount = count;
+			count -= spancount;
 			if (count)
 			{
 				// calculate s/z, t/z, zi->fixed s and t at far end of span,
@@ -125,14 +167,14 @@ void Turbulent8 (espan_t *pspan)
 				tdivz += tdivz16stepu;
 				zi += zi16stepu;
 				z = (float)0x10000 / zi;	// prescale to 16.16 fixed-point
-				snext = (int)(sdivz * z) + sadjust;
-				if (snext > bbextents) snext = bbextents;
+				snext = (int)(sdivz * z) + st->sadjust;
+				if (snext > st->bbextents) snext = st->bbextents;
 				else if (snext < 16) snext = 16;
-				tnext = (int)(tdivz * z) + tadjust;
-				if (tnext > bbextentt) tnext = bbextentt;
+				tnext = (int)(tdivz * z) + st->tadjust;
+				if (tnext > st->bbextentt) tnext = st->bbextentt;
 				else if (tnext < 16) tnext = 16; // guard against round-off error on <0 steps
-				r_turb_sstep = (snext - r_turb_s) >> 4;
-				r_turb_tstep = (tnext - r_turb_t) >> 4;
+				sstep = (snext - s) >> 4;
+				tstep = (tnext - t) >> 4;
 			}
 			else
 			{
@@ -140,28 +182,29 @@ void Turbulent8 (espan_t *pspan)
 				// can't step off polygon), clamp, calculate s and t steps across
 				// span by division, biasing steps low so we don't run off the
 				// texture
-				spancountminus1 = (float)(r_turb_spancount - 1);
-				sdivz += d_sdivzstepu * spancountminus1;
-				tdivz += d_tdivzstepu * spancountminus1;
-				zi += d_zistepu * spancountminus1;
+				spancountminus1 = (float)(spancount - 1);
+				sdivz += st->sdivzstepu * spancountminus1;
+				tdivz += st->tdivzstepu * spancountminus1;
+				zi += st->zistepu * spancountminus1;
 				z = (float)0x10000 / zi;	// prescale to 16.16 fixed-point
-				snext = (int)(sdivz * z) + sadjust;
-				if (snext > bbextents) snext = bbextents;
+				snext = (int)(sdivz * z) + st->sadjust;
+				if (snext > st->bbextents) snext = st->bbextents;
 				else if (snext < 16) snext = 16;
-				tnext = (int)(tdivz * z) + tadjust;
-				if (tnext > bbextentt) tnext = bbextentt;
+				tnext = (int)(tdivz * z) + st->tadjust;
+				if (tnext > st->bbextentt) tnext = st->bbextentt;
 				else if (tnext < 16) tnext = 16; // guard against round-off error on <0 steps
-				if (r_turb_spancount > 1)
+				if (spancount > 1)
 				{
-					r_turb_sstep = (snext - r_turb_s) / (r_turb_spancount - 1);
-					r_turb_tstep = (tnext - r_turb_t) / (r_turb_spancount - 1);
+					sstep = (snext - s) / (spancount - 1);
+					tstep = (tnext - t) / (spancount - 1);
 				}
 			}
-			r_turb_s = r_turb_s & ((CYCLE<<16)-1);
-			r_turb_t = r_turb_t & ((CYCLE<<16)-1);
-			D_DrawTurbulent8Span ();
-			r_turb_s = snext;
-			r_turb_t = tnext;
+			s = s & ((CYCLE<<16)-1);
+			t = t & ((CYCLE<<16)-1);
+			D_DrawTurbulent8Span (pdest, pbase, turb, s, t, sstep, tstep, spancount);
+			pdest += spancount;
+			s = snext;
+			t = tnext;
 		} while (count > 0);
 	} while ((pspan = pspan->pnext) != NULL);
 }
@@ -173,7 +216,7 @@ void Turbulent8 (espan_t *pspan)
 // D_DrawSpans8
 //============================================*/
 #ifndef USE_PQ_OPT5
-void D_DrawSpans8 (espan_t *pspan)
+void D_DrawSpans8_r (espan_t *pspan, spanstate_t *st)
 {
 	int				count, spancount;
 	unsigned char	*pbase, *pdest;
@@ -184,11 +227,11 @@ void D_DrawSpans8 (espan_t *pspan)
 	sstep = 0;	// keep compiler happy
 	tstep = 0;	// ditto
 
-	pbase = (unsigned char *)cacheblock;
+	pbase = (unsigned char *)st->cacheblock;
 
-	sdivz8stepu = d_sdivzstepu * 8;
-	tdivz8stepu = d_tdivzstepu * 8;
-	zi8stepu = d_zistepu * 8;
+	sdivz8stepu = st->sdivzstepu * 8;
+	tdivz8stepu = st->tdivzstepu * 8;
+	zi8stepu = st->zistepu * 8;
 
 	do
 	{
@@ -201,20 +244,20 @@ void D_DrawSpans8 (espan_t *pspan)
 		du = (float)pspan->u;
 		dv = (float)pspan->v;
 
-		sdivz = d_sdivzorigin + dv*d_sdivzstepv + du*d_sdivzstepu;
-		tdivz = d_tdivzorigin + dv*d_tdivzstepv + du*d_tdivzstepu;
-		zi = d_ziorigin + dv*d_zistepv + du*d_zistepu;
+		sdivz = st->sdivzorigin + dv*st->sdivzstepv + du*st->sdivzstepu;
+		tdivz = st->tdivzorigin + dv*st->tdivzstepv + du*st->tdivzstepu;
+		zi = st->ziorigin + dv*st->zistepv + du*st->zistepu;
 		z = (float)0x10000 / zi;	// prescale to 16.16 fixed-point
 
-		s = (int)(sdivz * z) + sadjust;
-		if (s > bbextents)
-			s = bbextents;
+		s = (int)(sdivz * z) + st->sadjust;
+		if (s > st->bbextents)
+			s = st->bbextents;
 		else if (s < 0)
 			s = 0;
 
-		t = (int)(tdivz * z) + tadjust;
-		if (t > bbextentt)
-			t = bbextentt;
+		t = (int)(tdivz * z) + st->tadjust;
+		if (t > st->bbextentt)
+			t = st->bbextentt;
 		else if (t < 0)
 			t = 0;
 
@@ -237,17 +280,17 @@ void D_DrawSpans8 (espan_t *pspan)
 				zi += zi8stepu;
 				z = (float)0x10000 / zi;	// prescale to 16.16 fixed-point
 
-				snext = (int)(sdivz * z) + sadjust;
-				if (snext > bbextents)
-					snext = bbextents;
+				snext = (int)(sdivz * z) + st->sadjust;
+				if (snext > st->bbextents)
+					snext = st->bbextents;
 				else if (snext < 8)
 					snext = 8;	// prevent round-off error on <0 steps from
 								//  from causing overstepping & running off the
 								//  edge of the texture
 
-				tnext = (int)(tdivz * z) + tadjust;
-				if (tnext > bbextentt)
-					tnext = bbextentt;
+				tnext = (int)(tdivz * z) + st->tadjust;
+				if (tnext > st->bbextentt)
+					tnext = st->bbextentt;
 				else if (tnext < 8)
 					tnext = 8;	// guard against round-off error on <0 steps
 
@@ -261,21 +304,21 @@ void D_DrawSpans8 (espan_t *pspan)
 			// span by division, biasing steps low so we don't run off the
 			// texture
 				spancountminus1 = (float)(spancount - 1);
-				sdivz += d_sdivzstepu * spancountminus1;
-				tdivz += d_tdivzstepu * spancountminus1;
-				zi += d_zistepu * spancountminus1;
+				sdivz += st->sdivzstepu * spancountminus1;
+				tdivz += st->tdivzstepu * spancountminus1;
+				zi += st->zistepu * spancountminus1;
 				z = (float)0x10000 / zi;	// prescale to 16.16 fixed-point
-				snext = (int)(sdivz * z) + sadjust;
-				if (snext > bbextents)
-					snext = bbextents;
+				snext = (int)(sdivz * z) + st->sadjust;
+				if (snext > st->bbextents)
+					snext = st->bbextents;
 				else if (snext < 8)
 					snext = 8;	// prevent round-off error on <0 steps from
 								//  from causing overstepping & running off the
 								//  edge of the texture
 
-				tnext = (int)(tdivz * z) + tadjust;
-				if (tnext > bbextentt)
-					tnext = bbextentt;
+				tnext = (int)(tdivz * z) + st->tadjust;
+				if (tnext > st->bbextentt)
+					tnext = st->bbextentt;
 				else if (tnext < 8)
 					tnext = 8;	// guard against round-off error on <0 steps
 
@@ -288,7 +331,7 @@ void D_DrawSpans8 (espan_t *pspan)
 
 			do
 			{
-				*pdest++ = *(pbase + (s >> 16) + (t >> 16) * cachewidth);
+				*pdest++ = *(pbase + (s >> 16) + (t >> 16) * st->cachewidth);
 				s += sstep;
 				t += tstep;
 			} while (--spancount > 0);
@@ -302,67 +345,39 @@ void D_DrawSpans8 (espan_t *pspan)
 }
 #else
 
-static int sdivzorig, sdivzstepv, sdivzstepu, sdivz8stepu;
-static int tdivzorig, tdivzstepv, tdivzstepu, tdivz8stepu;
-static int zi8stepu;
-static float last = 0;
-
-/*==============================================
-// UpdateFixedPointVars
-//============================================*/
-void UpdateFixedPointVars( int all )
-{
-	// JB: Store texture transformation matrix in fixed point vars
-	if (all)
-	{
-/*
-		sdivzorig = (int)(524288.0f * d_sdivzorigin); // 13.19 fixed point
-		tdivzorig = (int)(524288.0f * d_tdivzorigin);
-		sdivzstepv = (int)(524288.0f * d_sdivzstepv);
-		tdivzstepv = (int)(524288.0f * d_tdivzstepv);
-		sdivzstepu = (int)(524288.0f * d_sdivzstepu);
-		sdivz8stepu = sdivzstepu*8;
-		tdivzstepu = (int)(524288.0f * d_tdivzstepu);
-		tdivz8stepu = tdivzstepu*8;
-*/
-
-		sdivzorig = (int)(4194304.0f * d_sdivzorigin); // 10.22 fixed point
-		tdivzorig = (int)(4194304.0f * d_tdivzorigin);
-		sdivzstepv = (int)(4194304.0f * d_sdivzstepv);
-		tdivzstepv = (int)(4194304.0f * d_tdivzstepv);
-		sdivzstepu = (int)(4194304.0f * d_sdivzstepu);
-		sdivz8stepu = sdivzstepu*8;
-		tdivzstepu = (int)(4194304.0f * d_tdivzstepu);
-		tdivz8stepu = tdivzstepu*8;
-
-	}
-/*
-	ziorig = (int)(524288.0f * d_ziorigin);  // 13.19 fixed point
-	zistepv = (int)(524288.0f * d_zistepv ); 
-	zistepu = (int)(524288.0f * d_zistepu ); 
-*/
-#ifndef USE_PQ_OPT3
-	d_ziorigin_fxp = (int)(4194304.0f * d_ziorigin);  // 10.22 fixed point
-	d_zistepv_fxp = (int)(4194304.0f * d_zistepv ); 
-	d_zistepu_fxp = (int)(4194304.0f * d_zistepu ); 
-#endif
-
-	zi8stepu = d_zistepu_fxp * 8;
-	last = d_zistepv;
-}
-
-void D_DrawSpans8 (espan_t *pspan)
+void D_DrawSpans8_r (espan_t *pspan, spanstate_t *st)
 {
 	int count, spancount, spancountminus1;
 	unsigned char *pbase, *pdest;
 	fixed16_t s1, t1;
 	int zi, sdivz, tdivz, sstep, tstep;
 	int snext, tnext;
-	pbase = (unsigned char *)cacheblock;
+	int sdivzorig, sdivzstepv, sdivzstepu, sdivz8stepu;
+	int tdivzorig, tdivzstepv, tdivzstepu, tdivz8stepu;
+	int ziorig, zistepv, zistepu, zi8stepu;
+	pbase = (unsigned char *)st->cacheblock;
 	//Jacco Biker's fixed point conversion
 
-	// Recalc fixed point values
-	UpdateFixedPointVars( 1 );
+	// JB: Store texture transformation matrix in fixed point vars
+	sdivzorig = (int)(4194304.0f * st->sdivzorigin); // 10.22 fixed point
+	tdivzorig = (int)(4194304.0f * st->tdivzorigin);
+	sdivzstepv = (int)(4194304.0f * st->sdivzstepv);
+	tdivzstepv = (int)(4194304.0f * st->tdivzstepv);
+	sdivzstepu = (int)(4194304.0f * st->sdivzstepu);
+	sdivz8stepu = sdivzstepu*8;
+	tdivzstepu = (int)(4194304.0f * st->tdivzstepu);
+	tdivz8stepu = tdivzstepu*8;
+
+#ifndef USE_PQ_OPT3
+	ziorig = (int)(4194304.0f * st->ziorigin);  // 10.22 fixed point
+	zistepv = (int)(4194304.0f * st->zistepv ); 
+	zistepu = (int)(4194304.0f * st->zistepu ); 
+#else
+	ziorig = d_ziorigin_fxp;
+	zistepv = d_zistepv_fxp;
+	zistepu = d_zistepu_fxp;
+#endif
+	zi8stepu = zistepu * 8;
 	do
 	{
 		pdest = (unsigned char *)((byte *)d_viewbuffer + (screenwidth * pspan->v) + pspan->u);
@@ -370,22 +385,22 @@ void D_DrawSpans8 (espan_t *pspan)
 		// calculate the initial s/z, t/z, 1/z, s, and t and clamp
 		sdivz = sdivzorig + pspan->v * sdivzstepv + pspan->u * sdivzstepu;
 		tdivz = tdivzorig + pspan->v * tdivzstepv + pspan->u * tdivzstepu;
-		zi = d_ziorigin_fxp + pspan->v * d_zistepv_fxp + pspan->u * d_zistepu_fxp;
+		zi = ziorig + pspan->v * zistepv + pspan->u * zistepu;
 		if (zi == 0) zi = 1;
-		s1 = (((sdivz << 8) / zi) << 8) + sadjust;	// 5.27 / 13.19 = 24.8 >> 8 = 16.16
-		if (s1 > bbextents) s1 = bbextents; else if (s1 < 0) s1 = 0;
-		t1 = (((tdivz << 8) / zi) << 8) + tadjust;
-		if (t1 > bbextentt) t1 = bbextentt; else if (t1 < 0) t1 = 0;
+		s1 = (((sdivz << 8) / zi) << 8) + st->sadjust;	// 5.27 / 13.19 = 24.8 >> 8 = 16.16
+		if (s1 > st->bbextents) s1 = st->bbextents; else if (s1 < 0) s1 = 0;
+		t1 = (((tdivz << 8) / zi) << 8) + st->tadjust;
+		if (t1 > st->bbextentt) t1 = st->bbextentt; else if (t1 < 0) t1 = 0;
 		// calculate final s/z, t/z, 1/z, s, and t and clamp
 		//sdivz += sdivzstepu * (count - 1);
 		//tdivz += tdivzstepu * (count - 1);
-		//zi += d_zistepu_fxp * (count - 1);
+		//zi += zistepu * (count - 1);
 		//if (zi == 0) zi = 1;
 #if 0
-		s2 = (((sdivz << 8) / zi) << 8) + sadjust;
-		if (s2 > bbextents) s2 = bbextents; else if (s2 < 8) s2 = 8;
-		t2 = (((tdivz << 8) / zi) << 8) + tadjust;
-		if (t2 > bbextentt) t2 = bbextentt; else if (t2 < 8) t2 = 8;
+		s2 = (((sdivz << 8) / zi) << 8) + st->sadjust;
+		if (s2 > st->bbextents) s2 = st->bbextents; else if (s2 < 8) s2 = 8;
+		t2 = (((tdivz << 8) / zi) << 8) + st->tadjust;
+		if (t2 > st->bbextentt) t2 = st->bbextentt; else if (t2 < 8) t2 = 8;
 		if (count > 1)
 		{
 			sstep = (s2 - s1) / (count - 1);
@@ -414,18 +429,18 @@ void D_DrawSpans8 (espan_t *pspan)
 				if (!zi) zi = 1;
 				//z = zi;
 				//z = (float)0x10000 / zi;	// prescale to 16.16 fixed-point
-				snext = (((sdivz<<8)/zi)<<8)+sadjust;
-				//snext = (int)(sdivz * z) + sadjust;
-				if (snext > bbextents)
-					snext = bbextents;
+				snext = (((sdivz<<8)/zi)<<8)+st->sadjust;
+				//snext = (int)(sdivz * z) + st->sadjust;
+				if (snext > st->bbextents)
+					snext = st->bbextents;
 				else if (snext < 8)
 					snext = 8;	// prevent round-off error on <0 steps from
 								//  from causing overstepping & running off the
 								//  edge of the texture
 
-				tnext = (((tdivz<<8)/zi)<<8) + tadjust;
-				if (tnext > bbextentt)
-					tnext = bbextentt;
+				tnext = (((tdivz<<8)/zi)<<8) + st->tadjust;
+				if (tnext > st->bbextentt)
+					tnext = st->bbextentt;
 				else if (tnext < 8)
 					tnext = 8;	// guard against round-off error on <0 steps
 
@@ -441,20 +456,20 @@ void D_DrawSpans8 (espan_t *pspan)
 				spancountminus1 = spancount - 1;
 				sdivz += sdivzstepu * spancountminus1;
 				tdivz += tdivzstepu * spancountminus1;
-				zi += d_zistepu_fxp * spancountminus1;
+				zi += zistepu * spancountminus1;
 				if (!zi) zi = 1;
 				//z = zi;//(float)0x10000 / zi;	// prescale to 16.16 fixed-point
-				snext = (((sdivz<<8) / zi)<<8) + sadjust;
-				if (snext > bbextents)
-					snext = bbextents;
+				snext = (((sdivz<<8) / zi)<<8) + st->sadjust;
+				if (snext > st->bbextents)
+					snext = st->bbextents;
 				else if (snext < 8)
 					snext = 8;	// prevent round-off error on <0 steps from
 								//  from causing overstepping & running off the
 								//  edge of the texture
 
-				tnext = (((tdivz<<8) / zi)<<8) + tadjust;
-				if (tnext > bbextentt)
-					tnext = bbextentt;
+				tnext = (((tdivz<<8) / zi)<<8) + st->tadjust;
+				if (tnext > st->bbextentt)
+					tnext = st->bbextentt;
 				else if (tnext < 8)
 					tnext = 8;	// guard against round-off error on <0 steps
 
@@ -466,7 +481,7 @@ void D_DrawSpans8 (espan_t *pspan)
 			}
 			do
 			{
-				*pdest++ = *(pbase + (s1 >> 16) + (t1 >> 16) * cachewidth);
+				*pdest++ = *(pbase + (s1 >> 16) + (t1 >> 16) * st->cachewidth);
 				s1 += sstep;
 				t1 += tstep;
 			} while (--spancount > 0);
@@ -480,7 +495,7 @@ void D_DrawSpans8 (espan_t *pspan)
 		// Draw span
 		for ( i = 0; i < count; i++ )
 		{
-			*pdest++ = *(pbase + (s1 >> 16) + (t1 >> 16) * cachewidth);
+			*pdest++ = *(pbase + (s1 >> 16) + (t1 >> 16) * st->cachewidth);
 			s1 += sstep;
 			t1 += tstep;
 		}
@@ -496,23 +511,29 @@ void D_DrawSpans8 (espan_t *pspan)
 /*==============================================
 // D_DrawZSpans
 //============================================*/
-void D_DrawZSpans (espan_t *pspan)
+void D_DrawZSpans_r (espan_t *pspan, spanstate_t *st)
 {
 	int count, doublecount, izistep;
 	int izi;
 	short *pdest;
 	unsigned ltemp;
-#ifdef USE_PQ_OPT5
-	// Recalc fixed point values
-	UpdateFixedPointVars( 0 );
+	int ziorig, zistepv, zistepu;
+#ifndef USE_PQ_OPT3
+	ziorig = (int)(4194304.0f * st->ziorigin);  // 10.22 fixed point
+	zistepv = (int)(4194304.0f * st->zistepv ); 
+	zistepu = (int)(4194304.0f * st->zistepu ); 
+#else
+	ziorig = d_ziorigin_fxp;
+	zistepv = d_zistepv_fxp;
+	zistepu = d_zistepu_fxp;
 #endif
-	izistep = d_zistepu_fxp << 9;
+	izistep = zistepu << 9;
 	do
 	{
 		pdest = d_pzbuffer + (d_zwidth * pspan->v) + pspan->u;
 		count = pspan->count;
 		// calculate the initial 1/z
-		izi = (d_ziorigin_fxp + pspan->v * d_zistepv_fxp + pspan->u * d_zistepu_fxp) << 9; // 1.31 fixed point
+		izi = (ziorig + pspan->v * zistepv + pspan->u * zistepu) << 9; // 1.31 fixed point
 		if ((long)pdest & 0x02)
 		{
 			*pdest++ = (short)(izi >> 16);
@@ -537,7 +558,7 @@ void D_DrawZSpans (espan_t *pspan)
 }
 #endif
 #else
-void D_DrawZSpans (espan_t *pspan)
+void D_DrawZSpans_r (espan_t *pspan, spanstate_t *st)
 {
 	int				count, doublecount, izistep;
 	int				izi;
@@ -549,7 +570,7 @@ void D_DrawZSpans (espan_t *pspan)
 
 // FIXME: check for clamping/range problems
 // we count on FP exceptions being turned off to avoid range problems
-	izistep = (int)(d_zistepu * 0x8000 * 0x10000);
+	izistep = (int)(st->zistepu * 0x8000 * 0x10000);
 
 	do
 	{
@@ -561,7 +582,7 @@ void D_DrawZSpans (espan_t *pspan)
 		du = (float)pspan->u;
 		dv = (float)pspan->v;
 
-		zi = d_ziorigin + dv*d_zistepv + du*d_zistepu;
+		zi = st->ziorigin + dv*st->zistepv + du*st->zistepu;
 	// we count on FP exceptions being turned off to avoid range problems
 		izi = (int)(zi * 0x8000 * 0x10000);
 
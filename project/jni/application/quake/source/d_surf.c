@@ -29,6 +29,9 @@ qboolean        r_cache_thrash;         // set if surface cache is thrashing
 int					sc_size;
 surfcache_t			*sc_rover, *sc_base;
 
+int					d_surfbatch = 1;
+qboolean			d_deferfills;
+
 #ifdef USEFPM
 fixedpoint_t	surfscaleFPM;
 surfcache_FPM_t		*sc_roverFPM, *sc_baseFPM;
@@ -122,6 +125,7 @@ void D_InitCaches (void *buffer, int size)
 	sc_base->next = NULL;
 	sc_base->owner = NULL;
 	sc_base->size = sc_size;
+	sc_base->batch = 0;
 	
 	D_ClearCacheGuard ();
 }
@@ -167,6 +171,7 @@ void D_FlushCaches (void)
 	sc_base->next = NULL;
 	sc_base->owner = NULL;
 	sc_base->size = sc_size;
+	sc_base->batch = 0;
 }
 
 #ifdef USEFPM
@@ -197,8 +202,9 @@ D_SCAlloc
 */
 surfcache_t     *D_SCAlloc (int width, int size)
 {
-	surfcache_t             *new;
+	surfcache_t             *new, *c;
 	qboolean                wrapped_this_time;
+	int                     total;
 
 	if ((width < 0) || (width > 256))
 		Sys_Error ("D_SCAlloc: bad cache width %d\n", width);
@@ -222,6 +228,20 @@ surfcache_t     *D_SCAlloc (int width, int size)
 		}
 		sc_rover = sc_base;
 	}
+
+// the span batch may still read or fill the blocks about to be freed
+	if (d_deferfills)
+	{
+		for (c = sc_rover, total = 0 ; c && total < size ; c = c->next)
+		{
+			if (c->batch == d_surfbatch)
+			{
+				D_FlushSurfaceBatch ();
+				break;
+			}
+			total += c->size;
+		}
+	}
 		
 // colect and free surfcache_t blocks until the rover block is large enough
 	new = sc_rover;
@@ -249,6 +269,7 @@ surfcache_t     *D_SCAlloc (int width, int size)
 		sc_rover->next = new->next;
 		sc_rover->width = 0;
 		sc_rover->owner = NULL;
+		sc_rover->batch = 0;
 		new->next = sc_rover;
 		new->size = size;
 	}
@@ -261,6 +282,7 @@ surfcache_t     *D_SCAlloc (int width, int size)
 		new->height = (size - sizeof(*new) + sizeof(new->data)) / width;
 
 	new->owner = NULL;              // should be set properly after return
+	new->batch = 0;
 
 	if (d_roverwrapped)
 	{
@@ -428,6 +450,7 @@ D_CacheSurface
 surfcache_t *D_CacheSurface (msurface_t *surface, int miplevel)
 {
 	surfcache_t     *cache;
+	int             stage;
 
 //
 // if the surface is animating or flashing, flush the cache
@@ -471,6 +494,8 @@ surfcache_t *D_CacheSurface (msurface_t *surface, int miplevel)
 		cache->owner = &surface->cachespots[miplevel];
 		cache->mipscale = surfscale;
 	}
+	else if (cache->batch == d_surfbatch)
+		D_FlushSurfaceBatch ();	// the span batch still reads or fills it
 	
 	if (surface->dlightframe == r_framecount)
 		cache->dlight = 1;
@@ -491,7 +516,14 @@ surfcache_t *D_CacheSurface (msurface_t *surface, int miplevel)
 	r_drawsurf.surf = surface;
 
 	c_surf++;
-	R_DrawSurface ();
+	if (d_deferfills)
+		D_QueueSurfaceFill (cache);
+	else
+	{
+		stage = R_TimeStage (RS_SURFCACHE);
+		R_DrawSurface ();
+		R_TimeStage (stage);
+	}
 
 	return surface->cachespots[miplevel];
 }
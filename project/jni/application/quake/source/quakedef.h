@@ -37,11 +37,15 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 
 
+// Build with -DFLOAT_PIPELINE to get the original floating point code,
+// to compare the two with timedemo on a given CPU
+#ifndef FLOAT_PIPELINE
 #define USE_PQ_OPT1		//Uses the fixed point R_EmitEdge_fxp function.
 #define USE_PQ_OPT2
 //#define USE_PQ_OPT3	//In progress, don't use.
 #define USE_PQ_OPT4		//Uses the fixed point D_PolysetCalcGradients function.
 #define USE_PQ_OPT5		//Uses the fixed point D_DrawSpans8 (partially from Jacco Biker)
+#endif
 
 #define MIN_VID_HEIGHT 180
 
@@ -191,6 +191,22 @@ extern	qboolean		insubmodel;
 extern	vec3_t			r_worldmodelorg;
 //extern	vec3_FPM_t		r_worldmodelorgFPM;
 
+// one surface being built by the block drawers, kept out of globals so
+// several surfaces can be built at once
+typedef struct
+{
+	unsigned char	*pbasesource;
+	void			*prowdestbase;
+	unsigned		*lightptr;
+	int				lightwidth;
+	int				numvblocks;
+	int				blockdivshift;
+	int				sourcetstep;
+	int				rowbytes;
+	unsigned char	*sourcemax;
+	int				stepback;
+} surfblock_t;
+
 void R_DrawSprite (void);
 //void R_DrawSpriteFPM (void);
 void R_RenderFace (msurface_t *fa, int clipflags);
@@ -204,20 +220,10 @@ void R_TransformFrustum (void);
 //void R_TransformFrustumFPM (void);
 void R_SetSkyFrame (void);
 //void R_SetSkyFrameFPM (void);
-void R_DrawSurfaceBlock16 (void);
-void R_DrawSurfaceBlock8 (void);
+void R_DrawSurfaceBlock16 (surfblock_t *sb);
 texture_t *R_TextureAnimation (texture_t *base);
 //texture_t *R_TextureAnimationFPM (texture_t *base);
 
-#if	id386
-
-void R_DrawSurfaceBlock8_mip0 (void);
-void R_DrawSurfaceBlock8_mip1 (void);
-void R_DrawSurfaceBlock8_mip2 (void);
-void R_DrawSurfaceBlock8_mip3 (void);
-
-#endif
-
 void R_GenSkyTile (void *pdest);
 void R_GenSkyTile16 (void *pdest);
 void R_Surf8Patch (void);
@@ -158,6 +158,13 @@ alight_FPM_t r_viewlightingFPM = {FPM_FROMLONGC(128), FPM_FROMLONGC(192), viewli
 int		d_lightstylevalue[256];	// 8.8 fraction of base light value
 
 float	dp_time1, dp_time2, db_time1, db_time2, rw_time1, rw_time2;
+
+qboolean	r_timestages;
+double		r_stagetime[NUM_RSTAGES];
+char		*r_stagenames[NUM_RSTAGES] =
+	{"other", "setup", "bsp", "edges", "spans", "surfcache", "alias", "particles"};
+static int		r_stage;
+static double	r_stagestart;
 float	se_time1, se_time2, de_time1, de_time2, dv_time1, dv_time2;
 
 void R_MarkLeaves (void);
@@ -186,6 +193,7 @@ cvar_t	r_numedges = {"r_numedges", "0"};
 cvar_t	r_aliastransbase = {"r_aliastransbase", "200"};
 cvar_t	r_aliastransadj = {"r_aliastransadj", "100"};
 cvar_t	r_fastturb = {"r_fastturb", "0"};
+cvar_t	r_threads = {"r_threads", "1", true};	// threads drawing the surfaces
 
 //Dan East: Added:
 cvar_t	r_maxparticles = {"r_maxparticles","512"};
@@ -256,6 +264,7 @@ void R_Init (void)
 	Cvar_RegisterVariable (&r_skycolor);
 	Cvar_RegisterVariable (&r_fastsky);
 	Cvar_RegisterVariable (&r_fastturb);
+	Cvar_RegisterVariable (&r_threads);
 	Cvar_RegisterVariable (&r_fullbright);
 	Cvar_RegisterVariable (&r_drawentities);
 	Cvar_RegisterVariable (&r_drawviewmodel);
@@ -321,6 +330,7 @@ void R_InitFPM (void)
 	Cvar_RegisterVariable (&r_skycolor);
 	Cvar_RegisterVariable (&r_fastsky);
 	Cvar_RegisterVariable (&r_fastturb);
+	Cvar_RegisterVariable (&r_threads);
 	Cvar_RegisterVariable (&r_fullbright);
 	Cvar_RegisterVariable (&r_drawentities);
 	Cvar_RegisterVariable (&r_drawviewmodel);
@@ -1559,6 +1569,37 @@ void R_DrawBEntitiesOnList (void)
 //extern surf_t	*lsurfs;
 
 
+/*
+================
+R_TimeStage
+
+Charges the time since the last call to the current stage and makes stage
+the current one.  Returns the old stage, so nested stages can restore it.
+================
+*/
+int R_TimeStage (int stage)
+{
+	double	time;
+	int		old;
+
+	if (!r_timestages)
+		return stage;
+
+	time = Sys_FloatTime ();
+	r_stagetime[r_stage] += time - r_stagestart;
+	r_stagestart = time;
+	old = r_stage;
+	r_stage = stage;
+	return old;
+}
+
+void R_ClearStageTimes (void)
+{
+	memset (r_stagetime, 0, sizeof(r_stagetime));
+	r_stage = RS_OTHER;
+	r_stagestart = Sys_FloatTime ();
+}
+
 /*
 ================
 R_EdgeDrawing
@@ -1621,6 +1662,7 @@ void R_EdgeDrawing (void)
 
 	//	Cache_Report();
 
+	R_TimeStage (RS_BSP);
 	R_RenderWorld ();
 
 	if (r_drawculledpolys){
@@ -1656,7 +1698,7 @@ void R_EdgeDrawing (void)
 
 	//	Cache_Report();
 
-	
+	R_TimeStage (RS_EDGES);
 	if (!(r_drawpolys | r_drawculledpolys)) {
 	  R_ScanEdges ();
 	}
@@ -1773,6 +1815,7 @@ byte	warpbuffer[WARP_WIDTH * WARP_HEIGHT];
 	if (r_timegraph.value || r_speeds.value || r_dspeeds.value)
 		r_time1 = (float)Sys_FloatTime ();
 
+	R_TimeStage (RS_SETUP);
 	R_SetupFrame ();
 
 #ifdef PASSAGES
@@ -1812,6 +1855,7 @@ byte	warpbuffer[WARP_WIDTH * WARP_HEIGHT];
 		de_time1 = se_time2;
 	}
 
+	R_TimeStage (RS_ALIAS);
 	 R_DrawEntitiesOnList ();
 
 	if (r_dspeeds.value)
@@ -1828,11 +1872,13 @@ byte	warpbuffer[WARP_WIDTH * WARP_HEIGHT];
 		dp_time1 = (float)Sys_FloatTime ();
 	}
 
+	R_TimeStage (RS_PARTICLES);
 	 R_DrawParticles ();
 
 	if (r_dspeeds.value)
 		dp_time2 = (float)Sys_FloatTime ();
 
+	R_TimeStage (RS_OTHER);
 
 	if (r_dowarp)
 	   D_WarpScreen ();
@@ -27,25 +27,15 @@ drawsurf_t	r_drawsurf;
 drawsurf_FPM_t	r_drawsurfFPM;
 #endif //USEFPM
 
-int				lightleft, sourcesstep, blocksize, sourcetstep;
-int				lightdelta, lightdeltastep;
-int				lightright, lightleftstep, lightrightstep, blockdivshift;
-unsigned		blockdivmask;
-void			*prowdestbase;
-unsigned char	*pbasesource;
-int				surfrowbytes;	// used by ASM files
-unsigned		*r_lightptr;
-int				r_stepback;
-int				r_lightwidth;
-int				r_numhblocks, r_numvblocks;
-unsigned char	*r_source, *r_sourcemax;
-
-void R_DrawSurfaceBlock8_mip0 (void);
-void R_DrawSurfaceBlock8_mip1 (void);
-void R_DrawSurfaceBlock8_mip2 (void);
-void R_DrawSurfaceBlock8_mip3 (void);
-
-static void	(*surfmiptable[4])(void) = {
+int				lightleft, sourcesstep;
+int				lightright, lightleftstep, lightrightstep;
+
+void R_DrawSurfaceBlock8_mip0 (surfblock_t *sb);
+void R_DrawSurfaceBlock8_mip1 (surfblock_t *sb);
+void R_DrawSurfaceBlock8_mip2 (surfblock_t *sb);
+void R_DrawSurfaceBlock8_mip3 (surfblock_t *sb);
+
+static void	(*surfmiptable[4])(surfblock_t *sb) = {
 	R_DrawSurfaceBlock8_mip0,
 	R_DrawSurfaceBlock8_mip1,
 	R_DrawSurfaceBlock8_mip2,
@@ -61,9 +51,8 @@ unsigned		blocklights[18*18];
 R_AddDynamicLights
 ===============
 */
-void R_AddDynamicLights (void)
+void R_AddDynamicLights (msurface_t *surf, unsigned *blocklights)
 {
-	msurface_t *surf;
 	int			lnum;
 	int			sd, td;
 	float		dist, rad, minlight;
@@ -73,7 +62,6 @@ void R_AddDynamicLights (void)
 	int			smax, tmax;
 	mtexinfo_t	*tex;
 
-	surf = r_drawsurf.surf;
 	smax = (surf->extents[0]>>4)+1;
 	tmax = (surf->extents[1]>>4)+1;
 	tex = surf->texinfo;
@@ -232,7 +220,7 @@ R_BuildLightMap
 Combine and scale multiple lightmaps into the 8.8 format in blocklights
 ===============
 */
-void R_BuildLightMap (void)
+void R_BuildLightMap (drawsurf_t *ds, unsigned *blocklights)
 {
 	int			smax, tmax;
 	int			t;
@@ -242,7 +230,7 @@ void R_BuildLightMap (void)
 	int			maps;
 	msurface_t	*surf;
 
-	surf = r_drawsurf.surf;
+	surf = ds->surf;
 
 	smax = (surf->extents[0]>>4)+1;
 	tmax = (surf->extents[1]>>4)+1;
@@ -266,7 +254,7 @@ void R_BuildLightMap (void)
 		for (maps = 0 ; maps < MAXLIGHTMAPS && surf->styles[maps] != 255 ;
 			 maps++)
 		{
-			scale = r_drawsurf.lightadj[maps];	// 8.8 fraction		
+			scale = ds->lightadj[maps];	// 8.8 fraction		
 			for (i=0 ; i<size ; i++)
 				blocklights[i] += lightmap[i] * scale;
 			lightmap += size;	// skip to next lightmap
@@ -274,7 +262,7 @@ void R_BuildLightMap (void)
 
 // add all the dynamic lights
 	if (surf->dlightframe == r_framecount)
-		R_AddDynamicLights ();
+		R_AddDynamicLights (surf, blocklights);
 
 // bound, invert, and shift
 	for (i=0 ; i<size ; i++)
@@ -415,48 +403,51 @@ texture_t *R_TextureAnimationFPM (texture_t *base)
 
 /*
 ===============
-R_DrawSurface
+R_GenerateSurface
+
+Builds the surface described by ds, with blocklights as scratch space.
+Nothing else is written, so surfaces can be built on several threads at once
 ===============
 */
-void R_DrawSurface (void)
+void R_GenerateSurface (drawsurf_t *ds, unsigned *blocklights)
 {
 	unsigned char	*basetptr;
 	int				smax, tmax, twidth;
 	int				u;
 	int				soffset, basetoffset, texwidth;
-	int				horzblockstep;
-	unsigned char	*pcolumndest;
-	void			(*pblockdrawer)(void);
+	int				horzblockstep, blocksize, numhblocks;
+	unsigned char	*pcolumndest, *source;
+	void			(*pblockdrawer)(surfblock_t *sb);
 	texture_t		*mt;
+	surfblock_t		sb;
 
 // calculate the lightings
-	R_BuildLightMap ();
+	R_BuildLightMap (ds, blocklights);
 	
-	surfrowbytes = r_drawsurf.rowbytes;
+	sb.rowbytes = ds->rowbytes;
 
-	mt = r_drawsurf.texture;
+	mt = ds->texture;
 	
-	r_source = (byte *)mt + mt->offsets[r_drawsurf.surfmip];
+	source = (byte *)mt + mt->offsets[ds->surfmip];
 	
 // the fractional light values should range from 0 to (VID_GRADES - 1) << 16
 // from a source range of 0 - 255
 	
-	texwidth = mt->width >> r_drawsurf.surfmip;
+	texwidth = mt->width >> ds->surfmip;
 
-	blocksize = 16 >> r_drawsurf.surfmip;
-	blockdivshift = 4 - r_drawsurf.surfmip;
-	blockdivmask = (1 << blockdivshift) - 1;
+	blocksize = 16 >> ds->surfmip;
+	sb.blockdivshift = 4 - ds->surfmip;
 	
-	r_lightwidth = (r_drawsurf.surf->extents[0]>>4)+1;
+	sb.lightwidth = (ds->surf->extents[0]>>4)+1;
 
-	r_numhblocks = r_drawsurf.surfwidth >> blockdivshift;
-	r_numvblocks = r_drawsurf.surfheight >> blockdivshift;
+	numhblocks = ds->surfwidth >> sb.blockdivshift;
+	sb.numvblocks = ds->surfheight >> sb.blockdivshift;
 
 //==============================
 
 	if (r_pixbytes == 1)
 	{
-		pblockdrawer = surfmiptable[r_drawsurf.surfmip];
+		pblockdrawer = surfmiptable[ds->surfmip];
 	// TODO: only needs to be set when there is a display settings change
 		horzblockstep = blocksize;
 	}
@@ -467,33 +458,33 @@ void R_DrawSurface (void)
 		horzblockstep = blocksize << 1;
 	}
 
-	smax = mt->width >> r_drawsurf.surfmip;
+	smax = mt->width >> ds->surfmip;
 	twidth = texwidth;
-	tmax = mt->height >> r_drawsurf.surfmip;
-	sourcetstep = texwidth;
-	r_stepback = tmax * twidth;
+	tmax = mt->height >> ds->surfmip;
+	sb.sourcetstep = texwidth;
+	sb.stepback = tmax * twidth;
 
-	r_sourcemax = r_source + (tmax * smax);
+	sb.sourcemax = source + (tmax * smax);
 
-	soffset = r_drawsurf.surf->texturemins[0];
-	basetoffset = r_drawsurf.surf->texturemins[1];
+	soffset = ds->surf->texturemins[0];
+	basetoffset = ds->surf->texturemins[1];
 
 // << 16 components are to guarantee positive values for %
-	soffset = ((soffset >> r_drawsurf.surfmip) + (smax << 16)) % smax;
-	basetptr = &r_source[((((basetoffset >> r_drawsurf.surfmip) 
+	soffset = ((soffset >> ds->surfmip) + (smax << 16)) % smax;
+	basetptr = &source[((((basetoffset >> ds->surfmip) 
 		+ (tmax << 16)) % tmax) * twidth)];
 
-	pcolumndest = r_drawsurf.surfdat;
+	pcolumndest = ds->surfdat;
 
-	for (u=0 ; u<r_numhblocks; u++)
+	for (u=0 ; u<numhblocks; u++)
 	{
-		r_lightptr = blocklights + u;
+		sb.lightptr = blocklights + u;
 
-		prowdestbase = pcolumndest;
+		sb.prowdestbase = pcolumndest;
 
-		pbasesource = basetptr + soffset;
+		sb.pbasesource = basetptr + soffset;
 
-		(*pblockdrawer)();
+		(*pblockdrawer)(&sb);
 
 		soffset = soffset + blocksize;
 		if (soffset >= smax)
@@ -503,6 +494,16 @@ void R_DrawSurface (void)
 	}
 }
 
+/*
+===============
+R_DrawSurface
+===============
+*/
+void R_DrawSurface (void)
+{
+	R_GenerateSurface (&r_drawsurf, blocklights);
+}
+
 #ifdef USEFPM
 void R_DrawSurfaceFPM (void)
 {
@@ -512,17 +513,20 @@ void R_DrawSurfaceFPM (void)
 	int				soffset, basetoffset, texwidth;
 	int				horzblockstep;
 	unsigned char	*pcolumndest;
-	void			(*pblockdrawer)(void);
+	int				blocksize, numhblocks;
+	unsigned char	*source;
+	void			(*pblockdrawer)(surfblock_t *sb);
 	texture_t		*mt;
+	surfblock_t		sb;
 
 // calculate the lightings
 	R_BuildLightMapFPM ();
 	
-	surfrowbytes = r_drawsurfFPM.rowbytes;
+	sb.rowbytes = r_drawsurfFPM.rowbytes;
 
 	mt = r_drawsurfFPM.texture;
 	
-	r_source = (byte *)mt + mt->offsets[r_drawsurfFPM.surfmip];
+	source = (byte *)mt + mt->offsets[r_drawsurfFPM.surfmip];
 	
 // the fractional light values should range from 0 to (VID_GRADES - 1) << 16
 // from a source range of 0 - 255
@@ -530,13 +534,12 @@ void R_DrawSurfaceFPM (void)
 	texwidth = mt->width >> r_drawsurfFPM.surfmip;
 
 	blocksize = 16 >> r_drawsurfFPM.surfmip;
-	blockdivshift = 4 - r_drawsurfFPM.surfmip;
-	blockdivmask = (1 << blockdivshift) - 1;
+	sb.blockdivshift = 4 - r_drawsurfFPM.surfmip;
 	
-	r_lightwidth = (r_drawsurfFPM.surf->extents[0]>>4)+1;
+	sb.lightwidth = (r_drawsurfFPM.surf->extents[0]>>4)+1;
 
-	r_numhblocks = r_drawsurfFPM.surfwidth >> blockdivshift;
-	r_numvblocks = r_drawsurfFPM.surfheight >> blockdivshift;
+	numhblocks = r_drawsurfFPM.surfwidth >> sb.blockdivshift;
+	sb.numvblocks = r_drawsurfFPM.surfheight >> sb.blockdivshift;
 
 //==============================
 
@@ -556,30 +559,30 @@ void R_DrawSurfaceFPM (void)
 	smax = mt->width >> r_drawsurfFPM.surfmip;
 	twidth = texwidth;
 	tmax = mt->height >> r_drawsurfFPM.surfmip;
-	sourcetstep = texwidth;
-	r_stepback = tmax * twidth;
+	sb.sourcetstep = texwidth;
+	sb.stepback = tmax * twidth;
 
-	r_sourcemax = r_source + (tmax * smax);
+	sb.sourcemax = source + (tmax * smax);
 
 	soffset = r_drawsurfFPM.surf->texturemins[0];
 	basetoffset = r_drawsurfFPM.surf->texturemins[1];
 
 // << 16 components are to guarantee positive values for %
 	soffset = ((soffset >> r_drawsurfFPM.surfmip) + (smax << 16)) % smax;
-	basetptr = &r_source[((((basetoffset >> r_drawsurfFPM.surfmip) 
+	basetptr = &source[((((basetoffset >> r_drawsurfFPM.surfmip) 
 		+ (tmax << 16)) % tmax) * twidth)];
 
 	pcolumndest = r_drawsurfFPM.surfdat;
 
-	for (u=0 ; u<r_numhblocks; u++)
+	for (u=0 ; u<numhblocks; u++)
 	{
-		r_lightptr = blocklights + u;
+		sb.lightptr = blocklights + u;
 
-		prowdestbase = pcolumndest;
+		sb.prowdestbase = pcolumndest;
 
-		pbasesource = basetptr + soffset;
+		sb.pbasesource = basetptr + soffset;
 
-		(*pblockdrawer)();
+		(*pblockdrawer)(&sb);
 
 		soffset = soffset + blocksize;
 		if (soffset >= smax)
@@ -599,23 +602,23 @@ void R_DrawSurfaceFPM (void)
 R_DrawSurfaceBlock8_mip0
 ================
 */
-void R_DrawSurfaceBlock8_mip0 (void)
+void R_DrawSurfaceBlock8_mip0 (surfblock_t *sb)
 {
 	int				v, i, b, lightstep, lighttemp, light;
+	int				lightleft, lightright, lightleftstep, lightrightstep;
 	unsigned char	pix, *psource, *prowdest;
 
-	psource = pbasesource;
-	prowdest = prowdestbase;
+	psource = sb->pbasesource;
+	prowdest = sb->prowdestbase;
 
-	for (v=0 ; v<r_numvblocks ; v++)
+	for (v=0 ; v<sb->numvblocks ; v++)
 	{
-	// FIXME: make these locals?
 	// FIXME: use delta rather than both right and left, like ASM?
-		lightleft = r_lightptr[0];
-		lightright = r_lightptr[1];
-		r_lightptr += r_lightwidth;
-		lightleftstep = (r_lightptr[0] - lightleft) >> 4;
-		lightrightstep = (r_lightptr[1] - lightright) >> 4;
+		lightleft = sb->lightptr[0];
+		lightright = sb->lightptr[1];
+		sb->lightptr += sb->lightwidth;
+		lightleftstep = (sb->lightptr[0] - lightleft) >> 4;
+		lightrightstep = (sb->lightptr[1] - lightright) >> 4;
 
 		for (i=0 ; i<16 ; i++)
 		{
@@ -632,14 +635,14 @@ void R_DrawSurfaceBlock8_mip0 (void)
 				light += lightstep;
 			}
 	
-			psource += sourcetstep;
+			psource += sb->sourcetstep;
 			lightright += lightrightstep;
 			lightleft += lightleftstep;
-			prowdest += surfrowbytes;
+			prowdest += sb->rowbytes;
 		}
 
-		if (psource >= r_sourcemax)
-			psource -= r_stepback;
+		if (psource >= sb->sourcemax)
+			psource -= sb->stepback;
 	}
 }
 
@@ -649,23 +652,23 @@ void R_DrawSurfaceBlock8_mip0 (void)
 R_DrawSurfaceBlock8_mip1
 ================
 */
-void R_DrawSurfaceBlock8_mip1 (void)
+void R_DrawSurfaceBlock8_mip1 (surfblock_t *sb)
 {
 	int				v, i, b, lightstep, lighttemp, light;
+	int				lightleft, lightright, lightleftstep, lightrightstep;
 	unsigned char	pix, *psource, *prowdest;
 
-	psource = pbasesource;
-	prowdest = prowdestbase;
+	psource = sb->pbasesource;
+	prowdest = sb->prowdestbase;
 
-	for (v=0 ; v<r_numvblocks ; v++)
+	for (v=0 ; v<sb->numvblocks ; v++)
 	{
-	// FIXME: make these locals?
 	// FIXME: use delta rather than both right and left, like ASM?
-		lightleft = r_lightptr[0];
-		lightright = r_lightptr[1];
-		r_lightptr += r_lightwidth;
-		lightleftstep = (r_lightptr[0] - lightleft) >> 3;
-		lightrightstep = (r_lightptr[1] - lightright) >> 3;
+		lightleft = sb->lightptr[0];
+		lightright = sb->lightptr[1];
+		sb->lightptr += sb->lightwidth;
+		lightleftstep = (sb->lightptr[0] - lightleft) >> 3;
+		lightrightstep = (sb->lightptr[1] - lightright) >> 3;
 
 		for (i=0 ; i<8 ; i++)
 		{
@@ -682,14 +685,14 @@ void R_DrawSurfaceBlock8_mip1 (void)
 				light += lightstep;
 			}
 	
-			psource += sourcetstep;
+			psource += sb->sourcetstep;
 			lightright += lightrightstep;
 			lightleft += lightleftstep;
-			prowdest += surfrowbytes;
+			prowdest += sb->rowbytes;
 		}
 
-		if (psource >= r_sourcemax)
-			psource -= r_stepback;
+		if (psource >= sb->sourcemax)
+			psource -= sb->stepback;
 	}
 }
 
@@ -699,23 +702,23 @@ void R_DrawSurfaceBlock8_mip1 (void)
 R_DrawSurfaceBlock8_mip2
 ================
 */
-void R_DrawSurfaceBlock8_mip2 (void)
+void R_DrawSurfaceBlock8_mip2 (surfblock_t *sb)
 {
 	int				v, i, b, lightstep, lighttemp, light;
+	int				lightleft, lightright, lightleftstep, lightrightstep;
 	unsigned char	pix, *psource, *prowdest;
 
-	psource = pbasesource;
-	prowdest = prowdestbase;
+	psource = sb->pbasesource;
+	prowdest = sb->prowdestbase;
 
-	for (v=0 ; v<r_numvblocks ; v++)
+	for (v=0 ; v<sb->numvblocks ; v++)
 	{
-	// FIXME: make these locals?
 	// FIXME: use delta rather than both right and left, like ASM?
-		lightleft = r_lightptr[0];
-		lightright = r_lightptr[1];
-		r_lightptr += r_lightwidth;
-		lightleftstep = (r_lightptr[0] - lightleft) >> 2;
-		lightrightstep = (r_lightptr[1] - lightright) >> 2;
+		lightleft = sb->lightptr[0];
+		lightright = sb->lightptr[1];
+		sb->lightptr += sb->lightwidth;
+		lightleftstep = (sb->lightptr[0] - lightleft) >> 2;
+		lightrightstep = (sb->lightptr[1] - lightright) >> 2;
 
 		for (i=0 ; i<4 ; i++)
 		{
@@ -732,14 +735,14 @@ void R_DrawSurfaceBlock8_mip2 (void)
 				light += lightstep;
 			}
 	
-			psource += sourcetstep;
+			psource += sb->sourcetstep;
 			lightright += lightrightstep;
 			lightleft += lightleftstep;
-			prowdest += surfrowbytes;
+			prowdest += sb->rowbytes;
 		}
 
-		if (psource >= r_sourcemax)
-			psource -= r_stepback;
+		if (psource >= sb->sourcemax)
+			psource -= sb->stepback;
 	}
 }
 
@@ -749,23 +752,23 @@ void R_DrawSurfaceBlock8_mip2 (void)
 R_DrawSurfaceBlock8_mip3
 ================
 */
-void R_DrawSurfaceBlock8_mip3 (void)
+void R_DrawSurfaceBlock8_mip3 (surfblock_t *sb)
 {
 	int				v, i, b, lightstep, lighttemp, light;
+	int				lightleft, lightright, lightleftstep, lightrightstep;
 	unsigned char	pix, *psource, *prowdest;
 
-	psource = pbasesource;
-	prowdest = prowdestbase;
+	psource = sb->pbasesource;
+	prowdest = sb->prowdestbase;
 
-	for (v=0 ; v<r_numvblocks ; v++)
+	for (v=0 ; v<sb->numvblocks ; v++)
 	{
-	// FIXME: make these locals?
 	// FIXME: use delta rather than both right and left, like ASM?
-		lightleft = r_lightptr[0];
-		lightright = r_lightptr[1];
-		r_lightptr += r_lightwidth;
-		lightleftstep = (r_lightptr[0] - lightleft) >> 1;
-		lightrightstep = (r_lightptr[1] - lightright) >> 1;
+		lightleft = sb->lightptr[0];
+		lightright = sb->lightptr[1];
+		sb->lightptr += sb->lightwidth;
+		lightleftstep = (sb->lightptr[0] - lightleft) >> 1;
+		lightrightstep = (sb->lightptr[1] - lightright) >> 1;
 
 		for (i=0 ; i<2 ; i++)
 		{
@@ -782,14 +785,14 @@ void R_DrawSurfaceBlock8_mip3 (void)
 				light += lightstep;
 			}
 	
-			psource += sourcetstep;
+			psource += sb->sourcetstep;
 			lightright += lightrightstep;
 			lightleft += lightleftstep;
-			prowdest += surfrowbytes;
+			prowdest += sb->rowbytes;
 		}
 
-		if (psource >= r_sourcemax)
-			psource -= r_stepback;
+		if (psource >= sb->sourcemax)
+			psource -= sb->stepback;
 	}
 }
 
@@ -801,14 +804,16 @@ R_DrawSurfaceBlock16
 FIXME: make this work
 ================
 */
-void R_DrawSurfaceBlock16 (void)
+void R_DrawSurfaceBlock16 (surfblock_t *sb)
 {
 	int				k;
 	unsigned char	*psource;
 	int				lighttemp, lightstep, light;
+	int				blocksize;
 	unsigned short	*prowdest;
 
-	prowdest = (unsigned short *)prowdestbase;
+	blocksize = 1 << sb->blockdivshift;
+	prowdest = (unsigned short *)sb->prowdestbase;
 
 	for (k=0 ; k<blocksize ; k++)
 	{
@@ -816,9 +821,9 @@ void R_DrawSurfaceBlock16 (void)
 		unsigned char	pix;
 		int				b;
 
-		psource = pbasesource;
+		psource = sb->pbasesource;
 		lighttemp = lightright - lightleft;
-		lightstep = lighttemp >> blockdivshift;
+		lightstep = lighttemp >> sb->blockdivshift;
 
 		light = lightleft;
 		pdest = prowdest;
@@ -832,13 +837,13 @@ void R_DrawSurfaceBlock16 (void)
 			light += lightstep;
 		}
 
-		pbasesource += sourcetstep;
+		sb->pbasesource += sb->sourcetstep;
 		lightright += lightrightstep;
 		lightleft += lightleftstep;
-		prowdest = (unsigned short *)((long)prowdest + surfrowbytes);
+		prowdest = (unsigned short *)((long)prowdest + sb->rowbytes);
 	}
 
-	prowdestbase = prowdest;
+	sb->prowdestbase = prowdest;
 }
 
 #endif
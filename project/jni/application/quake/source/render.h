@@ -242,6 +242,29 @@ void R_TeleportSplashFPM (vec3_FPM_t org);
 void R_PushDlights (void);
 void R_PushDlightsFPM (void);
 
+//
+// per stage render times, summed while r_timestages is set
+//
+typedef enum
+{
+	RS_OTHER,		// everything outside R_RenderView
+	RS_SETUP,
+	RS_BSP,			// world and brush model traversal
+	RS_EDGES,
+	RS_SPANS,
+	RS_SURFCACHE,
+	RS_ALIAS,		// alias models and sprites
+	RS_PARTICLES,
+	NUM_RSTAGES
+} rstage_t;
+
+extern	qboolean	r_timestages;
+extern	double		r_stagetime[NUM_RSTAGES];
+extern	char		*r_stagenames[NUM_RSTAGES];
+
+int R_TimeStage (int stage);
+void R_ClearStageTimes (void);
+
 //
 // surface cache related
 //
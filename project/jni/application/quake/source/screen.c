@@ -1047,6 +1047,7 @@ void SCR_UpdateScreen (void)
 #else
 	V_RenderView ();	   
 #endif
+	CL_HashTimeDemoFrame ();
 
 //	VID_UnlockBuffer ();
 
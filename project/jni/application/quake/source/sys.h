@@ -65,6 +65,10 @@ void Sys_Sleep (void);
 void Sys_SendKeyEvents (void);
 // Perform Key_Event () callbacks until the input que is empty
 
+void Sys_RunParallel (int threads, int count, void (*func) (int i));
+// calls func for every i from 0 to count-1 on up to threads threads, the
+// calling one included, and returns once all the calls are done
+
 void Sys_LowFPPrecision (void);
 void Sys_HighFPPrecision (void);
 void Sys_SetFPCW (void);
@@ -427,6 +427,98 @@ void Sys_Sleep(void)
 	SDL_Delay(1);
 }
 
+// =======================================================================
+// Worker threads
+// =======================================================================
+
+#define	MAX_WORKERS	15
+
+static SDL_Thread	*sys_workers[MAX_WORKERS];
+static int			sys_numworkers;
+static SDL_sem		*sys_workstart, *sys_workdone;
+static SDL_mutex	*sys_worklock;
+static void			(*sys_workfunc) (int i);
+static int			sys_worknext, sys_workcount;
+
+static void Sys_DoWork (void)
+{
+	int		i;
+
+	for (;;)
+	{
+		SDL_mutexP (sys_worklock);
+		i = sys_worknext++;
+		SDL_mutexV (sys_worklock);
+		if (i >= sys_workcount)
+			return;
+		sys_workfunc (i);
+	}
+}
+
+static int Sys_WorkerThread (void *unused)
+{
+	for (;;)
+	{
+		SDL_SemWait (sys_workstart);
+		Sys_DoWork ();
+		SDL_SemPost (sys_workdone);
+	}
+	return 0;
+}
+
+/*
+================
+Sys_RunParallel
+
+The workers are started the first time they are needed and then wait for
+more work; if they can't be started everything runs on the calling thread
+================
+*/
+void Sys_RunParallel (int threads, int count, void (*func) (int i))
+{
+	int		i;
+
+	if (threads > count)
+		threads = count;
+	if (threads > MAX_WORKERS + 1)
+		threads = MAX_WORKERS + 1;
+
+	if (threads > 1 && !sys_worklock)
+	{
+		sys_worklock = SDL_CreateMutex ();
+		sys_workstart = SDL_CreateSemaphore (0);
+		sys_workdone = SDL_CreateSemaphore (0);
+		if (!sys_worklock || !sys_workstart || !sys_workdone)
+			Sys_Error ("Sys_RunParallel: %s", SDL_GetError ());
+	}
+	while (sys_numworkers < threads - 1)
+	{
+		sys_workers[sys_numworkers] = SDL_CreateThread (Sys_WorkerThread, NULL);
+		if (!sys_workers[sys_numworkers])
+			break;
+		sys_numworkers++;
+	}
+	if (threads > sys_numworkers + 1)
+		threads = sys_numworkers + 1;
+
+	if (threads <= 1)
+	{
+		for (i=0 ; i<count ; i++)
+			func (i);
+		return;
+	}
+
+	sys_workfunc = func;
+	sys_worknext = 0;
+	sys_workcount = count;
+
+	for (i=1 ; i<threads ; i++)
+		SDL_SemPost (sys_workstart);
+	Sys_DoWork ();
+	for (i=1 ; i<threads ; i++)
+		SDL_SemWait (sys_workdone);
+}
+
 void floating_point_exception_handler(int whatever) {
 //	Sys_Warn("floating point exception\n");
 	signal(SIGFPE, floating_point_exception_handler);
@@ -441,6 +533,7 @@ int main (int c, char **v) {
 	extern int vcrFile;
 	extern int recording;
 	static int frame;
+	int j;
 
 	moncontrol(0);
 
@@ -460,6 +553,11 @@ int main (int c, char **v) {
 
 	Cvar_RegisterVariable (&sys_nostdout);
 
+	// -benchmark <demo>: timedemo with render stage times, then quit
+	j = COM_CheckParm ("-benchmark");
+	if (j && j < com_argc-1)
+		Cbuf_AddText (va("cl_timedemostages 1\ntimedemo %s\n", com_argv[j+1]));
+
 	while (1) {
 		oldtime = Sys_FloatTime () - 0.1;
 
@@ -9,6 +9,12 @@
 #include "quakedef.h"
 #include "d_local.h"
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 // R2-Tec
 #include "sys_r2-tec.h"
 static TTF_Font *gTTFFont = NULL;
@@ -22,6 +28,13 @@ unsigned short d_8to16table[256];
 static SDL_Surface *hwscreen = NULL;
 static SDL_Surface *screen = NULL;
 
+// Palette in the pixel format of hwscreen, used by VID_Update to expand
+// only the updated rects instead of blitting the whole screen
+static Uint16 vid_pal16[256];
+static Uint32 vid_pal32[256];
+static qboolean vid_expand = false;
+static qboolean vid_palchanged = true;
+
 int min_vid_width = 320;
 
 int VGA_width, VGA_height, VGA_rowbytes, VGA_bufferrowbytes = 0;
@@ -60,16 +73,86 @@ void VID_SetPalette (unsigned char *palette) {
     }
     //SDL_SetPalette(screen, SDL_LOGPAL|SDL_PHYSPAL, colors, 0, 256);
     SDL_SetColors(screen, colors, 0, 256);
+
+    vid_expand = hwscreen->format->BytesPerPixel == 2 || hwscreen->format->BytesPerPixel == 4;
+    for ( i=0; i<256; ++i ) {
+        vid_pal32[i] = SDL_MapRGB(hwscreen->format, colors[i].r, colors[i].g, colors[i].b);
+        vid_pal16[i] = (Uint16)vid_pal32[i];
+    }
+    vid_palchanged = true;
 }
 
 void VID_ShiftPalette (unsigned char *palette) {
     VID_SetPalette(palette);
 }
 
+/*
+================
+VID_StartGame
+
+Sets the mode and checks the game data picked in the launcher menu
+================
+*/
+static void VID_StartGame (void) {
+	int pnum;
+	int handle = -1;
+
+	// Set up display mode (width and height)
+	vid.width = 480;
+	vid.height = 320;
+
+	if ((pnum=COM_CheckParm("-winsize"))) {
+		if (pnum >= com_argc-2)
+			Sys_Error("VID: -winsize <width> <height>\n");
+
+		vid.width = Q_atoi(com_argv[pnum+1]);
+		vid.height = Q_atoi(com_argv[pnum+2]);
+
+		if (!vid.width || !vid.height)
+			Sys_Error("VID: Bad window width/height\n");
+	}
+
+	if (r2_cpu == 1) {
+		cpu_set_clock(336);
+	} else if (r2_cpu == 2) {
+		cpu_set_clock(364);
+	} else if (r2_cpu == 3) {
+		cpu_set_clock(392);
+	} else if (r2_cpu == 3) {
+		cpu_set_clock(420);
+	}
+
+	if (r2_mod == 0) {
+		if (Sys_FileOpenRead("id1/pak0.pak", &handle) < 0) {
+			Sys_Error("/id1/pak0.pak was not found.\n");
+			return;
+		} else {
+			Sys_FileClose(handle);
+		}
+	} else if (r2_mod == 1) {
+		if (Sys_FileOpenRead("hipnotic/pak0.pak", &handle) < 0) {
+			Sys_Error("/hipnotic/pak0.pak was not found.\n");
+			return;
+		} else {
+			Sys_FileClose(handle);
+		}
+	} else if (r2_mod == 2) {
+		if (Sys_FileOpenRead("rogue/pak0.pak", &handle) < 0) {
+			Sys_Error("/rogue/pak0.pak was not found.\n");
+			return;
+		} else {
+			Sys_FileClose(handle);
+		}
+	}
+
+	// Initialize display 
+	screen = SDL_CreateRGBSurface(SDL_SWSURFACE, vid.width, vid.height, 8, 0, 0, 0, 0);
+}
+
 void VID_Init (unsigned char *palette) {
 	cpu_init();
 	
-	int pnum, chunk;
+	int chunk;
 	byte *cache;
     int cachesize;
 
@@ -78,11 +161,16 @@ void VID_Init (unsigned char *palette) {
 
 	int quit = false;
 	int option = 0;
-	int handle = -1;
 
 	TTF_Init();
 	gTTFFont = TTF_OpenFont("q_sys/gfx/dpquake.ttf", 16);
 
+#ifndef __ANDROID__
+	// -benchmark runs without a window unless a video driver is asked for
+	if (COM_CheckParm("-benchmark") && !getenv("SDL_VIDEODRIVER"))
+		SDL_putenv("SDL_VIDEODRIVER=dummy");
+#endif
+
     // Load the SDL library
     if (SDL_Init(SDL_INIT_VIDEO|SDL_INIT_AUDIO) != 0)
         Sys_Error("VID: Couldn't load SDL: %s", SDL_GetError());
@@ -103,6 +191,12 @@ void VID_Init (unsigned char *palette) {
 	// initialize the mouse
 	SDL_ShowCursor(0);
 
+	// -benchmark skips the launcher menu
+	if (COM_CheckParm("-benchmark")) {
+		VID_StartGame();
+		quit = true;
+	}
+
 	while (!quit) {
 		SDL_FillRect(hwscreen, NULL, SDL_MapRGB(hwscreen->format, 0,0,0));
 
@@ -207,56 +301,7 @@ void VID_Init (unsigned char *palette) {
 
 						case SDLK_LCTRL:
 							if(option == 2) {
-								// Set up display mode (width and height)
-								vid.width = 480;
-								vid.height = 320;
-
-								if ((pnum=COM_CheckParm("-winsize"))) {
-									if (pnum >= com_argc-2)
-										Sys_Error("VID: -winsize <width> <height>\n");
-
-									vid.width = Q_atoi(com_argv[pnum+1]);
-									vid.height = Q_atoi(com_argv[pnum+2]);
-
-									if (!vid.width || !vid.height)
-										Sys_Error("VID: Bad window width/height\n");
-								}
-
-								if (r2_cpu == 1) {
-									cpu_set_clock(336);
-								} else if (r2_cpu == 2) {
-									cpu_set_clock(364);
-								} else if (r2_cpu == 3) {
-									cpu_set_clock(392);
-								} else if (r2_cpu == 3) {
-									cpu_set_clock(420);
-								}
-
-								if (r2_mod == 0) {
-									if (Sys_FileOpenRead("id1/pak0.pak", &handle) < 0) {
-										Sys_Error("/id1/pak0.pak was not found.\n");
-										return;
-									} else {
-										Sys_FileClose(handle);
-									}
-								} else if (r2_mod == 1) {
-									if (Sys_FileOpenRead("hipnotic/pak0.pak", &handle) < 0) {
-										Sys_Error("/hipnotic/pak0.pak was not found.\n");
-										return;
-									} else {
-										Sys_FileClose(handle);
-									}
-								} else if (r2_mod == 2) {
-									if (Sys_FileOpenRead("rogue/pak0.pak", &handle) < 0) {
-										Sys_Error("/rogue/pak0.pak was not found.\n");
-										return;
-									} else {
-										Sys_FileClose(handle);
-									}
-								}
-
-								// Initialize display 
-								screen = SDL_CreateRGBSurface(SDL_SWSURFACE, vid.width, vid.height, 8, 0, 0, 0, 0);
+								VID_StartGame();
 								quit = true;
 							}
 						break;
@@ -306,11 +351,135 @@ void    VID_Shutdown (void) {
     SDL_Quit();
 }
 
+/*
+================
+VID_Expand8to16 / VID_Expand8to32
+
+Palette lookup of one row.  Neither SSE2 nor NEON can index a 256 entry
+table, so the lookups stay scalar and the vector units only gather eight
+pixels into one wide store.
+================
+*/
+static void VID_Expand8to16 (Uint16 *d, const byte *s, int w)
+{
+    const Uint16 *pal = vid_pal16;
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    uint16x8_t v;
+
+    for ( ; w >= 8; w -= 8, s += 8, d += 8) {
+        v = vdupq_n_u16(pal[s[0]]);
+        v = vsetq_lane_u16(pal[s[1]], v, 1);
+        v = vsetq_lane_u16(pal[s[2]], v, 2);
+        v = vsetq_lane_u16(pal[s[3]], v, 3);
+        v = vsetq_lane_u16(pal[s[4]], v, 4);
+        v = vsetq_lane_u16(pal[s[5]], v, 5);
+        v = vsetq_lane_u16(pal[s[6]], v, 6);
+        v = vsetq_lane_u16(pal[s[7]], v, 7);
+        vst1q_u16(d, v);
+    }
+#elif defined(__SSE2__)
+    for ( ; w >= 8; w -= 8, s += 8, d += 8)
+        _mm_storeu_si128((__m128i *)d, _mm_set_epi16(pal[s[7]], pal[s[6]], pal[s[5]], pal[s[4]],
+            pal[s[3]], pal[s[2]], pal[s[1]], pal[s[0]]));
+#endif
+    while (w-- > 0)
+        *d++ = pal[*s++];
+}
+
+static void VID_Expand8to32 (Uint32 *d, const byte *s, int w)
+{
+    const Uint32 *pal = vid_pal32;
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    uint32x4_t v0, v1;
+
+    for ( ; w >= 8; w -= 8, s += 8, d += 8) {
+        v0 = vdupq_n_u32(pal[s[0]]);
+        v0 = vsetq_lane_u32(pal[s[1]], v0, 1);
+        v0 = vsetq_lane_u32(pal[s[2]], v0, 2);
+        v0 = vsetq_lane_u32(pal[s[3]], v0, 3);
+        v1 = vdupq_n_u32(pal[s[4]]);
+        v1 = vsetq_lane_u32(pal[s[5]], v1, 1);
+        v1 = vsetq_lane_u32(pal[s[6]], v1, 2);
+        v1 = vsetq_lane_u32(pal[s[7]], v1, 3);
+        vst1q_u32(d, v0);
+        vst1q_u32(d + 4, v1);
+    }
+#elif defined(__SSE2__)
+    for ( ; w >= 8; w -= 8, s += 8, d += 8) {
+        _mm_storeu_si128((__m128i *)d, _mm_set_epi32(pal[s[3]], pal[s[2]], pal[s[1]], pal[s[0]]));
+        _mm_storeu_si128((__m128i *)(d + 4), _mm_set_epi32(pal[s[7]], pal[s[6]], pal[s[5]], pal[s[4]]));
+    }
+#endif
+    while (w-- > 0)
+        *d++ = pal[*s++];
+}
+
+/*
+================
+VID_ExpandRect
+
+Clips the rect to both surfaces and copies it from screen to the locked
+hwscreen through the palette table.  Returns false if nothing is left.
+================
+*/
+static qboolean VID_ExpandRect (SDL_Rect *r, int x, int y, int width, int height)
+{
+    byte *src;
+    Uint8 *dst;
+
+    if (x < 0) { width += x; x = 0; }
+    if (y < 0) { height += y; y = 0; }
+    if (width > screen->w - x) width = screen->w - x;
+    if (width > hwscreen->w - x) width = hwscreen->w - x;
+    if (height > screen->h - y) height = screen->h - y;
+    if (height > hwscreen->h - y) height = hwscreen->h - y;
+    if (width <= 0 || height <= 0)
+        return false;
+
+    r->x = x;
+    r->y = y;
+    r->w = width;
+    r->h = height;
+
+    src = (byte *)screen->pixels + y * screen->pitch + x;
+    dst = (Uint8 *)hwscreen->pixels + y * hwscreen->pitch + x * hwscreen->format->BytesPerPixel;
+    for ( ; height > 0; height--, src += screen->pitch, dst += hwscreen->pitch) {
+        if (hwscreen->format->BytesPerPixel == 2)
+            VID_Expand8to16((Uint16 *)dst, src, width);
+        else
+            VID_Expand8to32((Uint32 *)dst, src, width);
+    }
+    return true;
+}
+
 void    VID_Update (vrect_t *rects) {
     SDL_Rect *sdlrects;
+    SDL_Rect full;
     int n, i;
     vrect_t *rect;
 
+    // No table for this pixel format, let SDL convert the whole screen
+    if (!vid_expand) {
+        SDL_BlitSurface(screen, 0, hwscreen, 0);
+        SDL_Flip(hwscreen);
+        return;
+    }
+
+    if (SDL_MUSTLOCK(hwscreen) && SDL_LockSurface(hwscreen) < 0)
+        return;
+
+    // A new palette changes every pixel, not just the updated ones
+    if (vid_palchanged) {
+        VID_ExpandRect(&full, 0, 0, screen->w, screen->h);
+        if (SDL_MUSTLOCK(hwscreen))
+            SDL_UnlockSurface(hwscreen);
+        SDL_Flip(hwscreen);
+        vid_palchanged = false;
+        return;
+    }
+
     // Two-pass system, since Quake doesn't do it the SDL way...
 
     // First, count the number of rectangles
@@ -318,22 +487,19 @@ void    VID_Update (vrect_t *rects) {
     for (rect = rects; rect; rect = rect->pnext)
         ++n;
 
-    // Second, copy them to SDL rectangles and update
+    // Second, expand them to hwscreen and update only those
     if (!(sdlrects = (SDL_Rect *)alloca(n*sizeof(*sdlrects))))
         Sys_Error("Out of memory");
     i = 0;
 
-	for (rect = rects; rect; rect = rect->pnext) {
-        sdlrects[i].x = rect->x;
-        sdlrects[i].y = rect->y;
-        sdlrects[i].w = rect->width;
-        sdlrects[i].h = rect->height;
-        ++i;
+    for (rect = rects; rect; rect = rect->pnext) {
+        if (VID_ExpandRect(&sdlrects[i], rect->x, rect->y, rect->width, rect->height))
+            ++i;
     }
 
-	SDL_Flip(screen);
-	SDL_BlitSurface(screen, 0, hwscreen, 0);
-	SDL_Flip(hwscreen);
+    if (SDL_MUSTLOCK(hwscreen))
+        SDL_UnlockSurface(hwscreen);
+    SDL_UpdateRects(hwscreen, i, sdlrects);
 }
 
 /*
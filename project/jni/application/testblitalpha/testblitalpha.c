@@ -0,0 +1,225 @@
+/*
+ * Compares alpha blitters, which SDL selects for this CPU (SSE2, NEON or C),
+ * with reference C code, which is the same as C blitters in SDL_blit_A.c.
+ * Blits random pixels with random sizes and offsets, so unaligned pixels
+ * at the start and end of each row are tested too, then measures blit speed.
+ * Results are written to logcat, the screen becomes green if all blits are pixel-exact, red otherwise.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+#ifdef __ANDROID__
+#include <android/log.h>
+#define LOG(...) __android_log_print(ANDROID_LOG_INFO, "TestBlitAlpha", __VA_ARGS__)
+#else
+#include <stdio.h>
+#define LOG(...) (printf(__VA_ARGS__), printf("\n"))
+#endif
+
+enum { TEST_ITERATIONS = 500, BENCHMARK_W = 320, BENCHMARK_H = 240, BENCHMARK_BLITS = 200 };
+
+typedef enum { ARGB_TO_RGB888, ARGB_TO_RGB565, RGB565_SURFACE_ALPHA } BlitType;
+
+static const char * blitNames[] = { "ARGB8888->RGB888 pixel alpha", "ARGB8888->RGB565 pixel alpha", "RGB565->RGB565 surface alpha" };
+
+static Uint32 randomPixel(void)
+{
+	Uint32 p = (rand() & 0xffff) | ((rand() & 0xffff) << 16);
+	/* Sprites are mostly fully transparent or opaque */
+	switch(rand() % 4) {
+		case 0: return p & 0x00ffffff;
+		case 1: return p | 0xff000000;
+	}
+	return p;
+}
+
+static Uint32 referenceRGB888(Uint32 s, Uint32 d)
+{
+	Uint32 alpha = s >> 24;
+	Uint32 s1, d1;
+	if(alpha == 0)
+		return d;
+	if(alpha == SDL_ALPHA_OPAQUE)
+		return (s & 0x00ffffff) | (d & 0xff000000);
+	s1 = s & 0xff00ff;
+	d1 = d & 0xff00ff;
+	d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0xff00ff;
+	d1 |= ((d & 0xff00) + (((s & 0xff00) - (d & 0xff00)) * alpha >> 8)) & 0xff00;
+	return d1 | (d & 0xff000000);
+}
+
+static Uint16 referenceRGB565(Uint32 s, Uint32 d)
+{
+	unsigned alpha = s >> 27;
+	if(alpha == 0)
+		return d;
+	if(alpha == (SDL_ALPHA_OPAQUE >> 3))
+		return (Uint16)((s >> 8 & 0xf800) + (s >> 5 & 0x7e0) + (s >> 3 & 0x1f));
+	s = ((s & 0xfc00) << 11) + (s >> 8 & 0xf800) + (s >> 3 & 0x1f);
+	d = (d | d << 16) & 0x07e0f81f;
+	d += (s - d) * alpha >> 5;
+	d &= 0x07e0f81f;
+	return (Uint16)(d | d >> 16);
+}
+
+static Uint16 referenceSurfaceAlpha565(Uint32 s, Uint32 d, unsigned alpha)
+{
+	/* SDL_CalculateBlit() picks a plain copy for an opaque surface */
+	if(alpha == SDL_ALPHA_OPAQUE)
+		return (Uint16)s;
+	alpha >>= 3;
+	s = (s | s << 16) & 0x07e0f81f;
+	d = (d | d << 16) & 0x07e0f81f;
+	d += (s - d) * alpha >> 5;
+	d &= 0x07e0f81f;
+	return (Uint16)(d | d >> 16);
+}
+
+static void createSurfaces(BlitType type, int w, int h, SDL_Surface **src, SDL_Surface **dst)
+{
+	if(type == RGB565_SURFACE_ALPHA)
+		*src = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 16, 0xf800, 0x7e0, 0x1f, 0);
+	else
+		*src = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 32, 0xff0000, 0xff00, 0xff, 0xff000000);
+	if(type == ARGB_TO_RGB888)
+		*dst = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 32, 0xff0000, 0xff00, 0xff, 0xff000000);
+	else
+		*dst = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 16, 0xf800, 0x7e0, 0x1f, 0);
+}
+
+static void fillRandom(SDL_Surface *s)
+{
+	int x, y;
+	for(y = 0; y < s->h; y++) {
+		Uint8 *row = (Uint8 *)s->pixels + y * s->pitch;
+		for(x = 0; x < s->w; x++) {
+			Uint32 p = randomPixel();
+			if(s->format->BytesPerPixel == 4)
+				((Uint32 *)row)[x] = p;
+			else
+				((Uint16 *)row)[x] = (Uint16)p;
+		}
+	}
+}
+
+static void copyPixels(SDL_Surface *from, SDL_Surface *to)
+{
+	int y;
+	for(y = 0; y < from->h; y++)
+		memcpy((Uint8 *)to->pixels + y * to->pitch, (Uint8 *)from->pixels + y * from->pitch, from->w * from->format->BytesPerPixel);
+}
+
+static Uint32 getPixel(SDL_Surface *s, int x, int y)
+{
+	Uint8 *row = (Uint8 *)s->pixels + y * s->pitch;
+	if(s->format->BytesPerPixel == 4)
+		return ((Uint32 *)row)[x];
+	return ((Uint16 *)row)[x];
+}
+
+/* Returns amount of wrong pixels */
+static int testBlit(BlitType type)
+{
+	SDL_Surface *src, *dst, *unused, *ref;
+	SDL_Rect srcRect, dstRect;
+	int w = 1 + rand() % 67, h = 1 + rand() % 4;
+	unsigned alpha = rand() % 256;
+	int x, y, errors = 0;
+
+	createSurfaces(type, w + 8, h, &src, &dst);
+	createSurfaces(type, w + 8, h, &unused, &ref);
+	SDL_FreeSurface(unused);
+	fillRandom(src);
+	fillRandom(dst);
+	copyPixels(dst, ref);
+	if(type == RGB565_SURFACE_ALPHA)
+		SDL_SetAlpha(src, SDL_SRCALPHA, alpha);
+
+	srcRect.x = rand() % 8;
+	srcRect.y = 0;
+	srcRect.w = w;
+	srcRect.h = h;
+	dstRect.x = rand() % 8;
+	dstRect.y = 0;
+	SDL_BlitSurface(src, &srcRect, dst, &dstRect);
+
+	for(y = 0; y < h; y++) {
+		for(x = 0; x < dst->w; x++) {
+			Uint32 d = getPixel(ref, x, y), expected = d;
+			if(x >= dstRect.x && x < dstRect.x + w) {
+				Uint32 s = getPixel(src, x - dstRect.x + srcRect.x, y);
+				if(type == ARGB_TO_RGB888)
+					expected = referenceRGB888(s, d);
+				else if(type == ARGB_TO_RGB565)
+					expected = referenceRGB565(s, d);
+				else
+					expected = referenceSurfaceAlpha565(s, d, alpha);
+			}
+			if(getPixel(dst, x, y) != expected) {
+				if(errors == 0)
+					LOG("%s: mismatch at x %d y %d blit width %d: got %08x expected %08x",
+						blitNames[type], x, y, w, getPixel(dst, x, y), expected);
+				errors++;
+			}
+		}
+	}
+
+	SDL_FreeSurface(src);
+	SDL_FreeSurface(dst);
+	SDL_FreeSurface(ref);
+	return errors;
+}
+
+static void benchmarkBlit(BlitType type)
+{
+	SDL_Surface *src, *dst;
+	Uint32 ticks;
+	int i;
+
+	createSurfaces(type, BENCHMARK_W, BENCHMARK_H, &src, &dst);
+	fillRandom(src);
+	fillRandom(dst);
+	if(type == RGB565_SURFACE_ALPHA)
+		SDL_SetAlpha(src, SDL_SRCALPHA, 100);
+	ticks = SDL_GetTicks();
+	for(i = 0; i < BENCHMARK_BLITS; i++)
+		SDL_BlitSurface(src, NULL, dst, NULL);
+	ticks = SDL_GetTicks() - ticks;
+	LOG("%s: %d blits %dx%d in %d ms", blitNames[type], BENCHMARK_BLITS, BENCHMARK_W, BENCHMARK_H, (int)ticks);
+	SDL_FreeSurface(src);
+	SDL_FreeSurface(dst);
+}
+
+int main(int argc, char *argv[])
+{
+	SDL_Surface *screen;
+	SDL_Event event;
+	int type, i, errors = 0;
+
+	if(SDL_Init(SDL_INIT_VIDEO) < 0)
+		return 1;
+	screen = SDL_SetVideoMode(640, 480, 16, SDL_SWSURFACE);
+	if(!screen)
+		return 1;
+
+	LOG("CPU features: SSE2 %d NEON %d", SDL_HasSSE2(), SDL_HasNEON());
+	srand(1);
+	for(type = ARGB_TO_RGB888; type <= RGB565_SURFACE_ALPHA; type++) {
+		int typeErrors = 0;
+		for(i = 0; i < TEST_ITERATIONS; i++)
+			typeErrors += testBlit(type);
+		LOG("%s: %s, %d wrong pixels", blitNames[type], typeErrors ? "FAILED" : "passed", typeErrors);
+		errors += typeErrors;
+		benchmarkBlit(type);
+	}
+
+	SDL_FillRect(screen, NULL, errors ? SDL_MapRGB(screen->format, 255, 0, 0) : SDL_MapRGB(screen->format, 0, 255, 0));
+	SDL_Flip(screen);
+	while(SDL_WaitEvent(&event)) {
+		if(event.type == SDL_QUIT || event.type == SDL_KEYDOWN || event.type == SDL_MOUSEBUTTONDOWN)
+			break;
+	}
+	SDL_Quit();
+	return errors ? 1 : 0;
+}
@@ -568,6 +568,158 @@ bool quarter_pixel(const GLvoid *src[16],
     #undef write_each
 }
 
+// Specialized row converters for the common texture upload formats.
+// They are plain loops over bytes, so the compiler can vectorize them
+// (NEON on ARM, SSE2 on x86), and skip the float pixel_t round trip of
+// remap_pixel. 8 bit to 4/5/6 bit channels are truncated, like the
+// old hand written fast paths; the other way the high bits are replicated.
+
+typedef void (*convert_row_t)(const GLubyte *restrict src, GLvoid *restrict dst, GLuint width);
+
+static void convert_bgra8_rgba8(const GLubyte *restrict src, GLvoid *restrict dst, GLuint width) {
+    GLubyte *restrict d = (GLubyte *)dst;
+    for (GLuint i = 0; i < width; i++) {
+        d[4*i+0] = src[4*i+2];
+        d[4*i+1] = src[4*i+1];
+        d[4*i+2] = src[4*i+0];
+        d[4*i+3] = src[4*i+3];
+    }
+}
+
+static void convert_rgb8_rgba8(const GLubyte *restrict src, GLvoid *restrict dst, GLuint width) {
+    GLubyte *restrict d = (GLubyte *)dst;
+    for (GLuint i = 0; i < width; i++) {
+        d[4*i+0] = src[3*i+0];
+        d[4*i+1] = src[3*i+1];
+        d[4*i+2] = src[3*i+2];
+        d[4*i+3] = 255;
+    }
+}
+
+static void convert_bgr8_rgba8(const GLubyte *restrict src, GLvoid *restrict dst, GLuint width) {
+    GLubyte *restrict d = (GLubyte *)dst;
+    for (GLuint i = 0; i < width; i++) {
+        d[4*i+0] = src[3*i+2];
+        d[4*i+1] = src[3*i+1];
+        d[4*i+2] = src[3*i+0];
+        d[4*i+3] = 255;
+    }
+}
+
+static void convert_l8_rgba8(const GLubyte *restrict src, GLvoid *restrict dst, GLuint width) {
+    GLubyte *restrict d = (GLubyte *)dst;
+    for (GLuint i = 0; i < width; i++) {
+        d[4*i+0] = d[4*i+1] = d[4*i+2] = src[i];
+        d[4*i+3] = 255;
+    }
+}
+
+static void convert_la8_rgba8(const GLubyte *restrict src, GLvoid *restrict dst, GLuint width) {
+    GLubyte *restrict d = (GLubyte *)dst;
+    for (GLuint i = 0; i < width; i++) {
+        d[4*i+0] = d[4*i+1] = d[4*i+2] = src[2*i+0];
+        d[4*i+3] = src[2*i+1];
+    }
+}
+
+static void convert_a8_rgba8(const GLubyte *restrict src, GLvoid *restrict dst, GLuint width) {
+    GLubyte *restrict d = (GLubyte *)dst;
+    for (GLuint i = 0; i < width; i++) {
+        d[4*i+0] = d[4*i+1] = d[4*i+2] = 0;
+        d[4*i+3] = src[i];
+    }
+}
+
+static void convert_rgba8_rgb565(const GLubyte *restrict src, GLvoid *restrict dst, GLuint width) {
+    GLushort *restrict d = (GLushort *)dst;
+    for (GLuint i = 0; i < width; i++)
+        d[i] = ((src[4*i+0] & 0xf8) << 8) | ((src[4*i+1] & 0xfc) << 3) | (src[4*i+2] >> 3);
+}
+
+static void convert_rgb8_rgb565(const GLubyte *restrict src, GLvoid *restrict dst, GLuint width) {
+    GLushort *restrict d = (GLushort *)dst;
+    for (GLuint i = 0; i < width; i++)
+        d[i] = ((src[3*i+0] & 0xf8) << 8) | ((src[3*i+1] & 0xfc) << 3) | (src[3*i+2] >> 3);
+}
+
+static void convert_bgr8_rgb565(const GLubyte *restrict src, GLvoid *restrict dst, GLuint width) {
+    GLushort *restrict d = (GLushort *)dst;
+    for (GLuint i = 0; i < width; i++)
+        d[i] = ((src[3*i+2] & 0xf8) << 8) | ((src[3*i+1] & 0xfc) << 3) | (src[3*i+0] >> 3);
+}
+
+static void convert_rgba8_rgba4444(const GLubyte *restrict src, GLvoid *restrict dst, GLuint width) {
+    GLushort *restrict d = (GLushort *)dst;
+    for (GLuint i = 0; i < width; i++)
+        d[i] = ((src[4*i+0] & 0xf0) << 8) | ((src[4*i+1] & 0xf0) << 4) |
+               (src[4*i+2] & 0xf0) | (src[4*i+3] >> 4);
+}
+
+static void convert_rgba8_rgba5551(const GLubyte *restrict src, GLvoid *restrict dst, GLuint width) {
+    GLushort *restrict d = (GLushort *)dst;
+    for (GLuint i = 0; i < width; i++)
+        d[i] = ((src[4*i+0] & 0xf8) << 8) | ((src[4*i+1] & 0xf8) << 3) |
+               ((src[4*i+2] & 0xf8) >> 2) | (src[4*i+3] >> 7);
+}
+
+static void convert_rgb565_rgba8(const GLubyte *restrict src, GLvoid *restrict dst, GLuint width) {
+    const GLushort *restrict s = (const GLushort *)src;
+    GLubyte *restrict d = (GLubyte *)dst;
+    for (GLuint i = 0; i < width; i++) {
+        GLuint r = s[i] >> 11, g = (s[i] >> 5) & 0x3f, b = s[i] & 0x1f;
+        d[4*i+0] = (r << 3) | (r >> 2);
+        d[4*i+1] = (g << 2) | (g >> 4);
+        d[4*i+2] = (b << 3) | (b >> 2);
+        d[4*i+3] = 255;
+    }
+}
+
+static void convert_rgba4444_rgba8(const GLubyte *restrict src, GLvoid *restrict dst, GLuint width) {
+    const GLushort *restrict s = (const GLushort *)src;
+    GLubyte *restrict d = (GLubyte *)dst;
+    for (GLuint i = 0; i < width; i++) {
+        d[4*i+0] = ((s[i] >> 12) & 0x0f) * 0x11;
+        d[4*i+1] = ((s[i] >> 8) & 0x0f) * 0x11;
+        d[4*i+2] = ((s[i] >> 4) & 0x0f) * 0x11;
+        d[4*i+3] = (s[i] & 0x0f) * 0x11;
+    }
+}
+
+typedef struct {
+    GLenum src_format, src_type;
+    GLenum dst_format, dst_type;
+    convert_row_t convert;
+} fast_convert_t;
+
+static const fast_convert_t fast_converters[] = {
+    {GL_BGRA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE, convert_bgra8_rgba8},
+    {GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, GL_RGBA, GL_UNSIGNED_BYTE, convert_bgra8_rgba8},
+    {GL_RGBA, GL_UNSIGNED_BYTE, GL_BGRA, GL_UNSIGNED_BYTE, convert_bgra8_rgba8},
+    {GL_RGB, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE, convert_rgb8_rgba8},
+    {GL_BGR, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE, convert_bgr8_rgba8},
+    {GL_LUMINANCE, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE, convert_l8_rgba8},
+    {GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE, convert_la8_rgba8},
+    {GL_ALPHA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE, convert_a8_rgba8},
+    {GL_RGBA, GL_UNSIGNED_BYTE, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, convert_rgba8_rgb565},
+    {GL_RGB, GL_UNSIGNED_BYTE, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, convert_rgb8_rgb565},
+    {GL_BGR, GL_UNSIGNED_BYTE, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, convert_bgr8_rgb565},
+    {GL_RGBA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, convert_rgba8_rgba4444},
+    {GL_RGBA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, convert_rgba8_rgba5551},
+    {GL_RGB, GL_UNSIGNED_SHORT_5_6_5, GL_RGBA, GL_UNSIGNED_BYTE, convert_rgb565_rgba8},
+    {GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, GL_RGBA, GL_UNSIGNED_BYTE, convert_rgba4444_rgba8},
+};
+
+static convert_row_t get_fast_converter(GLenum src_format, GLenum src_type,
+                                        GLenum dst_format, GLenum dst_type) {
+    for (int i = 0; i < sizeof(fast_converters) / sizeof(fast_converters[0]); i++) {
+        const fast_convert_t *c = &fast_converters[i];
+        if (c->src_format == src_format && c->src_type == src_type &&
+            c->dst_format == dst_format && c->dst_type == dst_type)
+            return c->convert;
+    }
+    return NULL;
+}
+
 bool pixel_convert(const GLvoid *src, GLvoid **dst,
                    GLuint width, GLuint height,
                    GLenum src_format, GLenum src_type,
@@ -603,46 +755,14 @@ bool pixel_convert(const GLvoid *src, GLvoid **dst,
         *dst = malloc(dst_size);
     uintptr_t src_pos = (uintptr_t)src;
     uintptr_t dst_pos = (uintptr_t)*dst;
-    // fast optimized loop for common conversion cases first...
-    if ((src_format == GL_BGRA) && (dst_format == GL_RGBA) && (dst_type == GL_UNSIGNED_BYTE) && ((src_type == GL_UNSIGNED_BYTE)||(src_type == GL_UNSIGNED_INT_8_8_8_8_REV))) {
-        GLuint tmp;
+    // fast specialized loops for common conversion cases first...
+    convert_row_t convert = get_fast_converter(src_format, src_type, dst_format, dst_type);
+    if (convert) {
+        GLuint dst_pitch = stride ? dst_width : src_width;
         for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				tmp = *(const GLuint*)src_pos;
-				*(GLuint*)dst_pos = (tmp&0xff00ff00) | ((tmp&0x00ff0000)>>16) | ((tmp&0x000000ff)<<16);
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			if (stride)
-				dst_pos += dst_width - src_width;
-        }
-        return true;
-    }
-    if ((src_format == GL_RGB) && (dst_format == GL_RGB) && (dst_type = GL_UNSIGNED_SHORT_5_6_5) && ((src_type == GL_UNSIGNED_BYTE)||(src_type == GL_UNSIGNED_INT_8_8_8_8_REV))) {
-        GLuint tmp;
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				tmp = *(const GLuint*)src_pos;
-				*(GLushort*)dst_pos = ((tmp&0x00f80000)>>(16+3)) | ((tmp&0x0000fc00)>>(8+2-5)) | ((tmp&0x000000f8)<<(11-3));
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			if (stride)
-				dst_pos += dst_width - src_width;
-        }
-        return true;
-    }
-    if ((src_format == GL_BGR) && (dst_format == GL_RGB) && (dst_type = GL_UNSIGNED_SHORT_5_6_5) && ((src_type == GL_UNSIGNED_BYTE)||(src_type == GL_UNSIGNED_INT_8_8_8_8_REV))) {
-        GLuint tmp;
-        for (int i = 0; i < height; i++) {
-			for (int j = 0; j < width; j++) {
-				tmp = *(const GLuint*)src_pos;
-				*(GLushort*)dst_pos = ((tmp&0x00f80000)>>(16+3-11)) | ((tmp&0x0000fc00)>>(8+2-5)) | ((tmp&0x000000f8)>>(3));
-				src_pos += src_stride;
-				dst_pos += dst_stride;
-			}
-			if (stride)
-				dst_pos += dst_width - src_width;
+            convert((const GLubyte *)src_pos, (GLvoid *)dst_pos, width);
+            src_pos += width * src_stride;
+            dst_pos += dst_pitch;
         }
         return true;
     }
@@ -678,6 +798,34 @@ bool pixel_transform(const GLvoid *src, GLvoid **dst,
         *dst = malloc(dst_size);
     uintptr_t src_pos = (uintptr_t)src;
     uintptr_t dst_pos = (uintptr_t)*dst;
+    if (src_type == GL_UNSIGNED_BYTE && src_color->type) {
+        // 8 bit channels: transform through a lookup table per channel
+        GLubyte lut[4][256];
+        const GLint channel[4] = {src_color->red, src_color->green, src_color->blue, src_color->alpha};
+        for (int c = 0; c < 4; c++) {
+            for (int v = 0; v < 256; v++) {
+                GLfloat f = v / 255.0f * scales[c] + bias[c];
+                if (f < 0.0f) f = 0.0f;
+                if (f > 1.0f) f = 1.0f;
+                lut[c][v] = f * 255.0f;
+            }
+        }
+        // same as transform_pixel: a byte shared by several channels
+        // (luminance) gets the value of the last one
+        GLubyte *map[4] = {NULL, NULL, NULL, NULL};
+        for (int c = 0; c < 4; c++)
+            if (channel[c] >= 0)
+                map[channel[c]] = lut[c];
+        const GLubyte *s = (const GLubyte *)src_pos;
+        GLubyte *d = (GLubyte *)dst_pos;
+        for (int i = 0; i < pixels; i++) {
+            for (int k = 0; k < src_stride; k++)
+                d[k] = map[k][s[k]];
+            s += src_stride;
+            d += src_stride;
+        }
+        return true;
+    }
 	if (! transform_pixel((const GLvoid *)src_pos, (GLvoid *)dst_pos,
 					  src_color, src_type, scales, bias)) {
 		// fake convert, to get if it's ok or not
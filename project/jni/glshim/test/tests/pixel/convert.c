@@ -0,0 +1,80 @@
+#include <time.h>
+#include "pixel.h"
+
+#define WIDTH 256
+#define HEIGHT 256
+#define LOOPS 20
+
+static GLubyte src[WIDTH * HEIGHT * 4];
+static GLubyte dst[WIDTH * HEIGHT * 4];
+
+static void bench(const char *name, GLenum src_format, GLenum src_type,
+                  GLenum dst_format, GLenum dst_type) {
+    GLvoid *out = dst;
+    clock_t start = clock();
+    for (int i = 0; i < LOOPS; i++)
+        assert(pixel_convert(src, &out, WIDTH, HEIGHT, src_format, src_type,
+                             dst_format, dst_type, 0));
+    assert(out == dst);
+    double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+    if (secs > 0)
+        printf("%-28s %8.1f Mpixel/s\n", name, WIDTH * HEIGHT * LOOPS / secs / 1e6);
+    else
+        printf("%-28s too fast to measure\n", name);
+}
+
+static void convert(const GLvoid *pixels, GLenum src_format, GLenum src_type,
+                    GLenum dst_format, GLenum dst_type) {
+    GLvoid *out = dst;
+    memset(dst, 0xcc, sizeof(dst));
+    assert(pixel_convert(pixels, &out, 2, 1, src_format, src_type,
+                         dst_format, dst_type, 0));
+}
+
+int main() {
+    // check a couple of pixels through the specialized converters
+    GLubyte bgra[] = {0x10, 0x20, 0x30, 0x40, 0xff, 0x80, 0x00, 0x7f};
+    convert(bgra, GL_BGRA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE);
+    assert(memcmp(dst, (GLubyte[]){0x30, 0x20, 0x10, 0x40, 0x00, 0x80, 0xff, 0x7f}, 8) == 0);
+
+    GLubyte rgb[] = {0xff, 0x80, 0x08, 0x00, 0xfc, 0xff};
+    convert(rgb, GL_RGB, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE);
+    assert(memcmp(dst, (GLubyte[]){0xff, 0x80, 0x08, 0xff, 0x00, 0xfc, 0xff, 0xff}, 8) == 0);
+    convert(rgb, GL_RGB, GL_UNSIGNED_BYTE, GL_RGB, GL_UNSIGNED_SHORT_5_6_5);
+    assert(((GLushort *)dst)[0] == 0xfc01 && ((GLushort *)dst)[1] == 0x07ff);
+
+    GLubyte lum[] = {0x12, 0xfe};
+    convert(lum, GL_LUMINANCE, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE);
+    assert(memcmp(dst, (GLubyte[]){0x12, 0x12, 0x12, 0xff, 0xfe, 0xfe, 0xfe, 0xff}, 8) == 0);
+
+    GLubyte rgba[] = {0xff, 0x80, 0x08, 0x7f, 0x00, 0xf0, 0x1f, 0xff};
+    convert(rgba, GL_RGBA, GL_UNSIGNED_BYTE, GL_RGB, GL_UNSIGNED_SHORT_5_6_5);
+    assert(((GLushort *)dst)[0] == 0xfc01 && ((GLushort *)dst)[1] == 0x0783);
+    convert(rgba, GL_RGBA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4);
+    assert(((GLushort *)dst)[0] == 0xf807 && ((GLushort *)dst)[1] == 0x0f1f);
+
+    GLushort rgb565[] = {0xf800, 0x07ff};
+    convert(rgb565, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, GL_RGBA, GL_UNSIGNED_BYTE);
+    assert(memcmp(dst, (GLubyte[]){0xff, 0x00, 0x00, 0xff, 0x00, 0xff, 0xff, 0xff}, 8) == 0);
+
+    // stride is the width of the destination rows in pixels
+    GLvoid *out = dst;
+    memset(dst, 0xcc, sizeof(dst));
+    assert(pixel_convert(lum, &out, 1, 2, GL_LUMINANCE, GL_UNSIGNED_BYTE,
+                         GL_RGBA, GL_UNSIGNED_BYTE, 2));
+    assert(memcmp(dst, (GLubyte[]){0x12, 0x12, 0x12, 0xff, 0xcc, 0xcc, 0xcc, 0xcc,
+                                   0xfe, 0xfe, 0xfe, 0xff}, 12) == 0);
+
+    // and how fast they are, compared to the generic path
+    for (int i = 0; i < sizeof(src); i++)
+        src[i] = i * 7;
+    bench("BGRA8 -> RGBA8", GL_BGRA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE);
+    bench("RGB8 -> RGBA8", GL_RGB, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE);
+    bench("L8 -> RGBA8", GL_LUMINANCE, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_BYTE);
+    bench("RGBA8 -> RGB565", GL_RGBA, GL_UNSIGNED_BYTE, GL_RGB, GL_UNSIGNED_SHORT_5_6_5);
+    bench("RGBA8 -> RGBA4444", GL_RGBA, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4);
+    bench("RGB565 -> RGBA8", GL_RGB, GL_UNSIGNED_SHORT_5_6_5, GL_RGBA, GL_UNSIGNED_BYTE);
+    bench("BGR8 -> RGBA4444 (generic)", GL_BGR, GL_UNSIGNED_BYTE, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4);
+    bench("RGBA8 -> BGRA4444 (generic)", GL_RGBA, GL_UNSIGNED_BYTE, GL_BGRA, GL_UNSIGNED_SHORT_4_4_4_4);
+    mock_return;
+}
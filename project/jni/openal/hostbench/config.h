@@ -0,0 +1,6 @@
+/* Host build configuration: the Android one, without the Android backend,
+   so the null backend is the default device */
+
+#include "../src/config.h"
+
+#undef HAVE_ANDROID
@@ -0,0 +1,127 @@
+/*
+    Mixer benchmark of the host build: plays a scene of looping sources on
+    the null backend and times aluMixData() on them, without a device.
+
+    Usage: mixbench [-sources N] [-seconds S] [-o FILE]
+      -sources N   number of sources, default runs 64 and then 128
+      -seconds S   length of audio to mix, default 10
+      -o FILE      write the mixed 16-bit stereo output to FILE, to compare
+                   the output of two builds with cmp
+
+    The scene is what a 3D game plays: mono sources at 22050 and 44100 Hz
+    around the listener, a quarter of them beyond the maximum distance of
+    the linear distance model and so inaudible, and every eighth source a
+    stereo one. The listener turns a little on every update, so the source
+    parameters are recalculated and the gains ramp. Pick the resampler with
+    a config file in ALSOFT_CONF, "resampler = 0" is point, 1 linear, 2 cosine.
+
+    The null backend mixes from its mixer thread, see ringbench.c; the benchmark
+    stops that thread as soon as the device plays, so it mixes nothing and
+    the output is the same on every run.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "config.h"
+#include "alMain.h"
+#include "AL/al.h"
+#include "AL/alc.h"
+#include "scene.h"
+
+#define UPDATE_SIZE 1024
+#define FREQUENCY 44100
+
+static double now(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void run(int count, double seconds, FILE *out)
+{
+	static ALshort output[UPDATE_SIZE * 2];
+	ALCint attrs[] = { ALC_FREQUENCY, FREQUENCY, 0 };
+	ALCdevice *device;
+	ALCcontext *context;
+	Scene scene;
+	int updates = (int)(seconds * FREQUENCY / UPDATE_SIZE), i;
+	double start, elapsed;
+
+	device = alcOpenDevice(NULL);
+	if( !device )
+	{
+		fprintf(stderr, "mixbench: cannot open the null device\n");
+		exit(1);
+	}
+	context = alcCreateContext(device, attrs);
+	alcMakeContextCurrent(context);
+
+	/* Stop the mixer thread of the backend before the sources start, or it
+	   mixes a few updates of some of them, and clears the dry buffer of the
+	   device in the middle of ours */
+	StopMixerThread(device->Mixer);
+	createScene(&scene, count);
+
+	start = now();
+	for( i = 0; i < updates; i++ )
+	{
+		turnListener(i);
+		aluMixData(device, output, UPDATE_SIZE);
+		if( out )
+			fwrite(output, sizeof(output), 1, out);
+	}
+	elapsed = now() - start;
+
+	printf("mixbench: sources=%d seconds=%.1f mix_ms=%.1f update_us=%.1f cpu=%.1f%%\n",
+		count, updates * (double)UPDATE_SIZE / FREQUENCY, elapsed * 1000.0,
+		elapsed * 1000000.0 / updates, elapsed * 100.0 * FREQUENCY / ((double)updates * UPDATE_SIZE));
+
+	deleteScene(&scene);
+	alcMakeContextCurrent(NULL);
+	alcDestroyContext(context);
+	alcCloseDevice(device);
+}
+
+int main(int argc, char *argv[])
+{
+	int count = 0, i;
+	double seconds = 10;
+	FILE *out = NULL;
+
+	for( i = 1; i < argc; i++ )
+	{
+		if( !strcmp(argv[i], "-sources") && i + 1 < argc )
+			count = atoi(argv[++i]);
+		else if( !strcmp(argv[i], "-seconds") && i + 1 < argc )
+			seconds = atof(argv[++i]);
+		else if( !strcmp(argv[i], "-o") && i + 1 < argc )
+		{
+			out = fopen(argv[++i], "wb");
+			if( !out )
+			{
+				perror(argv[i]);
+				return 1;
+			}
+		}
+		else
+		{
+			fprintf(stderr, "Usage: mixbench [-sources N] [-seconds S] [-o FILE]\n");
+			return 1;
+		}
+	}
+
+	if( count > 0 )
+		run(count, seconds, out);
+	else
+	{
+		run(64, seconds, out);
+		run(128, seconds, out);
+	}
+	if( out )
+		fclose(out);
+	return 0;
+}
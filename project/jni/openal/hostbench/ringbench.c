@@ -0,0 +1,100 @@
+/*
+    Mixer thread benchmark of the host build: plays the scene of mixbench.c
+    on the null backend in real time, the way a device does, and prints the
+    stats of the ring of periods between the mixer thread and the writer.
+
+    Usage: ringbench [-sources N] [-seconds S] [-stall MS]
+      -sources N   number of sources, default 32
+      -seconds S   how long to play, default 5
+      -stall MS    hold the device lock for MS milliseconds once a second,
+                   like a game that uploads a large buffer, default 0
+
+    The period size and count come from the config file in ALSOFT_CONF,
+    "period_size" and "periods", as the [android] block does on the device.
+    A stall longer than the ring shows up as underruns, e.g.:
+
+      for p in 2 4 8; do
+        printf "period_size = 1024\nperiods = $p\n" > /tmp/ring.conf
+        ALSOFT_CONF=/tmp/ring.conf ./ringbench -stall 100
+      done
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "alMain.h"
+#include "AL/al.h"
+#include "AL/alc.h"
+#include "scene.h"
+
+int main(int argc, char *argv[])
+{
+	ALCdevice *device;
+	ALCcontext *context;
+	Scene scene;
+	MixerStats stats;
+	int count = 32, stall = 0, i;
+	double seconds = 5;
+
+	for( i = 1; i < argc; i++ )
+	{
+		if( !strcmp(argv[i], "-sources") && i + 1 < argc )
+			count = atoi(argv[++i]);
+		else if( !strcmp(argv[i], "-seconds") && i + 1 < argc )
+			seconds = atof(argv[++i]);
+		else if( !strcmp(argv[i], "-stall") && i + 1 < argc )
+			stall = atoi(argv[++i]);
+		else
+		{
+			fprintf(stderr, "Usage: ringbench [-sources N] [-seconds S] [-stall MS]\n");
+			return 1;
+		}
+	}
+
+	device = alcOpenDevice(NULL);
+	if( !device )
+	{
+		fprintf(stderr, "ringbench: cannot open the null device\n");
+		return 1;
+	}
+	context = alcCreateContext(device, NULL);
+	alcMakeContextCurrent(context);
+	if( !device->Mixer )
+	{
+		fprintf(stderr, "ringbench: the backend does not mix from a mixer thread\n");
+		return 1;
+	}
+
+	createScene(&scene, count);
+
+	/* Turn the listener every 10 ms, as a game does every frame */
+	for( i = 0; i < (int)(seconds * 100); i++ )
+	{
+		turnListener(i);
+		if( stall > 0 && i % 100 == 99 )
+		{
+			SuspendContext(NULL);
+			usleep(stall * 1000);
+			ProcessContext(NULL);
+		}
+		else
+			usleep(10000);
+	}
+
+	GetMixerStats(device->Mixer, &stats);
+	printf("ringbench: sources=%d period=%u periods=%u stall_ms=%d underruns=%u "
+		"latency_ms=%.1f max_latency_ms=%.1f mix_us=%.1f max_mix_us=%u cpu=%.1f%%\n",
+		count, device->UpdateSize, device->NumUpdates, stall, stats.Underruns,
+		stats.Latency * 1000.0 / device->Frequency, stats.MaxLatency * 1000.0 / device->Frequency,
+		stats.PeriodsMixed ? (double)stats.MixTime / stats.PeriodsMixed : 0.0, stats.MaxMixTime,
+		stats.PeriodsMixed ? stats.MixTime * 100.0 * device->Frequency / (stats.PeriodsMixed * (double)device->UpdateSize * 1000000.0) : 0.0);
+
+	deleteScene(&scene);
+	alcMakeContextCurrent(NULL);
+	alcDestroyContext(context);
+	alcCloseDevice(device);
+	return 0;
+}
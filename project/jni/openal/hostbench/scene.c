@@ -0,0 +1,79 @@
+/*
+    The scene the host benchmarks play, see mixbench.c for what it is.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "scene.h"
+
+static ALuint makeBuffer(int channels, int freq)
+{
+	static unsigned int seed = 1;
+	int frames = freq, i;
+	ALshort *data = (ALshort *) malloc(frames * channels * sizeof(ALshort));
+	ALuint buffer;
+
+	/* A tone with some noise on it, so no resampler gets an easy signal */
+	for( i = 0; i < frames * channels; i++ )
+	{
+		seed = seed * 1103515245 + 12345;
+		data[i] = (ALshort)(sin(i * 2 * M_PI * 441 / freq / channels) * 12000 + (int)((seed >> 16) & 0x1FFF) - 0x1000);
+	}
+	alGenBuffers(1, &buffer);
+	alBufferData(buffer, channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16, data,
+		frames * channels * sizeof(ALshort), freq);
+	free(data);
+	return buffer;
+}
+
+void createScene(Scene *scene, int count)
+{
+	int i;
+
+	scene->count = count;
+	scene->buffers[0] = makeBuffer(1, 22050);
+	scene->buffers[1] = makeBuffer(1, 44100);
+	scene->buffers[2] = makeBuffer(2, 44100);
+
+	alDistanceModel(AL_LINEAR_DISTANCE_CLAMPED);
+	scene->sources = (ALuint *) malloc(count * sizeof(ALuint));
+	alGenSources(count, scene->sources);
+	for( i = 0; i < count; i++ )
+	{
+		ALuint source = scene->sources[i];
+		float angle = i * 2.39996f, distance = (i % 4 == 0) ? 80.0f : 2.0f + (i * 7 % 48);
+
+		alSourcei(source, AL_LOOPING, AL_TRUE);
+		alSourcef(source, AL_GAIN, 0.03f);
+		alSourcef(source, AL_REFERENCE_DISTANCE, 1.0f);
+		alSourcef(source, AL_MAX_DISTANCE, 60.0f);
+		if( i % 8 == 7 )
+			alSourcei(source, AL_BUFFER, scene->buffers[2]);
+		else
+		{
+			alSourcei(source, AL_BUFFER, scene->buffers[i % 2]);
+			alSource3f(source, AL_POSITION, cos(angle) * distance, 0.0f, sin(angle) * distance);
+		}
+		alSourcePlay(source);
+	}
+	if( alGetError() != AL_NO_ERROR )
+		fprintf(stderr, "scene: OpenAL error while setting up the scene\n");
+}
+
+void deleteScene(Scene *scene)
+{
+	alDeleteSources(scene->count, scene->sources);
+	alDeleteBuffers(3, scene->buffers);
+	free(scene->sources);
+	scene->sources = NULL;
+}
+
+void turnListener(int update)
+{
+	float angle = update * 0.01f;
+	ALfloat orientation[6] = { sin(angle), 0.0f, -cos(angle), 0.0f, 1.0f, 0.0f };
+
+	alListenerfv(AL_ORIENTATION, orientation);
+}
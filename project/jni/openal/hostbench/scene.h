@@ -0,0 +1,24 @@
+/*
+    The scene the host benchmarks play: looping 3D sources around the
+    listener, see mixbench.c.
+*/
+
+#ifndef _HOSTBENCH_SCENE_H_
+#define _HOSTBENCH_SCENE_H_
+
+#include "AL/al.h"
+
+typedef struct
+{
+	int count;
+	ALuint *sources;
+	ALuint buffers[3];
+} Scene;
+
+/* Creates and starts count sources in the current context */
+void createScene(Scene *scene, int count);
+void deleteScene(Scene *scene);
+/* Turns the listener a little, so the source parameters are recalculated */
+void turnListener(int update);
+
+#endif
@@ -37,6 +37,12 @@
 #include "alu.h"
 #include "bs2b.h"
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
 #define FRACTIONBITS 14
 #define FRACTIONMASK ((1L<<FRACTIONBITS)-1)
 #define MAX_PITCH 65536
@@ -45,6 +51,10 @@
  * adequately reduce clicks and pops from harsh gain changes. */
 #define MIN_RAMP_LENGTH  16
 
+/* Gains below this (-100dB) are inaudible even in a 24-bit output, so
+ * paths of a source whose gain stays below it are not mixed. */
+#define GAIN_SILENCE_THRESHOLD  0.00001f
+
 
 static __inline ALfloat aluF2F(ALfloat Value)
 {
@@ -911,6 +921,186 @@ static __inline ALfloat cos_lerp(ALfloat val1, ALfloat val2, ALint frac)
     return val1 + ((val2-val1)*mult);
 }
 
+/* Resamples channel Chan of the interleaved Data into Out, stepping the
+ * position the same way the DO_MIX loops do. Mono data played at the
+ * device rate needs no resampling, and is returned in place. */
+static const ALfloat *DoResample(resampler_t Resampler, const ALfloat *Data,
+                                 ALuint Channels, ALuint Chan, ALuint DataPosFrac,
+                                 ALint increment, ALuint BufferSize, ALfloat *Out)
+{
+    ALuint pos = 0, frac = DataPosFrac;
+    ALuint i;
+
+    if(Channels == 1 && increment == (1<<FRACTIONBITS) &&
+       (DataPosFrac == 0 || Resampler == POINT_RESAMPLER))
+        return Data;
+
+#define DO_RESAMPLE(resampler) do {                                           \
+    for(i = 0;i < BufferSize;i++)                                             \
+    {                                                                         \
+        Out[i] = (resampler)(Data[pos*Channels + Chan],                       \
+                             Data[(pos+1)*Channels + Chan], frac);            \
+        frac += increment;                                                    \
+        pos += frac>>FRACTIONBITS;                                            \
+        frac &= FRACTIONMASK;                                                 \
+    }                                                                         \
+} while(0)
+
+    switch(Resampler)
+    {
+        case POINT_RESAMPLER:
+        DO_RESAMPLE(point); break;
+        case LINEAR_RESAMPLER:
+        DO_RESAMPLE(lerp); break;
+        case COSINE_RESAMPLER:
+        DO_RESAMPLE(cos_lerp); break;
+        case RESAMPLER_MIN:
+        case RESAMPLER_MAX:
+        memset(Out, 0, BufferSize*sizeof(ALfloat));
+        break;
+    }
+#undef DO_RESAMPLE
+    return Out;
+}
+
+/* Runs Samples through Poles chained one-pole low-pass filters, starting at
+ * history[Offset]. At coefficient 0 the filters pass the signal unchanged,
+ * so only their history is updated. */
+static const ALfloat *DoLowPass(FILTER *iir, ALuint Offset, ALuint Poles,
+                                const ALfloat *Samples, ALuint BufferSize,
+                                ALfloat *Out)
+{
+    ALuint i;
+
+    if(iir->coeff == 0.0f)
+    {
+        for(i = 0;i < Poles;i++)
+            iir->history[Offset+i] = Samples[BufferSize-1];
+        return Samples;
+    }
+
+    switch(Poles)
+    {
+        case 4:
+            for(i = 0;i < BufferSize;i++)
+                Out[i] = lpFilter4P(iir, Offset, Samples[i]);
+            break;
+        case 2:
+            for(i = 0;i < BufferSize;i++)
+                Out[i] = lpFilter2P(iir, Offset, Samples[i]);
+            break;
+        default:
+            for(i = 0;i < BufferSize;i++)
+                Out[i] = lpFilter1P(iir, Offset, Samples[i]);
+            break;
+    }
+    return Out;
+}
+
+/* Adds mono Samples to every output channel of DryBuffer, stepping each
+ * gain before every sample like the DO_MIX loops do. The first eight
+ * channels of a DryBuffer row are mixed four at a time. */
+static void MixDryMono(float (*DryBuffer)[OUTPUTCHANNELS], const ALfloat *Samples,
+                       ALuint BufferSize, ALfloat *Gains, const ALfloat *Steps)
+{
+    ALuint i, c;
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    float32x4_t gain0 = vld1q_f32(&Gains[0]), gain1 = vld1q_f32(&Gains[4]);
+    float32x4_t step0 = vld1q_f32(&Steps[0]), step1 = vld1q_f32(&Steps[4]);
+
+    for(i = 0;i < BufferSize;i++)
+    {
+        float32x4_t value = vdupq_n_f32(Samples[i]);
+        float *out = DryBuffer[i];
+
+        gain0 = vaddq_f32(gain0, step0);
+        gain1 = vaddq_f32(gain1, step1);
+        vst1q_f32(&out[0], vaddq_f32(vld1q_f32(&out[0]), vmulq_f32(value, gain0)));
+        vst1q_f32(&out[4], vaddq_f32(vld1q_f32(&out[4]), vmulq_f32(value, gain1)));
+    }
+    vst1q_f32(&Gains[0], gain0);
+    vst1q_f32(&Gains[4], gain1);
+    c = 8;
+#elif defined(__SSE__)
+    __m128 gain0 = _mm_loadu_ps(&Gains[0]), gain1 = _mm_loadu_ps(&Gains[4]);
+    __m128 step0 = _mm_loadu_ps(&Steps[0]), step1 = _mm_loadu_ps(&Steps[4]);
+
+    for(i = 0;i < BufferSize;i++)
+    {
+        __m128 value = _mm_set1_ps(Samples[i]);
+        float *out = DryBuffer[i];
+
+        gain0 = _mm_add_ps(gain0, step0);
+        gain1 = _mm_add_ps(gain1, step1);
+        _mm_storeu_ps(&out[0], _mm_add_ps(_mm_loadu_ps(&out[0]), _mm_mul_ps(value, gain0)));
+        _mm_storeu_ps(&out[4], _mm_add_ps(_mm_loadu_ps(&out[4]), _mm_mul_ps(value, gain1)));
+    }
+    _mm_storeu_ps(&Gains[0], gain0);
+    _mm_storeu_ps(&Gains[4], gain1);
+    c = 8;
+#else
+    c = 0;
+#endif
+
+    for(;c < OUTPUTCHANNELS;c++)
+    {
+        ALfloat gain = Gains[c];
+        for(i = 0;i < BufferSize;i++)
+        {
+            gain += Steps[c];
+            DryBuffer[i][c] += Samples[i]*gain;
+        }
+        Gains[c] = gain;
+    }
+}
+
+/* Adds Samples to output channel Chan of DryBuffer, stepping the gain */
+static void MixDryChannel(float (*DryBuffer)[OUTPUTCHANNELS], ALuint Chan,
+                          const ALfloat *Samples, ALuint BufferSize,
+                          ALfloat *Gain, ALfloat Step)
+{
+    ALfloat gain = *Gain;
+    ALuint i;
+
+    for(i = 0;i < BufferSize;i++)
+    {
+        gain += Step;
+        DryBuffer[i][Chan] += Samples[i]*gain;
+    }
+    *Gain = gain;
+}
+
+/* Filters Samples for an auxiliary send and adds them to its WetBuffer,
+ * stepping the gain */
+static void MixSend(ALfloat *WetBuffer, FILTER *iir, ALuint Offset, ALuint Poles,
+                    const ALfloat *Samples, ALuint BufferSize, ALfloat *Gain,
+                    ALfloat Step, ALfloat Scale, ALfloat *Scratch)
+{
+    const ALfloat *Filtered;
+    ALfloat gain = *Gain;
+    ALuint i;
+
+    Filtered = DoLowPass(iir, Offset, Poles, Samples, BufferSize, Scratch);
+    for(i = 0;i < BufferSize;i++)
+    {
+        gain += Step;
+        WetBuffer[i] += Filtered[i]*gain*Scale;
+    }
+    *Gain = gain;
+}
+
+/* Returns how many whole samples the position moves in BufferSize output
+ * samples, and leaves the fraction in DataPosFrac */
+static __inline ALuint AdvancePosition(ALuint *DataPosFrac, ALint increment,
+                                       ALuint BufferSize)
+{
+    ALuint64 pos = (ALuint64)increment*BufferSize + *DataPosFrac;
+
+    *DataPosFrac = (ALuint)(pos&FRACTIONMASK);
+    return (ALuint)(pos>>FRACTIONBITS);
+}
+
 static void MixSomeSources(ALCcontext *ALContext, float (*DryBuffer)[OUTPUTCHANNELS], ALuint SamplesToDo)
 {
     static float DummyBuffer[BUFFERSIZE];
@@ -938,9 +1128,14 @@ static void MixSomeSources(ALCcontext *ALContext, float (*DryBuffer)[OUTPUTCHANN
     ALfloat Pitch;
     ALenum State;
     ALsizei pos;
+    ALboolean Silent, DrySilent;
+    ALboolean WetSilent[MAX_SENDS];
+    ALfloat *ResampledData, *FilteredData;
 
     DuplicateStereo = ALContext->Device->DuplicateStereo;
     DeviceFreq = ALContext->Device->Frequency;
+    ResampledData = ALContext->Device->ResampledData;
+    FilteredData = ALContext->Device->FilteredData;
 
     rampLength = DeviceFreq * MIN_RAMP_LENGTH / 1000;
     rampLength = max(rampLength, SamplesToDo);
@@ -1027,6 +1222,26 @@ next_source:
                         DummyBuffer);
     }
 
+    /* Paths whose gain stays inaudible for this update are not mixed, and
+     * sends without an effect slot only go to DummyBuffer. A source with
+     * no path left only has its position advanced. */
+    DrySilent = AL_TRUE;
+    for(i = 0;i < OUTPUTCHANNELS;i++)
+    {
+        if(aluFabs(DrySend[i]) > GAIN_SILENCE_THRESHOLD ||
+           aluFabs(ALSource->Params.DryGains[i]) > GAIN_SILENCE_THRESHOLD)
+            DrySilent = AL_FALSE;
+    }
+    Silent = DrySilent;
+    for(i = 0;i < MAX_SENDS;i++)
+    {
+        WetSilent[i] = (!ALSource->Send[i].Slot ||
+                        (aluFabs(WetSend[i]) <= GAIN_SILENCE_THRESHOLD &&
+                         aluFabs(ALSource->Params.WetGains[i]) <= GAIN_SILENCE_THRESHOLD));
+        if(!WetSilent[i])
+            Silent = AL_FALSE;
+    }
+
     /* Get current buffer queue item */
     BufferListItem = ALSource->queue;
     for(i = 0;i < BuffersPlayed && BufferListItem;i++)
@@ -1112,57 +1327,49 @@ next_source:
         k = 0;
         Data += DataPosInt*Channels;
 
-        if(Channels == 1) /* Mono */
+        if(Silent)
         {
-#define DO_MIX(resampler) do { \
-    while(BufferSize--) \
-    { \
-        for(i = 0;i < OUTPUTCHANNELS;i++) \
-            DrySend[i] += dryGainStep[i]; \
-        for(i = 0;i < MAX_SENDS;i++) \
-            WetSend[i] += wetGainStep[i]; \
- \
-        /* First order interpolator */ \
-        value = (resampler)(Data[k], Data[k+1], DataPosFrac); \
- \
-        /* Direct path final mix buffer and panning */ \
-        outsamp = lpFilter4P(DryFilter, 0, value); \
-        DryBuffer[j][FRONT_LEFT]   += outsamp*DrySend[FRONT_LEFT]; \
-        DryBuffer[j][FRONT_RIGHT]  += outsamp*DrySend[FRONT_RIGHT]; \
-        DryBuffer[j][SIDE_LEFT]    += outsamp*DrySend[SIDE_LEFT]; \
-        DryBuffer[j][SIDE_RIGHT]   += outsamp*DrySend[SIDE_RIGHT]; \
-        DryBuffer[j][BACK_LEFT]    += outsamp*DrySend[BACK_LEFT]; \
-        DryBuffer[j][BACK_RIGHT]   += outsamp*DrySend[BACK_RIGHT]; \
-        DryBuffer[j][FRONT_CENTER] += outsamp*DrySend[FRONT_CENTER]; \
-        DryBuffer[j][BACK_CENTER]  += outsamp*DrySend[BACK_CENTER]; \
- \
-        /* Room path final mix buffer and panning */ \
-        for(i = 0;i < MAX_SENDS;i++) \
-        { \
-            outsamp = lpFilter2P(WetFilter[i], 0, value); \
-            WetBuffer[i][j] += outsamp*WetSend[i]; \
-        } \
- \
-        DataPosFrac += increment; \
-        k += DataPosFrac>>FRACTIONBITS; \
-        DataPosFrac &= FRACTIONMASK; \
-        j++; \
-    } \
-} while(0)
+            for(i = 0;i < OUTPUTCHANNELS;i++)
+                DrySend[i] += dryGainStep[i]*BufferSize;
+            for(i = 0;i < MAX_SENDS;i++)
+                WetSend[i] += wetGainStep[i]*BufferSize;
+            k += AdvancePosition(&DataPosFrac, increment, BufferSize);
+            j += BufferSize;
+        }
+        else if(Channels == 1) /* Mono */
+        {
+            const ALfloat *Samples, *Filtered;
 
-            switch(Resampler)
+            Samples = DoResample(Resampler, Data, Channels, 0, DataPosFrac,
+                                 increment, BufferSize, ResampledData);
+
+            /* Direct path final mix buffer and panning */
+            if(DrySilent)
             {
-                case POINT_RESAMPLER:
-                DO_MIX(point); break;
-                case LINEAR_RESAMPLER:
-                DO_MIX(lerp); break;
-                case COSINE_RESAMPLER:
-                DO_MIX(cos_lerp); break;
-                case RESAMPLER_MIN:
-                case RESAMPLER_MAX:
-                break;
+                for(i = 0;i < OUTPUTCHANNELS;i++)
+                    DrySend[i] += dryGainStep[i]*BufferSize;
             }
-#undef DO_MIX
+            else
+            {
+                Filtered = DoLowPass(DryFilter, 0, 4, Samples, BufferSize,
+                                     FilteredData);
+                MixDryMono(&DryBuffer[j], Filtered, BufferSize, DrySend,
+                           dryGainStep);
+            }
+
+            /* Room path final mix buffer and panning */
+            for(i = 0;i < MAX_SENDS;i++)
+            {
+                if(WetSilent[i])
+                    WetSend[i] += wetGainStep[i]*BufferSize;
+                else
+                    MixSend(&WetBuffer[i][j], WetFilter[i], 0, 2, Samples,
+                            BufferSize, &WetSend[i], wetGainStep[i], 1.0f,
+                            FilteredData);
+            }
+
+            k += AdvancePosition(&DataPosFrac, increment, BufferSize);
+            j += BufferSize;
         }
         else if(Channels == 2 && DuplicateStereo) /* Stereo */
         {
@@ -1225,6 +1432,60 @@ next_source:
                 FRONT_LEFT, FRONT_RIGHT
             };
             const ALfloat scaler = 1.0f/Channels;
+            ALfloat WetStart[MAX_SENDS];
+            ALboolean Mixed[OUTPUTCHANNELS];
+            const ALfloat *Samples, *Filtered;
+
+            for(i = 0;i < OUTPUTCHANNELS;i++)
+                Mixed[i] = AL_FALSE;
+            for(out = 0;out < MAX_SENDS;out++)
+                WetStart[out] = WetSend[out];
+
+            for(i = 0;i < Channels;i++)
+            {
+                Samples = DoResample(Resampler, Data, Channels, i, DataPosFrac,
+                                     increment, BufferSize, ResampledData);
+                if(!DrySilent)
+                {
+                    Filtered = DoLowPass(DryFilter, chans[i]*2, 2, Samples,
+                                         BufferSize, FilteredData);
+                    MixDryChannel(&DryBuffer[j], chans[i], Filtered, BufferSize,
+                                  &DrySend[chans[i]], dryGainStep[chans[i]]);
+                    Mixed[chans[i]] = AL_TRUE;
+                }
+                /* Both channels ramp the send gains from the same start */
+                for(out = 0;out < MAX_SENDS;out++)
+                {
+                    if(WetSilent[out])
+                        continue;
+                    WetSend[out] = WetStart[out];
+                    MixSend(&WetBuffer[out][j], WetFilter[out], chans[i], 1, Samples,
+                            BufferSize, &WetSend[out], wetGainStep[out], scaler,
+                            FilteredData);
+                }
+            }
+
+            for(i = 0;i < OUTPUTCHANNELS;i++)
+            {
+                if(!Mixed[i])
+                    DrySend[i] += dryGainStep[i]*BufferSize;
+            }
+            for(out = 0;out < MAX_SENDS;out++)
+            {
+                if(WetSilent[out])
+                    WetSend[out] += wetGainStep[out]*BufferSize;
+            }
+
+            k += AdvancePosition(&DataPosFrac, increment, BufferSize);
+            j += BufferSize;
+        }
+        else if(Channels == 4) /* Quad */
+        {
+            const int chans[] = {
+                FRONT_LEFT, FRONT_RIGHT,
+                BACK_LEFT,  BACK_RIGHT
+            };
+            const ALfloat scaler = 1.0f/Channels;
 
 #define DO_MIX(resampler) do {                                                \
     while(BufferSize--)                                                       \
@@ -1267,27 +1528,6 @@ next_source:
                 break;
             }
         }
-        else if(Channels == 4) /* Quad */
-        {
-            const int chans[] = {
-                FRONT_LEFT, FRONT_RIGHT,
-                BACK_LEFT,  BACK_RIGHT
-            };
-            const ALfloat scaler = 1.0f/Channels;
-
-            switch(Resampler)
-            {
-                case POINT_RESAMPLER:
-                DO_MIX(point); break;
-                case LINEAR_RESAMPLER:
-                DO_MIX(lerp); break;
-                case COSINE_RESAMPLER:
-                DO_MIX(cos_lerp); break;
-                case RESAMPLER_MIN:
-                case RESAMPLER_MAX:
-                break;
-            }
-        }
         else if(Channels == 6) /* 5.1 */
         {
             const int chans[] = {
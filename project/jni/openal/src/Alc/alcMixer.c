@@ -0,0 +1,213 @@
+/**
+ * OpenAL cross platform audio library
+ * Copyright (C) 2010 by Chris Robinson
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ *  Boston, MA  02111-1307, USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+/* A mixer thread for the backends whose output call blocks: it mixes the
+ * device a period at a time into a ring of periods, ahead of the backend's
+ * writer, so a slow write or a long mix does not stall the other one. The
+ * ring holds at most `periods` periods, which is the latency the backend
+ * adds on top of its own buffer. */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "alMain.h"
+
+
+struct MixerThread {
+    ALCdevice *device;
+
+    ALubyte *mem;
+    ALuint period_size;
+    ALuint period_bytes;
+    ALuint periods;
+
+    // Positions in periods; the period being read still counts as filled
+    ALuint read_pos;
+    ALuint write_pos;
+    ALuint filled;
+
+    ALboolean started;
+    ALboolean running;
+    volatile ALboolean killNow;
+
+    MixerStats stats;
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t mixed;
+    pthread_cond_t read;
+};
+
+
+static ALuint GetMicroseconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ALuint)((ALuint64)ts.tv_sec*1000000 + ts.tv_nsec/1000);
+}
+
+static void *MixerProc(void *ptr)
+{
+    MixerThread *mixer = (MixerThread*)ptr;
+    ALCdevice *device = mixer->device;
+    ALubyte *period;
+    ALuint start, elapsed;
+
+    SetRTPriority();
+
+    pthread_mutex_lock(&mixer->lock);
+    while(!mixer->killNow && device->Connected)
+    {
+        if(mixer->filled == mixer->periods)
+        {
+            pthread_cond_wait(&mixer->read, &mixer->lock);
+            continue;
+        }
+        period = mixer->mem + mixer->write_pos*mixer->period_bytes;
+        pthread_mutex_unlock(&mixer->lock);
+
+        /* The period is not visible to the reader until it is counted, so
+         * it is mixed without the ring lock */
+        start = GetMicroseconds();
+        aluMixData(device, period, mixer->period_size);
+        elapsed = GetMicroseconds() - start;
+
+        pthread_mutex_lock(&mixer->lock);
+        mixer->stats.PeriodsMixed++;
+        mixer->stats.MixTime += elapsed;
+        mixer->stats.MaxMixTime = max(mixer->stats.MaxMixTime, elapsed);
+
+        mixer->write_pos = (mixer->write_pos+1) % mixer->periods;
+        mixer->filled++;
+        pthread_cond_signal(&mixer->mixed);
+    }
+    /* Wake up a reader waiting for a period that will not come */
+    mixer->killNow = AL_TRUE;
+    pthread_cond_broadcast(&mixer->mixed);
+    pthread_mutex_unlock(&mixer->lock);
+
+    return NULL;
+}
+
+
+MixerThread *StartMixerThread(ALCdevice *device, ALuint period_size, ALuint periods)
+{
+    MixerThread *mixer = calloc(1, sizeof(*mixer));
+    if(!mixer)
+        return NULL;
+
+    mixer->device = device;
+    mixer->period_size = period_size;
+    mixer->period_bytes = period_size * aluFrameSizeFromFormat(device->Format);
+    mixer->periods = max(periods, 1);
+    mixer->mem = malloc(mixer->periods * mixer->period_bytes);
+    if(!mixer->mem)
+    {
+        free(mixer);
+        return NULL;
+    }
+
+    pthread_mutex_init(&mixer->lock, NULL);
+    pthread_cond_init(&mixer->mixed, NULL);
+    pthread_cond_init(&mixer->read, NULL);
+
+    if(pthread_create(&mixer->thread, NULL, MixerProc, mixer) != 0)
+    {
+        AL_PRINT("Could not create the mixer thread\n");
+        DestroyMixerThread(mixer);
+        return NULL;
+    }
+    mixer->running = AL_TRUE;
+
+    return mixer;
+}
+
+void StopMixerThread(MixerThread *mixer)
+{
+    if(!mixer->running)
+        return;
+
+    pthread_mutex_lock(&mixer->lock);
+    mixer->killNow = AL_TRUE;
+    pthread_cond_signal(&mixer->read);
+    pthread_mutex_unlock(&mixer->lock);
+
+    pthread_join(mixer->thread, NULL);
+    mixer->running = AL_FALSE;
+}
+
+void DestroyMixerThread(MixerThread *mixer)
+{
+    if(!mixer)
+        return;
+
+    StopMixerThread(mixer);
+
+    pthread_cond_destroy(&mixer->read);
+    pthread_cond_destroy(&mixer->mixed);
+    pthread_mutex_destroy(&mixer->lock);
+    free(mixer->mem);
+    free(mixer);
+}
+
+const ALubyte *ReadMixerPeriod(MixerThread *mixer)
+{
+    const ALubyte *period = NULL;
+
+    pthread_mutex_lock(&mixer->lock);
+    /* Before the first period, the ring is empty because it was just
+     * started; afterwards, it means the mixer fell behind the output */
+    if(mixer->filled == 0 && mixer->started && !mixer->killNow)
+        mixer->stats.Underruns++;
+    while(mixer->filled == 0 && !mixer->killNow)
+        pthread_cond_wait(&mixer->mixed, &mixer->lock);
+
+    if(mixer->filled > 0 && !mixer->killNow)
+    {
+        mixer->started = AL_TRUE;
+        mixer->stats.Latency = mixer->filled * mixer->period_size;
+        mixer->stats.MaxLatency = max(mixer->stats.MaxLatency, mixer->stats.Latency);
+        period = mixer->mem + mixer->read_pos*mixer->period_bytes;
+    }
+    pthread_mutex_unlock(&mixer->lock);
+
+    return period;
+}
+
+void ReleaseMixerPeriod(MixerThread *mixer)
+{
+    pthread_mutex_lock(&mixer->lock);
+    mixer->read_pos = (mixer->read_pos+1) % mixer->periods;
+    mixer->filled--;
+    mixer->stats.PeriodsRead++;
+    pthread_cond_signal(&mixer->read);
+    pthread_mutex_unlock(&mixer->lock);
+}
+
+void GetMixerStats(MixerThread *mixer, MixerStats *stats)
+{
+    pthread_mutex_lock(&mixer->lock);
+    *stats = mixer->stats;
+    pthread_mutex_unlock(&mixer->lock);
+}
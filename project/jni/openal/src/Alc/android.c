@@ -34,9 +34,11 @@ extern int SDL_ANDROID_SetOpenALPutToBackgroundCallback(
 		SDL_ANDROID_ApplicationPutToBackgroundCallback_t PutToBackground,
 		SDL_ANDROID_ApplicationPutToBackgroundCallback_t Restored );
 
-static int doPause=0;
-int resumeHandled;
-int pauseHandled;
+/* Pause and resume come from the SDL thread, for every device; the writer
+ * thread sleeps on pauseCond while paused, instead of polling doPause */
+static pthread_mutex_t pauseLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pauseCond = PTHREAD_COND_INITIALIZER;
+static int doPause = 0;
 
 static const ALCchar android_device[] = "Android Default";
 
@@ -69,6 +71,10 @@ typedef struct
 {
     pthread_t thread;
     volatile int running;
+
+    MixerThread* mixer;
+    ALuint periodSize;
+    ALuint periods;
 } AndroidData;
 
 #define STREAM_MUSIC 3
@@ -78,10 +84,41 @@ typedef struct
 #define ENCODING_PCM_16BIT 2
 #define MODE_STREAM 1
 
+/* Waits out a pause, with the track paused; returns 0 if the device was
+ * stopped meanwhile */
+static int wait_for_resume(JNIEnv* env, jobject track, AndroidData* data)
+{
+    int paused = 0;
+
+    pthread_mutex_lock(&pauseLock);
+    while (doPause && data->running)
+    {
+        if (!paused)
+        {
+            pthread_mutex_unlock(&pauseLock);
+            (*env)->CallNonvirtualVoidMethod(env, track, cAudioTrack, mPause);
+            pthread_mutex_lock(&pauseLock);
+            paused = 1;
+            continue;
+        }
+        pthread_cond_wait(&pauseCond, &pauseLock);
+    }
+    pthread_mutex_unlock(&pauseLock);
+
+    if (paused && data->running)
+        (*env)->CallNonvirtualVoidMethod(env, track, cAudioTrack, mPlay);
+    return data->running;
+}
+
+/* Writes the periods of the mixer thread to the AudioTrack. The mixer keeps
+ * up to data->periods periods ahead of the track, so a write that blocks
+ * longer than usual does not starve it, and the mix no longer runs inside
+ * GetPrimitiveArrayCritical. */
 static void* thread_function(void* arg)
 {
     ALCdevice* device = (ALCdevice*)arg;
     AndroidData* data = (AndroidData*)device->ExtraData;
+    MixerStats stats;
 
     JNIEnv* env;
     (*javaVM)->AttachCurrentThread(javaVM, &env, NULL);
@@ -95,47 +132,32 @@ static void* thread_function(void* arg)
     int bufferSizeInBytes = (*env)->CallStaticIntMethod(env, cAudioTrack, 
         mGetMinBufferSize, sampleRateInHz, channelConfig, audioFormat);
 
-    int bufferSizeInSamples = bufferSizeInBytes / aluFrameSizeFromFormat(device->Format);
+    int periodSizeInBytes = data->periodSize * aluFrameSizeFromFormat(device->Format);
+
+    /* The track buffer only needs to take a period; the ring holds the rest */
+    if (bufferSizeInBytes < periodSizeInBytes)
+        bufferSizeInBytes = periodSizeInBytes;
 
     jobject track = (*env)->NewObject(env, cAudioTrack, mAudioTrack,
-        STREAM_MUSIC, sampleRateInHz, channelConfig, audioFormat, device->NumUpdates * bufferSizeInBytes, MODE_STREAM);
+        STREAM_MUSIC, sampleRateInHz, channelConfig, audioFormat, bufferSizeInBytes, MODE_STREAM);
 
-	//(*env)->CallNonvirtualVoidMethod(env, track, cAudioTrack, mPlay);
+	jarray buffer = (*env)->NewByteArray(env, periodSizeInBytes);
 
-	jarray buffer = (*env)->NewByteArray(env, bufferSizeInBytes);
+	(*env)->CallNonvirtualVoidMethod(env, track, cAudioTrack, mPlay);
 
-	pauseHandled=0;
-	resumeHandled=0;
 	while (data->running)
 	{
-		if(doPause && !pauseHandled)
-		{
-			(*env)->CallNonvirtualVoidMethod(env, track, cAudioTrack, mPause);
-			pauseHandled=1;
-			while(doPause)
-			{
-				usleep(500000);
-			}
-		}
-		if(!doPause && !resumeHandled)
-		{
-			(*env)->CallNonvirtualVoidMethod(env, track, cAudioTrack, mPlay);
-			resumeHandled=1;
-		}
-		
-		void* pBuffer = (*env)->GetPrimitiveArrayCritical(env, buffer, NULL);
-
-		if (pBuffer)
-		{
-			aluMixData(device, pBuffer, bufferSizeInSamples);
-			(*env)->ReleasePrimitiveArrayCritical(env, buffer, pBuffer, 0);
-
-			(*env)->CallNonvirtualIntMethod(env, track, cAudioTrack, mWrite, buffer, 0, bufferSizeInBytes);
-		}
-		else
-		{
-			AL_PRINT("Failed to get pointer to array bytes");
-		}
+		if (doPause && !wait_for_resume(env, track, data))
+			break;
+
+		const ALubyte* period = ReadMixerPeriod(data->mixer);
+		if (!period)
+			break;
+
+		(*env)->SetByteArrayRegion(env, buffer, 0, periodSizeInBytes, (const jbyte*)period);
+		ReleaseMixerPeriod(data->mixer);
+
+		(*env)->CallNonvirtualIntMethod(env, track, cAudioTrack, mWrite, buffer, 0, periodSizeInBytes);
 	}
 	
 	(*env)->CallNonvirtualVoidMethod(env, track, cAudioTrack, mStop);
@@ -144,6 +166,14 @@ static void* thread_function(void* arg)
     (*env)->PopLocalFrame(env, NULL);
 
     (*javaVM)->DetachCurrentThread(javaVM);
+
+    /* Tells how the period size and count of this device work out */
+    GetMixerStats(data->mixer, &stats);
+    ALuint64 mixedTime = (ALuint64)stats.PeriodsMixed * data->periodSize * 1000000 / device->Frequency;
+    AL_PRINT("Audio stopped: %u underruns in %u periods, latency %u ms, max %u ms, mixing took %u%% of the time\n",
+             stats.Underruns, stats.PeriodsRead,
+             stats.Latency * 1000 / device->Frequency, stats.MaxLatency * 1000 / device->Frequency,
+             mixedTime ? (ALuint)(stats.MixTime * 100 / mixedTime) : 0);
     return NULL;
 }
 
@@ -218,8 +248,27 @@ static ALCboolean android_reset_playback(ALCdevice *device)
 
     SetDefaultChannelOrder(device);
 
+    /* Fewer or shorter periods lower the latency, more or longer ones
+     * lower the chance of an underrun when a frame takes long */
+    int periodSize = GetConfigValueInt("android", "period_size", device->UpdateSize);
+    int periods = GetConfigValueInt("android", "periods", device->NumUpdates);
+    data->periodSize = periodSize > 0 ? periodSize : device->UpdateSize;
+    data->periods = periods >= 2 ? periods : 2;
+
+    data->mixer = StartMixerThread(device, data->periodSize, data->periods);
+    if (!data->mixer)
+        return ALC_FALSE;
+    device->Mixer = data->mixer;
+
     data->running = 1;
-    pthread_create(&data->thread, NULL, thread_function, device);
+    if (pthread_create(&data->thread, NULL, thread_function, device) != 0)
+    {
+        data->running = 0;
+        device->Mixer = NULL;
+        DestroyMixerThread(data->mixer);
+        data->mixer = NULL;
+        return ALC_FALSE;
+    }
 
     return ALC_TRUE;
 }
@@ -230,8 +279,18 @@ static void android_stop_playback(ALCdevice *device)
 
     if (data->running)
     {
+        pthread_mutex_lock(&pauseLock);
         data->running = 0;
+        pthread_cond_broadcast(&pauseCond);
+        pthread_mutex_unlock(&pauseLock);
+
+        /* Wakes up the writer if it waits for a period */
+        StopMixerThread(data->mixer);
         pthread_join(data->thread, NULL);
+
+        device->Mixer = NULL;
+        DestroyMixerThread(data->mixer);
+        data->mixer = NULL;
     }
 }
 
@@ -310,13 +369,16 @@ void alc_android_probe(int type)
 }
 AL_API void AL_APIENTRY al_android_pause_playback()
 {
+	pthread_mutex_lock(&pauseLock);
 	doPause=1;
-	pauseHandled=0;
+	pthread_mutex_unlock(&pauseLock);
 	AL_PRINT("Audio paused.");
 }
 AL_API void AL_APIENTRY al_android_resume_playback()
 {
+	pthread_mutex_lock(&pauseLock);
 	doPause=0;
-	resumeHandled=0;
+	pthread_cond_broadcast(&pauseCond);
+	pthread_mutex_unlock(&pauseLock);
 	AL_PRINT("Audio resumed.");
 }
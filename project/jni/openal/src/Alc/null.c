@@ -27,8 +27,7 @@
 
 
 typedef struct {
-    ALvoid *buffer;
-    ALuint size;
+    MixerThread *mixer;
 
     volatile int killNow;
     ALvoid *thread;
@@ -37,16 +36,16 @@ typedef struct {
 
 static const ALCchar nullDevice[] = "Null Output";
 
+/* Plays out the periods of the mixer thread in real time, the way a device
+ * would read them, so the ring and the mixer timing can be tested without
+ * one */
 static ALuint NullProc(ALvoid *ptr)
 {
     ALCdevice *Device = (ALCdevice*)ptr;
     null_data *data = (null_data*)Device->ExtraData;
-    ALuint frameSize;
     ALuint now, last;
     ALuint avail;
 
-    frameSize = aluFrameSizeFromFormat(Device->Format);
-
     last = timeGetTime()<<8;
     while(!data->killNow && Device->Connected)
     {
@@ -61,7 +60,9 @@ static ALuint NullProc(ALvoid *ptr)
 
         while(avail >= Device->UpdateSize)
         {
-            aluMixData(Device, data->buffer, Device->UpdateSize);
+            if(!ReadMixerPeriod(data->mixer))
+                return 0;
+            ReleaseMixerPeriod(data->mixer);
 
             avail -= Device->UpdateSize;
             last += (ALuint64)Device->UpdateSize * (1000<<8) / Device->Frequency;
@@ -99,22 +100,20 @@ static ALCboolean null_reset_playback(ALCdevice *device)
 {
     null_data *data = (null_data*)device->ExtraData;
 
-    data->size = device->UpdateSize * aluFrameSizeFromFormat(device->Format);
-    data->buffer = malloc(data->size);
-    if(!data->buffer)
-    {
-        AL_PRINT("buffer malloc failed\n");
-        return ALC_FALSE;
-    }
     SetDefaultWFXChannelOrder(device);
 
+    data->mixer = StartMixerThread(device, device->UpdateSize, device->NumUpdates);
+    if(data->mixer == NULL)
+        return ALC_FALSE;
+
     data->thread = StartThread(NullProc, device);
     if(data->thread == NULL)
     {
-        free(data->buffer);
-        data->buffer = NULL;
+        DestroyMixerThread(data->mixer);
+        data->mixer = NULL;
         return ALC_FALSE;
     }
+    device->Mixer = data->mixer;
 
     return ALC_TRUE;
 }
@@ -127,13 +126,15 @@ static void null_stop_playback(ALCdevice *device)
         return;
 
     data->killNow = 1;
+    StopMixerThread(data->mixer);
     StopThread(data->thread);
     data->thread = NULL;
 
     data->killNow = 0;
 
-    free(data->buffer);
-    data->buffer = NULL;
+    device->Mixer = NULL;
+    DestroyMixerThread(data->mixer);
+    data->mixer = NULL;
 }
 
 
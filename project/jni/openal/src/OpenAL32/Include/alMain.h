@@ -390,6 +390,11 @@ struct ALCdevice_struct
     // Dry path buffer mix
     float DryBuffer[BUFFERSIZE][OUTPUTCHANNELS];
 
+    // Scratch buffers of the source mixer, for one resampled and one
+    // filtered channel
+    ALfloat ResampledData[BUFFERSIZE];
+    ALfloat FilteredData[BUFFERSIZE];
+
     ALuint DevChannels[OUTPUTCHANNELS];
 
     ALfloat ChannelMatrix[OUTPUTCHANNELS][OUTPUTCHANNELS];
@@ -405,6 +410,9 @@ struct ALCdevice_struct
     BackendFuncs *Funcs;
     void         *ExtraData; // For the backend's use
 
+    // Set by backends that mix through a MixerThread, for its stats
+    struct MixerThread *Mixer;
+
     ALCdevice *next;
 };
 
@@ -473,6 +481,28 @@ ALsizei RingBufferSize(RingBuffer *ring);
 void WriteRingBuffer(RingBuffer *ring, const ALubyte *data, ALsizei len);
 void ReadRingBuffer(RingBuffer *ring, ALubyte *data, ALsizei len);
 
+typedef struct MixerThread MixerThread;
+typedef struct MixerStats {
+    // Times the reader found no period mixed, after the first one
+    ALuint Underruns;
+    ALuint PeriodsMixed;
+    ALuint PeriodsRead;
+    // Sample frames mixed ahead of the reader, when it last read a period,
+    // and the most ever
+    ALuint Latency;
+    ALuint MaxLatency;
+    // Microseconds spent in aluMixData, in total and for the longest period,
+    // waits for the device lock included
+    ALuint64 MixTime;
+    ALuint MaxMixTime;
+} MixerStats;
+MixerThread *StartMixerThread(ALCdevice *device, ALuint period_size, ALuint periods);
+void StopMixerThread(MixerThread *mixer);
+void DestroyMixerThread(MixerThread *mixer);
+const ALubyte *ReadMixerPeriod(MixerThread *mixer);
+void ReleaseMixerPeriod(MixerThread *mixer);
+void GetMixerStats(MixerThread *mixer, MixerStats *stats);
+
 void ReadALConfig(void);
 void FreeALConfig(void);
 int ConfigValueExists(const char *blockName, const char *keyName);
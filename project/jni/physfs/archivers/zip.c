@@ -34,7 +34,31 @@
  * Depending on your speed and memory requirements, you should tweak this
  *  value.
  */
+#ifndef ZIP_READBUFSIZE
 #define ZIP_READBUFSIZE   (16 * 1024)
+#endif
+
+/*
+ * If the PHYSFS_ZIP_CHECKPOINTS environment variable is set to a number
+ *  of kilobytes when a compressed file is opened, then the first time
+ *  through that file a copy of the zlib state is saved every that many
+ *  bytes of decompressed data, so ZIP_seek() can resume from the nearest
+ *  one instead of decompressing from the start of the file again. Each
+ *  copy costs about 40k, mostly zlib's 32k window. Once
+ *  ZIP_MAX_CHECKPOINTS are saved, every other one is dropped and the
+ *  interval doubles, so memory use stays bounded.
+ *
+ * This is off unless asked for, since it's a lot of memory per open file
+ *  for programs that never seek backwards. Define ZIP_CHECKPOINT_INTERVAL
+ *  to turn it on for every file without the environment variable.
+ */
+#ifndef ZIP_CHECKPOINT_INTERVAL
+#define ZIP_CHECKPOINT_INTERVAL   0
+#endif
+
+#ifndef ZIP_MAX_CHECKPOINTS
+#define ZIP_MAX_CHECKPOINTS   16
+#endif
 
 
 /*
@@ -84,6 +108,16 @@ typedef struct
     ZIPentry *entries;        /* info on all files in ZIP.                   */
 } ZIPinfo;
 
+/*
+ * A saved copy of the zlib state partway through a compressed file.
+ */
+typedef struct
+{
+    PHYSFS_uint32 compressed_position;    /* next byte to feed inflate(). */
+    PHYSFS_uint32 uncompressed_position;  /* data decompressed so far.    */
+    z_stream stream;                      /* inflateCopy() of the state.  */
+} ZIPcheckpoint;
+
 /*
  * One ZIPfileinfo is kept for each open file in a ZIP archive.
  */
@@ -95,6 +129,10 @@ typedef struct
     PHYSFS_uint32 uncompressed_position;  /* tell() position.           */
     PHYSFS_uint8 *buffer;                 /* decompression buffer.      */
     z_stream stream;                      /* zlib stream state.         */
+    ZIPcheckpoint **checkpoints;          /* NULL until the first one.  */
+    PHYSFS_uint32 checkpointCount;        /* saved so far.              */
+    PHYSFS_uint32 checkpointInterval;     /* 0 if not saving any.       */
+    int checkpointsStopped;               /* out of memory, save no more. */
 } ZIPfileinfo;
 
 
@@ -198,6 +236,150 @@ static int readui16(void *in, PHYSFS_uint16 *val)
 } /* readui16 */
 
 
+/*
+ * Bytes of decompressed data between checkpoints in a file opened now,
+ *  or 0 for none.
+ */
+static PHYSFS_uint32 zip_checkpoint_interval(void)
+{
+#ifndef _WIN32_WCE
+    const char *envr = getenv("PHYSFS_ZIP_CHECKPOINTS");
+    if (envr != NULL)
+    {
+        long kb = atol(envr);
+        if ((kb <= 0) || (kb > 64 * 1024))
+            return(0);
+        return((PHYSFS_uint32) kb * 1024);
+    } /* if */
+#endif
+
+    return(ZIP_CHECKPOINT_INTERVAL);
+} /* zip_checkpoint_interval */
+
+
+/*
+ * Offset in the decompressed data where the next checkpoint is due, or
+ *  past the end of the file if no more are wanted. Checkpoint (i) is
+ *  at ((i + 1) * checkpointInterval).
+ */
+static PHYSFS_uint64 zip_next_checkpoint(ZIPfileinfo *finfo)
+{
+    PHYSFS_uint64 next;
+
+    if ((finfo->checkpointInterval == 0) || (finfo->checkpointsStopped))
+        return(finfo->entry->uncompressed_size);
+
+    next = ((PHYSFS_uint64) finfo->checkpointCount + 1) *
+           finfo->checkpointInterval;
+    if (next > finfo->entry->uncompressed_size)
+        next = finfo->entry->uncompressed_size;
+    return(next);
+} /* zip_next_checkpoint */
+
+
+static void zip_free_checkpoints(ZIPfileinfo *finfo)
+{
+    PHYSFS_uint32 i;
+
+    for (i = 0; i < finfo->checkpointCount; i++)
+    {
+        inflateEnd(&finfo->checkpoints[i]->stream);
+        allocator.Free(finfo->checkpoints[i]);
+    } /* for */
+
+    if (finfo->checkpoints != NULL)
+        allocator.Free(finfo->checkpoints);
+
+    finfo->checkpoints = NULL;
+    finfo->checkpointCount = 0;
+} /* zip_free_checkpoints */
+
+
+/*
+ * Called when the stream is exactly at the next checkpoint. Checkpoints
+ *  are only an optimization: if memory runs out, we stop saving them.
+ *  Seeks still use the ones already saved, and fall back to decompressing
+ *  from the start of the file before the first one.
+ */
+static void zip_save_checkpoint(ZIPfileinfo *finfo)
+{
+    ZIPcheckpoint *cp;
+    PHYSFS_uint32 i;
+
+    if (finfo->checkpoints == NULL)
+    {
+        finfo->checkpoints = (ZIPcheckpoint **) allocator.Malloc(
+                                sizeof (ZIPcheckpoint *) * ZIP_MAX_CHECKPOINTS);
+        if (finfo->checkpoints == NULL)
+        {
+            finfo->checkpointsStopped = 1;
+            return;
+        } /* if */
+    } /* if */
+
+    cp = (ZIPcheckpoint *) allocator.Malloc(sizeof (ZIPcheckpoint));
+    if (cp == NULL)
+    {
+        finfo->checkpointsStopped = 1;
+        return;
+    } /* if */
+
+    /* copy in place: a z_stream can't be moved once zlib knows about it. */
+    if (inflateCopy(&cp->stream, &finfo->stream) != Z_OK)
+    {
+        allocator.Free(cp);
+        finfo->checkpointsStopped = 1;
+        return;
+    } /* if */
+
+    cp->uncompressed_position = (PHYSFS_uint32) zip_next_checkpoint(finfo);
+    cp->compressed_position = finfo->compressed_position -
+                              finfo->stream.avail_in;
+    finfo->checkpoints[finfo->checkpointCount++] = cp;
+
+    /* full? Keep the ones on multiples of twice the interval. */
+    if (finfo->checkpointCount == ZIP_MAX_CHECKPOINTS)
+    {
+        for (i = 0; i < ZIP_MAX_CHECKPOINTS; i++)
+        {
+            cp = finfo->checkpoints[i];
+            if ((i % 2) == 0)
+            {
+                inflateEnd(&cp->stream);
+                allocator.Free(cp);
+            } /* if */
+            else
+            {
+                finfo->checkpoints[i / 2] = cp;
+            } /* else */
+        } /* for */
+
+        finfo->checkpointCount = ZIP_MAX_CHECKPOINTS / 2;
+        finfo->checkpointInterval *= 2;
+    } /* if */
+} /* zip_save_checkpoint */
+
+
+/*
+ * The last checkpoint at or before (offset), or NULL.
+ */
+static ZIPcheckpoint *zip_find_checkpoint(ZIPfileinfo *finfo,
+                                          PHYSFS_uint64 offset)
+{
+    PHYSFS_uint64 i;
+
+    if ((finfo->checkpointCount == 0) || (finfo->checkpointInterval == 0))
+        return(NULL);
+
+    i = offset / finfo->checkpointInterval;
+    if (i == 0)
+        return(NULL);
+    if (i > finfo->checkpointCount)
+        i = finfo->checkpointCount;
+    return(finfo->checkpoints[i - 1]);
+} /* zip_find_checkpoint */
+
+
 static PHYSFS_sint64 ZIP_read(fvoid *opaque, void *buf,
                               PHYSFS_uint32 objSize, PHYSFS_uint32 objCount)
 {
@@ -226,11 +408,13 @@ static PHYSFS_sint64 ZIP_read(fvoid *opaque, void *buf,
     else
     {
         finfo->stream.next_out = buf;
-        finfo->stream.avail_out = objSize * objCount;
 
         while (retval < maxread)
         {
             PHYSFS_uint32 before = finfo->stream.total_out;
+            PHYSFS_uint64 pos = finfo->uncompressed_position + retval;
+            PHYSFS_uint64 next = zip_next_checkpoint(finfo);
+            PHYSFS_uint64 avail = maxread - retval;
             int rc;
 
             if (finfo->stream.avail_in == 0)
@@ -255,9 +439,18 @@ static PHYSFS_sint64 ZIP_read(fvoid *opaque, void *buf,
                 } /* if */
             } /* if */
 
+            /* stop where the next checkpoint is due, so it's saved there. */
+            if ((pos < next) && (next - pos < avail))
+                avail = next - pos;
+            finfo->stream.avail_out = (uInt) avail;
+
             rc = zlib_err(inflate(&finfo->stream, Z_SYNC_FLUSH));
             retval += (finfo->stream.total_out - before);
 
+            if ((pos < next) && (finfo->uncompressed_position + retval == next) &&
+                (next < finfo->entry->uncompressed_size))
+                zip_save_checkpoint(finfo);
+
             if (rc != Z_OK)
                 break;
         } /* while */
@@ -310,30 +503,55 @@ static int ZIP_seek(fvoid *opaque, PHYSFS_uint64 offset)
     else
     {
         /*
-         * If seeking backwards, we need to redecode the file
-         *  from the start and throw away the compressed bits until we hit
-         *  the offset we need. If seeking forward, we still need to
-         *  decode, but we don't rewind first.
+         * We have to decode up to the offset we need and throw away the
+         *  data. Start from the last checkpoint before it, if there is one
+         *  and we'd otherwise have to go back or decode more. If seeking
+         *  backwards without one, we need to redecode the file from the
+         *  start. If seeking forward, we don't rewind first.
          */
-        if (offset < finfo->uncompressed_position)
+        ZIPcheckpoint *cp = zip_find_checkpoint(finfo, offset);
+
+        if ((cp != NULL) &&
+            ((offset < finfo->uncompressed_position) ||
+             (cp->uncompressed_position > finfo->uncompressed_position)))
         {
-            /* we do a copy so state is sane if inflateInit2() fails. */
-            z_stream str;
-            initializeZStream(&str);
-            if (zlib_err(inflateInit2(&str, -MAX_WBITS)) != Z_OK)
+            inflateEnd(&finfo->stream);
+            if (inflateCopy(&finfo->stream, &cp->stream) == Z_OK)
+            {
+                finfo->compressed_position = cp->compressed_position;
+                finfo->uncompressed_position = cp->uncompressed_position;
+            } /* if */
+            else  /* no memory for the copy? Start over from the top. */
+            {
+                initializeZStream(&finfo->stream);
+                if (zlib_err(inflateInit2(&finfo->stream, -MAX_WBITS)) != Z_OK)
+                    return(0);
+                finfo->uncompressed_position = finfo->compressed_position = 0;
+            } /* else */
+
+            finfo->stream.next_in = NULL;
+            finfo->stream.avail_in = 0;
+            if (!__PHYSFS_platformSeek(in, entry->offset + finfo->compressed_position))
                 return(0);
+        } /* if */
 
+        else if (offset < finfo->uncompressed_position)
+        {
             if (!__PHYSFS_platformSeek(in, entry->offset))
                 return(0);
 
-            inflateEnd(&finfo->stream);
-            memcpy(&finfo->stream, &str, sizeof (z_stream));
+            /* reset in place: a z_stream can't be moved once it's used. */
+            if (zlib_err(inflateReset(&finfo->stream)) != Z_OK)
+                return(0);
+
+            finfo->stream.next_in = NULL;
+            finfo->stream.avail_in = 0;
             finfo->uncompressed_position = finfo->compressed_position = 0;
-        } /* if */
+        } /* else if */
 
         while (finfo->uncompressed_position != offset)
         {
-            PHYSFS_uint8 buf[512];
+            PHYSFS_uint8 buf[4096];
             PHYSFS_uint32 maxread;
 
             maxread = (PHYSFS_uint32) (offset - finfo->uncompressed_position);
@@ -364,6 +582,8 @@ static int ZIP_fileClose(fvoid *opaque)
     if (finfo->entry->compression_method != COMPMETH_NONE)
         inflateEnd(&finfo->stream);
 
+    zip_free_checkpoints(finfo);
+
     if (finfo->buffer != NULL)
         allocator.Free(finfo->buffer);
 
@@ -1375,6 +1595,8 @@ static fvoid *ZIP_openRead(dvoid *opaque, const char *fnm, int *fileExists)
             ZIP_fileClose(finfo);
             BAIL_MACRO(ERR_OUT_OF_MEMORY, NULL);
         } /* if */
+
+        finfo->checkpointInterval = zip_checkpoint_interval();
     } /* if */
 
     return(finfo);
@@ -55,6 +55,11 @@ LOCAL_CPP_EXTENSION := .cpp
 # Note this "simple" makefile var substitution, you can find even more complex examples in different Android projects
 LOCAL_SRC_FILES := $(foreach F, $(SDL_SRCS), $(addprefix $(dir $(F)),$(notdir $(wildcard $(LOCAL_PATH)/$(F)))))
 
+# NEON code is selected at runtime, so enable NEON only for files which contain nothing else
+ifneq ($(filter armeabi-v7a%,$(TARGET_ARCH_ABI)),)
+LOCAL_SRC_FILES := $(patsubst %_neon.c,%_neon.c.neon,$(LOCAL_SRC_FILES))
+endif
+
 LOCAL_SHARED_LIBRARIES := sdl_native_helpers # Not really a dependency, needed for CustomBuildScript
 
 LOCAL_LDLIBS := -lGLESv1_CM -ldl -llog
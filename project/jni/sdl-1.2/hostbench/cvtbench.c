@@ -0,0 +1,174 @@
+/*
+    Audio conversion benchmark for the host build: converts sine waves
+    with SDL_BuildAudioCVT() and SDL_ConvertAudio() between the rates
+    games ship their sounds at and the rates devices play at, and prints
+    the speed and the signal to noise ratio of every resampler.
+
+      make APP_SRCS=cvtbench.c
+      ./hostbench -frames 0 -- [-seconds S]
+
+    Each conversion is 16-bit stereo to 16-bit stereo, once as a whole
+    sound the way Mix_LoadWAV() converts it, and once in 4 KB chunks
+    through SDL_ConvertAudioStream() the way the streaming music decoders
+    do, so the chunked SNR also counts any error at the chunk edges.
+    The SNR is measured on a 1 kHz, a 7 kHz and a 10 kHz sine, against the best fit
+    sine of the same frequency, without the first and last 10 ms.
+    The resampler is picked with SDL_AUDIO_RESAMPLER, as applications do.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/time.h>
+#include "SDL.h"
+
+#define CHUNK 4096
+
+static const struct {
+	int src_rate, dst_rate;
+} conversions[] = {
+	{ 22050, 44100 },
+	{ 22050, 48000 },
+	{ 44100, 48000 },
+	{ 48000, 44100 },
+	{ 44100, 22050 },
+};
+
+static const char *resamplers[] = { "legacy", "fast", "medium", "best" };
+
+static double now(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static Sint16 *makeSine(int rate, double freq, int frames)
+{
+	Sint16 *buf = (Sint16 *)malloc(frames * 4);
+	int i;
+	for( i = 0; i < frames; i++ )
+		buf[i * 2] = buf[i * 2 + 1] = (Sint16)floor(16000.0 * sin(2 * M_PI * freq * i / rate) + 0.5);
+	return buf;
+}
+
+/* Converts frames of src in chunks of chunk bytes, as a stream if there
+   is more than one, returns the output and its length in frames */
+static Sint16 *convert(SDL_AudioCVT *cvt, const Sint16 *src, int frames, int chunk, int *outFrames)
+{
+	Uint8 *out = (Uint8 *)malloc((size_t)(frames * 4 * cvt->len_mult + chunk * cvt->len_mult));
+	Uint8 *buf = (Uint8 *)malloc((size_t)chunk * cvt->len_mult);
+	SDL_AudioCVTStream *stream = NULL;
+	int pos = 0, outLen = 0;
+
+	if( chunk < frames * 4 )
+		stream = SDL_NewAudioCVTStream(cvt, chunk);
+
+	while( pos < frames * 4 )
+	{
+		cvt->len = frames * 4 - pos < chunk ? frames * 4 - pos : chunk;
+		cvt->buf = buf;
+		memcpy(buf, (const Uint8 *)src + pos, cvt->len);
+		SDL_ConvertAudioStream(stream, cvt);
+		memcpy(out + outLen, buf, cvt->len_cvt);
+		outLen += cvt->len_cvt;
+		pos += cvt->len;
+	}
+	SDL_FreeAudioCVTStream(stream);
+	free(buf);
+	*outFrames = outLen / 4;
+	return (Sint16 *)out;
+}
+
+/* Least squares fit of a sine of freq to the left channel, returns the
+   ratio of the fitted sine power to the power of the rest in dB */
+static double snr(const Sint16 *buf, int frames, int rate, double freq)
+{
+	double ss = 0, cc = 0, sc = 0, sy = 0, cy = 0, yy = 0, det, a, b, signal, noise;
+	int skip = rate / 100, i;
+
+	for( i = skip; i < frames - skip; i++ )
+	{
+		double s = sin(2 * M_PI * freq * i / rate), c = cos(2 * M_PI * freq * i / rate), y = buf[i * 2];
+		ss += s * s; cc += c * c; sc += s * c;
+		sy += s * y; cy += c * y; yy += y * y;
+	}
+	det = ss * cc - sc * sc;
+	a = (sy * cc - cy * sc) / det;
+	b = (cy * ss - sy * sc) / det;
+	signal = a * a * ss + 2 * a * b * sc + b * b * cc;
+	noise = yy - signal;
+	if( noise <= 0 )
+		return 200;
+	return 10 * log10(signal / noise);
+}
+
+static void run(int src_rate, int dst_rate, const char *resampler, double seconds)
+{
+	static const double freqs[3] = { 1000, 7000, 10000 };
+	SDL_AudioCVT cvt;
+	int frames = (int)(seconds * src_rate), outFrames, repeats = 0, f;
+	Sint16 *src, *out;
+	double whole[3], chunked[3], start, elapsed;
+	char env[64];
+
+	sprintf(env, "SDL_AUDIO_RESAMPLER=%s", resampler);
+	SDL_putenv(env);
+	if( SDL_BuildAudioCVT(&cvt, AUDIO_S16SYS, 2, src_rate, AUDIO_S16SYS, 2, dst_rate) < 0 )
+	{
+		printf("cvtbench: %d -> %d %s: %s\n", src_rate, dst_rate, resampler, SDL_GetError());
+		return;
+	}
+
+	for( f = 0; f < 3; f++ )
+	{
+		src = makeSine(src_rate, freqs[f], frames);
+		out = convert(&cvt, src, frames, frames * 4, &outFrames);
+		whole[f] = snr(out, outFrames, dst_rate, freqs[f]);
+		free(out);
+		out = convert(&cvt, src, frames, CHUNK, &outFrames);
+		chunked[f] = snr(out, outFrames, dst_rate, freqs[f]);
+		free(out);
+		free(src);
+	}
+
+	/* Speed of the chunked conversion, the common case at runtime */
+	src = makeSine(src_rate, freqs[0], frames);
+	start = now();
+	do
+	{
+		free(convert(&cvt, src, frames, CHUNK, &outFrames));
+		repeats++;
+		elapsed = now() - start;
+	}
+	while( elapsed < 0.5 );
+	free(src);
+
+	printf("cvtbench: %5d -> %5d %-6s  x%-6.0f realtime  SNR 1k %5.1f  7k %5.1f  10k %5.1f dB  chunked 1k %5.1f  7k %5.1f  10k %5.1f dB\n",
+		src_rate, dst_rate, resampler, seconds * repeats / elapsed,
+		whole[0], whole[1], whole[2], chunked[0], chunked[1], chunked[2]);
+}
+
+int main(int argc, char *argv[])
+{
+	double seconds = 5;
+	unsigned c, r;
+	int i;
+
+	for( i = 1; i < argc; i++ )
+	{
+		if( !strcmp(argv[i], "-seconds") && i + 1 < argc )
+			seconds = atof(argv[++i]);
+		else
+		{
+			fprintf(stderr, "Usage: cvtbench [-seconds S]\n");
+			return 1;
+		}
+	}
+
+	for( c = 0; c < sizeof(conversions) / sizeof(conversions[0]); c++ )
+		for( r = 0; r < sizeof(resamplers) / sizeof(resamplers[0]); r++ )
+			run(conversions[c].src_rate, conversions[c].dst_rate, resamplers[r], seconds);
+	return 0;
+}
@@ -0,0 +1,295 @@
+/*
+    Software stand-in for libGLESv1_CM in the host benchmark build.
+
+    Nothing is rasterized: textures are stored and copied like a driver
+    would, which is the cost libSDL controls, draw calls are counted,
+    and all other state calls are accepted and dropped. libSDL dlopen()s
+    libGLESv1_CM.so for SDL_GL_GetProcAddress(), so dlopen() is
+    interposed to hand it this executable instead of the host GL library.
+*/
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <GLES/gl.h>
+#include <GLES/glext.h>
+
+#include "hostbench.h"
+
+typedef struct
+{
+	GLsizei width, height;
+	int bpp;
+	GLubyte *pixels;
+} texture_t;
+
+static texture_t *textures = NULL;
+static GLuint texturesCount = 0;
+static GLuint texturesNext = 1;
+static GLuint boundTexture = 0;
+static GLint unpackAlignment = 4;
+
+/* ---------- Library loading ---------- */
+
+void *dlopen(const char *file, int mode)
+{
+	static void * (*realDlopen)(const char *, int) = NULL;
+
+	if( file && (strstr(file, "libGLESv1_CM") || strstr(file, "libGLESv2")) )
+		file = NULL;
+	if( !realDlopen )
+		realDlopen = (void * (*)(const char *, int)) dlsym(RTLD_NEXT, "dlopen");
+	return realDlopen(file, mode);
+}
+
+/* ---------- Textures ---------- */
+
+static int bytesPerPixel(GLenum format, GLenum type)
+{
+	if( type != GL_UNSIGNED_BYTE )
+		return 2;
+	switch( format )
+	{
+		case GL_RGBA:
+			return 4;
+		case GL_RGB:
+			return 3;
+		case GL_LUMINANCE_ALPHA:
+			return 2;
+		default:
+			return 1;
+	}
+}
+
+static texture_t * getTexture(GLuint id)
+{
+	if( id >= texturesCount )
+	{
+		GLuint count = texturesCount ? texturesCount : 64;
+		while( count <= id )
+			count *= 2;
+		textures = (texture_t *) realloc(textures, count * sizeof(texture_t));
+		memset(textures + texturesCount, 0, (count - texturesCount) * sizeof(texture_t));
+		texturesCount = count;
+	}
+	return &textures[id];
+}
+
+static void copyRows(GLubyte *dst, int dstPitch, const GLubyte *src, int rowBytes, int rows)
+{
+	int srcPitch = (rowBytes + unpackAlignment - 1) / unpackAlignment * unpackAlignment;
+	for( ; rows > 0; rows--, dst += dstPitch, src += srcPitch )
+		memcpy(dst, src, rowBytes);
+}
+
+GL_API void GL_APIENTRY glGenTextures(GLsizei n, GLuint *ids)
+{
+	while( n-- > 0 )
+		*ids++ = texturesNext++;
+}
+
+GL_API void GL_APIENTRY glDeleteTextures(GLsizei n, const GLuint *ids)
+{
+	for( ; n > 0; n--, ids++ )
+	{
+		texture_t *tex = getTexture(*ids);
+		free(tex->pixels);
+		memset(tex, 0, sizeof(texture_t));
+	}
+}
+
+/* All textures are gone with the OpenGL context, like on a real device */
+void HB_DropTextures(void)
+{
+	GLuint i;
+	for( i = 0; i < texturesCount; i++ )
+		free(textures[i].pixels);
+	memset(textures, 0, texturesCount * sizeof(texture_t));
+	boundTexture = 0;
+}
+
+GL_API void GL_APIENTRY glBindTexture(GLenum target, GLuint id)
+{
+	boundTexture = id;
+}
+
+GL_API void GL_APIENTRY glPixelStorei(GLenum pname, GLint param)
+{
+	if( pname == GL_UNPACK_ALIGNMENT )
+		unpackAlignment = param;
+}
+
+GL_API void GL_APIENTRY glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+	GLint border, GLenum format, GLenum type, const GLvoid *pixels)
+{
+	Uint64 start = HB_Now();
+	texture_t *tex = getTexture(boundTexture);
+	int bpp = bytesPerPixel(format, type);
+
+	if( level != 0 )
+		return;
+	if( tex->width != width || tex->height != height || tex->bpp != bpp )
+	{
+		free(tex->pixels);
+		tex->pixels = (GLubyte *) malloc(width * height * bpp);
+		tex->width = width;
+		tex->height = height;
+		tex->bpp = bpp;
+	}
+	if( !pixels )
+		return;
+	copyRows(tex->pixels, width * bpp, (const GLubyte *) pixels, width * bpp, height);
+	HB_TextureUpload(HB_Now() - start, width * height * bpp);
+}
+
+GL_API void GL_APIENTRY glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height,
+	GLenum format, GLenum type, const GLvoid *pixels)
+{
+	Uint64 start = HB_Now();
+	texture_t *tex = getTexture(boundTexture);
+	int bpp = bytesPerPixel(format, type);
+
+	if( level != 0 || !tex->pixels || xoffset + width > tex->width || yoffset + height > tex->height )
+		return;
+	copyRows(tex->pixels + (yoffset * tex->width + xoffset) * tex->bpp, tex->width * tex->bpp,
+		(const GLubyte *) pixels, width * bpp, height);
+	HB_TextureUpload(HB_Now() - start, width * height * bpp);
+}
+
+GL_API void GL_APIENTRY glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid *pixels)
+{
+	memset(pixels, 0, width * height * bytesPerPixel(format, type));
+}
+
+/* ---------- Draw calls ---------- */
+
+GL_API void GL_APIENTRY glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	HB_DrawCall();
+}
+
+GL_API void GL_APIENTRY glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices)
+{
+	HB_DrawCall();
+}
+
+GL_API void GL_APIENTRY glDrawTexiOES(GLint x, GLint y, GLint z, GLint width, GLint height)
+{
+	HB_DrawCall();
+}
+
+GL_API void GL_APIENTRY glDrawTexfOES(GLfloat x, GLfloat y, GLfloat z, GLfloat width, GLfloat height)
+{
+	HB_DrawCall();
+}
+
+GL_API void GL_APIENTRY glClear(GLbitfield mask)
+{
+	HB_DrawCall();
+}
+
+/* ---------- Queries ---------- */
+
+GL_API GLenum GL_APIENTRY glGetError(void)
+{
+	return GL_NO_ERROR;
+}
+
+GL_API const GLubyte * GL_APIENTRY glGetString(GLenum name)
+{
+	switch( name )
+	{
+		case GL_VENDOR:
+			return (const GLubyte *) "libSDL hostbench";
+		case GL_RENDERER:
+			return (const GLubyte *) "Software stand-in";
+		case GL_VERSION:
+			return (const GLubyte *) "OpenGL ES-CM 1.1";
+		case GL_EXTENSIONS:
+			return (const GLubyte *) "GL_OES_draw_texture";
+	}
+	return NULL;
+}
+
+GL_API void GL_APIENTRY glGetIntegerv(GLenum pname, GLint *params)
+{
+	switch( pname )
+	{
+		case GL_MAX_TEXTURE_SIZE:
+			*params = 2048;
+			break;
+		case GL_MAX_TEXTURE_UNITS:
+			*params = 2;
+			break;
+		case GL_UNPACK_ALIGNMENT:
+			*params = unpackAlignment;
+			break;
+		case GL_TEXTURE_BINDING_2D:
+			*params = boundTexture;
+			break;
+		default:
+			*params = 0;
+	}
+}
+
+GL_API void GL_APIENTRY glGetFloatv(GLenum pname, GLfloat *params)
+{
+	GLint value;
+	glGetIntegerv(pname, &value);
+	*params = value;
+}
+
+GL_API void GL_APIENTRY glGetBooleanv(GLenum pname, GLboolean *params)
+{
+	*params = GL_FALSE;
+}
+
+GL_API GLboolean GL_APIENTRY glIsEnabled(GLenum cap)
+{
+	return GL_FALSE;
+}
+
+GL_API void GL_APIENTRY glGetTexEnviv(GLenum env, GLenum pname, GLint *params)
+{
+	*params = 0;
+}
+
+GL_API void GL_APIENTRY glGetTexEnvfv(GLenum env, GLenum pname, GLfloat *params)
+{
+	*params = 0;
+}
+
+/* ---------- State, dropped ---------- */
+
+GL_API void GL_APIENTRY glActiveTexture(GLenum texture) {}
+GL_API void GL_APIENTRY glBlendFunc(GLenum sfactor, GLenum dfactor) {}
+GL_API void GL_APIENTRY glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha) {}
+GL_API void GL_APIENTRY glClientActiveTexture(GLenum texture) {}
+GL_API void GL_APIENTRY glColor4f(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {}
+GL_API void GL_APIENTRY glColor4ub(GLubyte red, GLubyte green, GLubyte blue, GLubyte alpha) {}
+GL_API void GL_APIENTRY glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) {}
+GL_API void GL_APIENTRY glColorPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer) {}
+GL_API void GL_APIENTRY glDisable(GLenum cap) {}
+GL_API void GL_APIENTRY glDisableClientState(GLenum array) {}
+GL_API void GL_APIENTRY glEnable(GLenum cap) {}
+GL_API void GL_APIENTRY glEnableClientState(GLenum array) {}
+GL_API void GL_APIENTRY glFinish(void) {}
+GL_API void GL_APIENTRY glFlush(void) {}
+GL_API void GL_APIENTRY glHint(GLenum target, GLenum mode) {}
+GL_API void GL_APIENTRY glLoadIdentity(void) {}
+GL_API void GL_APIENTRY glMatrixMode(GLenum mode) {}
+GL_API void GL_APIENTRY glOrthof(GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat zNear, GLfloat zFar) {}
+GL_API void GL_APIENTRY glPopMatrix(void) {}
+GL_API void GL_APIENTRY glPushMatrix(void) {}
+GL_API void GL_APIENTRY glScissor(GLint x, GLint y, GLsizei width, GLsizei height) {}
+GL_API void GL_APIENTRY glShadeModel(GLenum mode) {}
+GL_API void GL_APIENTRY glTexCoordPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer) {}
+GL_API void GL_APIENTRY glTexEnvf(GLenum target, GLenum pname, GLfloat param) {}
+GL_API void GL_APIENTRY glTexEnvfv(GLenum target, GLenum pname, const GLfloat *params) {}
+GL_API void GL_APIENTRY glTexEnvi(GLenum target, GLenum pname, GLint param) {}
+GL_API void GL_APIENTRY glTexParameterf(GLenum target, GLenum pname, GLfloat param) {}
+GL_API void GL_APIENTRY glTexParameteri(GLenum target, GLenum pname, GLint param) {}
+GL_API void GL_APIENTRY glTexParameteriv(GLenum target, GLenum pname, const GLint *params) {}
+GL_API void GL_APIENTRY glVertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *pointer) {}
+GL_API void GL_APIENTRY glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {}
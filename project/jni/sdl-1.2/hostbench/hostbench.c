@@ -0,0 +1,705 @@
+/*
+    Host benchmark build of libSDL with the Android video and audio backends.
+
+    Runs an SDL application on a Linux PC without a device: jni_stub.c plays
+    the part of the Java side, gles_stub.c the part of the GLES driver.
+    This file starts the application the same way DemoRenderer does,
+    replays an input script recorded with recordUserInput.sh, and prints
+    per-frame timings of flip, texture upload and event pump, and the audio
+    stats, when the application exits.
+
+    Usage: hostbench [options] [script.sh] [-- application arguments]
+      -w WIDTH -h HEIGHT  physical screen size, default 800x480
+      -bpp 16|24|32       video depth, default 16
+      -hw                 do not force software video mode
+      -mt                 multithreaded video
+      -vsync              pace swapBuffers() to 60 Hz
+      -frames N           keep running until N frames are drawn, default 300
+      -timeout SECONDS    quit after this time even if frames are missing, default 60
+      -speed FACTOR       replay the script faster or slower, default 1
+      -eventdelay MSEC    delay after each input event, to mimic adb latency, default 16
+      -touch WIDTH HEIGHT touchscreen range of the recording device, default is screen size
+      -csv FILE           write timings of every frame to FILE
+      -kbtheme FILE       show the on-screen keyboard with a theme from project/res/raw,
+                          uncompressed with gunzip first
+      -contextloss N      lose the OpenGL context on the Nth swapBuffers(), like when
+                          the app is put to background, and report the texture restore
+      -audioout FILE      write the audio data the application plays to FILE,
+                          in the format AudioTrack gets
+      -C DIR              application data directory, default current directory
+      -v                  print libSDL log
+
+    A frame is one SDL_Flip(), SDL_UpdateRects() or SDL_GL_SwapBuffers() call.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <jni.h>
+#include <android/log.h>
+
+#include "SDL.h"
+#include "SDL_android.h"
+#include "video/SDL_sysvideo.h"
+#include "hostbench.h"
+
+#undef main
+
+#define JAVA_EXPORT_NAME2(name,package) Java_##package##_##name
+#define JAVA_EXPORT_NAME1(name,package) JAVA_EXPORT_NAME2(name,package)
+#define JAVA_EXPORT_NAME(name) JAVA_EXPORT_NAME1(name,SDL_JAVA_PACKAGE_PATH)
+
+extern jint JNI_OnLoad(JavaVM *vm, void *reserved);
+extern jint JAVA_EXPORT_NAME(AudioThread_nativeAudioInitJavaCallbacks) (JNIEnv *env, jobject thiz);
+extern void JAVA_EXPORT_NAME(DemoRenderer_nativeInitJavaCallbacks) (JNIEnv *env, jobject thiz);
+extern void JAVA_EXPORT_NAME(DemoRenderer_nativeResize) (JNIEnv *env, jobject thiz, jint w, jint h, jint keepRatio);
+extern void JAVA_EXPORT_NAME(DemoRenderer_nativeInit) (JNIEnv *env, jobject thiz, jstring jcurdir, jstring cmdline, jint multiThreadedVideo, jint waitForDebugger);
+extern void JAVA_EXPORT_NAME(DemoRenderer_nativeDone) (JNIEnv *env, jobject thiz);
+extern void JAVA_EXPORT_NAME(DemoRenderer_nativeGlContextLost) (JNIEnv *env, jobject thiz);
+extern void JAVA_EXPORT_NAME(Settings_nativeInitKeymap) (JNIEnv *env, jobject thiz);
+extern void JAVA_EXPORT_NAME(Settings_nativeSetVideoDepth) (JNIEnv *env, jobject thiz, jint bpp, jint UseGles2);
+extern void JAVA_EXPORT_NAME(Settings_nativeSetVideoForceSoftwareMode) (JNIEnv *env, jobject thiz);
+extern void JAVA_EXPORT_NAME(Settings_nativeSetVideoMultithreaded) (JNIEnv *env, jobject thiz);
+extern void JAVA_EXPORT_NAME(Settings_nativeSetMultitouchUsed) (JNIEnv *env, jobject thiz);
+extern void JAVA_EXPORT_NAME(Settings_nativeSetTouchscreenKeyboardUsed) (JNIEnv *env, jobject thiz);
+extern void JAVA_EXPORT_NAME(Settings_nativeSetupScreenKeyboard) (JNIEnv *env, jobject thiz,
+	jint size, jint drawsize, jint theme, jint transparency, jint floatingScreenJoystick);
+extern void JAVA_EXPORT_NAME(Settings_nativeSetupScreenKeyboardButtons) (JNIEnv *env, jobject thiz, jbyteArray img);
+extern void JAVA_EXPORT_NAME(Settings_nativeSetMouseUsed) (JNIEnv *env, jobject thiz,
+	jint RightClickMethod, jint ShowScreenUnderFinger, jint LeftClickMethod,
+	jint MoveMouseWithJoystick, jint ClickMouseWithDpad,
+	jint MaxForce, jint MaxRadius,
+	jint MoveMouseWithJoystickSpeed, jint MoveMouseWithJoystickAccel,
+	jint LeftClickKeycode, jint RightClickKeycode,
+	jint LeftClickTimeout, jint RightClickTimeout,
+	jint RelativeMovement, jint RelativeMovementSpeed, jint RelativeMovementAccel,
+	jint ShowMouseCursor, jint HoverJitterFilter, jint RightMouseButtonLongPress,
+	jint MoveMouseWithGyroscope, jint MoveMouseWithGyroscopeSpeed,
+	jint ForceScreenUpdateMouseClick, jint ScreenFollowsMouse);
+extern jint JAVA_EXPORT_NAME(DemoGLSurfaceView_nativeMotionEvent) (JNIEnv *env, jobject thiz, jint x, jint y, jint action, jint pointerId, jint force, jint radius);
+extern jint JAVA_EXPORT_NAME(DemoGLSurfaceView_nativeKey) (JNIEnv *env, jobject thiz, jint key, jint action, jint unicode);
+
+/* Bionic has strlcpy(), which SDL_config_android.h relies on, older glibc does not */
+size_t strlcpy(char *dst, const char *src, size_t size)
+{
+	size_t len = strlen(src);
+	if( size > 0 )
+	{
+		size_t n = len < size - 1 ? len : size - 1;
+		memcpy(dst, src, n);
+		dst[n] = 0;
+	}
+	return len;
+}
+
+/* ---------- Options ---------- */
+
+static int screenWidth = 800, screenHeight = 480, videoDepth = 16;
+static int softwareMode = 1, multiThreadedVideo = 0;
+static int minFrames = 300, timeoutSec = 60;
+static int contextLossSwap = 0;
+static float replaySpeed = 1.0f;
+static int eventDelayMsec = 16;
+static int touchWidth = 0, touchHeight = 0;
+static const char *scriptFile = NULL, *csvFile = NULL, *curdir = ".", *kbThemeFile = NULL;
+static char cmdline[1024] = "sdl";
+
+/* ---------- Measurements ---------- */
+
+typedef struct
+{
+	Uint64 time, frame, flip, upload, pump;
+	int uploadBytes, draws;
+} frame_t;
+
+static pthread_mutex_t statsLock = PTHREAD_MUTEX_INITIALIZER;
+static frame_t *frames = NULL;
+static int framesCount = 0, framesAlloc = 0;
+static frame_t current;
+static Uint64 lastFrameEnd = 0, startTime = 0;
+static int swapsCount = 0;
+static volatile int videoStarted = 0, appFinished = 0;
+
+Uint64 HB_Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (Uint64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void HB_TextureUpload(Uint64 usec, int bytes)
+{
+	pthread_mutex_lock(&statsLock);
+	current.upload += usec;
+	current.uploadBytes += bytes;
+	pthread_mutex_unlock(&statsLock);
+}
+
+void HB_DrawCall(void)
+{
+	pthread_mutex_lock(&statsLock);
+	current.draws++;
+	pthread_mutex_unlock(&statsLock);
+}
+
+static void addPumpTime(Uint64 usec)
+{
+	pthread_mutex_lock(&statsLock);
+	current.pump += usec;
+	pthread_mutex_unlock(&statsLock);
+}
+
+static void endFrame(Uint64 flipStart)
+{
+	Uint64 now = HB_Now();
+
+	pthread_mutex_lock(&statsLock);
+	if( framesCount >= framesAlloc )
+	{
+		framesAlloc = framesAlloc ? framesAlloc * 2 : 1024;
+		frames = (frame_t *) realloc(frames, framesAlloc * sizeof(frame_t));
+	}
+	current.time = now - startTime;
+	current.frame = lastFrameEnd ? now - lastFrameEnd : 0;
+	current.flip = now - flipStart;
+	frames[framesCount++] = current;
+	memset(&current, 0, sizeof(current));
+	lastFrameEnd = now;
+	pthread_mutex_unlock(&statsLock);
+}
+
+/* Wrappers around the video driver functions, installed on the first swapBuffers() */
+
+#define _THIS SDL_VideoDevice *this
+
+static void (*origPumpEvents)(_THIS);
+static int (*origFlipHWSurface)(_THIS, SDL_Surface *surface);
+static void (*origUpdateRects)(_THIS, int numrects, SDL_Rect *rects);
+static void (*origGLSwapBuffers)(_THIS);
+
+static void hookPumpEvents(_THIS)
+{
+	Uint64 start = HB_Now();
+	origPumpEvents(this);
+	addPumpTime(HB_Now() - start);
+}
+
+static int hookFlipHWSurface(_THIS, SDL_Surface *surface)
+{
+	Uint64 start = HB_Now();
+	int ret = origFlipHWSurface(this, surface);
+	endFrame(start);
+	return ret;
+}
+
+static void hookUpdateRects(_THIS, int numrects, SDL_Rect *rects)
+{
+	Uint64 start = HB_Now();
+	origUpdateRects(this, numrects, rects);
+	endFrame(start);
+}
+
+static void hookGLSwapBuffers(_THIS)
+{
+	Uint64 start = HB_Now();
+	origGLSwapBuffers(this);
+	endFrame(start);
+}
+
+void HB_SwapBuffers(void)
+{
+	swapsCount++;
+	/* DemoRenderer.onSurfaceDestroyed() is called inside swapBuffers(), the textures
+	   are restored by libSDL when swapBuffers() returns, within the same frame */
+	if( swapsCount == contextLossSwap )
+	{
+		HB_DropTextures();
+		JAVA_EXPORT_NAME(DemoRenderer_nativeGlContextLost) (HB_JNIEnv, HB_DemoRenderer);
+	}
+	if( videoStarted || !current_video )
+		return;
+
+	origPumpEvents = current_video->PumpEvents;
+	origFlipHWSurface = current_video->FlipHWSurface;
+	origUpdateRects = current_video->UpdateRects;
+	origGLSwapBuffers = current_video->GL_SwapBuffers;
+	if( origPumpEvents )
+		current_video->PumpEvents = hookPumpEvents;
+	if( origFlipHWSurface )
+		current_video->FlipHWSurface = hookFlipHWSurface;
+	if( origUpdateRects )
+		current_video->UpdateRects = hookUpdateRects;
+	if( origGLSwapBuffers )
+		current_video->GL_SwapBuffers = hookGLSwapBuffers;
+	videoStarted = 1;
+}
+
+/* ---------- Report ---------- */
+
+static int compareUint64(const void *a, const void *b)
+{
+	Uint64 x = *(const Uint64 *)a, y = *(const Uint64 *)b;
+	return x < y ? -1 : x > y;
+}
+
+static void printRow(const char *name, Uint64 *values, int count, int divisor)
+{
+	Uint64 sum = 0;
+	int i;
+
+	if( count <= 0 )
+	{
+		printf("%-16s %10s\n", name, "-");
+		return;
+	}
+	qsort(values, count, sizeof(Uint64), compareUint64);
+	for( i = 0; i < count; i++ )
+		sum += values[i];
+	printf("%-16s %10.1f %10.1f %10.1f %10.1f\n", name,
+		(double)sum / count / divisor,
+		(double)values[count / 2] / divisor,
+		(double)values[count * 95 / 100] / divisor,
+		(double)values[count - 1] / divisor);
+}
+
+#define FRAME_COLUMN(name, field, divisor) \
+	do { \
+		for( i = 0; i < count; i++ ) \
+			values[i] = frames[i + skip].field; \
+		printRow(name, values, count, divisor); \
+	} while(0)
+
+static void report(void)
+{
+	static int reported = 0;
+	Uint64 *values, elapsed;
+	int i, skip, count;
+	int audioCallbacks = 0, avgCallbackUs = 0, maxCallbackUs = 0, audioWrites = 0, underruns = 0, latencyMs = 0;
+
+	pthread_mutex_lock(&statsLock);
+	if( reported )
+	{
+		pthread_mutex_unlock(&statsLock);
+		return;
+	}
+	reported = 1;
+
+	if( csvFile )
+	{
+		FILE *csv = fopen(csvFile, "w");
+		if( csv )
+		{
+			fprintf(csv, "frame,time_us,frame_us,flip_us,upload_us,upload_bytes,pump_us,draw_calls\n");
+			for( i = 0; i < framesCount; i++ )
+				fprintf(csv, "%d,%llu,%llu,%llu,%llu,%d,%llu,%d\n", i,
+					(unsigned long long)frames[i].time, (unsigned long long)frames[i].frame,
+					(unsigned long long)frames[i].flip, (unsigned long long)frames[i].upload,
+					frames[i].uploadBytes, (unsigned long long)frames[i].pump, frames[i].draws);
+			fclose(csv);
+		}
+		else
+			fprintf(stderr, "hostbench: cannot write %s\n", csvFile);
+	}
+
+	/* The first frame includes the application startup */
+	skip = framesCount > 1 ? 1 : 0;
+	count = framesCount - skip;
+	elapsed = count > 0 ? frames[framesCount - 1].time - frames[0].time : 0;
+
+	printf("hostbench: %d frames, %d swaps, %.2f s, %.1f FPS\n", framesCount, swapsCount,
+		elapsed / 1000000.0, elapsed ? count * 1000000.0 / elapsed : 0.0);
+	printf("%-16s %10s %10s %10s %10s\n", "", "avg", "median", "95%", "max");
+
+	values = (Uint64 *) malloc((count + 1) * sizeof(Uint64));
+	FRAME_COLUMN("frame, ms", frame, 1000);
+	FRAME_COLUMN("flip, ms", flip, 1000);
+	FRAME_COLUMN("tex upload, ms", upload, 1000);
+	FRAME_COLUMN("tex upload, KB", uploadBytes, 1024);
+	FRAME_COLUMN("event pump, ms", pump, 1000);
+	FRAME_COLUMN("draw calls", draws, 1);
+	free(values);
+
+	SDL_ANDROID_GetAudioStats(&audioCallbacks, &avgCallbackUs, &maxCallbackUs, &audioWrites, &underruns, &latencyMs);
+	if( HB_AudioOut )
+		fflush(HB_AudioOut);
+	if( audioCallbacks )
+		printf("audio: %d callbacks, avg %.2f ms, max %.2f ms, %d writes, %d underruns, latency %d ms\n",
+			audioCallbacks, avgCallbackUs / 1000.0, maxCallbackUs / 1000.0, audioWrites, underruns, latencyMs);
+
+	if( contextLossSwap > 0 )
+	{
+		int restoreMs = 0, restored = 0, pending = 0, lazyRestored = 0;
+		SDL_ANDROID_GetVideoRestoreStats(&restoreMs, &restored, &pending, &lazyRestored);
+		printf("context restore: %d ms, %d surfaces, %d restored on first use, %d never used\n",
+			restoreMs, restored, lazyRestored, pending);
+	}
+	fflush(stdout);
+
+	pthread_mutex_unlock(&statsLock);
+}
+
+/* ---------- Application thread, like DemoRenderer.onSurfaceCreated() ---------- */
+
+static void setEnvInt(const char *name, int value)
+{
+	char str[16];
+	sprintf(str, "%d", value);
+	setenv(name, str, 1);
+}
+
+/* Same variables as Settings.nativeSetEnv() sets, for a 160 DPI screen */
+static void setDisplayEnv(void)
+{
+	float w = screenWidth / 160.0f, h = screenHeight / 160.0f;
+	char str[32];
+
+	sprintf(str, "%f", sqrt(w * w + h * h));
+	setenv("DISPLAY_SIZE", str, 1);
+	setEnvInt("DISPLAY_SIZE_MM", (int)(sqrt(w * w + h * h) * 25.4f));
+	sprintf(str, "%f", w);
+	setenv("DISPLAY_WIDTH", str, 1);
+	sprintf(str, "%f", h);
+	setenv("DISPLAY_HEIGHT", str, 1);
+	setEnvInt("DISPLAY_WIDTH_MM", (int)(w * 25.4f));
+	setEnvInt("DISPLAY_HEIGHT_MM", (int)(h * 25.4f));
+	setEnvInt("DISPLAY_RESOLUTION_WIDTH", screenWidth);
+	setEnvInt("DISPLAY_RESOLUTION_HEIGHT", screenHeight);
+	setenv("ANDROID_VERSION", "10", 1);
+}
+
+/* Same calls as Settings.Apply() and SetupTouchscreenKeyboardGraphics() */
+static void setupScreenKeyboard(JNIEnv *env, jobject renderer)
+{
+	FILE *f = fopen(kbThemeFile, "rb");
+	jbyteArray img;
+	long len;
+
+	if( !f )
+	{
+		fprintf(stderr, "hostbench: cannot open %s\n", kbThemeFile);
+		return;
+	}
+	fseek(f, 0, SEEK_END);
+	len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	img = (*env)->NewByteArray(env, len);
+	if( fread((*env)->GetByteArrayElements(env, img, NULL), 1, len, f) == len )
+	{
+		JAVA_EXPORT_NAME(Settings_nativeSetTouchscreenKeyboardUsed) (env, renderer);
+		JAVA_EXPORT_NAME(Settings_nativeSetupScreenKeyboard) (env, renderer, 0, 0, 0, 2, 0);
+		JAVA_EXPORT_NAME(Settings_nativeSetupScreenKeyboardButtons) (env, renderer, img);
+	}
+	else
+		fprintf(stderr, "hostbench: cannot read %s\n", kbThemeFile);
+	(*env)->DeleteLocalRef(env, img);
+	fclose(f);
+}
+
+static void * rendererThread(void *unused)
+{
+	JNIEnv *env = HB_JNIEnv;
+	jobject renderer = HB_DemoRenderer;
+	jstring jcurdir, jcmdline;
+
+	JNI_OnLoad(HB_JavaVM, NULL);
+	JAVA_EXPORT_NAME(AudioThread_nativeAudioInitJavaCallbacks) (env, HB_AudioThread);
+	JAVA_EXPORT_NAME(Settings_nativeInitKeymap) (env, renderer);
+	JAVA_EXPORT_NAME(Settings_nativeSetVideoDepth) (env, renderer, videoDepth, 0);
+	if( softwareMode )
+		JAVA_EXPORT_NAME(Settings_nativeSetVideoForceSoftwareMode) (env, renderer);
+	if( multiThreadedVideo )
+		JAVA_EXPORT_NAME(Settings_nativeSetVideoMultithreaded) (env, renderer);
+	JAVA_EXPORT_NAME(Settings_nativeSetMultitouchUsed) (env, renderer);
+	JAVA_EXPORT_NAME(Settings_nativeSetMouseUsed) (env, renderer,
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 23, 82, 3, 4, 0, 2, 0, 0, 1, 1, 0, 2, 0, 0);
+
+	setDisplayEnv();
+	JAVA_EXPORT_NAME(DemoRenderer_nativeResize) (env, renderer, screenWidth, screenHeight, 0);
+	JAVA_EXPORT_NAME(DemoRenderer_nativeInitJavaCallbacks) (env, renderer);
+	if( kbThemeFile )
+		setupScreenKeyboard(env, renderer);
+
+	startTime = HB_Now();
+	jcurdir = HB_NewString(curdir);
+	jcmdline = HB_NewString(cmdline);
+	JAVA_EXPORT_NAME(DemoRenderer_nativeInit) (env, renderer, jcurdir, jcmdline, multiThreadedVideo, 0);
+	(*env)->DeleteLocalRef(env, jcurdir);
+	(*env)->DeleteLocalRef(env, jcmdline);
+
+	appFinished = 1;
+	return NULL;
+}
+
+/* ---------- Input script replay ---------- */
+
+enum { EV_SYN = 0, EV_KEY = 1, EV_ABS = 3 };
+enum { SYN_REPORT = 0, SYN_MT_REPORT = 2 };
+enum { ABS_X = 0, ABS_Y = 1, ABS_PRESSURE = 24, ABS_MT_SLOT = 47, ABS_MT_TOUCH_MAJOR = 48,
+	ABS_MT_POSITION_X = 53, ABS_MT_POSITION_Y = 54, ABS_MT_TRACKING_ID = 57, ABS_MT_PRESSURE = 58 };
+enum { BTN_TOUCH = 330 };
+enum { MOUSE_DOWN = 0, MOUSE_UP = 1, MOUSE_MOVE = 2 };
+
+#define MAX_POINTERS 16
+
+typedef struct
+{
+	int x, y, pressure, radius;
+	int down, wasDown, moved, reported;
+} pointer_t;
+
+static pointer_t pointers[MAX_POINTERS];
+static int currentSlot = 0, typeAReports = 0;
+
+/* Linux input key codes to Android KEYCODE_ */
+static const int keyMap[][2] =
+{
+	{ 158, 4 },   /* KEY_BACK */
+	{ 139, 82 },  /* KEY_MENU */
+	{ 102, 3 },   /* KEY_HOME */
+	{ 217, 84 },  /* KEY_SEARCH */
+	{ 115, 24 },  /* KEY_VOLUMEUP */
+	{ 114, 25 },  /* KEY_VOLUMEDOWN */
+	{ 103, 19 },  /* KEY_UP */
+	{ 108, 20 },  /* KEY_DOWN */
+	{ 105, 21 },  /* KEY_LEFT */
+	{ 106, 22 },  /* KEY_RIGHT */
+	{ 232, 23 },  /* KEY_REPLY, DPAD_CENTER on most devices */
+	{ 28, 66 },   /* KEY_ENTER */
+	{ 57, 62 },   /* KEY_SPACE */
+	{ 14, 67 },   /* KEY_BACKSPACE */
+};
+
+static void sendKey(int code, int value)
+{
+	int i;
+	if( value == 2 )
+		return; /* Autorepeat is generated by libSDL */
+	for( i = 0; i < sizeof(keyMap) / sizeof(keyMap[0]); i++ )
+		if( keyMap[i][0] == code )
+			JAVA_EXPORT_NAME(DemoGLSurfaceView_nativeKey) (HB_JNIEnv, HB_DemoRenderer, keyMap[i][1], value ? 1 : 0, 0);
+}
+
+static void sendTouches(void)
+{
+	int i;
+
+	for( i = 0; i < MAX_POINTERS; i++ )
+	{
+		pointer_t *p = &pointers[i];
+		int action = -1;
+
+		/* Type A devices report every touching finger in each frame */
+		if( typeAReports && !p->reported )
+			p->down = 0;
+		if( p->down && !p->wasDown )
+			action = MOUSE_DOWN;
+		else if( !p->down && p->wasDown )
+			action = MOUSE_UP;
+		else if( p->down && p->moved )
+			action = MOUSE_MOVE;
+		if( action >= 0 )
+		{
+			int x = touchWidth ? p->x * screenWidth / touchWidth : p->x;
+			int y = touchHeight ? p->y * screenHeight / touchHeight : p->y;
+			JAVA_EXPORT_NAME(DemoGLSurfaceView_nativeMotionEvent) (HB_JNIEnv, HB_DemoRenderer,
+				x, y, action, i, p->pressure, p->radius);
+		}
+		p->wasDown = p->down;
+		p->moved = 0;
+		p->reported = 0;
+	}
+	currentSlot = 0;
+	typeAReports = 0;
+}
+
+static void sendEvent(int type, int code, int value)
+{
+	pointer_t *p = &pointers[currentSlot];
+
+	if( type == EV_SYN && code == SYN_REPORT )
+	{
+		sendTouches();
+		if( eventDelayMsec > 0 )
+			usleep(eventDelayMsec * 1000 / replaySpeed);
+	}
+	else if( type == EV_SYN && code == SYN_MT_REPORT )
+	{
+		typeAReports = 1;
+		p->reported = p->down = 1;
+		if( currentSlot < MAX_POINTERS - 1 )
+			currentSlot++;
+	}
+	else if( type == EV_KEY && code == BTN_TOUCH )
+		pointers[0].down = pointers[0].reported = (value != 0);
+	else if( type == EV_KEY )
+		sendKey(code, value);
+	else if( type == EV_ABS )
+	{
+		switch( code )
+		{
+			case ABS_MT_SLOT:
+				if( value >= 0 && value < MAX_POINTERS )
+					currentSlot = value;
+				break;
+			case ABS_MT_TRACKING_ID:
+				p->down = ( value != -1 && (unsigned)value != 0xffffffff );
+				break;
+			case ABS_X:
+			case ABS_MT_POSITION_X:
+				p->x = value;
+				p->moved = 1;
+				break;
+			case ABS_Y:
+			case ABS_MT_POSITION_Y:
+				p->y = value;
+				p->moved = 1;
+				break;
+			case ABS_PRESSURE:
+			case ABS_MT_PRESSURE:
+				p->pressure = value;
+				break;
+			case ABS_MT_TOUCH_MAJOR:
+				p->radius = value;
+				break;
+		}
+	}
+}
+
+static void replayScript(const char *file)
+{
+	FILE *f = fopen(file, "r");
+	char line[256];
+
+	if( !f )
+	{
+		fprintf(stderr, "hostbench: cannot open %s\n", file);
+		return;
+	}
+	while( fgets(line, sizeof(line), f) && !appFinished )
+	{
+		char *cmd = line, dev[64];
+		long long type, code, value;
+		float delay;
+
+		while( *cmd == ' ' || *cmd == '\t' )
+			cmd++;
+		if( !strncmp(cmd, "adb shell ", 10) )
+			cmd += 10;
+		if( sscanf(cmd, "sendevent %63s %lld %lld %lld", dev, &type, &code, &value) == 4 )
+			sendEvent((int)type, (int)code, (int)value);
+		else if( sscanf(cmd, "sleep %f", &delay) == 1 )
+			usleep(delay * 1000000 / replaySpeed);
+	}
+	fclose(f);
+}
+
+/* ---------- Main ---------- */
+
+static void usage(void)
+{
+	fprintf(stderr, "Usage: hostbench [-w WIDTH] [-h HEIGHT] [-bpp BPP] [-hw] [-mt] [-vsync] [-frames N]\n"
+		"       [-timeout SECONDS] [-speed FACTOR] [-eventdelay MSEC] [-touch WIDTH HEIGHT]\n"
+		"       [-csv FILE] [-kbtheme FILE] [-contextloss N] [-audioout FILE] [-C DIR] [-v]\n"
+		"       [script.sh] [-- application arguments]\n");
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	pthread_t thread;
+	Uint64 deadline;
+	int i;
+
+	for( i = 1; i < argc; i++ )
+	{
+		const char *arg = argv[i], *next = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if( !strcmp(arg, "--") )
+		{
+			for( i++; i < argc; i++ )
+			{
+				strncat(cmdline, " ", sizeof(cmdline) - strlen(cmdline) - 1);
+				strncat(cmdline, argv[i], sizeof(cmdline) - strlen(cmdline) - 1);
+			}
+		}
+		else if( !strcmp(arg, "-hw") )
+			softwareMode = 0;
+		else if( !strcmp(arg, "-mt") )
+			multiThreadedVideo = 1;
+		else if( !strcmp(arg, "-vsync") )
+			HB_SwapIntervalUsec = 1000000 / 60;
+		else if( !strcmp(arg, "-v") )
+			HB_LogLevel = ANDROID_LOG_INFO;
+		else if( arg[0] == '-' && !next )
+			usage();
+		else if( !strcmp(arg, "-w") )
+			screenWidth = atoi(argv[++i]);
+		else if( !strcmp(arg, "-h") )
+			screenHeight = atoi(argv[++i]);
+		else if( !strcmp(arg, "-bpp") )
+			videoDepth = atoi(argv[++i]);
+		else if( !strcmp(arg, "-frames") )
+			minFrames = atoi(argv[++i]);
+		else if( !strcmp(arg, "-timeout") )
+			timeoutSec = atoi(argv[++i]);
+		else if( !strcmp(arg, "-speed") )
+			replaySpeed = atof(argv[++i]);
+		else if( !strcmp(arg, "-eventdelay") )
+			eventDelayMsec = atoi(argv[++i]);
+		else if( !strcmp(arg, "-csv") )
+			csvFile = argv[++i];
+		else if( !strcmp(arg, "-kbtheme") )
+			kbThemeFile = argv[++i];
+		else if( !strcmp(arg, "-contextloss") )
+			contextLossSwap = atoi(argv[++i]);
+		else if( !strcmp(arg, "-audioout") )
+		{
+			HB_AudioOut = fopen(argv[++i], "wb");
+			if( !HB_AudioOut )
+				perror(argv[i]);
+		}
+		else if( !strcmp(arg, "-C") )
+			curdir = argv[++i];
+		else if( !strcmp(arg, "-touch") && i + 2 < argc )
+		{
+			touchWidth = atoi(argv[++i]);
+			touchHeight = atoi(argv[++i]);
+		}
+		else if( arg[0] != '-' && !scriptFile )
+			scriptFile = arg;
+		else
+			usage();
+	}
+	if( screenWidth <= 0 || screenHeight <= 0 || replaySpeed <= 0 )
+		usage();
+
+	/* Multithreaded video exits from the application thread */
+	atexit(report);
+	deadline = HB_Now() + (Uint64)timeoutSec * 1000000;
+
+	pthread_create(&thread, NULL, rendererThread, NULL);
+
+	while( !videoStarted && !appFinished && HB_Now() < deadline )
+		usleep(10000);
+	if( scriptFile )
+		replayScript(scriptFile);
+	while( framesCount < minFrames && !appFinished && HB_Now() < deadline )
+		usleep(10000);
+
+	if( !appFinished )
+	{
+		JAVA_EXPORT_NAME(DemoRenderer_nativeDone) (HB_JNIEnv, HB_DemoRenderer);
+		deadline = HB_Now() + 5000000;
+		while( !appFinished && HB_Now() < deadline )
+			usleep(10000);
+		if( !appFinished )
+			fprintf(stderr, "hostbench: application did not quit after SDL_QUIT\n");
+	}
+
+	report();
+	return 0;
+}
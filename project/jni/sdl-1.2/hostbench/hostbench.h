@@ -0,0 +1,35 @@
+/*
+    Shared state of the host benchmark build, see hostbench.c.
+*/
+
+#ifndef _HOSTBENCH_H
+#define _HOSTBENCH_H
+
+#include <stdio.h>
+#include <jni.h>
+#include "SDL_types.h"
+
+/* Monotonic time in microseconds */
+extern Uint64 HB_Now(void);
+
+/* Measurements reported by the JNI and GLES stand-ins */
+extern void HB_SwapBuffers(void);
+extern void HB_TextureUpload(Uint64 usec, int bytes);
+extern void HB_DrawCall(void);
+
+/* Frees the storage of all textures, when the OpenGL context is lost */
+extern void HB_DropTextures(void);
+
+/* Settings of the stand-ins, filled in from the command line */
+extern int HB_LogLevel;
+extern int HB_SwapIntervalUsec;
+extern FILE *HB_AudioOut;
+
+/* The fake Java VM, and the objects of the Java classes libSDL talks to */
+extern JavaVM *HB_JavaVM;
+extern JNIEnv *HB_JNIEnv;
+extern jobject HB_DemoRenderer;
+extern jobject HB_AudioThread;
+extern jstring HB_NewString(const char *str);
+
+#endif
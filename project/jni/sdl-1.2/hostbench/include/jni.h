@@ -0,0 +1,88 @@
+/*
+    Minimal jni.h for the host benchmark build of the Android backend.
+
+    Only the types and JNIEnv/JavaVM functions which libSDL uses are
+    declared, they are implemented by jni_stub.c. The layout of the
+    function tables does not match the real JNI, this header is only
+    good for code which is compiled together with jni_stub.c.
+*/
+
+#ifndef _HOSTBENCH_JNI_H
+#define _HOSTBENCH_JNI_H
+
+#include <stdint.h>
+#include <stdarg.h>
+
+#define JNIEXPORT
+#define JNICALL
+
+#define JNI_FALSE 0
+#define JNI_TRUE 1
+#define JNI_OK 0
+#define JNI_ERR (-1)
+#define JNI_VERSION_1_2 0x00010002
+#define JNI_VERSION_1_4 0x00010004
+#define JNI_VERSION_1_6 0x00010006
+
+typedef uint8_t jboolean;
+typedef int8_t jbyte;
+typedef uint16_t jchar;
+typedef int16_t jshort;
+typedef int32_t jint;
+typedef int64_t jlong;
+typedef float jfloat;
+typedef double jdouble;
+typedef jint jsize;
+
+struct _jobject;
+typedef struct _jobject *jobject;
+typedef jobject jclass;
+typedef jobject jstring;
+typedef jobject jarray;
+typedef jarray jbyteArray;
+typedef jarray jshortArray;
+typedef jarray jintArray;
+
+struct _jmethodID;
+typedef struct _jmethodID *jmethodID;
+
+struct JNINativeInterface;
+struct JNIInvokeInterface;
+typedef const struct JNINativeInterface *JNIEnv;
+typedef const struct JNIInvokeInterface *JavaVM;
+
+struct JNINativeInterface
+{
+	jint (*PushLocalFrame)(JNIEnv *env, jint capacity);
+	jobject (*PopLocalFrame)(JNIEnv *env, jobject result);
+	jobject (*NewGlobalRef)(JNIEnv *env, jobject obj);
+	void (*DeleteGlobalRef)(JNIEnv *env, jobject obj);
+	void (*DeleteLocalRef)(JNIEnv *env, jobject obj);
+	jclass (*GetObjectClass)(JNIEnv *env, jobject obj);
+	jmethodID (*GetMethodID)(JNIEnv *env, jclass clazz, const char *name, const char *sig);
+	jobject (*CallObjectMethod)(JNIEnv *env, jobject obj, jmethodID method, ...);
+	jboolean (*CallBooleanMethod)(JNIEnv *env, jobject obj, jmethodID method, ...);
+	jint (*CallIntMethod)(JNIEnv *env, jobject obj, jmethodID method, ...);
+	void (*CallVoidMethod)(JNIEnv *env, jobject obj, jmethodID method, ...);
+	jstring (*NewStringUTF)(JNIEnv *env, const char *bytes);
+	const char * (*GetStringUTFChars)(JNIEnv *env, jstring str, jboolean *isCopy);
+	void (*ReleaseStringUTFChars)(JNIEnv *env, jstring str, const char *chars);
+	jsize (*GetArrayLength)(JNIEnv *env, jarray array);
+	jbyteArray (*NewByteArray)(JNIEnv *env, jsize len);
+	jintArray (*NewIntArray)(JNIEnv *env, jsize len);
+	jbyte * (*GetByteArrayElements)(JNIEnv *env, jbyteArray array, jboolean *isCopy);
+	void (*ReleaseByteArrayElements)(JNIEnv *env, jbyteArray array, jbyte *elems, jint mode);
+	void (*GetIntArrayRegion)(JNIEnv *env, jintArray array, jsize start, jsize len, jint *buf);
+	void (*SetIntArrayRegion)(JNIEnv *env, jintArray array, jsize start, jsize len, const jint *buf);
+	void * (*GetPrimitiveArrayCritical)(JNIEnv *env, jarray array, jboolean *isCopy);
+	void (*ReleasePrimitiveArrayCritical)(JNIEnv *env, jarray array, void *carray, jint mode);
+};
+
+struct JNIInvokeInterface
+{
+	jint (*AttachCurrentThread)(JavaVM *vm, JNIEnv **penv, void *args);
+	jint (*DetachCurrentThread)(JavaVM *vm);
+	jint (*GetEnv)(JavaVM *vm, void **penv, jint version);
+};
+
+#endif
@@ -0,0 +1,358 @@
+/*
+    Fake Java VM for the host benchmark build.
+
+    Implements the JNIEnv and JavaVM functions libSDL calls, and the Java
+    methods of DemoRenderer and AudioThread it calls through them:
+    swapBuffers() is paced like eglSwapBuffers() with vsync when
+    HB_SwapIntervalUsec is set, and fillBuffer() blocks like
+    AudioTrack.write() once one buffer is queued, so the audio thread
+    runs in real time, and writes the buffer to HB_AudioOut if it is set.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <jni.h>
+#include <android/log.h>
+
+#include "hostbench.h"
+
+#define JAVA_EXPORT_NAME2(name,package) Java_##package##_##name
+#define JAVA_EXPORT_NAME1(name,package) JAVA_EXPORT_NAME2(name,package)
+#define JAVA_EXPORT_NAME(name) JAVA_EXPORT_NAME1(name,SDL_JAVA_PACKAGE_PATH)
+
+extern void JAVA_EXPORT_NAME(DemoRenderer_nativeTextInputFinished) ( JNIEnv* env, jobject thiz );
+
+enum { OBJ_CLASS, OBJ_RENDERER, OBJ_AUDIO, OBJ_STRING, OBJ_BYTEARRAY, OBJ_INTARRAY };
+
+struct _jobject
+{
+	int type;
+	jsize len;
+	void *data;
+};
+
+struct _jmethodID
+{
+	char name[64];
+};
+
+int HB_LogLevel = ANDROID_LOG_WARN;
+int HB_SwapIntervalUsec = 0;
+FILE *HB_AudioOut = NULL;
+
+static struct _jobject rendererObject = { OBJ_RENDERER, 0, NULL };
+static struct _jobject audioObject = { OBJ_AUDIO, 0, NULL };
+static struct _jobject classObject = { OBJ_CLASS, 0, NULL };
+static struct _jobject audioBuffer = { OBJ_BYTEARRAY, 0, NULL };
+
+jobject HB_DemoRenderer = &rendererObject;
+jobject HB_AudioThread = &audioObject;
+
+int __android_log_print(int prio, const char *tag, const char *fmt, ...)
+{
+	va_list ap;
+	if( prio < HB_LogLevel )
+		return 0;
+	va_start(ap, fmt);
+	fprintf(stderr, "%s: ", tag);
+	vfprintf(stderr, fmt, ap);
+	fprintf(stderr, "\n");
+	va_end(ap);
+	return 1;
+}
+
+/* ---------- Java methods ---------- */
+
+static Uint64 lastSwap = 0;
+
+static jint swapBuffers(void)
+{
+	HB_SwapBuffers();
+	if( HB_SwapIntervalUsec > 0 )
+	{
+		Uint64 now = HB_Now();
+		if( lastSwap + HB_SwapIntervalUsec > now )
+			usleep(lastSwap + HB_SwapIntervalUsec - now);
+		lastSwap = HB_Now();
+	}
+	return 1;
+}
+
+static Uint64 audioStart = 0;
+static Uint64 audioBytesQueued = 0;
+static int audioBytesPerSec = 0;
+
+static jint initAudio(jint rate, jint channels, jint encoding, jint bufSize)
+{
+	free(audioBuffer.data);
+	audioBuffer.data = calloc(1, bufSize);
+	audioBuffer.len = bufSize;
+	audioBytesPerSec = rate * channels * (encoding ? 2 : 1);
+	audioStart = 0;
+	audioBytesQueued = 0;
+	return bufSize;
+}
+
+static jint fillBuffer(void)
+{
+	Uint64 now = HB_Now(), due;
+
+	if( HB_AudioOut )
+		fwrite(audioBuffer.data, 1, audioBuffer.len, HB_AudioOut);
+	if( !audioStart )
+		audioStart = now;
+
+	/* Let one buffer be queued, then block until the oldest one is played */
+	due = audioStart + audioBytesQueued * 1000000 / audioBytesPerSec;
+	audioBytesQueued += audioBuffer.len;
+	if( due > now )
+		usleep(due - now);
+	return 1;
+}
+
+static jint callInt(jmethodID method, va_list ap)
+{
+	if( !strcmp(method->name, "swapBuffers") )
+		return swapBuffers();
+	if( !strcmp(method->name, "fillBuffer") )
+		return fillBuffer();
+	if( !strcmp(method->name, "initAudio") )
+	{
+		jint rate = va_arg(ap, jint);
+		jint channels = va_arg(ap, jint);
+		jint encoding = va_arg(ap, jint);
+		jint bufSize = va_arg(ap, jint);
+		return initAudio(rate, channels, encoding, bufSize);
+	}
+	if( !strcmp(method->name, "isScreenKeyboardShown") )
+		return 0;
+	return 1;
+}
+
+static jint CallIntMethod(JNIEnv *env, jobject obj, jmethodID method, ...)
+{
+	jint ret;
+	va_list ap;
+	va_start(ap, method);
+	ret = callInt(method, ap);
+	va_end(ap);
+	return ret;
+}
+
+static jboolean CallBooleanMethod(JNIEnv *env, jobject obj, jmethodID method, ...)
+{
+	return JNI_FALSE;
+}
+
+static jobject CallObjectMethod(JNIEnv *env, jobject obj, jmethodID method, ...)
+{
+	if( !strcmp(method->name, "getBuffer") )
+		return &audioBuffer;
+	return NULL;
+}
+
+static void CallVoidMethod(JNIEnv *env, jobject obj, jmethodID method, ...)
+{
+	/* There is nobody to type the text, finish the input right away */
+	if( !strcmp(method->name, "showScreenKeyboard") )
+		JAVA_EXPORT_NAME(DemoRenderer_nativeTextInputFinished) (env, obj);
+}
+
+/* ---------- References, classes and methods ---------- */
+
+static jint PushLocalFrame(JNIEnv *env, jint capacity)
+{
+	return JNI_OK;
+}
+
+static jobject PopLocalFrame(JNIEnv *env, jobject result)
+{
+	return result;
+}
+
+static jobject NewGlobalRef(JNIEnv *env, jobject obj)
+{
+	return obj;
+}
+
+static void DeleteGlobalRef(JNIEnv *env, jobject obj)
+{
+}
+
+static void DeleteLocalRef(JNIEnv *env, jobject obj)
+{
+	if( obj && obj != &audioBuffer && (obj->type == OBJ_STRING || obj->type == OBJ_BYTEARRAY || obj->type == OBJ_INTARRAY) )
+	{
+		free(obj->data);
+		free(obj);
+	}
+}
+
+static jclass GetObjectClass(JNIEnv *env, jobject obj)
+{
+	return &classObject;
+}
+
+static pthread_mutex_t methodsLock = PTHREAD_MUTEX_INITIALIZER;
+static struct _jmethodID methods[64];
+static int methodsCount = 0;
+
+static jmethodID GetMethodID(JNIEnv *env, jclass clazz, const char *name, const char *sig)
+{
+	jmethodID method = NULL;
+	int i;
+
+	pthread_mutex_lock(&methodsLock);
+	for( i = 0; i < methodsCount && !method; i++ )
+		if( !strcmp(methods[i].name, name) )
+			method = &methods[i];
+	if( !method && methodsCount < sizeof(methods) / sizeof(methods[0]) )
+	{
+		method = &methods[methodsCount++];
+		strncpy(method->name, name, sizeof(method->name) - 1);
+	}
+	pthread_mutex_unlock(&methodsLock);
+	return method;
+}
+
+/* ---------- Strings and arrays ---------- */
+
+static jobject newObject(int type, jsize len, void *data)
+{
+	jobject obj = (jobject) malloc(sizeof(struct _jobject));
+	obj->type = type;
+	obj->len = len;
+	obj->data = data;
+	return obj;
+}
+
+jstring HB_NewString(const char *str)
+{
+	return newObject(OBJ_STRING, strlen(str), strdup(str));
+}
+
+static jstring NewStringUTF(JNIEnv *env, const char *bytes)
+{
+	return bytes ? HB_NewString(bytes) : NULL;
+}
+
+static const char * GetStringUTFChars(JNIEnv *env, jstring str, jboolean *isCopy)
+{
+	if( isCopy )
+		*isCopy = JNI_FALSE;
+	return str ? (const char *) str->data : NULL;
+}
+
+static void ReleaseStringUTFChars(JNIEnv *env, jstring str, const char *chars)
+{
+}
+
+static jsize GetArrayLength(JNIEnv *env, jarray array)
+{
+	return array->len;
+}
+
+static jbyteArray NewByteArray(JNIEnv *env, jsize len)
+{
+	return newObject(OBJ_BYTEARRAY, len, calloc(1, len));
+}
+
+static jintArray NewIntArray(JNIEnv *env, jsize len)
+{
+	return newObject(OBJ_INTARRAY, len, calloc(len, sizeof(jint)));
+}
+
+static jbyte * GetByteArrayElements(JNIEnv *env, jbyteArray array, jboolean *isCopy)
+{
+	if( isCopy )
+		*isCopy = JNI_FALSE;
+	return (jbyte *) array->data;
+}
+
+static void ReleaseByteArrayElements(JNIEnv *env, jbyteArray array, jbyte *elems, jint mode)
+{
+}
+
+static void GetIntArrayRegion(JNIEnv *env, jintArray array, jsize start, jsize len, jint *buf)
+{
+	memcpy(buf, (jint *) array->data + start, len * sizeof(jint));
+}
+
+static void SetIntArrayRegion(JNIEnv *env, jintArray array, jsize start, jsize len, const jint *buf)
+{
+	memcpy((jint *) array->data + start, buf, len * sizeof(jint));
+}
+
+static void * GetPrimitiveArrayCritical(JNIEnv *env, jarray array, jboolean *isCopy)
+{
+	if( isCopy )
+		*isCopy = JNI_FALSE;
+	return array->data;
+}
+
+static void ReleasePrimitiveArrayCritical(JNIEnv *env, jarray array, void *carray, jint mode)
+{
+}
+
+static const struct JNINativeInterface nativeInterface =
+{
+	PushLocalFrame,
+	PopLocalFrame,
+	NewGlobalRef,
+	DeleteGlobalRef,
+	DeleteLocalRef,
+	GetObjectClass,
+	GetMethodID,
+	CallObjectMethod,
+	CallBooleanMethod,
+	CallIntMethod,
+	CallVoidMethod,
+	NewStringUTF,
+	GetStringUTFChars,
+	ReleaseStringUTFChars,
+	GetArrayLength,
+	NewByteArray,
+	NewIntArray,
+	GetByteArrayElements,
+	ReleaseByteArrayElements,
+	GetIntArrayRegion,
+	SetIntArrayRegion,
+	GetPrimitiveArrayCritical,
+	ReleasePrimitiveArrayCritical,
+};
+
+static JNIEnv jniEnv = &nativeInterface;
+JNIEnv *HB_JNIEnv = &jniEnv;
+
+/* ---------- Java VM ---------- */
+
+static jint AttachCurrentThread(JavaVM *vm, JNIEnv **penv, void *args)
+{
+	*penv = HB_JNIEnv;
+	return JNI_OK;
+}
+
+static jint DetachCurrentThread(JavaVM *vm)
+{
+	return JNI_OK;
+}
+
+static jint GetEnv(JavaVM *vm, void **penv, jint version)
+{
+	*penv = HB_JNIEnv;
+	return JNI_OK;
+}
+
+static const struct JNIInvokeInterface invokeInterface =
+{
+	AttachCurrentThread,
+	DetachCurrentThread,
+	GetEnv,
+};
+
+static JavaVM javaVM = &invokeInterface;
+JavaVM *HB_JavaVM = &javaVM;
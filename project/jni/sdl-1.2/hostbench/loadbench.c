@@ -0,0 +1,179 @@
+/*
+    Asset loading benchmark for the host build: reads every file under
+    the given directories, or under the current directory, through
+    SDL_RWops the way image, sound and font loaders do, and prints the
+    time spent per backend.
+
+    Unpack the data of an application first, the same way the Java side
+    does on the device, and run:
+
+      make APP_SRCS=loadbench.c
+      unzip -d /tmp/data ../../application/APP/AndroidData/FILE.zip
+      ./hostbench -frames 0 -C /tmp/data
+
+    Each file is loaded in three ways:
+      small  16-byte reads, like header parsers and per-row loaders
+      bulk   one read of the whole file into a malloc()ed buffer
+      direct SDL_RWGetMemory(), like a zero-copy chunk or memory font
+    through SDL_RWFromFP() for the old stdio RWops, and SDL_RWFromFile()
+    for the memory one, buffered or memory-mapped depending on the size.
+    "direct" has no stdio variant.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include "SDL.h"
+
+#define REPEATS 10
+#define SMALL_READ 16
+
+enum { SMALL, BULK, DIRECT, MODES };
+static const char *modeNames[MODES] = { "small", "bulk", "direct" };
+
+static char **files = NULL;
+static int filesCount = 0;
+static long long totalBytes = 0;
+
+static double now(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void addFiles(const char *path)
+{
+	struct stat st;
+	DIR *dir;
+	struct dirent *ent;
+
+	if( stat(path, &st) < 0 )
+		return;
+	if( S_ISREG(st.st_mode) )
+	{
+		files = (char **) realloc(files, (filesCount + 1) * sizeof(char *));
+		files[filesCount++] = strdup(path);
+		totalBytes += st.st_size;
+		return;
+	}
+	if( !S_ISDIR(st.st_mode) || !(dir = opendir(path)) )
+		return;
+	while( (ent = readdir(dir)) )
+	{
+		char sub[4096];
+		if( !strcmp(ent->d_name, ".") || !strcmp(ent->d_name, "..") )
+			continue;
+		snprintf(sub, sizeof(sub), "%s/%s", path, ent->d_name);
+		addFiles(sub);
+	}
+	closedir(dir);
+}
+
+/* With check set, returns a checksum of the file, so the backends can be
+   compared; otherwise only touches every page, like a decoder would */
+static Uint32 load(SDL_RWops *rw, int mode, int check)
+{
+	Uint8 buf[SMALL_READ];
+	const Uint8 *data = NULL;
+	Uint8 *copy = NULL;
+	Uint32 sum = 0;
+	int size = 0, i, n;
+
+	if( !rw )
+		return 0;
+	if( mode == SMALL )
+	{
+		while( (n = SDL_RWread(rw, buf, 1, sizeof(buf))) > 0 )
+			for( i = 0; check && i < n; i++ )
+				sum = sum * 31 + buf[i];
+	}
+	else
+	{
+		if( mode == DIRECT )
+			data = (const Uint8 *) SDL_RWGetMemory(rw, &size);
+		else
+		{
+			size = SDL_RWseek(rw, 0, RW_SEEK_END);
+			SDL_RWseek(rw, 0, RW_SEEK_SET);
+			data = copy = (Uint8 *) malloc(size > 0 ? size : 1);
+			size = SDL_RWread(rw, copy, 1, size);
+		}
+		for( i = 0; data && i < size; i += check ? 1 : 4096 )
+			sum = sum * 31 + data[i];
+		free(copy);
+	}
+	SDL_RWclose(rw);
+	return sum;
+}
+
+static double run(int useMemory, int mode, int check, Uint32 *sums)
+{
+	double start = now();
+	int r, i;
+
+	for( r = 0; r < (check ? 1 : REPEATS); r++ )
+		for( i = 0; i < filesCount; i++ )
+		{
+			SDL_RWops *rw;
+			if( useMemory )
+				rw = SDL_RWFromFile(files[i], "rb");
+			else
+			{
+				FILE *fp = fopen(files[i], "rb");
+				rw = fp ? SDL_RWFromFP(fp, 1) : NULL;
+			}
+			sums[i] = load(rw, mode, check);
+		}
+	return (now() - start) * 1000.0 / r;
+}
+
+int main(int argc, char *argv[])
+{
+	Uint32 *stdioSums, *memSums;
+	int mode, i, mismatch = 0;
+
+	for( i = 1; i < argc; i++ )
+		addFiles(argv[i]);
+	if( argc <= 1 )
+		addFiles(".");
+	if( !filesCount )
+	{
+		printf("loadbench: no files found\n");
+		return 1;
+	}
+
+	stdioSums = (Uint32 *) calloc(filesCount, sizeof(Uint32));
+	memSums = (Uint32 *) calloc(filesCount, sizeof(Uint32));
+	/* Warm up the page cache, cold reads measure the flash, not SDL */
+	run(0, BULK, 0, stdioSums);
+
+	printf("loadbench: %d files, %lld bytes, average of %d runs\n", filesCount, totalBytes, REPEATS);
+	printf("%-8s %12s %12s\n", "", "stdio, ms", "memory, ms");
+	for( mode = 0; mode < MODES; mode++ )
+	{
+		double stdioMs = 0, memMs;
+		if( mode != DIRECT )
+			stdioMs = run(0, mode, 0, stdioSums);
+		memMs = run(1, mode, 0, memSums);
+		if( mode == DIRECT )
+			printf("%-8s %12s %12.2f\n", modeNames[mode], "-", memMs);
+		else
+			printf("%-8s %12.2f %12.2f\n", modeNames[mode], stdioMs, memMs);
+		/* "direct" is checked against the sums of "bulk" */
+		if( mode != DIRECT )
+			run(0, mode, 1, stdioSums);
+		run(1, mode, 1, memSums);
+		for( i = 0; i < filesCount; i++ )
+			if( stdioSums[i] != memSums[i] )
+				mismatch++;
+	}
+	if( mismatch )
+		printf("loadbench: %d files read differently from memory\n", mismatch);
+	free(stdioSums);
+	free(memSums);
+	return mismatch != 0;
+}
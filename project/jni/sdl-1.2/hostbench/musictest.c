@@ -0,0 +1,92 @@
+/*
+    Music restart check for the host build: plays a WAV whose every frame
+    holds its own number as music, and restarts it with Mix_PlayMusic()
+    at random moments while it plays. A post-mix hook checks that every
+    frame heard is the one after the last, or the first frame of the
+    music after a restart. Audio left over from before a restart, like a
+    decode-ahead ring that was not flushed right, shows up as a jump.
+
+      M=../../sdl_mixer; make APP_SRCS="musictest.c $M/mixer.c $M/music.c \
+        $M/wavestream.c $M/effect_position.c $M/effect_stereoreverse.c \
+        $M/effects_internal.c $M/load_aiff.c $M/load_voc.c" \
+        APP_CFLAGS="-DWAV_MUSIC -I$M/include -I$M"
+      ./hostbench -frames 0 -- [decode ahead ms]
+
+    Run it with 0, the synchronous decoders, and with a decode-ahead
+    time. It prints the number of bad frames, which should be 0.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "SDL.h"
+#include "SDL_mixer.h"
+
+#define FREQ 44100
+static volatile Uint32 last = 0;	/* last frame number heard, 0 for none */
+static volatile int bad = 0, restarts_heard = 0, frames_heard = 0;
+
+static void writeWav(const char *path, int n)
+{
+	FILE *f = fopen(path, "wb");
+	Uint32 v, i;
+	Uint16 w;
+	fwrite("RIFF", 1, 4, f); v = 36 + n * 4; fwrite(&v, 4, 1, f);
+	fwrite("WAVEfmt ", 1, 8, f); v = 16; fwrite(&v, 4, 1, f);
+	w = 1; fwrite(&w, 2, 1, f); w = 2; fwrite(&w, 2, 1, f);
+	v = FREQ; fwrite(&v, 4, 1, f); v = FREQ * 4; fwrite(&v, 4, 1, f);
+	w = 4; fwrite(&w, 2, 1, f); w = 16; fwrite(&w, 2, 1, f);
+	fwrite("data", 1, 4, f); v = n * 4; fwrite(&v, 4, 1, f);
+	/* frame i (from 1) holds i: low 15 bits left, the rest right */
+	for (i = 1; i <= (Uint32)n; i++) {
+		Sint16 l = i & 0x7fff, r = i >> 15;
+		fwrite(&l, 2, 1, f); fwrite(&r, 2, 1, f);
+	}
+	fclose(f);
+}
+
+static void postmix(void *udata, Uint8 *stream, int len)
+{
+	Sint16 *s = (Sint16 *)stream;
+	int i;
+	for (i = 0; i < len / 4; i++) {
+		Uint32 v = (Uint16)s[2*i] | ((Uint32)(Uint16)s[2*i+1] << 15);
+		if (v == 0)
+			continue;	/* silence: halted, starting or underrun */
+		if (v == 1 && last != 0)
+			restarts_heard++;
+		else if (last != 0 ? v != last + 1 : v != 1) {
+			if (bad < 10)
+				printf("musictest: heard frame %u after %u\n", v, last);
+			bad++;
+		}
+		last = v;
+		frames_heard++;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int ahead = argc > 1 ? atoi(argv[1]) : 0, i;
+	Mix_Music *mus;
+	SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO);
+	SDL_SetVideoMode(320, 240, 16, SDL_SWSURFACE);
+	writeWav("musictest.wav", FREQ * 20);
+	Mix_SetMusicDecodeAhead(ahead);
+	if (Mix_OpenAudio(FREQ, AUDIO_S16SYS, 2, 1024) < 0) { printf("open failed\n"); return 1; }
+	mus = Mix_LoadMUS("musictest.wav");
+	Mix_VolumeMusic(MIX_MAX_VOLUME);
+	Mix_SetPostMix(postmix, NULL);
+	srand(1);
+	for (i = 0; i < 1000; i++) {
+		Mix_PlayMusic(mus, 0);
+		SDL_Delay(rand() % 40);
+	}
+	SDL_Delay(100);
+	Mix_HaltMusic();
+	printf("musictest: ahead %d ms, %d restarts, %d heard, %d frames, %d bad\n", ahead, i, restarts_heard, frames_heard, bad);
+	Mix_FreeMusic(mus);
+	remove("musictest.wav");
+	Mix_CloseAudio();
+	SDL_Quit();
+	return bad != 0;
+}
@@ -0,0 +1,145 @@
+/*
+    Built-in application of the host benchmark: draws moving rectangles and
+    a cursor under the finger into a software surface, and plays a tone.
+
+    Application arguments, after "--" on the hostbench command line:
+      -audioformat FORMAT  u8, s8, u16, s16, u16msb or s16msb, default s16;
+                           every format plays the same tone, so the output of
+                           hostbench -audioout is the same for all 16-bit ones
+                           and for both 8-bit ones
+      -audiosamples N      audio buffer size in samples, default 1024
+*/
+
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include "SDL.h"
+#include "SDL_endian.h"
+
+#define RECTS 64
+
+static Uint16 audioFormat = AUDIO_S16SYS;
+
+static void audioCallback(void *userdata, Uint8 *stream, int len)
+{
+	static double phase = 0;
+	int sampleSize = (audioFormat & 0xff) / 8;
+	int i;
+
+	for( i = 0; i < len / sampleSize / 2; i++ )
+	{
+		Sint16 v = (Sint16)(sin(phase) * 4000);
+		Uint16 u = (Uint16) v;
+		phase += 2 * M_PI * 440 / 44100;
+
+		if( audioFormat == AUDIO_U16LSB || audioFormat == AUDIO_U16MSB )
+			u ^= 0x8000;
+		if( audioFormat == AUDIO_S16LSB || audioFormat == AUDIO_U16LSB )
+			u = SDL_SwapLE16(u);
+		if( audioFormat == AUDIO_S16MSB || audioFormat == AUDIO_U16MSB )
+			u = SDL_SwapBE16(u);
+
+		if( sampleSize == 1 )
+			stream[i * 2] = stream[i * 2 + 1] = (Uint8)(v >> 8) ^ (audioFormat == AUDIO_U8 ? 0x80 : 0);
+		else
+			((Uint16 *) stream)[i * 2] = ((Uint16 *) stream)[i * 2 + 1] = u;
+	}
+	phase = fmod(phase, 2 * M_PI);
+}
+
+static Uint16 parseAudioFormat(const char *name)
+{
+	static const struct { const char *name; Uint16 format; } formats[] = {
+		{ "u8", AUDIO_U8 }, { "s8", AUDIO_S8 },
+		{ "u16", AUDIO_U16LSB }, { "s16", AUDIO_S16LSB },
+		{ "u16msb", AUDIO_U16MSB }, { "s16msb", AUDIO_S16MSB },
+	};
+	int i;
+
+	for( i = 0; i < (int)(sizeof(formats) / sizeof(formats[0])); i++ )
+		if( !strcmp(name, formats[i].name) )
+			return formats[i].format;
+	return AUDIO_S16SYS;
+}
+
+int main(int argc, char *argv[])
+{
+	SDL_Surface *screen;
+	SDL_AudioSpec spec;
+	SDL_Rect rects[RECTS];
+	int speed[RECTS][2];
+	int quit = 0, frame = 0, samples = 1024, i;
+
+	for( i = 1; i < argc; i++ )
+	{
+		if( !strcmp(argv[i], "-audioformat") && i + 1 < argc )
+			audioFormat = parseAudioFormat(argv[++i]);
+		else if( !strcmp(argv[i], "-audiosamples") && i + 1 < argc )
+			samples = atoi(argv[++i]);
+	}
+
+	if( SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0 )
+		return 1;
+	screen = SDL_SetVideoMode(640, 480, 16, SDL_SWSURFACE);
+	if( !screen )
+		return 1;
+
+	spec.freq = 44100;
+	spec.format = audioFormat;
+	spec.channels = 2;
+	spec.samples = samples;
+	spec.callback = audioCallback;
+	spec.userdata = NULL;
+	if( SDL_OpenAudio(&spec, NULL) == 0 )
+		SDL_PauseAudio(0);
+
+	for( i = 0; i < RECTS; i++ )
+	{
+		rects[i].x = (i * 97) % (screen->w - 64);
+		rects[i].y = (i * 53) % (screen->h - 64);
+		rects[i].w = rects[i].h = 32 + i % 32;
+		speed[i][0] = i % 7 - 3;
+		speed[i][1] = i % 5 - 2;
+	}
+
+	while( !quit )
+	{
+		SDL_Event event;
+		SDL_Rect cursor;
+		int x, y;
+
+		while( SDL_PollEvent(&event) )
+		{
+			if( event.type == SDL_QUIT )
+				quit = 1;
+			if( event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE )
+				quit = 1;
+		}
+
+		SDL_FillRect(screen, NULL, SDL_MapRGB(screen->format, 0, 0, frame & 0xff));
+		for( i = 0; i < RECTS; i++ )
+		{
+			SDL_Rect r = rects[i];
+			SDL_FillRect(screen, &r, SDL_MapRGB(screen->format, i * 4, 255 - i * 4, (i * 16) & 0xff));
+			rects[i].x += speed[i][0];
+			rects[i].y += speed[i][1];
+			if( rects[i].x < 0 || rects[i].x + rects[i].w > screen->w )
+				speed[i][0] = -speed[i][0];
+			if( rects[i].y < 0 || rects[i].y + rects[i].h > screen->h )
+				speed[i][1] = -speed[i][1];
+		}
+
+		SDL_GetMouseState(&x, &y);
+		cursor.x = x - 8;
+		cursor.y = y - 8;
+		cursor.w = cursor.h = 16;
+		SDL_FillRect(screen, &cursor, SDL_MapRGB(screen->format, 255, 255, 255));
+
+		SDL_Flip(screen);
+		frame++;
+	}
+
+	SDL_CloseAudio();
+	SDL_Quit();
+	return 0;
+}
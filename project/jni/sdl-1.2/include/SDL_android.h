@@ -47,6 +47,16 @@ extern DECLSPEC int SDLCALL SDL_ANDROID_SetApplicationPutToBackgroundCallback(
 extern DECLSPEC int SDLCALL SDL_ANDROID_PauseAudioPlayback(void);
 extern DECLSPEC int SDLCALL SDL_ANDROID_ResumeAudioPlayback(void);
 
+/*
+Get statistics of audio playback. The audio callback fills periods of the size and format the application requested,
+they are converted into a ring buffer, and another thread writes periods of the size Java asked for to AudioTrack.
+callbacks is the amount of audio callbacks, avgCallbackUs and maxCallbackUs is the time they took in microseconds,
+writes is the amount of periods written to AudioTrack, underruns is the amount of times the ring had no period
+to write because the callback was late, latencyMs is the audio queued in the ring when the last period was written.
+Any pointer may be NULL. Returns 0 if audio is not opened.
+*/
+extern DECLSPEC int SDLCALL SDL_ANDROID_GetAudioStats(int *callbacks, int *avgCallbackUs, int *maxCallbackUs, int *writes, int *underruns, int *latencyMs);
+
 /*
 Get the advertisement size, position and visibility.
 If the advertisement is not yet loaded, this function will return zero width and height,
@@ -79,6 +89,51 @@ extern DECLSPEC int SDLCALL SDL_ANDROID_SetAdvertisementPosition(int x, int y);
 extern DECLSPEC int SDLCALL SDL_ANDROID_RequestNewAdvertisement(void);
 
 
+/*
+Get statistics of pipelined multithreaded video mode, which is enabled by setting environment variable
+SDL_ANDROID_VIDEO_PIPELINE to 1 or 2 (amount of frames that SDL_Flip() may queue without waiting)
+before calling SDL_SetVideoMode(), it requires MultiThreadedVideo=y and SW video mode.
+frames is the amount of frames shown, latency is the time in milliseconds between SDL_Flip() and buffer swap.
+Any pointer may be NULL. Returns 0 if pipelined video is not active.
+*/
+extern DECLSPEC int SDLCALL SDL_ANDROID_GetVideoPipelineStats(int *frames, int *avgLatencyMs, int *maxLatencyMs);
+
+/*
+Get statistics of the last restore of HW surfaces after OpenGL context was lost, when the app was put to background.
+Surfaces used during the last 60 frames, or the amount of frames set by environment variable
+SDL_ANDROID_VIDEO_RESTORE_FRAMES before calling SDL_SetVideoMode(), are restored before the first frame is shown,
+the rest are restored when they are blitted or locked for the first time.
+restoreMs is the time spent before the first frame, restoredSurfaces is the amount of surfaces restored then,
+pendingSurfaces is the amount of surfaces still not restored, lazyRestoredSurfaces is the amount of surfaces
+restored on first use. Any pointer may be NULL. Returns 0 if SDL_ANDROID_VIDEO_RESTORE_FRAMES is 0,
+which restores all surfaces before the first frame.
+*/
+extern DECLSPEC int SDLCALL SDL_ANDROID_GetVideoRestoreStats(int *restoreMs, int *restoredSurfaces, int *pendingSurfaces, int *lazyRestoredSurfaces);
+
+/*
+Get statistics of lock-free event queue, which is enabled by LockFreeEventQueue=y in AndroidAppSettings.cfg.
+coalesced is the amount of motion events skipped because a newer motion event of the same pointer was queued,
+dropped is the amount of events lost because the queue was full. Any pointer may be NULL.
+Returns 0 if lock-free event queue is not used.
+*/
+extern DECLSPEC int SDLCALL SDL_ANDROID_GetInputQueueStats(int *coalesced, int *dropped);
+
+/*
+Get statistics of the last frame drawn by the GLES renderer, which draws HW surfaces and the SW video surface.
+drawCalls is the amount of OpenGL draw calls, copies is the amount of SDL_RenderCopy() calls, which are merged
+into a single draw call while they use the same texture, blend mode, scale mode and color modulation.
+Any pointer may be NULL. Returns 0 if batching is disabled by setting environment variable
+SDL_ANDROID_VIDEO_BATCH to 0 before calling SDL_SetVideoMode().
+*/
+extern DECLSPEC int SDLCALL SDL_ANDROID_GetRenderStats(int *drawCalls, int *copies);
+
+/*
+Get statistics of the last frame drawn by the GLES renderer: skippedCalls is the amount of OpenGL state calls
+not issued because the state was already set, uploadedBytes is the amount of texture data sent to OpenGL.
+Any pointer may be NULL. Returns 1.
+*/
+extern DECLSPEC int SDLCALL SDL_ANDROID_GetRenderStateStats(int *skippedCalls, int *uploadedBytes);
+
 /** Exports for Java environment and Video object instance */
 extern DECLSPEC JavaVM* SDL_ANDROID_JavaVM();
 
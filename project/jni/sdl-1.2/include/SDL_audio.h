@@ -229,6 +229,14 @@ extern DECLSPEC void SDLCALL SDL_FreeWAV(Uint8 *audio_buf);
  * by SDL_ConvertAudio() to convert a buffer of audio data from one format
  * to the other.
  *
+ * Rate conversion uses a windowed sinc filter, which also converts the
+ * format and between mono and stereo in the same pass. The environment
+ * variable SDL_AUDIO_RESAMPLER picks its quality: "fast", "medium" (the
+ * default) or "best", or "legacy" for the old filters, which only convert
+ * by powers of two, by repeating or dropping samples, but are about ten
+ * times faster. SDL_ConvertAudio() filters each buffer on its own, so
+ * streams converted a buffer at a time should use SDL_NewAudioCVTStream().
+ *
  * @return This function returns 0, or -1 if there was an error.
  */
 extern DECLSPEC int SDLCALL SDL_BuildAudioCVT(SDL_AudioCVT *cvt,
@@ -246,6 +254,41 @@ extern DECLSPEC int SDLCALL SDL_BuildAudioCVT(SDL_AudioCVT *cvt,
  */
 extern DECLSPEC int SDLCALL SDL_ConvertAudio(SDL_AudioCVT *cvt);
 
+/** The resampler state of a stream, see SDL_NewAudioCVTStream() */
+typedef struct SDL_AudioCVTStream SDL_AudioCVTStream;
+
+/**
+ * Sets up the state to convert a stream with a cvt built by
+ * SDL_BuildAudioCVT(), a buffer of at most max_len bytes at a time.
+ * The rate conversion then carries its filter history and the position
+ * of the next sample from a buffer to the next, so the output is the
+ * same as if the stream had been converted as a whole, only late by half
+ * the filter length. Everything the conversion needs is allocated here,
+ * so SDL_ConvertAudioStream() can run in the audio callback.
+ *
+ * @return The stream state, or NULL if out of memory. Build the cvt
+ * again and get a new state to change the conversion.
+ */
+extern DECLSPEC SDL_AudioCVTStream * SDLCALL SDL_NewAudioCVTStream(const SDL_AudioCVT *cvt, int max_len);
+
+/**
+ * Converts the next buffer of a stream in place, like SDL_ConvertAudio().
+ * The number of bytes it gives for a buffer varies from call to call,
+ * the total follows len_ratio. With a NULL stream this is just
+ * SDL_ConvertAudio().
+ */
+extern DECLSPEC int SDLCALL SDL_ConvertAudioStream(SDL_AudioCVTStream *stream, SDL_AudioCVT *cvt);
+
+/**
+ * Forgets the filter history and position of a stream, for a source which
+ * seeks, rewinds or loops: the next buffer starts the stream again, as if
+ * the state had just been created. NULL is ignored.
+ */
+extern DECLSPEC void SDLCALL SDL_ResetAudioCVTStream(SDL_AudioCVTStream *stream);
+
+/** Frees a stream state from SDL_NewAudioCVTStream(), NULL is ignored */
+extern DECLSPEC void SDLCALL SDL_FreeAudioCVTStream(SDL_AudioCVTStream *stream);
+
 
 #define SDL_MIX_MAXVOLUME 128
 /**
@@ -257,6 +300,22 @@ extern DECLSPEC int SDLCALL SDL_ConvertAudio(SDL_AudioCVT *cvt);
  */
 extern DECLSPEC void SDLCALL SDL_MixAudio(Uint8 *dst, const Uint8 *src, Uint32 len, int volume);
 
+/** One source buffer for SDL_MixAudioMulti() */
+typedef struct SDL_MixAudioSource {
+	const Uint8 *src;	/**< Samples in the playing audio format */
+	Uint32 offset;		/**< Position in the destination buffer where mixing starts, in bytes */
+	Uint32 len;		/**< Length of src in bytes */
+	int volume;		/**< Volume from 0 to SDL_MIX_MAXVOLUME */
+} SDL_MixAudioSource;
+
+/**
+ * This mixes several audio buffers into dst at once, dst is len bytes long.
+ * Samples are added up without clipping, and clipped once when written to dst,
+ * so it is faster and sounds cleaner than calling SDL_MixAudio() for each buffer.
+ * Sources must be inside of dst, their offsets and lengths must be multiples of sample size.
+ */
+extern DECLSPEC void SDLCALL SDL_MixAudioMulti(Uint8 *dst, Uint32 len, const SDL_MixAudioSource *sources, int count);
+
 /**
  * @name Audio Locks
  * The lock manipulated by these functions protects the callback function.
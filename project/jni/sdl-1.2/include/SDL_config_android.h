@@ -146,6 +146,7 @@
 #define HAVE_CLOCK_GETTIME 1
 #define HAVE_GETPAGESIZE 1
 #define HAVE_MPROTECT 1
+#define HAVE_MMAP 1
 
 #define HAVE_CEIL 1
 #define HAVE_COPYSIGN 1
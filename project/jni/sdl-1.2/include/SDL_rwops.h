@@ -110,6 +110,17 @@ extern DECLSPEC void SDLCALL SDL_FreeRW(SDL_RWops *area);
 
 /*@}*/
 
+/**
+ * Get a pointer to the data at the current read point, without copying it.
+ * Works for SDL_RWFromMem(), SDL_RWFromConstMem(), and for SDL_RWFromFile()
+ * on files opened read-only, which are memory-mapped where supported.
+ * The read point is not moved; 'size', if not NULL, is set to the number of
+ * bytes left. The data is read-only, and valid until SDL_RWclose().
+ *
+ * @return NULL if the data source is not in memory.
+ */
+extern DECLSPEC const void * SDLCALL SDL_RWGetMemory(SDL_RWops *context, int *size);
+
 /** @name Seek Reference Points */
 /*@{*/
 #define RW_SEEK_SET	0	/**< Seek from the beginning of data */
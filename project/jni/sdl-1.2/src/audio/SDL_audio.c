@@ -181,36 +181,54 @@ int SDLCALL SDL_RunAudio(void *audiop)
 	while ( audio->enabled ) {
 
 		/* Fill the current buffer with sound */
-		if ( audio->convert.needed ) {
-			if ( audio->convert.buf ) {
-				stream = audio->convert.buf;
-			} else {
-				continue;
-			}
-		} else {
-			stream = audio->GetAudioBuf(audio);
-			if ( stream == NULL ) {
-				stream = audio->fake_stream;
-			}
+		if ( audio->convert.needed && ! audio->convert.buf ) {
+			continue;
 		}
-
-		SDL_memset(stream, silence, stream_len);
-
-		if ( ! audio->paused ) {
-			SDL_mutexP(audio->mixer_lock);
-			(*fill)(udata, stream, stream_len);
-			SDL_mutexV(audio->mixer_lock);
+		stream = audio->GetAudioBuf(audio);
+		if ( stream == NULL ) {
+			stream = audio->fake_stream;
 		}
 
-		/* Convert the audio if necessary */
 		if ( audio->convert.needed ) {
-			SDL_ConvertAudio(&audio->convert);
-			stream = audio->GetAudioBuf(audio);
-			if ( stream == NULL ) {
-				stream = audio->fake_stream;
+			/* Rate conversion gives a sample more or less than the
+			   device buffer holds, what is left over starts the next
+			   device buffer */
+			int pos = 0, len;
+
+			while ( pos < audio->spec.size ) {
+				if ( audio->convert_left == 0 ) {
+					SDL_memset(audio->convert.buf, silence, stream_len);
+					if ( ! audio->paused ) {
+						SDL_mutexP(audio->mixer_lock);
+						(*fill)(udata, audio->convert.buf, stream_len);
+						SDL_mutexV(audio->mixer_lock);
+					}
+					SDL_ConvertAudioStream(audio->convert_stream,
+					                       &audio->convert);
+					audio->convert_left = audio->convert.len_cvt;
+					if ( audio->convert_left == 0 ) {
+						SDL_memset(stream + pos, audio->spec.silence,
+						           audio->spec.size - pos);
+						break;
+					}
+				}
+				len = audio->spec.size - pos;
+				if ( len > audio->convert_left ) {
+					len = audio->convert_left;
+				}
+				SDL_memcpy(stream + pos, audio->convert.buf +
+				           audio->convert.len_cvt - audio->convert_left, len);
+				audio->convert_left -= len;
+				pos += len;
+			}
+		} else {
+			SDL_memset(stream, silence, stream_len);
+
+			if ( ! audio->paused ) {
+				SDL_mutexP(audio->mixer_lock);
+				(*fill)(udata, stream, stream_len);
+				SDL_mutexV(audio->mixer_lock);
 			}
-			SDL_memcpy(stream, audio->convert.buf,
-			               audio->convert.len_cvt);
 		}
 
 		/* Ready current buffer for play and change current buffer */
@@ -535,8 +553,16 @@ int SDL_OpenAudio(SDL_AudioSpec *desired, SDL_AudioSpec *obtained)
 			return(-1);
 		}
 		if ( audio->convert.needed ) {
+			/* Whole frames for the callback, the sizes of the device
+			   buffers only match on average with rate conversion */
+			int frame_size = (desired->format & 0xFF) / 8 *
+			                 desired->channels;
 			audio->convert.len = (int) ( ((double) audio->spec.size) /
                                           audio->convert.len_ratio );
+			audio->convert.len -= audio->convert.len % frame_size;
+			if ( audio->convert.len < frame_size ) {
+				audio->convert.len = frame_size;
+			}
 			audio->convert.buf =(Uint8 *)SDL_AllocAudioMem(
 			   audio->convert.len*audio->convert.len_mult);
 			if ( audio->convert.buf == NULL ) {
@@ -544,6 +570,13 @@ int SDL_OpenAudio(SDL_AudioSpec *desired, SDL_AudioSpec *obtained)
 				SDL_OutOfMemory();
 				return(-1);
 			}
+			audio->convert_left = 0;
+			audio->convert_stream = SDL_NewAudioCVTStream(
+			   &audio->convert, audio->convert.len);
+			if ( audio->convert_stream == NULL ) {
+				SDL_CloseAudio();
+				return(-1);
+			}
 		}
 	}
 
@@ -639,7 +672,8 @@ void SDL_AudioQuit(void)
 		}
 		if ( audio->convert.needed ) {
 			SDL_FreeAudioMem(audio->convert.buf);
-
+			SDL_FreeAudioCVTStream(audio->convert_stream);
+			audio->convert_stream = NULL;
 		}
 		if ( audio->opened ) {
 			audio->CloseAudio(audio);
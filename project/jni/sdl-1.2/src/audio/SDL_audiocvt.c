@@ -23,7 +23,21 @@
 
 /* Functions for audio drivers to perform runtime conversion of audio format */
 
+#include <math.h>	/* Used for the sinc filter tables */
+
+#include "SDL_cpuinfo.h"
+#include "SDL_endian.h"
 #include "SDL_audio.h"
+#include "SDL_audiocvt_neon.h"
+
+#if SDL_ASSEMBLY_ROUTINES && defined(__GNUC__) && defined(__SSE2__)
+#define SDL_SSE2_RESAMPLER 1
+#include <emmintrin.h>
+#endif
+
+#ifndef M_PI
+#define M_PI	3.14159265358979323846
+#endif
 
 
 /* Effectively mix right and left channels into a single channel */
@@ -1300,6 +1314,585 @@ void SDLCALL SDL_RateSLOW(SDL_AudioCVT *cvt, Uint16 format)
 	}
 }
 
+/* Rate conversion with a polyphase windowed sinc filter.
+
+   The ratio src_rate/dst_rate is M/L in lowest terms: output sample i
+   is at input position i*M/L, and is the dot product of the input
+   around that position with the phase (i*M)%L of a Kaiser windowed sinc
+   filter. The filter is a table of 16 bit coefficients per phase, built
+   once per ratio and kept for the next conversions.
+
+   The filter is the last one of the chain, and also converts from the
+   format it is given to cvt->dst_format, and between mono and stereo,
+   so that the usual conversions of a sound to the device format are a
+   single pass over the data. Each call converts cvt->buf on its own,
+   the samples before and after the buffer are taken as its first and
+   last sample.
+
+   Streams converted a buffer at a time go through SDL_ConvertAudioStream()
+   instead, which runs the same filter on the planes of its stream state:
+   the last taps-1 input samples of a buffer stay in front of the next one,
+   along with the position of the next output sample, so the buffers are
+   filtered as one continuous signal. The output of a stream is late by
+   half the filter length, the history starts as its first sample.
+*/
+enum {
+	SDL_RESAMPLER_LEGACY = -1,
+	SDL_RESAMPLER_FAST,
+	SDL_RESAMPLER_MEDIUM,
+	SDL_RESAMPLER_BEST,
+	SDL_RESAMPLER_QUALITIES
+};
+
+/* Filter length in input samples when upsampling, Kaiser window beta,
+   and cutoff as a fraction of the lower of the two Nyquist frequencies.
+   The cutoff is in the middle of the transition band of the window, so
+   the stopband starts around the Nyquist frequency. The coefficients are
+   16 bit, the noise of their rounding grows with the taps and keeps any
+   filter at 82-90 dB below a loud sine, so best has just enough taps for
+   its stopband and wins over medium near the Nyquist frequency. */
+static const struct {
+	int taps;
+	double beta;
+	double cutoff;
+} SDL_resampler_params[SDL_RESAMPLER_QUALITIES] = {
+	{ 16, 5.0, 0.80 },	/* fast, ~55 dB stopband */
+	{ 32, 7.0, 0.86 },	/* medium, ~72 dB */
+	{ 56, 8.5, 0.90 }	/* best, ~85 dB */
+};
+
+#define SDL_RESAMPLER_MAX_TAPS		256
+#define SDL_RESAMPLER_MAX_PHASES	1024
+#define SDL_RESAMPLER_TABLES		16
+
+typedef struct SDL_ResampleTable {
+	int quality;
+	Uint32 L, M;
+	int taps;
+	int phases;
+	Sint16 *coeffs;		/* phases * taps */
+} SDL_ResampleTable;
+
+static SDL_ResampleTable *SDL_resample_tables[SDL_RESAMPLER_TABLES];
+
+/* The state of a stream, the cvt comes first so that the sinc filter in
+   its chain finds the rest from the cvt it is given */
+struct SDL_AudioCVTStream {
+	SDL_AudioCVT cvt;	/* copy of the caller's cvt the filters run on */
+	int rate_index;		/* of the sinc filter in the chain, or -1 */
+	int quality;
+	int src_channels, dst_channels;
+	SDL_ResampleTable *table;
+	int own_table;		/* not in the cache, freed with the stream */
+	Uint32 start;		/* next output sample, in 1/L input samples */
+	int primed;		/* the history holds input */
+	Sint16 *planebuf;	/* per plane: taps-1 samples of history, input */
+	int plane_len;
+};
+
+static int SDL_ResamplerQuality(void)
+{
+	const char *env = SDL_getenv("SDL_AUDIO_RESAMPLER");
+
+	if ( env ) {
+		if ( SDL_strcasecmp(env, "legacy") == 0 ) {
+			return SDL_RESAMPLER_LEGACY;
+		}
+		if ( SDL_strcasecmp(env, "fast") == 0 ) {
+			return SDL_RESAMPLER_FAST;
+		}
+		if ( SDL_strcasecmp(env, "best") == 0 ) {
+			return SDL_RESAMPLER_BEST;
+		}
+	}
+	return SDL_RESAMPLER_MEDIUM;
+}
+
+/* Finds M/L == rate_incr, the filter only gets the ratio as a double */
+static void SDL_ResampleRatio(double ratio, Uint32 *M, Uint32 *L)
+{
+	Uint32 p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+	double x = ratio;
+	int i;
+
+	for ( i=0; i<32; ++i ) {
+		Uint32 a = (Uint32)x, p2, q2;
+		p2 = a * p1 + p0;
+		q2 = a * q1 + q0;
+		if ( p2 > (1<<20) || q2 > (1<<20) ) {
+			break;
+		}
+		p0 = p1; q0 = q1;
+		p1 = p2; q1 = q2;
+		if ( fabs((double)p1 / q1 - ratio) <= ratio * 1e-12 ||
+		     x - a < 1e-9 ) {
+			break;
+		}
+		x = 1.0 / (x - a);
+	}
+	*M = p1;
+	*L = q1;
+}
+
+/* Modified Bessel function of the first kind, for the Kaiser window */
+static double SDL_ResampleBesselI0(double x)
+{
+	double sum = 1.0, term = 1.0;
+	int k;
+
+	for ( k=1; k<64 && term > sum * 1e-12; ++k ) {
+		term *= (x * x) / (4.0 * k * k);
+		sum += term;
+	}
+	return sum;
+}
+
+static SDL_ResampleTable *SDL_BuildResampleTable(int quality, Uint32 L, Uint32 M)
+{
+	SDL_ResampleTable *table;
+	double cutoff = SDL_resampler_params[quality].cutoff;
+	double beta = SDL_resampler_params[quality].beta;
+	double i0beta = SDL_ResampleBesselI0(beta);
+	double h[SDL_RESAMPLER_MAX_TAPS];
+	int taps = SDL_resampler_params[quality].taps;
+	int phase, k;
+
+	/* Downsampling needs a lower cutoff, and as many more taps to keep
+	   the same transition band in the output */
+	if ( M > L ) {
+		taps = (int)((double)taps * M / L + 7) & ~7;
+		if ( taps > SDL_RESAMPLER_MAX_TAPS ) {
+			taps = SDL_RESAMPLER_MAX_TAPS;
+		}
+		cutoff = cutoff * L / M;
+	}
+
+	table = (SDL_ResampleTable *)SDL_malloc(sizeof(*table));
+	if ( table == NULL ) {
+		return NULL;
+	}
+	table->quality = quality;
+	table->L = L;
+	table->M = M;
+	table->taps = taps;
+	table->phases = (L <= SDL_RESAMPLER_MAX_PHASES) ? L : SDL_RESAMPLER_MAX_PHASES;
+	table->coeffs = (Sint16 *)SDL_malloc(table->phases * taps * sizeof(Sint16));
+	if ( table->coeffs == NULL ) {
+		SDL_free(table);
+		return NULL;
+	}
+
+	for ( phase=0; phase<table->phases; ++phase ) {
+		Sint16 *coeffs = table->coeffs + phase * taps;
+		double frac = (double)phase / table->phases;
+		double sum = 0.0;
+		int total = 0;
+
+		/* Tap k is input sample ipos - taps/2 + 1 + k */
+		for ( k=0; k<taps; ++k ) {
+			double d = (k - taps/2 + 1) - frac;
+			double x = d / (taps/2);
+			double w = 1.0 - x * x;
+			double s = (d == 0.0) ? 1.0 : sin(M_PI * cutoff * d) / (M_PI * cutoff * d);
+			h[k] = (w > 0.0) ? cutoff * s * SDL_ResampleBesselI0(beta * sqrt(w)) / i0beta : 0.0;
+			sum += h[k];
+		}
+		/* Unity gain at DC for every phase. The rounding error is spread
+		   over the coefficients which were closest to rounding the other
+		   way, so each one stays within a step of the filter; put all on
+		   one coefficient, it would differ between the phases by several
+		   steps, and the phases would image the signal at -80 dB */
+		for ( k=0; k<taps; ++k ) {
+			h[k] = h[k] * 32768.0 / sum;
+			coeffs[k] = (Sint16)floor(h[k] + 0.5);
+			total += coeffs[k];
+		}
+		while ( total != 32768 ) {
+			int step = (total < 32768) ? 1 : -1, nearest = 0;
+			for ( k=1; k<taps; ++k ) {
+				if ( (h[k] - coeffs[k]) * step > (h[nearest] - coeffs[nearest]) * step ) {
+					nearest = k;
+				}
+			}
+			coeffs[nearest] += step;
+			total += step;
+		}
+	}
+	return table;
+}
+
+/* Returns the table for the ratio, *temporary is set if the caller has
+   to free it because the cache is full */
+static SDL_ResampleTable *SDL_GetResampleTable(int quality, Uint32 L, Uint32 M, int *temporary)
+{
+	SDL_ResampleTable *table;
+	int i;
+
+	for ( i=0; i<SDL_RESAMPLER_TABLES; ++i ) {
+		table = SDL_resample_tables[i];
+		if ( table && table->quality == quality &&
+		     table->L == L && table->M == M ) {
+			*temporary = 0;
+			return table;
+		}
+	}
+	table = SDL_BuildResampleTable(quality, L, M);
+	*temporary = 1;
+#ifdef __GNUC__
+	/* Two threads building the same table at once both keep theirs,
+	   that only costs a slot */
+	for ( i=0; table && i<SDL_RESAMPLER_TABLES; ++i ) {
+		if ( __sync_bool_compare_and_swap(&SDL_resample_tables[i], NULL, table) ) {
+			*temporary = 0;
+			break;
+		}
+	}
+#endif
+	return table;
+}
+
+static void SDL_FreeResampleTable(SDL_ResampleTable *table)
+{
+	if ( table ) {
+		SDL_free(table->coeffs);
+		SDL_free(table);
+	}
+}
+
+typedef Sint32 (*SDL_ResampleDotFunc)(const Sint16 *src, const Sint16 *coeffs, int taps);
+
+/* Sum of src * coeffs, taps is a multiple of 8 */
+static Sint32 SDL_ResampleDot_C(const Sint16 *src, const Sint16 *coeffs, int taps)
+{
+	Sint32 acc0 = 0, acc1 = 0;
+	int i;
+	for ( i=0; i<taps; i+=2 ) {
+		acc0 += src[i] * coeffs[i];
+		acc1 += src[i+1] * coeffs[i+1];
+	}
+	return acc0 + acc1;
+}
+
+#if SDL_SSE2_RESAMPLER
+static Sint32 SDL_ResampleDot_SSE2(const Sint16 *src, const Sint16 *coeffs, int taps)
+{
+	__m128i acc = _mm_setzero_si128();
+	int i;
+	for ( i=0; i<taps; i+=8 ) {
+		__m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+		__m128i h = _mm_loadu_si128((const __m128i *)(coeffs + i));
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(s, h));
+	}
+	acc = _mm_add_epi32(acc, _mm_srli_si128(acc, 8));
+	acc = _mm_add_epi32(acc, _mm_srli_si128(acc, 4));
+	return _mm_cvtsi128_si32(acc);
+}
+#endif /* SDL_SSE2_RESAMPLER */
+
+/* Filters count output samples of one channel from start/L on, src is
+   the padded plane, dst gets native 16 bit samples every stride samples */
+static void SDL_ResamplePlane(Sint16 *dst, int stride, const Sint16 *src,
+                              const SDL_ResampleTable *table, Uint32 start, int count)
+{
+	SDL_ResampleDotFunc dot = SDL_ResampleDot_C;
+	const Uint32 L = table->L;
+	const Uint32 step = table->M / L, frac = table->M % L;
+	const int taps = table->taps;
+	Uint32 ipos = start / L, phase = start % L;
+	int i;
+
+#if SDL_NEON_RESAMPLER
+	if ( SDL_HasNEON() ) {
+		dot = SDL_ResampleDot_NEON;
+	}
+#endif
+#if SDL_SSE2_RESAMPLER
+	if ( SDL_HasSSE2() ) {
+		dot = SDL_ResampleDot_SSE2;
+	}
+#endif
+	for ( i=0; i<count; ++i ) {
+		const Sint16 *coeffs;
+		Sint32 sample;
+
+		if ( table->phases == (int)L ) {
+			coeffs = table->coeffs + phase * taps;
+		} else {
+			coeffs = table->coeffs + (Uint32)(((Uint64)phase * table->phases) / L) * taps;
+		}
+		sample = (dot(src + ipos, coeffs, taps) + (1<<14)) >> 15;
+		if ( sample > 32767 ) {
+			sample = 32767;
+		} else if ( sample < -32768 ) {
+			sample = -32768;
+		}
+		*dst = (Sint16)sample;
+		dst += stride;
+
+		ipos += step;
+		phase += frac;
+		if ( phase >= L ) {
+			phase -= L;
+			++ipos;
+		}
+	}
+}
+
+/* Loads the input into planes of native 16 bit samples, averaging
+   stereo to mono if there is a single plane for two channels */
+#define SDL_RESAMPLE_LOAD(READ, size) \
+	for ( i=0; i<frames; ++i ) { \
+		const Uint8 *p = src + i * src_channels * (size); \
+		if ( planes < src_channels ) { \
+			planebuf[pad + i] = (Sint16)((READ(p) + READ(p + (size))) >> 1); \
+		} else { \
+			for ( c=0; c<planes; ++c ) { \
+				planebuf[c * plane_len + pad + i] = (Sint16)READ(p + c * (size)); \
+			} \
+		} \
+	}
+#define SDL_RESAMPLE_U8(p)	((Sint32)((p)[0] ^ 0x80) << 8)
+#define SDL_RESAMPLE_S8(p)	((Sint32)(Sint8)(p)[0] << 8)
+#define SDL_RESAMPLE_S16LSB(p)	((Sint32)(Sint16)((p)[0] | ((p)[1] << 8)))
+#define SDL_RESAMPLE_S16MSB(p)	((Sint32)(Sint16)(((p)[0] << 8) | (p)[1]))
+#define SDL_RESAMPLE_U16LSB(p)	((Sint32)(Sint16)(((p)[0] | ((p)[1] << 8)) ^ 0x8000))
+#define SDL_RESAMPLE_U16MSB(p)	((Sint32)(Sint16)((((p)[0] << 8) | (p)[1]) ^ 0x8000))
+
+/* Converts cvt->buf, on its own or as the next buffer of stream */
+static void SDL_RateSinc(SDL_AudioCVT *cvt, Uint16 format, int quality,
+                         int src_channels, int dst_channels,
+                         SDL_AudioCVTStream *stream)
+{
+	SDL_ResampleTable *table;
+	Uint32 M, L;
+	const Uint8 *src = cvt->buf;
+	Sint16 *planebuf, *out = (Sint16 *)cvt->buf;
+	Uint16 dst_format = cvt->dst_format;
+	int planes = (src_channels < dst_channels) ? src_channels : dst_channels;
+	int frames = cvt->len_cvt / (((format & 0xFF) / 8) * src_channels);
+	int temporary = 0, pad, plane_len, out_frames, out_samples, i, c;
+	Uint32 start = 0;
+	Uint64 end;
+
+	if ( stream ) {
+		table = stream->table;
+		M = table->M;
+		L = table->L;
+		start = stream->start;
+	} else {
+		SDL_ResampleRatio(cvt->rate_incr, &M, &L);
+		table = NULL;
+	}
+#ifdef DEBUG_CONVERT
+	fprintf(stderr, "Converting audio rate * %u/%u, %d -> %d channels\n",
+		L, M, src_channels, dst_channels);
+#endif
+	end = (Uint64)frames * L;
+	out_frames = (end > start) ? (int)((end - start + M - 1) / M) : 0;
+	if ( out_frames > cvt->len * cvt->len_mult / (2 * dst_channels) ) {
+		out_frames = cvt->len * cvt->len_mult / (2 * dst_channels);
+	}
+	out_samples = out_frames * dst_channels;
+
+	if ( stream ) {
+		/* The planes were allocated for the longest buffer of the
+		   stream, a longer one is not for the audio callback */
+		pad = table->taps - 1;
+		if ( frames > stream->plane_len - pad ) {
+			Sint16 *grown;
+			plane_len = pad + frames;
+			grown = (Sint16 *)SDL_malloc(planes * plane_len * sizeof(Sint16));
+			if ( grown == NULL ) {
+				cvt->len_cvt = 0;
+				return;
+			}
+			for ( c=0; c<planes; ++c ) {
+				SDL_memcpy(grown + c * plane_len,
+				           stream->planebuf + c * stream->plane_len,
+				           pad * sizeof(Sint16));
+			}
+			SDL_free(stream->planebuf);
+			stream->planebuf = grown;
+			stream->plane_len = plane_len;
+		}
+		planebuf = stream->planebuf;
+		plane_len = stream->plane_len;
+		if ( frames == 0 ) {
+			cvt->len_cvt = 0;
+			return;
+		}
+	} else {
+		table = SDL_GetResampleTable(quality, L, M, &temporary);
+		pad = table ? table->taps/2 : 0;
+		plane_len = pad - 1 + frames + pad;
+		planebuf = table ? (Sint16 *)SDL_malloc(planes * plane_len * sizeof(Sint16)) : NULL;
+		if ( planebuf == NULL || frames == 0 ) {
+			if ( temporary ) {
+				SDL_FreeResampleTable(table);
+			}
+			SDL_free(planebuf);
+			cvt->len_cvt = 0;
+			return;
+		}
+		--pad;	/* left padding, the filter is centered between two taps */
+	}
+
+	switch (format & 0x90FF) {
+		case AUDIO_U8:
+			SDL_RESAMPLE_LOAD(SDL_RESAMPLE_U8, 1);
+			break;
+		case AUDIO_S8:
+			SDL_RESAMPLE_LOAD(SDL_RESAMPLE_S8, 1);
+			break;
+		case AUDIO_U16LSB:
+			SDL_RESAMPLE_LOAD(SDL_RESAMPLE_U16LSB, 2);
+			break;
+		case AUDIO_S16LSB:
+			SDL_RESAMPLE_LOAD(SDL_RESAMPLE_S16LSB, 2);
+			break;
+		case AUDIO_U16MSB:
+			SDL_RESAMPLE_LOAD(SDL_RESAMPLE_U16MSB, 2);
+			break;
+		case AUDIO_S16MSB:
+			SDL_RESAMPLE_LOAD(SDL_RESAMPLE_S16MSB, 2);
+			break;
+	}
+	for ( c=0; c<planes; ++c ) {
+		Sint16 *plane = planebuf + c * plane_len;
+		if ( stream == NULL ) {
+			for ( i=0; i<pad; ++i ) {
+				plane[i] = plane[pad];
+			}
+			for ( i=pad+frames; i<plane_len; ++i ) {
+				plane[i] = plane[pad+frames-1];
+			}
+		} else if ( !stream->primed ) {
+			for ( i=0; i<pad; ++i ) {
+				plane[i] = plane[pad];
+			}
+		}
+	}
+
+	/* The input is all in the planes now, cvt->buf takes the output */
+	for ( c=0; c<planes; ++c ) {
+		SDL_ResamplePlane(out + c, dst_channels, planebuf + c * plane_len,
+		                  table, start, out_frames);
+	}
+	if ( planes < dst_channels ) {
+		for ( i=0; i<out_samples; i+=2 ) {
+			out[i+1] = out[i];
+		}
+	}
+	if ( stream ) {
+		/* The end of this buffer is the history of the next one */
+		for ( c=0; c<planes; ++c ) {
+			Sint16 *plane = planebuf + c * plane_len;
+			SDL_memmove(plane, plane + frames, pad * sizeof(Sint16));
+		}
+		stream->primed = 1;
+		stream->start = (Uint32)((start + (Uint64)out_frames * M > end) ?
+		                         start + (Uint64)out_frames * M - end : 0);
+	} else {
+		SDL_free(planebuf);
+		if ( temporary ) {
+			SDL_FreeResampleTable(table);
+		}
+	}
+
+	/* And to the destination format, in place */
+	switch (dst_format & 0x90FF) {
+		case AUDIO_U8:
+			for ( i=0; i<out_samples; ++i ) {
+				cvt->buf[i] = (Uint8)((out[i] >> 8) ^ 0x80);
+			}
+			break;
+		case AUDIO_S8:
+			for ( i=0; i<out_samples; ++i ) {
+				cvt->buf[i] = (Uint8)(out[i] >> 8);
+			}
+			break;
+		default:
+			if ( dst_format & 0x8000 ) {
+				if ( (dst_format & 0x1000) != (AUDIO_S16SYS & 0x1000) ) {
+					for ( i=0; i<out_samples; ++i ) {
+						out[i] = (Sint16)SDL_Swap16((Uint16)out[i]);
+					}
+				}
+			} else {
+				for ( i=0; i<out_samples; ++i ) {
+					Uint16 sample = (Uint16)out[i] ^ 0x8000;
+					if ( (dst_format & 0x1000) != (AUDIO_U16SYS & 0x1000) ) {
+						sample = SDL_Swap16(sample);
+					}
+					out[i] = (Sint16)sample;
+				}
+			}
+			break;
+	}
+	cvt->len_cvt = out_samples * ((dst_format & 0xFF) / 8);
+	if ( cvt->filters[++cvt->filter_index] ) {
+		cvt->filters[cvt->filter_index](cvt, dst_format);
+	}
+}
+
+#define SDL_RATE_SINC(q, name, src, dst) \
+static void SDLCALL SDL_RateSinc_##name##_##src##_##dst(SDL_AudioCVT *cvt, Uint16 format) \
+{ \
+	SDL_RateSinc(cvt, format, q, src, dst, NULL); \
+}
+#define SDL_RATE_SINC_QUALITY(q, name) \
+	SDL_RATE_SINC(q, name, 1, 1) \
+	SDL_RATE_SINC(q, name, 1, 2) \
+	SDL_RATE_SINC(q, name, 2, 1) \
+	SDL_RATE_SINC(q, name, 2, 2) \
+	SDL_RATE_SINC(q, name, 4, 4) \
+	SDL_RATE_SINC(q, name, 6, 6)
+SDL_RATE_SINC_QUALITY(SDL_RESAMPLER_FAST, fast)
+SDL_RATE_SINC_QUALITY(SDL_RESAMPLER_MEDIUM, medium)
+SDL_RATE_SINC_QUALITY(SDL_RESAMPLER_BEST, best)
+
+typedef void (SDLCALL *SDL_AudioFilter)(SDL_AudioCVT *cvt, Uint16 format);
+
+#define SDL_RATE_SINC_FILTERS(name) { \
+	SDL_RateSinc_##name##_1_1, SDL_RateSinc_##name##_1_2, \
+	SDL_RateSinc_##name##_2_1, SDL_RateSinc_##name##_2_2, \
+	SDL_RateSinc_##name##_4_4, SDL_RateSinc_##name##_6_6 }
+static const SDL_AudioFilter SDL_rate_sinc_filters[SDL_RESAMPLER_QUALITIES][6] = {
+	SDL_RATE_SINC_FILTERS(fast),
+	SDL_RATE_SINC_FILTERS(medium),
+	SDL_RATE_SINC_FILTERS(best)
+};
+
+/* Channels of the filters in each row of SDL_rate_sinc_filters */
+static const struct {
+	int src, dst;
+} SDL_rate_sinc_channels[6] = {
+	{ 1, 1 }, { 1, 2 }, { 2, 1 }, { 2, 2 }, { 4, 4 }, { 6, 6 }
+};
+
+/* Returns the sinc filter for the channels, or NULL */
+static SDL_AudioFilter SDL_GetRateSinc(int quality, int src_channels, int dst_channels)
+{
+	int index;
+
+	for ( index=0; index<(int)SDL_arraysize(SDL_rate_sinc_channels); ++index ) {
+		if ( SDL_rate_sinc_channels[index].src == src_channels &&
+		     SDL_rate_sinc_channels[index].dst == dst_channels ) {
+			return SDL_rate_sinc_filters[quality][index];
+		}
+	}
+	return NULL;
+}
+
+/* The sinc filter in the chain of a stream, the cvt is the stream's */
+static void SDLCALL SDL_RateSincStream(SDL_AudioCVT *cvt, Uint16 format)
+{
+	SDL_AudioCVTStream *stream = (SDL_AudioCVTStream *)cvt;
+
+	SDL_RateSinc(cvt, format, stream->quality,
+	             stream->src_channels, stream->dst_channels, stream);
+}
+
 int SDL_ConvertAudio(SDL_AudioCVT *cvt)
 {
 	/* Make sure there's data to convert */
@@ -1319,6 +1912,103 @@ int SDL_ConvertAudio(SDL_AudioCVT *cvt)
 	return(0);
 }
 
+SDL_AudioCVTStream *SDL_NewAudioCVTStream(const SDL_AudioCVT *cvt, int max_len)
+{
+	SDL_AudioCVTStream *stream;
+	Uint32 M, L;
+	int i, q, index, frame_size, planes;
+
+	stream = (SDL_AudioCVTStream *)SDL_malloc(sizeof(*stream));
+	if ( stream == NULL ) {
+		SDL_OutOfMemory();
+		return NULL;
+	}
+	SDL_memset(stream, 0, sizeof(*stream));
+	stream->rate_index = -1;
+
+	/* Find the sinc filter, there is nothing to keep without it */
+	for ( i=0; i<(int)SDL_arraysize(cvt->filters) && cvt->filters[i]; ++i ) {
+		for ( q=0; q<SDL_RESAMPLER_QUALITIES; ++q ) {
+			for ( index=0; index<(int)SDL_arraysize(SDL_rate_sinc_channels); ++index ) {
+				if ( cvt->filters[i] == SDL_rate_sinc_filters[q][index] ) {
+					stream->rate_index = i;
+					stream->quality = q;
+					stream->src_channels = SDL_rate_sinc_channels[index].src;
+					stream->dst_channels = SDL_rate_sinc_channels[index].dst;
+				}
+			}
+		}
+	}
+	if ( stream->rate_index < 0 ) {
+		return stream;
+	}
+
+	SDL_ResampleRatio(cvt->rate_incr, &M, &L);
+	stream->table = SDL_GetResampleTable(stream->quality, L, M, &stream->own_table);
+	if ( stream->table == NULL ) {
+		SDL_free(stream);
+		SDL_OutOfMemory();
+		return NULL;
+	}
+
+	/* The filters before the sinc filter keep the number of frames, but
+	   change their size when they are there, so the source frame size
+	   is only known without them */
+	frame_size = (cvt->src_format & 0xFF) / 8;
+	if ( stream->rate_index == 0 ) {
+		frame_size *= stream->src_channels;
+	}
+	planes = (stream->src_channels < stream->dst_channels) ?
+	         stream->src_channels : stream->dst_channels;
+	stream->plane_len = stream->table->taps - 1 + max_len / frame_size;
+	stream->planebuf = (Sint16 *)SDL_malloc(planes * stream->plane_len * sizeof(Sint16));
+	if ( stream->planebuf == NULL ) {
+		SDL_FreeAudioCVTStream(stream);
+		SDL_OutOfMemory();
+		return NULL;
+	}
+	return stream;
+}
+
+int SDL_ConvertAudioStream(SDL_AudioCVTStream *stream, SDL_AudioCVT *cvt)
+{
+	if ( stream == NULL || stream->rate_index < 0 ) {
+		return SDL_ConvertAudio(cvt);
+	}
+	if ( cvt->buf == NULL ) {
+		SDL_SetError("No buffer allocated for conversion");
+		return(-1);
+	}
+
+	/* Run the chain on the stream's cvt, with its own sinc filter */
+	stream->cvt = *cvt;
+	stream->cvt.filters[stream->rate_index] = SDL_RateSincStream;
+	stream->cvt.len_cvt = cvt->len;
+	stream->cvt.filter_index = 0;
+	stream->cvt.filters[0](&stream->cvt, cvt->src_format);
+	cvt->len_cvt = stream->cvt.len_cvt;
+	return(0);
+}
+
+void SDL_ResetAudioCVTStream(SDL_AudioCVTStream *stream)
+{
+	if ( stream ) {
+		stream->start = 0;
+		stream->primed = 0;
+	}
+}
+
+void SDL_FreeAudioCVTStream(SDL_AudioCVTStream *stream)
+{
+	if ( stream ) {
+		if ( stream->own_table ) {
+			SDL_FreeResampleTable(stream->table);
+		}
+		SDL_free(stream->planebuf);
+		SDL_free(stream);
+	}
+}
+
 /* Creates a set of audio filters to convert from one format to another. 
    Returns -1 if the format conversion is not supported, or 1 if the
    audio filter is set up.
@@ -1328,6 +2018,8 @@ int SDL_BuildAudioCVT(SDL_AudioCVT *cvt,
 	Uint16 src_format, Uint8 src_channels, int src_rate,
 	Uint16 dst_format, Uint8 dst_channels, int dst_rate)
 {
+	int quality;
+
 /*printf("Build format %04x->%04x, channels %u->%u, rate %d->%d\n",
 		src_format, dst_format, src_channels, dst_channels, src_rate, dst_rate);*/
 	/* Start off with no conversion necessary */
@@ -1336,6 +2028,36 @@ int SDL_BuildAudioCVT(SDL_AudioCVT *cvt,
 	cvt->filters[0] = NULL;
 	cvt->len_mult = 1;
 	cvt->len_ratio = 1.0;
+	cvt->rate_incr = 0.0;
+
+	/* Sounds at another rate are converted in a single pass by the sinc
+	   filter, which also does the format and mono/stereo conversion.
+	   Powers of two too: the legacy filters are faster there, but they
+	   repeat or drop samples, and 22050 Hz sounds on a 44100 Hz device
+	   are what most games play */
+	quality = SDL_ResamplerQuality();
+	if ( ((src_rate/100) != (dst_rate/100)) &&
+	     (quality != SDL_RESAMPLER_LEGACY) ) {
+		SDL_AudioFilter rate_cvt;
+		int src_size = (src_format & 0xFF) / 8 * src_channels;
+		int dst_size = (dst_format & 0xFF) / 8 * dst_channels;
+
+		rate_cvt = SDL_GetRateSinc(quality, src_channels, dst_channels);
+		if ( rate_cvt ) {
+			cvt->filters[cvt->filter_index++] = rate_cvt;
+			cvt->rate_incr = (double)src_rate / dst_rate;
+			cvt->len_ratio = (double)dst_rate / src_rate * dst_size / src_size;
+			/* The filter needs room for 16 bit samples before it
+			   converts them to the destination format */
+			cvt->len_mult = (int)(((Sint64)dst_rate * 2 * dst_channels +
+			                (Sint64)src_rate * src_size - 1) /
+			                ((Sint64)src_rate * src_size));
+			if ( cvt->len_mult < 1 ) {
+				cvt->len_mult = 1;
+			}
+			goto done;
+		}
+	}
 
 	/* First filter:  Endian conversion from src to dst */
 	if ( (src_format & 0x1000) != (dst_format & 0x1000)
@@ -1434,8 +2156,23 @@ int SDL_BuildAudioCVT(SDL_AudioCVT *cvt,
 	}
 
 	/* Do rate conversion */
-	cvt->rate_incr = 0.0;
-	if ( (src_rate/100) != (dst_rate/100) ) {
+	if ( ((src_rate/100) != (dst_rate/100)) &&
+	     (quality != SDL_RESAMPLER_LEGACY) ) {
+		/* Channels the sinc filter can't convert are done above */
+		SDL_AudioFilter rate_cvt;
+
+		rate_cvt = SDL_GetRateSinc(quality, src_channels, src_channels);
+		if ( rate_cvt == NULL ) {
+			return -1;
+		}
+		cvt->filters[cvt->filter_index++] = rate_cvt;
+		cvt->rate_incr = (double)src_rate / dst_rate;
+		cvt->len_ratio *= (double)dst_rate / src_rate;
+		cvt->len_mult *= (dst_rate + src_rate - 1) / src_rate;
+		if ( (dst_format & 0xFF) == 8 ) {
+			cvt->len_mult *= 2;
+		}
+	} else if ( (src_rate/100) != (dst_rate/100) ) {
 		Uint32 hi_rate, lo_rate;
 		int len_mult;
 		double len_ratio;
@@ -1498,6 +2235,7 @@ int SDL_BuildAudioCVT(SDL_AudioCVT *cvt,
 	}
 
 	/* Set up the filter information */
+done:
 	if ( cvt->filter_index != 0 ) {
 		cvt->needed = 1;
 		cvt->src_format = src_format;
@@ -0,0 +1,47 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#include "SDL_audio.h"
+#include "SDL_audiocvt_neon.h"
+
+#if SDL_NEON_RESAMPLER
+
+#include <arm_neon.h>
+
+/* Sum of src * coeffs, taps is a multiple of 8 */
+Sint32 SDL_ResampleDot_NEON(const Sint16 *src, const Sint16 *coeffs, int taps)
+{
+	int32x4_t acc = vdupq_n_s32(0);
+	int32x2_t sum;
+	int i;
+	for ( i=0; i<taps; i+=8 ) {
+		int16x8_t s = vld1q_s16(src + i);
+		int16x8_t h = vld1q_s16(coeffs + i);
+		acc = vmlal_s16(acc, vget_low_s16(s), vget_low_s16(h));
+		acc = vmlal_s16(acc, vget_high_s16(s), vget_high_s16(h));
+	}
+	sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+	return vget_lane_s32(vpadd_s32(sum, sum), 0);
+}
+
+#endif /* SDL_NEON_RESAMPLER */
@@ -30,6 +30,12 @@
 #include "SDL_mixer_MMX.h"
 #include "SDL_mixer_MMX_VC.h"
 #include "SDL_mixer_m68k.h"
+#include "SDL_mixer_neon.h"
+
+#if SDL_ASSEMBLY_ROUTINES && defined(__GNUC__) && defined(__SSE2__)
+#define SDL_SSE2_MIXER 1
+#include <emmintrin.h>
+#endif
 
 /* This table is used to add two sound values together and pin
  * the value to avoid overflow.  (used with permission from ARDI)
@@ -90,25 +96,25 @@ static const Uint8 mix8[] =
 #define ADJUST_VOLUME(s, v)	(s = (s*v)/SDL_MIX_MAXVOLUME)
 #define ADJUST_VOLUME_U8(s, v)	(s = (((s-128)*v)/SDL_MIX_MAXVOLUME)+128)
 
-void SDL_MixAudio (Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
+/* Mix the user-level audio format */
+static Uint16 SDL_MixFormat(void)
 {
-	Uint16 format;
-
-	if ( volume == 0 ) {
-		return;
-	}
-	/* Mix the user-level audio format */
 	if ( current_audio ) {
 		if ( current_audio->convert.needed ) {
-			format = current_audio->convert.src_format;
-		} else {
-			format = current_audio->spec.format;
+			return current_audio->convert.src_format;
 		}
-	} else {
-  		/* HACK HACK HACK */
-		format = AUDIO_S16;
+		return current_audio->spec.format;
+	}
+	/* HACK HACK HACK */
+	return AUDIO_S16;
+}
+
+void SDL_MixAudio (Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
+{
+	if ( volume == 0 ) {
+		return;
 	}
-	switch (format) {
+	switch (SDL_MixFormat()) {
 
 		case AUDIO_U8: {
 #if defined(__GNUC__) && defined(__M68000__) && !defined(__mcoldfire__) && defined(SDL_ASSEMBLY_ROUTINES)
@@ -262,3 +268,129 @@ void SDL_MixAudio (Uint8 *dst, const Uint8 *src, Uint32 len, int volume)
 	}
 }
 
+
+/* Samples of native 16-bit audio are added up in 32-bit block, and clipped once */
+#define MIX_BLOCK_SAMPLES	256
+
+#if SDL_SSE2_MIXER
+/* acc += (src * volume) >> 7, 8 samples at a time */
+static int SDL_MixAudio_SSE2_AddS16(Sint32 *acc, const Sint16 *src, int samples, int volume)
+{
+	const __m128i v = _mm_set1_epi32(volume);
+	const __m128i zero = _mm_setzero_si128();
+	int i;
+	for ( i=0; i+8<=samples; i+=8 ) {
+		__m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+		/* madd of (sample, 0) pairs with (volume, 0) pairs gives 32-bit products */
+		__m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(s, zero), v);
+		__m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(s, zero), v);
+		lo = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(acc + i)), _mm_srai_epi32(lo, 7));
+		hi = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(acc + i + 4)), _mm_srai_epi32(hi, 7));
+		_mm_storeu_si128((__m128i *)(acc + i), lo);
+		_mm_storeu_si128((__m128i *)(acc + i + 4), hi);
+	}
+	return i;
+}
+
+/* Saturating store, 8 samples at a time */
+static int SDL_MixAudio_SSE2_StoreS16(Sint16 *dst, const Sint32 *acc, int samples)
+{
+	int i;
+	for ( i=0; i+8<=samples; i+=8 ) {
+		__m128i lo = _mm_loadu_si128((const __m128i *)(acc + i));
+		__m128i hi = _mm_loadu_si128((const __m128i *)(acc + i + 4));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(lo, hi));
+	}
+	return i;
+}
+#endif /* SDL_SSE2_MIXER */
+
+static void SDL_MixAudio_AddS16(Sint32 *acc, const Sint16 *src, int samples, int volume)
+{
+	int i = 0;
+#if SDL_NEON_MIXER
+	if ( SDL_HasNEON() ) {
+		i = SDL_MixAudio_NEON_AddS16(acc, src, samples, volume);
+	}
+#endif
+#if SDL_SSE2_MIXER
+	if ( SDL_HasSSE2() ) {
+		i = SDL_MixAudio_SSE2_AddS16(acc, src, samples, volume);
+	}
+#endif
+	for ( ; i<samples; ++i ) {
+		acc[i] += (src[i] * volume) >> 7;
+	}
+}
+
+static void SDL_MixAudio_StoreS16(Sint16 *dst, const Sint32 *acc, int samples)
+{
+	const int max_audioval = ((1<<(16-1))-1);
+	const int min_audioval = -(1<<(16-1));
+	int i = 0;
+#if SDL_NEON_MIXER
+	if ( SDL_HasNEON() ) {
+		i = SDL_MixAudio_NEON_StoreS16(dst, acc, samples);
+	}
+#endif
+#if SDL_SSE2_MIXER
+	if ( SDL_HasSSE2() ) {
+		i = SDL_MixAudio_SSE2_StoreS16(dst, acc, samples);
+	}
+#endif
+	for ( ; i<samples; ++i ) {
+		Sint32 sample = acc[i];
+		if ( sample > max_audioval ) {
+			sample = max_audioval;
+		} else
+		if ( sample < min_audioval ) {
+			sample = min_audioval;
+		}
+		dst[i] = (Sint16)sample;
+	}
+}
+
+void SDL_MixAudioMulti (Uint8 *dst, Uint32 len, const SDL_MixAudioSource *sources, int count)
+{
+	Sint32 acc[MIX_BLOCK_SAMPLES];
+	Uint32 block, block_len;
+	int i;
+
+	if ( SDL_MixFormat() != AUDIO_S16SYS ) {
+		/* Other formats are rare, they are mixed one buffer at a time */
+		for ( i=0; i<count; ++i ) {
+			SDL_MixAudio(dst + sources[i].offset, sources[i].src, sources[i].len, sources[i].volume);
+		}
+		return;
+	}
+
+	for ( block=0; block<len; block+=block_len ) {
+		Sint16 *dst16 = (Sint16 *)(dst + block);
+		int samples, mixed = 0;
+
+		block_len = SDL_min(len - block, MIX_BLOCK_SAMPLES * 2);
+		samples = block_len / 2;
+		for ( i=0; i<count; ++i ) {
+			const SDL_MixAudioSource *source = &sources[i];
+			Uint32 start = SDL_max(source->offset, block);
+			Uint32 end = SDL_min(source->offset + source->len, block + block_len);
+			const Sint16 *src16;
+			int k;
+
+			if ( start >= end || source->volume == 0 ) {
+				continue;
+			}
+			if ( !mixed ) {
+				for ( k=0; k<samples; ++k ) {
+					acc[k] = dst16[k];
+				}
+				mixed = 1;
+			}
+			src16 = (const Sint16 *)(source->src + (start - source->offset));
+			SDL_MixAudio_AddS16(acc + (start - block) / 2, src16, (end - start) / 2, source->volume);
+		}
+		if ( mixed ) {
+			SDL_MixAudio_StoreS16(dst16, acc, samples);
+		}
+	}
+}
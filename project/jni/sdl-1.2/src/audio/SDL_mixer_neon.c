@@ -0,0 +1,60 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#include "SDL_audio.h"
+#include "SDL_mixer_neon.h"
+
+#if SDL_NEON_MIXER
+
+#include <arm_neon.h>
+
+/* acc += (src * volume) >> 7, 8 samples at a time */
+int SDL_MixAudio_NEON_AddS16(Sint32 *acc, const Sint16 *src, int samples, int volume)
+{
+	const int16x4_t v = vdup_n_s16(volume);
+	int i;
+	for ( i=0; i+8<=samples; i+=8 ) {
+		int16x8_t s = vld1q_s16(src + i);
+		int32x4_t lo = vld1q_s32(acc + i);
+		int32x4_t hi = vld1q_s32(acc + i + 4);
+		lo = vsraq_n_s32(lo, vmull_s16(vget_low_s16(s), v), 7);
+		hi = vsraq_n_s32(hi, vmull_s16(vget_high_s16(s), v), 7);
+		vst1q_s32(acc + i, lo);
+		vst1q_s32(acc + i + 4, hi);
+	}
+	return i;
+}
+
+/* Saturating store, 8 samples at a time */
+int SDL_MixAudio_NEON_StoreS16(Sint16 *dst, const Sint32 *acc, int samples)
+{
+	int i;
+	for ( i=0; i+8<=samples; i+=8 ) {
+		int16x4_t lo = vqmovn_s32(vld1q_s32(acc + i));
+		int16x4_t hi = vqmovn_s32(vld1q_s32(acc + i + 4));
+		vst1q_s16(dst + i, vcombine_s16(lo, hi));
+	}
+	return i;
+}
+
+#endif /* SDL_NEON_MIXER */
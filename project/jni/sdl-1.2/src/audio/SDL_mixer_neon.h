@@ -0,0 +1,35 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/*
+	NEON mix routines for SDL_MixAudioMulti(), SDL_mixer_neon.c is compiled
+	with -mfpu=neon on ARMv7, they are selected at runtime with SDL_HasNEON().
+	They return the amount of samples done, the rest is done in C.
+*/
+
+#if SDL_ASSEMBLY_ROUTINES && defined(__GNUC__) && \
+    (defined(__ARM_NEON__) || defined(__aarch64__) || defined(__ARM_ARCH_7A__))
+#define SDL_NEON_MIXER 1
+int SDL_MixAudio_NEON_AddS16(Sint32 *acc, const Sint16 *src, int samples, int volume);
+int SDL_MixAudio_NEON_StoreS16(Sint16 *dst, const Sint32 *acc, int samples);
+#endif
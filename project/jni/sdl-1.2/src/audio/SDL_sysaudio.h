@@ -70,6 +70,11 @@ struct SDL_AudioDevice {
 	/* An audio conversion block for audio format emulation */
 	SDL_AudioCVT convert;
 
+	/* The resampler state of the conversion, and how many converted
+	   bytes at the end of convert.buf are left for the next buffer */
+	SDL_AudioCVTStream *convert_stream;
+	int convert_left;
+
 	/* Current state flags */
 	int enabled;
 	int paused;
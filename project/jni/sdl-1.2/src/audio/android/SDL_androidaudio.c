@@ -41,6 +41,8 @@ If you compile this code with SDL 1.3 or newer, or use in some other way, the li
 #include <android/log.h>
 #include <string.h> // for memset()
 #include <pthread.h>
+#include <time.h>
+#include "SDL_endian.h"
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 
@@ -137,9 +139,34 @@ AudioBootStrap ANDROIDAUD_bootstrap = {
 static unsigned char * audioBuffer = NULL;
 static size_t audioBufferSize = 0;
 static Uint32 audioLastTick = 0;
-static unsigned char * shadowAppBuffer = NULL;
-static Uint32 shadowAppBufferPos = 0;
-static Uint32 shadowAppBufferSize = 0;
+
+// The application fills appBuffer in its own format, PlayAudio() converts it
+// into the ring, and the sink thread takes it from there in periods of the
+// size AudioTrack wants, so neither side has to wait for the other's period
+static Uint8 * appBuffer = NULL;
+static Uint32 appBufferSize = 0;
+static Uint16 appFormat = 0;
+static int appSampleSize = 0;
+static int deviceSampleSize = 0;
+static Uint32 appPeriodSize = 0; // appBufferSize converted to the device format
+static Uint8 * audioRing = NULL;
+static Uint32 audioRingSize = 0; // Power of 2
+static volatile Uint32 audioRingHead = 0;
+static volatile Uint32 audioRingTail = 0;
+static volatile int audioRingClosed = 0;
+static SDL_sem * audioRingData = NULL;
+static SDL_sem * audioRingSpace = NULL;
+static SDL_Thread * audioSinkThread = NULL;
+static int audioBytesPerSec = 0;
+
+// Stats for SDL_ANDROID_GetAudioStats()
+static Uint32 audioCallbackStart = 0;
+static int audioCallbacks = 0;
+static Uint64 audioCallbackTotalUs = 0;
+static int audioCallbackMaxUs = 0;
+static int audioWrites = 0;
+static int audioUnderruns = 0;
+static int audioLatencyMs = 0;
 
 // Extremely wicked JNI environment to call Java functions from C code
 static jbyteArray audioBufferJNI = NULL;
@@ -157,15 +184,77 @@ static jbyteArray recordingBufferJNI = NULL;
 static size_t recordingBufferSize = 0;
 
 
+static Uint32 ANDROIDAUD_Microseconds(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (Uint32)((Uint64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
 static Uint8 *ANDROIDAUD_GetAudioBuf(_THIS)
 {
-#ifdef SDL_AUDIO_APP_IGNORES_RETURNED_BUFFER_SIZE
-	return(shadowAppBuffer);
+	/* The application callback runs between this call and PlayAudio() */
+	audioCallbackStart = ANDROIDAUD_Microseconds();
+	return(appBuffer);
+}
+
+/* Converts samples from the application format to the device format:
+   8-bit samples to U8, which is what AudioTrack plays, the rest to S16 */
+static void ANDROIDAUD_ConvertAudio(const Uint8 * src, Uint8 * dst, int samples)
+{
+	int i;
+	switch( appFormat )
+	{
+		case AUDIO_U8:
+		case AUDIO_S16SYS:
+			memcpy(dst, src, samples * deviceSampleSize);
+			break;
+		case AUDIO_S8:
+			for( i = 0; i < samples; i++ )
+				dst[i] = src[i] ^ 0x80;
+			break;
+		case AUDIO_U16SYS:
+			for( i = 0; i < samples; i++ )
+				((Uint16 *)dst)[i] = ((const Uint16 *)src)[i] ^ 0x8000;
+			break;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+		case AUDIO_S16MSB:
 #else
-	return(audioBuffer);
+		case AUDIO_S16LSB:
 #endif
+			for( i = 0; i < samples; i++ )
+				((Uint16 *)dst)[i] = SDL_Swap16(((const Uint16 *)src)[i]);
+			break;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+		case AUDIO_U16MSB:
+#else
+		case AUDIO_U16LSB:
+#endif
+			for( i = 0; i < samples; i++ )
+				((Uint16 *)dst)[i] = SDL_Swap16(((const Uint16 *)src)[i]) ^ 0x8000;
+			break;
+#ifdef AUDIO_F32SYS
+		case AUDIO_F32LSB:
+		case AUDIO_F32MSB:
+			for( i = 0; i < samples; i++ )
+			{
+				union { Uint32 u; float f; } sample;
+				sample.u = ((const Uint32 *)src)[i];
+				if( appFormat != AUDIO_F32SYS )
+					sample.u = SDL_Swap32(sample.u);
+				if( sample.f >= 1.0f )
+					((Sint16 *)dst)[i] = 32767;
+				else if( sample.f <= -1.0f )
+					((Sint16 *)dst)[i] = -32768;
+				else
+					((Sint16 *)dst)[i] = (Sint16)(sample.f * 32767.0f);
+			}
+			break;
+#endif
+	}
 }
 
+static int ANDROIDAUD_SinkThread(void * unused);
 
 #if SDL_VERSION_ATLEAST(1,3,0)
 static int ANDROIDAUD_OpenAudio (_THIS, const char *devname, int iscapture)
@@ -178,21 +267,34 @@ static int ANDROIDAUD_OpenAudio (_THIS, SDL_AudioSpec *spec)
 	SDL_AudioSpec *audioFormat = spec;
 #endif
 
-	int bytesPerSample;
 	JNIEnv * jniEnv = NULL;
 
 	this->hidden = NULL;
 
-	if( ! (audioFormat->format == AUDIO_S8 || audioFormat->format == AUDIO_S16) )
+	switch( audioFormat->format )
 	{
-		__android_log_print(ANDROID_LOG_ERROR, "libSDL", "Application requested unsupported audio format - only S8 and S16 are supported");
-		return (-1); // TODO: enable format conversion? Don't know how to do that in SDL
+		case AUDIO_U8:
+		case AUDIO_S8:
+			deviceSampleSize = 1;
+			break;
+		case AUDIO_U16LSB:
+		case AUDIO_S16LSB:
+		case AUDIO_U16MSB:
+		case AUDIO_S16MSB:
+#ifdef AUDIO_F32SYS
+		case AUDIO_F32LSB:
+		case AUDIO_F32MSB:
+#endif
+			deviceSampleSize = 2;
+			break;
+		default:
+			__android_log_print(ANDROID_LOG_ERROR, "libSDL", "Application requested unsupported audio format 0x%x", (int)audioFormat->format);
+			return (-1);
 	}
+	appFormat = audioFormat->format;
+	appSampleSize = (audioFormat->format & 0xFF) / 8;
 
-	bytesPerSample = (audioFormat->format & 0xFF) / 8;
-	audioFormat->format = ( bytesPerSample == 2 ) ? AUDIO_S16 : AUDIO_S8;
-
-	__android_log_print(ANDROID_LOG_INFO, "libSDL", "ANDROIDAUD_OpenAudio(): app requested audio bytespersample %d freq %d channels %d samples %d", bytesPerSample, audioFormat->freq, (int)audioFormat->channels, (int)audioFormat->samples);
+	__android_log_print(ANDROID_LOG_INFO, "libSDL", "ANDROIDAUD_OpenAudio(): app requested audio format 0x%x freq %d channels %d samples %d", (int)audioFormat->format, audioFormat->freq, (int)audioFormat->channels, (int)audioFormat->samples);
 
 	if(audioFormat->samples <= 0)
 		audioFormat->samples = 16; // Some sane value
@@ -203,6 +305,9 @@ static int ANDROIDAUD_OpenAudio (_THIS, SDL_AudioSpec *spec)
 	}
 	
 	SDL_CalculateAudioSpec(audioFormat);
+	appBufferSize = audioFormat->size;
+	appPeriodSize = audioFormat->size / appSampleSize * deviceSampleSize;
+	audioBytesPerSec = audioFormat->freq * audioFormat->channels * deviceSampleSize;
 	
 	(*jniVM)->AttachCurrentThread(jniVM, &jniEnv, NULL);
 
@@ -215,7 +320,7 @@ static int ANDROIDAUD_OpenAudio (_THIS, SDL_AudioSpec *spec)
 	// The returned audioBufferSize may be huge, up to 100 Kb for 44100 because user may have selected large audio buffer to get rid of choppy sound
 	audioBufferSize = (*jniEnv)->CallIntMethod( jniEnv, JavaAudioThread, JavaInitAudio, 
 					(jint)audioFormat->freq, (jint)audioFormat->channels, 
-					(jint)(( bytesPerSample == 2 ) ? 1 : 0), (jint)(audioFormat->size) );
+					(jint)(( deviceSampleSize == 2 ) ? 1 : 0), (jint)appPeriodSize );
 
 	if( audioBufferSize == 0 )
 	{
@@ -227,19 +332,27 @@ static int ANDROIDAUD_OpenAudio (_THIS, SDL_AudioSpec *spec)
 	/* We cannot call DetachCurrentThread() from main thread or we'll crash */
 	/* (*jniVM)->DetachCurrentThread(jniVM); */
 
-#ifdef SDL_AUDIO_APP_IGNORES_RETURNED_BUFFER_SIZE
-	shadowAppBufferSize = audioFormat->size;
-	shadowAppBuffer = malloc(shadowAppBufferSize);
-	shadowAppBufferPos = 0;
-	if( shadowAppBufferSize > audioBufferSize )
-		__android_log_print(ANDROID_LOG_FATAL, "libSDL", "ANDROIDAUD_OpenAudio(): Java returned audio buffer smaller than app requested, SDL will crash!");
-#else
-	audioFormat->samples = audioBufferSize / bytesPerSample / audioFormat->channels;
-	audioFormat->size = audioBufferSize;
-#endif
+	/* The ring has to fit a period of each side, or they would wait for each other forever */
+	for( audioRingSize = 1024; audioRingSize < audioBufferSize + appPeriodSize; audioRingSize *= 2 )
+		;
+	audioRing = (Uint8 *) SDL_malloc(audioRingSize);
+	appBuffer = (Uint8 *) SDL_malloc(appBufferSize);
+	audioRingHead = audioRingTail = 0;
+	audioRingClosed = 0;
+	audioRingData = SDL_CreateSemaphore(0);
+	audioRingSpace = SDL_CreateSemaphore(0);
+	audioCallbacks = audioCallbackMaxUs = audioWrites = audioUnderruns = audioLatencyMs = 0;
+	audioCallbackTotalUs = 0;
+	if( audioRing && appBuffer && audioRingData && audioRingSpace )
+		audioSinkThread = SDL_CreateThread(ANDROIDAUD_SinkThread, NULL);
+	if( !audioSinkThread )
+	{
+		__android_log_print(ANDROID_LOG_ERROR, "libSDL", "ANDROIDAUD_OpenAudio(): cannot start audio thread");
+		ANDROIDAUD_CloseAudio(this);
+		return(-1);
+	}
 
-	SDL_CalculateAudioSpec(audioFormat);
-	__android_log_print(ANDROID_LOG_INFO, "libSDL", "ANDROIDAUD_OpenAudio(): app opened audio bytespersample %d freq %d channels %d bufsize %d, SDL returns bufsize %d", bytesPerSample, audioFormat->freq, (int)audioFormat->channels, audioBufferSize, audioFormat->size);
+	__android_log_print(ANDROID_LOG_INFO, "libSDL", "ANDROIDAUD_OpenAudio(): app opened audio format 0x%x freq %d channels %d bufsize %d, Java bufsize %d, ring size %d", (int)audioFormat->format, audioFormat->freq, (int)audioFormat->channels, audioFormat->size, audioBufferSize, audioRingSize);
 
 #if SDL_VERSION_ATLEAST(1,3,0)
 	return(1);
@@ -254,14 +367,27 @@ static void ANDROIDAUD_CloseAudio(_THIS)
 	JNIEnv * jniEnv = NULL;
 	(*jniVM)->AttachCurrentThread(jniVM, &jniEnv, NULL);
 
-	(*jniEnv)->DeleteGlobalRef(jniEnv, audioBufferJNI);
+	/* The SDL audio thread has exited already, the sink thread writes out the rest of the ring */
+	if( audioSinkThread )
+	{
+		audioRingClosed = 1;
+		SDL_SemPost(audioRingData);
+		SDL_WaitThread(audioSinkThread, NULL);
+		audioSinkThread = NULL;
+	}
+	if( audioRingData )
+		SDL_DestroySemaphore(audioRingData);
+	if( audioRingSpace )
+		SDL_DestroySemaphore(audioRingSpace);
+	audioRingData = audioRingSpace = NULL;
+	SDL_free(audioRing);
+	audioRing = NULL;
+	SDL_free(appBuffer);
+	appBuffer = NULL;
+
 	audioBufferJNI = NULL;
 	audioBuffer = NULL;
 	audioBufferSize = 0;
-#ifdef SDL_AUDIO_APP_IGNORES_RETURNED_BUFFER_SIZE
-	free(shadowAppBuffer);
-	shadowAppBuffer = NULL;
-#endif
 	(*jniEnv)->CallIntMethod( jniEnv, JavaAudioThread, JavaDeinitAudio );
 
 	/* We cannot call DetachCurrentThread() from main thread or we'll crash */
@@ -289,91 +415,141 @@ static void ANDROIDAUD_WaitAudio(_THIS)
 #endif
 }
 
-static JNIEnv * jniEnvPlaying = NULL;
-static jmethodID JavaFillBuffer = NULL;
-
 static void ANDROIDAUD_ThreadInit(_THIS)
 {
+	JNIEnv * jniEnv = NULL;
 	jclass JavaAudioThreadClass = NULL;
 	jmethodID JavaInitThread = NULL;
-	jmethodID JavaGetBuffer = NULL;
-	jboolean isCopy = JNI_TRUE;
-
-	(*jniVM)->AttachCurrentThread(jniVM, &jniEnvPlaying, NULL);
 
-	JavaAudioThreadClass = (*jniEnvPlaying)->GetObjectClass(jniEnvPlaying, JavaAudioThread);
-	JavaFillBuffer = (*jniEnvPlaying)->GetMethodID(jniEnvPlaying, JavaAudioThreadClass, "fillBuffer", "()I");
+	(*jniVM)->AttachCurrentThread(jniVM, &jniEnv, NULL);
 
 	/* HACK: raise our own thread priority to max to get rid of "W/AudioFlinger: write blocked for 54 msecs" errors */
-	JavaInitThread = (*jniEnvPlaying)->GetMethodID(jniEnvPlaying, JavaAudioThreadClass, "initAudioThread", "()I");
-	(*jniEnvPlaying)->CallIntMethod( jniEnvPlaying, JavaAudioThread, JavaInitThread );
-
-	JavaGetBuffer = (*jniEnvPlaying)->GetMethodID(jniEnvPlaying, JavaAudioThreadClass, "getBuffer", "()[B");
-	audioBufferJNI = (*jniEnvPlaying)->CallObjectMethod( jniEnvPlaying, JavaAudioThread, JavaGetBuffer );
-	audioBufferJNI = (*jniEnvPlaying)->NewGlobalRef(jniEnvPlaying, audioBufferJNI);
-	//audioBuffer = (unsigned char *) (*jniEnvPlaying)->GetByteArrayElements(jniEnvPlaying, audioBufferJNI, &isCopy);
-	audioBuffer = (unsigned char *) (*jniEnvPlaying)->GetPrimitiveArrayCritical(jniEnvPlaying, audioBufferJNI, &isCopy);
-	if( !audioBuffer )
-	{
-		__android_log_print(ANDROID_LOG_ERROR, "libSDL", "ANDROIDAUD_ThreadInit() JNI::GetByteArrayElements() failed! we will crash now");
-		return;
-	}
-	if( isCopy == JNI_TRUE )
-		__android_log_print(ANDROID_LOG_ERROR, "libSDL", "ANDROIDAUD_ThreadInit(): JNI returns a copy of byte array - no audio will be played");
-
-	//__android_log_print(ANDROID_LOG_INFO, "libSDL", "ANDROIDAUD_ThreadInit()");
-	SDL_memset(audioBuffer, this->spec.silence, this->spec.size);
+	JavaAudioThreadClass = (*jniEnv)->GetObjectClass(jniEnv, JavaAudioThread);
+	JavaInitThread = (*jniEnv)->GetMethodID(jniEnv, JavaAudioThreadClass, "initAudioThread", "()I");
+	(*jniEnv)->CallIntMethod( jniEnv, JavaAudioThread, JavaInitThread );
 };
 
 static void ANDROIDAUD_ThreadDeinit(_THIS)
 {
-	//(*jniEnvPlaying)->ReleaseByteArrayElements(jniEnvPlaying, audioBufferJNI, (jbyte *)audioBuffer, 0);
-	(*jniEnvPlaying)->ReleasePrimitiveArrayCritical(jniEnvPlaying, audioBufferJNI, (jbyte *)audioBuffer, 0);
-	// (*jniEnvPlaying)->DeleteGlobalRef(jniEnvPlaying, audioBufferJNI); // Application crashes here for some unknown reason
 	(*jniVM)->DetachCurrentThread(jniVM);
 };
 
-static void ANDROIDAUD_SendAudioToJava(void)
+/* Converts the period of the application into the ring, waiting for space if the ring is full */
+static void ANDROIDAUD_PlayAudio(_THIS)
 {
-	//__android_log_print(ANDROID_LOG_INFO, "libSDL", "ANDROIDAUD_PlayAudio()");
-	//jboolean isCopy = JNI_TRUE;
+	Uint32 head = audioRingHead, pos, part, elapsed;
 
-	//(*jniEnvPlaying)->ReleaseByteArrayElements(jniEnvPlaying, audioBufferJNI, (jbyte *)audioBuffer, 0);
-	(*jniEnvPlaying)->ReleasePrimitiveArrayCritical(jniEnvPlaying, audioBufferJNI, (jbyte *)audioBuffer, 0);
-	audioBuffer = NULL;
+	elapsed = ANDROIDAUD_Microseconds() - audioCallbackStart;
+	audioCallbacks++;
+	audioCallbackTotalUs += elapsed;
+	if( (int)elapsed > audioCallbackMaxUs )
+		audioCallbackMaxUs = elapsed;
 
-	(*jniEnvPlaying)->CallIntMethod( jniEnvPlaying, JavaAudioThread, JavaFillBuffer );
+	while( audioRingSize - (head - audioRingTail) < appPeriodSize && !audioRingClosed )
+		SDL_SemWait(audioRingSpace);
+	if( audioRingClosed )
+	{
+		/* The sink thread has stopped, nothing reads the ring any more: drop the period,
+		   and take as long as playing it would, so the audio thread does not spin the callback */
+		SDL_Delay( this->spec.samples * 1000 / this->spec.freq );
+		return;
+	}
+	__sync_synchronize(); // Write to the ring only after reading the tail
 
-	//audioBuffer = (unsigned char *) (*jniEnvPlaying)->GetByteArrayElements(jniEnvPlaying, audioBufferJNI, NULL);
-	audioBuffer = (unsigned char *) (*jniEnvPlaying)->GetPrimitiveArrayCritical(jniEnvPlaying, audioBufferJNI, NULL);
-	if( !audioBuffer )
-		__android_log_print(ANDROID_LOG_ERROR, "libSDL", "ANDROIDAUD_PlayAudio() JNI::GetByteArrayElements() failed! we will crash now");
+	pos = head & (audioRingSize - 1);
+	part = MIN(appPeriodSize, audioRingSize - pos);
+	ANDROIDAUD_ConvertAudio(appBuffer, audioRing + pos, part / deviceSampleSize);
+	if( part < appPeriodSize )
+		ANDROIDAUD_ConvertAudio(appBuffer + part / deviceSampleSize * appSampleSize, audioRing, (appPeriodSize - part) / deviceSampleSize);
 
-	//if( isCopy == JNI_TRUE )
-	//	__android_log_print(ANDROID_LOG_INFO, "libSDL", "ANDROIDAUD_PlayAudio() JNI returns a copy of byte array - that's slow");
+	__sync_synchronize(); // Audio data must be visible before the new head
+	audioRingHead = head + appPeriodSize;
+	SDL_SemPost(audioRingData);
 }
 
-#ifdef SDL_AUDIO_APP_IGNORES_RETURNED_BUFFER_SIZE
-static void ANDROIDAUD_PlayAudio(_THIS)
+/* Takes periods of the size Java asked for from the ring, and writes them to AudioTrack */
+static int ANDROIDAUD_SinkThread(void * unused)
 {
-	int audioCopiedSize = MIN(shadowAppBufferSize, audioBufferSize - shadowAppBufferPos);
-	memcpy(audioBuffer + shadowAppBufferPos, shadowAppBuffer, audioCopiedSize);
-	shadowAppBufferPos += audioCopiedSize;
-	if( shadowAppBufferPos >= audioBufferSize )
+	JNIEnv * jniEnv = NULL;
+	jclass JavaAudioThreadClass = NULL;
+	jmethodID JavaInitThread = NULL;
+	jmethodID JavaGetBuffer = NULL;
+	jmethodID JavaFillBuffer = NULL;
+	int started = 0;
+
+	(*jniVM)->AttachCurrentThread(jniVM, &jniEnv, NULL);
+
+	JavaAudioThreadClass = (*jniEnv)->GetObjectClass(jniEnv, JavaAudioThread);
+	JavaFillBuffer = (*jniEnv)->GetMethodID(jniEnv, JavaAudioThreadClass, "fillBuffer", "()I");
+	JavaInitThread = (*jniEnv)->GetMethodID(jniEnv, JavaAudioThreadClass, "initAudioThread", "()I");
+	(*jniEnv)->CallIntMethod( jniEnv, JavaAudioThread, JavaInitThread );
+
+	JavaGetBuffer = (*jniEnv)->GetMethodID(jniEnv, JavaAudioThreadClass, "getBuffer", "()[B");
+	audioBufferJNI = (*jniEnv)->CallObjectMethod( jniEnv, JavaAudioThread, JavaGetBuffer );
+
+	while( audioBufferJNI )
 	{
-		ANDROIDAUD_SendAudioToJava();
-		int audioCopiedRemaining = shadowAppBufferSize - audioCopiedSize;
-		memcpy(audioBuffer, shadowAppBuffer + audioCopiedSize, audioCopiedRemaining);
-		shadowAppBufferPos = audioCopiedRemaining;
+		Uint32 tail = audioRingTail, head = audioRingHead, pos, part;
+
+		if( head - tail < audioBufferSize )
+		{
+			if( audioRingClosed )
+				break;
+			if( started )
+				audioUnderruns++;
+			while( (head = audioRingHead) - tail < audioBufferSize && !audioRingClosed )
+				SDL_SemWait(audioRingData);
+			if( head - tail < audioBufferSize )
+				break;
+		}
+		__sync_synchronize(); // Read audio data only after reading the head
+		audioLatencyMs = (head - tail) * 1000 / audioBytesPerSec;
+
+		audioBuffer = (unsigned char *) (*jniEnv)->GetPrimitiveArrayCritical(jniEnv, audioBufferJNI, NULL);
+		if( !audioBuffer )
+		{
+			__android_log_print(ANDROID_LOG_ERROR, "libSDL", "ANDROIDAUD_SinkThread() JNI::GetPrimitiveArrayCritical() failed");
+			break;
+		}
+		pos = tail & (audioRingSize - 1);
+		part = MIN(audioBufferSize, audioRingSize - pos);
+		memcpy(audioBuffer, audioRing + pos, part);
+		memcpy(audioBuffer + part, audioRing, audioBufferSize - part);
+		(*jniEnv)->ReleasePrimitiveArrayCritical(jniEnv, audioBufferJNI, (jbyte *)audioBuffer, 0);
+		audioBuffer = NULL;
+
+		__sync_synchronize(); // Copy audio data before releasing ring space to producer
+		audioRingTail = tail + audioBufferSize;
+		SDL_SemPost(audioRingSpace);
+
+		(*jniEnv)->CallIntMethod( jniEnv, JavaAudioThread, JavaFillBuffer );
+		audioWrites++;
+		started = 1;
 	}
+
+	/* Wake up the SDL audio thread, if it still waits for space */
+	audioRingClosed = 1;
+	SDL_SemPost(audioRingSpace);
+	(*jniVM)->DetachCurrentThread(jniVM);
+	return 0;
 }
-#else
-static void ANDROIDAUD_PlayAudio(_THIS)
+
+int SDLCALL SDL_ANDROID_GetAudioStats(int *callbacks, int *avgCallbackUs, int *maxCallbackUs, int *writes, int *underruns, int *latencyMs)
 {
-	ANDROIDAUD_SendAudioToJava();
+	if( callbacks )
+		*callbacks = audioCallbacks;
+	if( avgCallbackUs )
+		*avgCallbackUs = audioCallbacks ? (int)(audioCallbackTotalUs / audioCallbacks) : 0;
+	if( maxCallbackUs )
+		*maxCallbackUs = audioCallbackMaxUs;
+	if( writes )
+		*writes = audioWrites;
+	if( underruns )
+		*underruns = audioUnderruns;
+	if( latencyMs )
+		*latencyMs = audioLatencyMs;
+	return audioRing != NULL;
 }
-#endif
-
 
 int SDL_ANDROID_PauseAudioPlayback(void)
 {
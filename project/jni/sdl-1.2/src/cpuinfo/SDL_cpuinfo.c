@@ -32,6 +32,11 @@
 #include <signal.h>
 #include <setjmp.h>
 #endif
+#if defined(__arm__) && !defined(__ARM_NEON__) && defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <elf.h> /* For NEON check */
+#endif
 
 #define CPU_HAS_RDTSC	0x00000001
 #define CPU_HAS_MMX	0x00000002
@@ -41,6 +46,7 @@
 #define CPU_HAS_SSE	0x00000040
 #define CPU_HAS_SSE2	0x00000080
 #define CPU_HAS_ALTIVEC	0x00000100
+#define CPU_HAS_NEON	0x00000200
 
 #if SDL_ALTIVEC_BLITTERS && HAVE_SETJMP && !__MACOSX__
 /* This is the brute force way of detecting instruction sets...
@@ -381,6 +387,28 @@ static __inline__ int CPU_haveAltiVec(void)
 	return altivec; 
 }
 
+static __inline__ int CPU_haveNEON(void)
+{
+	int neon = 0;
+#if defined(__aarch64__) || defined(__ARM_NEON__)
+	neon = 1;
+#elif defined(__arm__) && defined(__linux__)
+	/* NEON is optional on ARMv7, kernel reports it in AT_HWCAP */
+	Elf32_auxv_t aux;
+	int fd = open("/proc/self/auxv", O_RDONLY);
+	if ( fd >= 0 ) {
+		while ( read(fd, &aux, sizeof(aux)) == sizeof(aux) ) {
+			if ( aux.a_type == AT_HWCAP ) {
+				neon = (aux.a_un.a_val & 4096) != 0; /* HWCAP_NEON */
+				break;
+			}
+		}
+		close(fd);
+	}
+#endif
+	return neon;
+}
+
 static Uint32 SDL_CPUFeatures = 0xFFFFFFFF;
 
 static Uint32 SDL_GetCPUFeatures(void)
@@ -411,6 +439,9 @@ static Uint32 SDL_GetCPUFeatures(void)
 		if ( CPU_haveAltiVec() ) {
 			SDL_CPUFeatures |= CPU_HAS_ALTIVEC;
 		}
+		if ( CPU_haveNEON() ) {
+			SDL_CPUFeatures |= CPU_HAS_NEON;
+		}
 	}
 	return SDL_CPUFeatures;
 }
@@ -479,6 +510,14 @@ SDL_bool SDL_HasAltiVec(void)
 	return SDL_FALSE;
 }
 
+SDL_bool SDL_HasNEON(void)
+{
+	if ( SDL_GetCPUFeatures() & CPU_HAS_NEON ) {
+		return SDL_TRUE;
+	}
+	return SDL_FALSE;
+}
+
 #ifdef TEST_MAIN
 
 #include <stdio.h>
@@ -493,6 +532,7 @@ int main()
 	printf("SSE: %d\n", SDL_HasSSE());
 	printf("SSE2: %d\n", SDL_HasSSE2());
 	printf("AltiVec: %d\n", SDL_HasAltiVec());
+	printf("NEON: %d\n", SDL_HasNEON());
 	return 0;
 }
 
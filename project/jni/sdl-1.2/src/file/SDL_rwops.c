@@ -28,6 +28,14 @@
 #include "SDL_endian.h"
 #include "SDL_rwops.h"
 
+#ifdef HAVE_MMAP
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 
 #if defined(__WIN32__) && !defined(__SYMBIAN32__)
 
@@ -433,6 +441,111 @@ static int SDLCALL mem_close(SDL_RWops *context)
 	return(0);
 }
 
+#ifdef HAVE_MMAP
+
+/* Files opened read-only are read with the memory functions above: a
+   small read is then a memcpy() instead of a locked trip through the FILE
+   buffer, and SDL_RWGetMemory() works on them. Files up to
+   MMAP_MIN_SIZE are read whole into a buffer on open, which costs one
+   read() where mapping them costs a page fault per page and a munmap();
+   bigger files are memory-mapped. Files that fail both are left to stdio.
+ */
+
+#ifndef MMAP_MIN_SIZE
+#define MMAP_MIN_SIZE	(128 * 1024)
+#endif
+
+static int SDLCALL mmap_close(SDL_RWops *context)
+{
+	if ( context ) {
+		munmap(context->hidden.mem.base,
+		       context->hidden.mem.stop - context->hidden.mem.base);
+		SDL_FreeRW(context);
+	}
+	return(0);
+}
+static int SDLCALL buffer_close(SDL_RWops *context)
+{
+	if ( context ) {
+		SDL_free(context->hidden.mem.base);
+		SDL_FreeRW(context);
+	}
+	return(0);
+}
+
+static void *buffer_read(int fd, size_t size)
+{
+	Uint8 *mem = (Uint8 *)SDL_malloc(size);
+	size_t done = 0;
+	ssize_t n;
+
+	while ( mem && done < size ) {
+		n = read(fd, mem + done, size - done);
+		if ( n <= 0 ) {
+			SDL_free(mem);
+			mem = NULL;
+		} else {
+			done += n;
+		}
+	}
+	return(mem);
+}
+
+static SDL_RWops *mmap_open(const char *file, const char *mode)
+{
+	SDL_RWops *rwops = NULL;
+	struct stat st;
+	void *mem;
+	int fd;
+
+	if ( SDL_strchr(mode, 'r') == NULL || SDL_strchr(mode, '+') != NULL ||
+	     SDL_strchr(mode, 'w') != NULL || SDL_strchr(mode, 'a') != NULL ) {
+		return(NULL);
+	}
+	fd = open(file, O_RDONLY);
+	if ( fd < 0 ) {
+		return(NULL);
+	}
+	/* Empty files, pipes and devices can not be mapped, and the
+	   RWops offsets are int */
+	if ( fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) ||
+	     st.st_size <= 0 || st.st_size > 0x7FFFFFFF ) {
+		close(fd);
+		return(NULL);
+	}
+	if ( st.st_size <= MMAP_MIN_SIZE ) {
+		mem = buffer_read(fd, st.st_size);
+	} else {
+		mem = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if ( mem == MAP_FAILED ) {
+			mem = NULL;
+		}
+	}
+	close(fd);
+	if ( mem == NULL ) {
+		return(NULL);
+	}
+
+	rwops = SDL_AllocRW();
+	if ( rwops == NULL ) {
+		if ( st.st_size <= MMAP_MIN_SIZE ) {
+			SDL_free(mem);
+		} else {
+			munmap(mem, st.st_size);
+		}
+		return(NULL);
+	}
+	rwops->seek = mem_seek;
+	rwops->read = mem_read;
+	rwops->write = mem_writeconst;
+	rwops->close = (st.st_size <= MMAP_MIN_SIZE) ? buffer_close : mmap_close;
+	rwops->hidden.mem.base = (Uint8 *)mem;
+	rwops->hidden.mem.here = rwops->hidden.mem.base;
+	rwops->hidden.mem.stop = rwops->hidden.mem.base+st.st_size;
+	return(rwops);
+}
+#endif /* HAVE_MMAP */
+
 
 /* Functions to create SDL_RWops structures from various data sources */
 
@@ -506,6 +619,13 @@ SDL_RWops *SDL_RWFromFile(const char *file, const char *mode)
 
 #elif HAVE_STDIO_H
 
+#ifdef HAVE_MMAP
+	rwops = mmap_open(file, mode);
+	if ( rwops != NULL ) {
+		return(rwops);
+	}
+#endif
+
 #ifdef __MACOS__
 	{
 		char *mpath = unix_to_mac(file);
@@ -595,6 +715,18 @@ void SDL_FreeRW(SDL_RWops *area)
 	SDL_free(area);
 }
 
+const void *SDL_RWGetMemory(SDL_RWops *context, int *size)
+{
+	if ( !context || context->seek != mem_seek ) {
+		SDL_SetError("SDL_RWGetMemory(): data source is not in memory");
+		return(NULL);
+	}
+	if ( size ) {
+		*size = (context->hidden.mem.stop - context->hidden.mem.here);
+	}
+	return(context->hidden.mem.here);
+}
+
 /* Functions for dynamically reading and writing endian-specific values */
 
 Uint16 SDL_ReadLE16 (SDL_RWops *src)
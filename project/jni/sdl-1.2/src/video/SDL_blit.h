@@ -76,6 +76,18 @@ extern SDL_loblit SDL_CalculateBlit1(SDL_Surface *surface, int complex);
 extern SDL_loblit SDL_CalculateBlitN(SDL_Surface *surface, int complex);
 extern SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int complex);
 
+/* SSE2 and NEON blitters, NEON code lives in *_neon.c files, which are compiled with -mfpu=neon on ARMv7 */
+#if SDL_ASSEMBLY_ROUTINES && defined(__GNUC__) && defined(__SSE2__)
+#define SDL_SSE2_BLITTERS 1
+#endif
+#if SDL_ASSEMBLY_ROUTINES && defined(__GNUC__) && \
+    (defined(__ARM_NEON__) || defined(__aarch64__) || defined(__ARM_ARCH_7A__))
+#define SDL_NEON_BLITTERS 1
+extern void SDL_BlitRGBtoRGBPixelAlphaNEON(SDL_BlitInfo *info);
+extern void SDL_BlitARGBto565PixelAlphaNEON(SDL_BlitInfo *info);
+extern void SDL_Blit565to565SurfaceAlphaNEON(SDL_BlitInfo *info);
+#endif
+
 /*
  * Useful macros for blitting routines
  */
@@ -58,6 +58,9 @@
 #include <mmintrin.h>
 #include <mm3dnow.h>
 #endif
+#if SDL_SSE2_BLITTERS
+#include <emmintrin.h>
+#endif
 
 /* Functions to perform alpha blended blitting */
 
@@ -2583,6 +2586,190 @@ static void BlitARGBto555PixelAlpha(SDL_BlitInfo *info)
 	}
 }
 
+#if SDL_SSE2_BLITTERS || SDL_NEON_BLITTERS
+/*
+ * SSE2 and NEON blitters give exactly the same result as C blitters above.
+ * C blitters blend packed components as d + ((s - d) * alpha >> bits),
+ * for each component this equals to (d * ((1 << bits) - alpha) + s * alpha) >> bits,
+ * which always fits into 16-bit vector lane.
+ * SIMD blitters process only the columns which fill whole vectors,
+ * the rest of each row is blitted by C blitter.
+ */
+static void BlitAlphaTail(SDL_BlitInfo *info, int done, SDL_loblit blit)
+{
+	SDL_BlitInfo tail = *info;
+	int sbpp = info->src->BytesPerPixel;
+	int dbpp = info->dst->BytesPerPixel;
+
+	if(done >= info->d_width)
+		return;
+	tail.s_pixels += done * sbpp;
+	tail.d_pixels += done * dbpp;
+	tail.d_width -= done;
+	tail.s_skip += done * sbpp;
+	tail.d_skip += done * dbpp;
+	blit(&tail);
+}
+#endif /* SDL_SSE2_BLITTERS || SDL_NEON_BLITTERS */
+
+#if SDL_SSE2_BLITTERS
+/* d + ((s - d) * alpha >> bits) for 8 components in 16-bit lanes */
+#define BLEND16_SSE2(s, d, alpha, bits) \
+	_mm_srli_epi16(_mm_add_epi16(_mm_slli_epi16(d, bits), \
+	                             _mm_mullo_epi16(_mm_sub_epi16(s, d), alpha)), bits)
+
+/* fast ARGB888->(A)RGB888 blending with pixel alpha, 4 pixels at a time */
+static void BlitRGBtoRGBPixelAlphaSSE2(SDL_BlitInfo *info)
+{
+	int width = info->d_width & ~3;
+	int height = info->d_height;
+	Uint32 *srcp = (Uint32 *)info->s_pixels;
+	int srcskip = (info->s_skip >> 2) + info->d_width - width;
+	Uint32 *dstp = (Uint32 *)info->d_pixels;
+	int dstskip = (info->d_skip >> 2) + info->d_width - width;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i amask = _mm_set1_epi32(0xff000000);
+	/* do not blend destination alpha */
+	const __m128i rgbmask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+
+	while(height--) {
+		int n;
+		for(n = width; n > 0; n -= 4, srcp += 4, dstp += 4) {
+			__m128i s = _mm_loadu_si128((const __m128i *)srcp);
+			__m128i a = _mm_and_si128(s, amask);
+			__m128i d, opaque, sl, sh, dl, dh, al, ah;
+
+			if(_mm_movemask_epi8(_mm_cmpeq_epi32(a, zero)) == 0xffff)
+				continue; /* all pixels are transparent */
+			d = _mm_loadu_si128((const __m128i *)dstp);
+			opaque = _mm_cmpeq_epi32(a, amask);
+
+			sl = _mm_unpacklo_epi8(s, zero);
+			sh = _mm_unpackhi_epi8(s, zero);
+			dl = _mm_unpacklo_epi8(d, zero);
+			dh = _mm_unpackhi_epi8(d, zero);
+			al = _mm_and_si128(_mm_shufflehi_epi16(_mm_shufflelo_epi16(sl, 0xff), 0xff), rgbmask);
+			ah = _mm_and_si128(_mm_shufflehi_epi16(_mm_shufflelo_epi16(sh, 0xff), 0xff), rgbmask);
+			dl = BLEND16_SSE2(sl, dl, al, 8);
+			dh = BLEND16_SSE2(sh, dh, ah, 8);
+
+			/* opaque pixels are copied, keeping destination alpha */
+			s = _mm_or_si128(_mm_andnot_si128(amask, s), _mm_and_si128(amask, d));
+			d = _mm_packus_epi16(dl, dh);
+			d = _mm_or_si128(_mm_and_si128(opaque, s), _mm_andnot_si128(opaque, d));
+			_mm_storeu_si128((__m128i *)dstp, d);
+		}
+		srcp += srcskip;
+		dstp += dstskip;
+	}
+	BlitAlphaTail(info, width, BlitRGBtoRGBPixelAlpha);
+}
+
+/* fast ARGB8888->RGB565 blending with pixel alpha, 8 pixels at a time */
+static void BlitARGBto565PixelAlphaSSE2(SDL_BlitInfo *info)
+{
+	int width = info->d_width & ~7;
+	int height = info->d_height;
+	Uint32 *srcp = (Uint32 *)info->s_pixels;
+	int srcskip = (info->s_skip >> 2) + info->d_width - width;
+	Uint16 *dstp = (Uint16 *)info->d_pixels;
+	int dstskip = (info->d_skip >> 1) + info->d_width - width;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i smask5 = _mm_set1_epi32(0x1f);
+	const __m128i smask6 = _mm_set1_epi32(0x3f);
+	const __m128i mask5 = _mm_set1_epi16(0x1f);
+	const __m128i mask6 = _mm_set1_epi16(0x3f);
+	const __m128i opaque5 = _mm_set1_epi16(SDL_ALPHA_OPAQUE >> 3);
+
+	while(height--) {
+		int n;
+		for(n = width; n > 0; n -= 8, srcp += 8, dstp += 8) {
+			__m128i s0 = _mm_loadu_si128((const __m128i *)srcp);
+			__m128i s1 = _mm_loadu_si128((const __m128i *)(srcp + 4));
+			/* downscale alpha to 5 bits */
+			__m128i a = _mm_packs_epi32(_mm_srli_epi32(s0, 27), _mm_srli_epi32(s1, 27));
+			__m128i d, opaque, sr, sg, sb, dr, dg, db;
+
+			if(_mm_movemask_epi8(_mm_cmpeq_epi16(a, zero)) == 0xffff)
+				continue; /* all pixels are transparent */
+			d = _mm_loadu_si128((const __m128i *)dstp);
+			opaque = _mm_cmpeq_epi16(a, opaque5);
+
+			sr = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(s0, 19), smask5),
+			                     _mm_and_si128(_mm_srli_epi32(s1, 19), smask5));
+			sg = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(s0, 10), smask6),
+			                     _mm_and_si128(_mm_srli_epi32(s1, 10), smask6));
+			sb = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(s0, 3), smask5),
+			                     _mm_and_si128(_mm_srli_epi32(s1, 3), smask5));
+			dr = BLEND16_SSE2(sr, _mm_srli_epi16(d, 11), a, 5);
+			dg = BLEND16_SSE2(sg, _mm_and_si128(_mm_srli_epi16(d, 5), mask6), a, 5);
+			db = BLEND16_SSE2(sb, _mm_and_si128(d, mask5), a, 5);
+
+			s0 = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(sr, 11), _mm_slli_epi16(sg, 5)), sb);
+			d = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(dr, 11), _mm_slli_epi16(dg, 5)), db);
+			d = _mm_or_si128(_mm_and_si128(opaque, s0), _mm_andnot_si128(opaque, d));
+			_mm_storeu_si128((__m128i *)dstp, d);
+		}
+		srcp += srcskip;
+		dstp += dstskip;
+	}
+	BlitAlphaTail(info, width, BlitARGBto565PixelAlpha);
+}
+
+/* fast RGB565->RGB565 blending with surface alpha, 8 pixels at a time */
+static void Blit565to565SurfaceAlphaSSE2(SDL_BlitInfo *info)
+{
+	int width = info->d_width & ~7;
+	int height = info->d_height;
+	Uint16 *srcp = (Uint16 *)info->s_pixels;
+	int srcskip = (info->s_skip >> 1) + info->d_width - width;
+	Uint16 *dstp = (Uint16 *)info->d_pixels;
+	int dstskip = (info->d_skip >> 1) + info->d_width - width;
+	/* downscale alpha to 5 bits, alpha=128 special case of C blitter gives the same result */
+	const __m128i a = _mm_set1_epi16(info->src->alpha >> 3);
+	const __m128i mask5 = _mm_set1_epi16(0x1f);
+	const __m128i mask6 = _mm_set1_epi16(0x3f);
+
+	while(height--) {
+		int n;
+		for(n = width; n > 0; n -= 8, srcp += 8, dstp += 8) {
+			__m128i s = _mm_loadu_si128((const __m128i *)srcp);
+			__m128i d = _mm_loadu_si128((const __m128i *)dstp);
+			__m128i r = BLEND16_SSE2(_mm_srli_epi16(s, 11), _mm_srli_epi16(d, 11), a, 5);
+			__m128i g = BLEND16_SSE2(_mm_and_si128(_mm_srli_epi16(s, 5), mask6),
+			                         _mm_and_si128(_mm_srli_epi16(d, 5), mask6), a, 5);
+			__m128i b = BLEND16_SSE2(_mm_and_si128(s, mask5), _mm_and_si128(d, mask5), a, 5);
+			d = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+			_mm_storeu_si128((__m128i *)dstp, d);
+		}
+		srcp += srcskip;
+		dstp += dstskip;
+	}
+	BlitAlphaTail(info, width, Blit565to565SurfaceAlpha);
+}
+#endif /* SDL_SSE2_BLITTERS */
+
+#if SDL_NEON_BLITTERS
+/* NEON blitters live in SDL_blit_A_neon.c, which is the only file compiled with NEON enabled */
+static void BlitRGBtoRGBPixelAlphaNEON(SDL_BlitInfo *info)
+{
+	SDL_BlitRGBtoRGBPixelAlphaNEON(info);
+	BlitAlphaTail(info, info->d_width & ~7, BlitRGBtoRGBPixelAlpha);
+}
+
+static void BlitARGBto565PixelAlphaNEON(SDL_BlitInfo *info)
+{
+	SDL_BlitARGBto565PixelAlphaNEON(info);
+	BlitAlphaTail(info, info->d_width & ~7, BlitARGBto565PixelAlpha);
+}
+
+static void Blit565to565SurfaceAlphaNEON(SDL_BlitInfo *info)
+{
+	SDL_Blit565to565SurfaceAlphaNEON(info);
+	BlitAlphaTail(info, info->d_width & ~7, Blit565to565SurfaceAlpha);
+}
+#endif /* SDL_NEON_BLITTERS */
+
 /* General (slow) N->N blending with per-surface alpha */
 static void BlitNtoNSurfaceAlpha(SDL_BlitInfo *info)
 {
@@ -2746,6 +2933,14 @@ SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int blit_index)
 		if(surface->map->identity) {
 		    if(df->Gmask == 0x7e0)
 		    {
+#if SDL_NEON_BLITTERS
+		if(SDL_HasNEON())
+			return Blit565to565SurfaceAlphaNEON;
+#endif
+#if SDL_SSE2_BLITTERS
+		if(SDL_HasSSE2())
+			return Blit565to565SurfaceAlphaSSE2;
+#endif
 #if MMX_ASMBLIT
 		if(SDL_HasMMX())
 			return Blit565to565SurfaceAlphaMMX;
@@ -2819,8 +3014,17 @@ SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int blit_index)
 	       && sf->Gmask == 0xff00
 	       && ((sf->Rmask == 0xff && df->Rmask == 0x1f)
 		   || (sf->Bmask == 0xff && df->Bmask == 0x1f))) {
-		if(df->Gmask == 0x7e0)
+		if(df->Gmask == 0x7e0) {
+#if SDL_NEON_BLITTERS
+		    if(SDL_HasNEON())
+			return BlitARGBto565PixelAlphaNEON;
+#endif
+#if SDL_SSE2_BLITTERS
+		    if(SDL_HasSSE2())
+			return BlitARGBto565PixelAlphaSSE2;
+#endif
 		    return BlitARGBto565PixelAlpha;
+		}
 		else if(df->Gmask == 0x3e0)
 		    return BlitARGBto555PixelAlpha;
 	    }
@@ -2847,6 +3051,14 @@ SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int blit_index)
 #endif
 		if(sf->Amask == 0xff000000)
 		{
+#if SDL_NEON_BLITTERS
+			if(SDL_HasNEON())
+				return BlitRGBtoRGBPixelAlphaNEON;
+#endif
+#if SDL_SSE2_BLITTERS
+			if(SDL_HasSSE2())
+				return BlitRGBtoRGBPixelAlphaSSE2;
+#endif
 #if SDL_ALTIVEC_BLITTERS
 			if(!(surface->map->dst->flags & SDL_HWSURFACE)
 				&& SDL_HasAltiVec())
@@ -0,0 +1,156 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#include "SDL_video.h"
+#include "SDL_blit.h"
+
+/*
+ * NEON versions of alpha blitters from SDL_blit_A.c, they are selected at runtime
+ * with SDL_HasNEON(). On ARMv7 this file is compiled with -mfpu=neon, so nothing else
+ * should be placed here, or the compiler may use NEON in code which runs on any CPU.
+ * Only (d_width & ~7) columns are blitted, the rest is done by C blitters.
+ * Components are blended as (d * ((1 << bits) - alpha) + s * alpha) >> bits,
+ * which gives the same result as C blitters.
+ */
+
+#if SDL_NEON_BLITTERS
+
+#include <arm_neon.h>
+
+#define BLEND16_NEON(s, d, alpha, ialpha, bits) \
+	vshrq_n_u16(vmlaq_u16(vmulq_u16(d, ialpha), s, alpha), bits)
+
+/* fast ARGB888->(A)RGB888 blending with pixel alpha, 8 pixels at a time */
+void SDL_BlitRGBtoRGBPixelAlphaNEON(SDL_BlitInfo *info)
+{
+	int width = info->d_width & ~7;
+	int height = info->d_height;
+	Uint32 *srcp = (Uint32 *)info->s_pixels;
+	int srcskip = (info->s_skip >> 2) + info->d_width - width;
+	Uint32 *dstp = (Uint32 *)info->d_pixels;
+	int dstskip = (info->d_skip >> 2) + info->d_width - width;
+	const uint8x8_t opaque8 = vdup_n_u8(SDL_ALPHA_OPAQUE);
+
+	while(height--) {
+		int n;
+		for(n = width; n > 0; n -= 8, srcp += 8, dstp += 8) {
+			/* load with deinterleaving, val[3] is alpha, destination alpha is not changed */
+			uint8x8x4_t s = vld4_u8((const Uint8 *)srcp);
+			uint8x8x4_t d;
+			uint8x8_t a = s.val[3];
+			uint8x8_t ia = vmvn_u8(a);
+			uint8x8_t opaque = vceq_u8(a, opaque8);
+			int c;
+
+			if(vget_lane_u64(vreinterpret_u64_u8(a), 0) == 0)
+				continue; /* all pixels are transparent */
+			d = vld4_u8((const Uint8 *)dstp);
+			for(c = 0; c < 3; c++) {
+				/* s * alpha + d * (255 - alpha) + d */
+				uint16x8_t t = vaddw_u8(vmlal_u8(vmull_u8(s.val[c], a), d.val[c], ia), d.val[c]);
+				d.val[c] = vbsl_u8(opaque, s.val[c], vshrn_n_u16(t, 8));
+			}
+			vst4_u8((Uint8 *)dstp, d);
+		}
+		srcp += srcskip;
+		dstp += dstskip;
+	}
+}
+
+/* fast ARGB8888->RGB565 blending with pixel alpha, 8 pixels at a time */
+void SDL_BlitARGBto565PixelAlphaNEON(SDL_BlitInfo *info)
+{
+	int width = info->d_width & ~7;
+	int height = info->d_height;
+	Uint32 *srcp = (Uint32 *)info->s_pixels;
+	int srcskip = (info->s_skip >> 2) + info->d_width - width;
+	Uint16 *dstp = (Uint16 *)info->d_pixels;
+	int dstskip = (info->d_skip >> 1) + info->d_width - width;
+	const uint16x8_t mask5 = vdupq_n_u16(0x1f);
+	const uint16x8_t mask6 = vdupq_n_u16(0x3f);
+	const uint16x8_t max5 = vdupq_n_u16(32);
+
+	while(height--) {
+		int n;
+		for(n = width; n > 0; n -= 8, srcp += 8, dstp += 8) {
+			uint8x8x4_t s = vld4_u8((const Uint8 *)srcp);
+			uint8x8_t a8 = vshr_n_u8(s.val[3], 3); /* downscale alpha to 5 bits */
+			uint16x8_t a, ia, opaque, d, sr, sg, sb, dr, dg, db;
+
+			if(vget_lane_u64(vreinterpret_u64_u8(a8), 0) == 0)
+				continue; /* all pixels are transparent */
+			a = vmovl_u8(a8);
+			ia = vsubq_u16(max5, a);
+			opaque = vceqq_u16(a, mask5);
+			d = vld1q_u16(dstp);
+
+			sr = vmovl_u8(vshr_n_u8(s.val[2], 3));
+			sg = vmovl_u8(vshr_n_u8(s.val[1], 2));
+			sb = vmovl_u8(vshr_n_u8(s.val[0], 3));
+			dr = BLEND16_NEON(sr, vshrq_n_u16(d, 11), a, ia, 5);
+			dg = BLEND16_NEON(sg, vandq_u16(vshrq_n_u16(d, 5), mask6), a, ia, 5);
+			db = BLEND16_NEON(sb, vandq_u16(d, mask5), a, ia, 5);
+
+			dr = vbslq_u16(opaque, sr, dr);
+			dg = vbslq_u16(opaque, sg, dg);
+			db = vbslq_u16(opaque, sb, db);
+			vst1q_u16(dstp, vorrq_u16(vorrq_u16(vshlq_n_u16(dr, 11), vshlq_n_u16(dg, 5)), db));
+		}
+		srcp += srcskip;
+		dstp += dstskip;
+	}
+}
+
+/* fast RGB565->RGB565 blending with surface alpha, 8 pixels at a time */
+void SDL_Blit565to565SurfaceAlphaNEON(SDL_BlitInfo *info)
+{
+	unsigned alpha = info->src->alpha >> 3; /* downscale alpha to 5 bits */
+	int width = info->d_width & ~7;
+	int height = info->d_height;
+	Uint16 *srcp = (Uint16 *)info->s_pixels;
+	int srcskip = (info->s_skip >> 1) + info->d_width - width;
+	Uint16 *dstp = (Uint16 *)info->d_pixels;
+	int dstskip = (info->d_skip >> 1) + info->d_width - width;
+	const uint16x8_t a = vdupq_n_u16(alpha);
+	const uint16x8_t ia = vdupq_n_u16(32 - alpha);
+	const uint16x8_t mask5 = vdupq_n_u16(0x1f);
+	const uint16x8_t mask6 = vdupq_n_u16(0x3f);
+
+	/* alpha=128 special case of C blitter gives the same result as blending with 5-bit alpha=16 */
+	while(height--) {
+		int n;
+		for(n = width; n > 0; n -= 8, srcp += 8, dstp += 8) {
+			uint16x8_t s = vld1q_u16(srcp);
+			uint16x8_t d = vld1q_u16(dstp);
+			uint16x8_t r = BLEND16_NEON(vshrq_n_u16(s, 11), vshrq_n_u16(d, 11), a, ia, 5);
+			uint16x8_t g = BLEND16_NEON(vandq_u16(vshrq_n_u16(s, 5), mask6),
+			                            vandq_u16(vshrq_n_u16(d, 5), mask6), a, ia, 5);
+			uint16x8_t b = BLEND16_NEON(vandq_u16(s, mask5), vandq_u16(d, mask5), a, ia, 5);
+			vst1q_u16(dstp, vorrq_u16(vorrq_u16(vshlq_n_u16(r, 11), vshlq_n_u16(g, 5)), b));
+		}
+		srcp += srcskip;
+		dstp += dstskip;
+	}
+}
+
+#endif /* SDL_NEON_BLITTERS */
@@ -28,128 +28,62 @@
 */
 
 #include "SDL_video.h"
+#include "SDL_thread.h"
+#include "SDL_cpuinfo.h"
 #include "SDL_blit.h"
+#include "SDL_stretch_c.h"
 
-/* This isn't ready for general consumption yet - it should be folded
-   into the general blitting mechanism.
-*/
-
-#if ((defined(_MFC_VER) && defined(_M_IX86)/* && !defined(_WIN32_WCE) still needed? */) || \
-     defined(__WATCOMC__) || \
-     (defined(__GNUC__) && defined(__i386__))) && SDL_ASSEMBLY_ROUTINES
-/* There's a bug with gcc 4.4.1 and -O2 where srcp doesn't get the correct
- * value after the first scanline.  FIXME? */
-/*#define USE_ASM_STRETCH*/
-#endif
-
-#ifdef USE_ASM_STRETCH
-
-#ifdef HAVE_MPROTECT
-#include <sys/types.h>
-#include <sys/mman.h>
-#endif
-#ifdef __GNUC__
-#define PAGE_ALIGNED __attribute__((__aligned__(4096)))
-#else
-#define PAGE_ALIGNED
+#if HAVE_SYSCONF
+#include <unistd.h>
 #endif
-
-#if defined(_M_IX86) || defined(i386)
-#define PREFIX16	0x66
-#define STORE_BYTE	0xAA
-#define STORE_WORD	0xAB
-#define LOAD_BYTE	0xAC
-#define LOAD_WORD	0xAD
-#define RETURN		0xC3
-#else
-#error Need assembly opcodes for this architecture
+#if SDL_SSE2_BLITTERS
+#include <emmintrin.h>
 #endif
 
-static unsigned char copy_row[4096] PAGE_ALIGNED;
-
-static int generate_rowbytes(int src_w, int dst_w, int bpp)
-{
-	static struct {
-		int bpp;
-		int src_w;
-		int dst_w;
-		int status;
-	} last;
-
-	int i;
-	int pos, inc;
-	unsigned char *eip, *fence;
-	unsigned char load, store;
-
-	/* See if we need to regenerate the copy buffer */
-	if ( (src_w == last.src_w) &&
-	     (dst_w == last.dst_w) && (bpp == last.bpp) ) {
-		return(last.status);
-	}
-	last.bpp = bpp;
-	last.src_w = src_w;
-	last.dst_w = dst_w;
-	last.status = -1;
-
-	switch (bpp) {
-	    case 1:
-		load = LOAD_BYTE;
-		store = STORE_BYTE;
-		break;
-	    case 2:
-	    case 4:
-		load = LOAD_WORD;
-		store = STORE_WORD;
-		break;
-	    default:
-		SDL_SetError("ASM stretch of %d bytes isn't supported\n", bpp);
-		return(-1);
-	}
-#ifdef HAVE_MPROTECT
-	/* Make the code writeable */
-	if ( mprotect(copy_row, sizeof(copy_row), PROT_READ|PROT_WRITE) < 0 ) {
-		SDL_SetError("Couldn't make copy buffer writeable");
-		return(-1);
-	}
-#endif
-	pos = 0x10000;
-	inc = (src_w << 16) / dst_w;
-	eip = copy_row;
-	fence = copy_row+sizeof(copy_row)-2;
-	for ( i=0; i<dst_w && eip < end; ++i ) {
-		while ( pos >= 0x10000L ) {
-			if ( eip == fence ) {
-				return -1;
-			}
-			if ( bpp == 2 ) {
-				*eip++ = PREFIX16;
-			}
-			*eip++ = load;
-			pos -= 0x10000L;
-		}
-		if ( eip == fence ) {
-			return -1;
-		}
-		if ( bpp == 2 ) {
-			*eip++ = PREFIX16;
-		}
-		*eip++ = store;
-		pos += inc;
-	}
-	*eip++ = RETURN;
-
-#ifdef HAVE_MPROTECT
-	/* Make the code executable but not writeable */
-	if ( mprotect(copy_row, sizeof(copy_row), PROT_READ|PROT_EXEC) < 0 ) {
-		SDL_SetError("Couldn't make copy buffer executable");
-		return(-1);
-	}
-#endif
-	last.status = 0;
-	return(0);
-}
+/* This isn't ready for general consumption yet - it should be folded
+   into the general blitting mechanism.
+*/
 
-#endif /* USE_ASM_STRETCH */
+/*
+ * Each destination row and column is mapped to the source with a table,
+ * destination rows which use the same source row are copied from the previous row.
+ * 16 and 32 bpp rows are scaled with SSE2 or NEON where possible, the rest is done in C.
+ * Bilinear filtering works on 8-bit channels: 32 bpp pixels are used as they are,
+ * 16 bpp pixels are unpacked to one channel per byte and packed back after filtering.
+ * Big blits are split into bands of rows, which are scaled by worker threads.
+ */
+
+enum {
+	STRETCH_MAX_THREADS = 4,
+	STRETCH_THREADED_PIXELS = 640 * 480 /* Smaller blits are done by the calling thread alone */
+};
+
+typedef struct {
+	SDL_Surface *src;
+	SDL_Surface *dst;
+	SDL_Rect srcrect;
+	SDL_Rect dstrect;
+	int linear;
+	int *xofs;     /* Source column for each destination column */
+	Uint8 *xfrac;  /* Weight of the next source column, for bilinear filtering */
+	int *yofs;
+	Uint8 *yfrac;
+} StretchJob;
+
+typedef struct {
+	SDL_Thread *thread;
+	SDL_sem *start;
+	int row_start;
+	int row_end;
+	Uint32 *buf;   /* Scratch rows for bilinear filtering */
+	int buf_size;
+} StretchWorker;
+
+static StretchJob stretch_job;
+static StretchWorker stretch_workers[STRETCH_MAX_THREADS];
+static int stretch_threads = 0; /* Worker threads started, not counting the calling thread */
+static SDL_sem *stretch_done = NULL;
+static volatile int stretch_quit = 0;
 
 #define DEFINE_COPY_ROW(name, type)			\
 void name(type *src, int src_w, type *dst, int dst_w)	\
@@ -170,10 +104,8 @@ void name(type *src, int src_w, type *dst, int dst_w)	\
 	}						\
 }
 DEFINE_COPY_ROW(copy_row1, Uint8)
-DEFINE_COPY_ROW(copy_row2, Uint16)
-DEFINE_COPY_ROW(copy_row4, Uint32)
 
-/* The ASM code doesn't handle 24-bpp stretch blits */
+/* 24-bpp stretch blits are rare, they don't use tables */
 void copy_row3(Uint8 *src, int src_w, Uint8 *dst, int dst_w)
 {
 	int i;
@@ -196,28 +128,491 @@ void copy_row3(Uint8 *src, int src_w, Uint8 *dst, int dst_w)
 	}
 }
 
-/* Perform a stretch blit between two surfaces of the same format.
-   NOTE:  This function is not safe to call from multiple threads!
-*/
-int SDL_SoftStretch(SDL_Surface *src, SDL_Rect *srcrect,
-                    SDL_Surface *dst, SDL_Rect *dstrect)
+/* Nearest neighbour, the table version of copy_row2/copy_row4 */
+#define DEFINE_NEAREST_ROW(name, type)				\
+static void name(const type *src, type *dst, const int *xofs, int dst_w) \
+{								\
+	int i;							\
+	for ( i=0; i<dst_w; ++i ) {				\
+		dst[i] = src[xofs[i]];				\
+	}							\
+}
+DEFINE_NEAREST_ROW(nearest_row2, Uint16)
+DEFINE_NEAREST_ROW(nearest_row4, Uint32)
+
+/* (a * (256 - f) + b * f) >> 8 for each 8-bit channel */
+static __inline__ Uint32 lerp_pixel(Uint32 a, Uint32 b, int f)
+{
+	Uint32 rb = (a & 0xff00ff) * (256 - f) + (b & 0xff00ff) * f;
+	Uint32 ag = ((a >> 8) & 0xff00ff) * (256 - f) + ((b >> 8) & 0xff00ff) * f;
+	return ((rb >> 8) & 0xff00ff) | (ag & 0xff00ff00);
+}
+
+#if SDL_SSE2_BLITTERS
+/* Every source pixel is repeated 'factor' times */
+static int repeat_row2_SSE2(const Uint16 *src, int src_w, Uint16 *dst, int factor)
+{
+	int i, j;
+	if ( factor == 2 ) {
+		for ( i=0; i+8<=src_w; i+=8, src+=8, dst+=16 ) {
+			__m128i s = _mm_loadu_si128((const __m128i *)src);
+			_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(s, s));
+			_mm_storeu_si128((__m128i *)(dst + 8), _mm_unpackhi_epi16(s, s));
+		}
+		return i;
+	}
+	if ( factor < 8 ) {
+		return 0;
+	}
+	for ( i=0; i<src_w; ++i, dst+=factor ) {
+		__m128i s = _mm_set1_epi16(src[i]);
+		for ( j=0; j+8<=factor; j+=8 ) {
+			_mm_storeu_si128((__m128i *)(dst + j), s);
+		}
+		_mm_storeu_si128((__m128i *)(dst + factor - 8), s);
+	}
+	return i;
+}
+
+static int repeat_row4_SSE2(const Uint32 *src, int src_w, Uint32 *dst, int factor)
+{
+	int i, j;
+	if ( factor == 2 ) {
+		for ( i=0; i+4<=src_w; i+=4, src+=4, dst+=8 ) {
+			__m128i s = _mm_loadu_si128((const __m128i *)src);
+			_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi32(s, s));
+			_mm_storeu_si128((__m128i *)(dst + 4), _mm_unpackhi_epi32(s, s));
+		}
+		return i;
+	}
+	if ( factor < 4 ) {
+		return 0;
+	}
+	for ( i=0; i<src_w; ++i, dst+=factor ) {
+		__m128i s = _mm_set1_epi32(src[i]);
+		for ( j=0; j+4<=factor; j+=4 ) {
+			_mm_storeu_si128((__m128i *)(dst + j), s);
+		}
+		_mm_storeu_si128((__m128i *)(dst + factor - 4), s);
+	}
+	return i;
+}
+
+/* (a * (256 - f) + b * f) >> 8 == (a * 256 + (b - a) * f) >> 8, it fits into 16-bit lane */
+#define LERP16_SSE2(a, b, f) \
+	_mm_srli_epi16(_mm_add_epi16(_mm_slli_epi16(a, 8), _mm_mullo_epi16(_mm_sub_epi16(b, a), f)), 8)
+
+static int lerp_row_SSE2(const Uint32 *a, const Uint32 *b, Uint32 *dst, int width, int f)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i f16 = _mm_set1_epi16(f);
+	int i;
+	for ( i=0; i+4<=width; i+=4 ) {
+		__m128i a8 = _mm_loadu_si128((const __m128i *)(a + i));
+		__m128i b8 = _mm_loadu_si128((const __m128i *)(b + i));
+		__m128i lo = LERP16_SSE2(_mm_unpacklo_epi8(a8, zero), _mm_unpacklo_epi8(b8, zero), f16);
+		__m128i hi = LERP16_SSE2(_mm_unpackhi_epi8(a8, zero), _mm_unpackhi_epi8(b8, zero), f16);
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(lo, hi));
+	}
+	return i;
+}
+
+static int linear_row_SSE2(const Uint32 *src, Uint32 *dst, const int *xofs, const Uint8 *xfrac, int width)
+{
+	const __m128i zero = _mm_setzero_si128();
+	int i;
+	for ( i=0; i+4<=width; i+=4 ) {
+		const int *x = xofs + i;
+		const Uint8 *f = xfrac + i;
+		__m128i a8 = _mm_set_epi32(src[x[3]], src[x[2]], src[x[1]], src[x[0]]);
+		__m128i b8 = _mm_set_epi32(src[x[3] + 1], src[x[2] + 1], src[x[1] + 1], src[x[0] + 1]);
+		__m128i flo = _mm_set_epi16(f[1], f[1], f[1], f[1], f[0], f[0], f[0], f[0]);
+		__m128i fhi = _mm_set_epi16(f[3], f[3], f[3], f[3], f[2], f[2], f[2], f[2]);
+		__m128i lo = LERP16_SSE2(_mm_unpacklo_epi8(a8, zero), _mm_unpacklo_epi8(b8, zero), flo);
+		__m128i hi = LERP16_SSE2(_mm_unpackhi_epi8(a8, zero), _mm_unpackhi_epi8(b8, zero), fhi);
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(lo, hi));
+	}
+	return i;
+}
+#endif /* SDL_SSE2_BLITTERS */
+
+/* SIMD kernels return the amount of pixels done, the rest is done in C */
+static int repeat_row2_SIMD(const Uint16 *src, int src_w, Uint16 *dst, int factor)
+{
+#if SDL_NEON_BLITTERS
+	if ( SDL_HasNEON() ) {
+		return SDL_StretchRepeatRow2NEON(src, src_w, dst, factor);
+	}
+#endif
+#if SDL_SSE2_BLITTERS
+	if ( SDL_HasSSE2() ) {
+		return repeat_row2_SSE2(src, src_w, dst, factor);
+	}
+#endif
+	return 0;
+}
+
+static int repeat_row4_SIMD(const Uint32 *src, int src_w, Uint32 *dst, int factor)
+{
+#if SDL_NEON_BLITTERS
+	if ( SDL_HasNEON() ) {
+		return SDL_StretchRepeatRow4NEON(src, src_w, dst, factor);
+	}
+#endif
+#if SDL_SSE2_BLITTERS
+	if ( SDL_HasSSE2() ) {
+		return repeat_row4_SSE2(src, src_w, dst, factor);
+	}
+#endif
+	return 0;
+}
+
+static void lerp_row(const Uint32 *a, const Uint32 *b, Uint32 *dst, int width, int f)
+{
+	int i = 0;
+#if SDL_NEON_BLITTERS
+	if ( SDL_HasNEON() ) {
+		i = SDL_StretchLerpRowNEON(a, b, dst, width, f);
+	}
+#endif
+#if SDL_SSE2_BLITTERS
+	if ( SDL_HasSSE2() ) {
+		i = lerp_row_SSE2(a, b, dst, width, f);
+	}
+#endif
+	for ( ; i<width; ++i ) {
+		dst[i] = lerp_pixel(a[i], b[i], f);
+	}
+}
+
+static void linear_row(const Uint32 *src, Uint32 *dst, const int *xofs, const Uint8 *xfrac, int width)
+{
+	int i = 0;
+#if SDL_NEON_BLITTERS
+	if ( SDL_HasNEON() ) {
+		i = SDL_StretchLinearRowNEON(src, dst, xofs, xfrac, width);
+	}
+#endif
+#if SDL_SSE2_BLITTERS
+	if ( SDL_HasSSE2() ) {
+		i = linear_row_SSE2(src, dst, xofs, xfrac, width);
+	}
+#endif
+	for ( ; i<width; ++i ) {
+		dst[i] = lerp_pixel(src[xofs[i]], src[xofs[i] + 1], xfrac[i]);
+	}
+}
+
+/* 16 bpp pixel to one channel per byte, and back */
+static void unpack_row2(const Uint16 *src, Uint32 *dst, int width, const SDL_PixelFormat *fmt)
+{
+	int i;
+	for ( i=0; i<width; ++i ) {
+		Uint32 p = src[i];
+		dst[i] = ((p & fmt->Rmask) >> fmt->Rshift) |
+		         (((p & fmt->Gmask) >> fmt->Gshift) << 8) |
+		         (((p & fmt->Bmask) >> fmt->Bshift) << 16) |
+		         (((p & fmt->Amask) >> fmt->Ashift) << 24);
+	}
+}
+
+static void pack_row2(const Uint32 *src, Uint16 *dst, int width, const SDL_PixelFormat *fmt)
+{
+	int i;
+	for ( i=0; i<width; ++i ) {
+		Uint32 p = src[i];
+		dst[i] = (Uint16)(((p & 0xff) << fmt->Rshift) |
+		                  (((p >> 8) & 0xff) << fmt->Gshift) |
+		                  (((p >> 16) & 0xff) << fmt->Bshift) |
+		                  (((p >> 24) << fmt->Ashift) & fmt->Amask));
+	}
+}
+
+/* Maps destination pixels to the source, with pixel centers aligned for bilinear filtering */
+static void build_table(int src_w, int dst_w, int linear, int *ofs, Uint8 *frac)
+{
+	int i;
+	for ( i=0; i<dst_w; ++i ) {
+		if ( linear ) {
+			Sint64 pos = ((Sint64)(2 * i + 1) * src_w << 15) / dst_w - 0x8000;
+			if ( pos < 0 ) {
+				pos = 0;
+			}
+			if ( pos > ((Sint64)(src_w - 1) << 16) ) {
+				pos = (Sint64)(src_w - 1) << 16;
+			}
+			ofs[i] = (int)(pos >> 16);
+			frac[i] = (Uint8)(pos >> 8);
+		} else {
+			ofs[i] = (int)((Uint32)i * (Uint32)src_w / (Uint32)dst_w);
+			frac[i] = 0;
+		}
+	}
+}
+
+static Uint8 *row_pointer(SDL_Surface *surface, SDL_Rect *rect, int row)
+{
+	return (Uint8 *)surface->pixels + (rect->y + row) * surface->pitch +
+	       rect->x * surface->format->BytesPerPixel;
+}
+
+static void stretch_rows_nearest(StretchJob *job, int row_start, int row_end)
+{
+	const int bpp = job->dst->format->BytesPerPixel;
+	const int src_w = job->srcrect.w;
+	const int dst_w = job->dstrect.w;
+	const int factor = (dst_w % src_w == 0) ? dst_w / src_w : 0;
+	int row, last_src_row = -1;
+	Uint8 *last_dstp = NULL;
+
+	for ( row=row_start; row<row_end; ++row ) {
+		Uint8 *srcp = row_pointer(job->src, &job->srcrect, job->yofs[row]);
+		Uint8 *dstp = row_pointer(job->dst, &job->dstrect, row);
+		int done = 0;
+
+		if ( job->yofs[row] == last_src_row ) {
+			SDL_memcpy(dstp, last_dstp, dst_w * bpp);
+			continue;
+		}
+		last_src_row = job->yofs[row];
+		last_dstp = dstp;
+
+		switch (bpp) {
+		    case 1:
+			copy_row1(srcp, src_w, dstp, dst_w);
+			break;
+		    case 2:
+			if ( factor == 1 ) {
+				SDL_memcpy(dstp, srcp, dst_w * 2);
+				break;
+			}
+			if ( factor > 1 ) {
+				done = repeat_row2_SIMD((Uint16 *)srcp, src_w, (Uint16 *)dstp, factor) * factor;
+			}
+			nearest_row2((Uint16 *)srcp, (Uint16 *)dstp + done, job->xofs + done, dst_w - done);
+			break;
+		    case 3:
+			copy_row3(srcp, src_w, dstp, dst_w);
+			break;
+		    case 4:
+			if ( factor == 1 ) {
+				SDL_memcpy(dstp, srcp, dst_w * 4);
+				break;
+			}
+			if ( factor > 1 ) {
+				done = repeat_row4_SIMD((Uint32 *)srcp, src_w, (Uint32 *)dstp, factor) * factor;
+			}
+			nearest_row4((Uint32 *)srcp, (Uint32 *)dstp + done, job->xofs + done, dst_w - done);
+			break;
+		}
+	}
+}
+
+/* Returns source row as 32-bit pixels with one channel per byte, padded with a copy of the last pixel */
+static Uint32 *source_row_linear(StretchJob *job, int row, Uint32 *buf)
+{
+	const int src_w = job->srcrect.w;
+	Uint8 *srcp = row_pointer(job->src, &job->srcrect, row);
+
+	if ( job->src->format->BytesPerPixel == 2 ) {
+		unpack_row2((Uint16 *)srcp, buf, src_w, job->src->format);
+	} else {
+		SDL_memcpy(buf, srcp, src_w * 4);
+	}
+	buf[src_w] = buf[src_w - 1];
+	return buf;
+}
+
+static void stretch_rows_linear(StretchJob *job, StretchWorker *worker, int row_start, int row_end)
+{
+	const int bpp = job->dst->format->BytesPerPixel;
+	const int src_w = job->srcrect.w;
+	const int dst_w = job->dstrect.w;
+	const int stride = SDL_max(src_w + 1, dst_w);
+	Uint32 *rows[2], *blended, *out;
+	int row_index[2] = { -1, -1 };
+	int row;
+
+	if ( worker->buf_size < stride * 4 ) {
+		SDL_free(worker->buf);
+		worker->buf = (Uint32 *)SDL_malloc(stride * 4 * sizeof(Uint32));
+		if ( !worker->buf ) {
+			worker->buf_size = 0;
+			stretch_rows_nearest(job, row_start, row_end);
+			return;
+		}
+		worker->buf_size = stride * 4;
+	}
+	rows[0] = worker->buf;
+	rows[1] = worker->buf + stride;
+	blended = worker->buf + stride * 2;
+	out = worker->buf + stride * 3;
+
+	for ( row=row_start; row<row_end; ++row ) {
+		int y0 = job->yofs[row];
+		int y1 = SDL_min(y0 + 1, job->srcrect.h - 1);
+		int f = job->yfrac[row];
+		Uint8 *dstp = row_pointer(job->dst, &job->dstrect, row);
+		Uint32 *a, *b, *src;
+
+		/* Source rows are reused by following destination rows when upscaling */
+		if ( row_index[1] == y0 ) {
+			Uint32 *tmp = rows[0];
+			rows[0] = rows[1];
+			rows[1] = tmp;
+			row_index[0] = y0;
+			row_index[1] = -1;
+		}
+		if ( row_index[0] != y0 ) {
+			source_row_linear(job, y0, rows[0]);
+			row_index[0] = y0;
+		}
+		a = rows[0];
+		src = a;
+		if ( f ) {
+			if ( row_index[1] != y1 ) {
+				source_row_linear(job, y1, rows[1]);
+				row_index[1] = y1;
+			}
+			b = rows[1];
+			lerp_row(a, b, blended, src_w + 1, f);
+			src = blended;
+		}
+
+		if ( bpp == 4 ) {
+			linear_row(src, (Uint32 *)dstp, job->xofs, job->xfrac, dst_w);
+		} else {
+			linear_row(src, out, job->xofs, job->xfrac, dst_w);
+			pack_row2(out, (Uint16 *)dstp, dst_w, job->dst->format);
+		}
+	}
+}
+
+static void stretch_rows(StretchWorker *worker)
+{
+	if ( stretch_job.linear ) {
+		stretch_rows_linear(&stretch_job, worker, worker->row_start, worker->row_end);
+	} else {
+		stretch_rows_nearest(&stretch_job, worker->row_start, worker->row_end);
+	}
+}
+
+static int SDLCALL stretch_thread(void *data)
+{
+	StretchWorker *worker = (StretchWorker *)data;
+	for ( ;; ) {
+		SDL_SemWait(worker->start);
+		if ( stretch_quit ) {
+			break;
+		}
+		stretch_rows(worker);
+		SDL_SemPost(stretch_done);
+	}
+	return 0;
+}
+
+/* Starts worker threads on first big blit, workers[0] is the calling thread */
+static int stretch_init_threads(void)
+{
+	int cpus = 1;
+	int i;
+
+	if ( stretch_done ) {
+		return stretch_threads;
+	}
+#if HAVE_SYSCONF && defined(_SC_NPROCESSORS_ONLN)
+	cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	cpus = SDL_max(1, SDL_min(cpus, STRETCH_MAX_THREADS));
+	stretch_done = SDL_CreateSemaphore(0);
+	if ( !stretch_done ) {
+		return 0;
+	}
+	stretch_quit = 0;
+	for ( i=1; i<cpus; ++i ) {
+		StretchWorker *worker = &stretch_workers[i];
+		worker->start = SDL_CreateSemaphore(0);
+		if ( !worker->start ) {
+			break;
+		}
+		worker->thread = SDL_CreateThread(stretch_thread, worker);
+		if ( !worker->thread ) {
+			SDL_DestroySemaphore(worker->start);
+			worker->start = NULL;
+			break;
+		}
+		stretch_threads = i;
+	}
+	return stretch_threads;
+}
+
+void SDL_StretchQuit(void)
+{
+	int i;
+
+	if ( !stretch_done ) {
+		return;
+	}
+	stretch_quit = 1;
+	for ( i=1; i<=stretch_threads; ++i ) {
+		SDL_SemPost(stretch_workers[i].start);
+		SDL_WaitThread(stretch_workers[i].thread, NULL);
+		SDL_DestroySemaphore(stretch_workers[i].start);
+	}
+	for ( i=0; i<STRETCH_MAX_THREADS; ++i ) {
+		SDL_free(stretch_workers[i].buf);
+	}
+	SDL_memset(stretch_workers, 0, sizeof(stretch_workers));
+	SDL_DestroySemaphore(stretch_done);
+	stretch_done = NULL;
+	stretch_threads = 0;
+
+	SDL_free(stretch_job.xofs);
+	SDL_free(stretch_job.yofs);
+	SDL_memset(&stretch_job, 0, sizeof(stretch_job));
+}
+
+/* Tables are kept between calls, games stretch the same rects every frame */
+static int stretch_prepare_tables(StretchJob *job, SDL_Rect *srcrect, SDL_Rect *dstrect, int linear)
+{
+	static SDL_Rect last_src, last_dst;
+	static int last_linear = -1;
+
+	if ( job->xofs && linear == last_linear &&
+	     srcrect->w == last_src.w && srcrect->h == last_src.h &&
+	     dstrect->w == last_dst.w && dstrect->h == last_dst.h ) {
+		return 0;
+	}
+	SDL_free(job->xofs);
+	SDL_free(job->yofs);
+	job->xofs = (int *)SDL_malloc(dstrect->w * (sizeof(int) + 1));
+	job->yofs = (int *)SDL_malloc(dstrect->h * (sizeof(int) + 1));
+	if ( !job->xofs || !job->yofs ) {
+		SDL_free(job->xofs);
+		SDL_free(job->yofs);
+		job->xofs = job->yofs = NULL;
+		SDL_OutOfMemory();
+		return -1;
+	}
+	job->xfrac = (Uint8 *)(job->xofs + dstrect->w);
+	job->yfrac = (Uint8 *)(job->yofs + dstrect->h);
+	build_table(srcrect->w, dstrect->w, linear, job->xofs, job->xfrac);
+	build_table(srcrect->h, dstrect->h, linear, job->yofs, job->yfrac);
+	last_src = *srcrect;
+	last_dst = *dstrect;
+	last_linear = linear;
+	return 0;
+}
+
+static int stretch(SDL_Surface *src, SDL_Rect *srcrect,
+                   SDL_Surface *dst, SDL_Rect *dstrect, int linear)
 {
 	int src_locked;
 	int dst_locked;
-	int pos, inc;
-	int dst_width;
-	int dst_maxrow;
-	int src_row, dst_row;
-	Uint8 *srcp = NULL;
-	Uint8 *dstp;
+	int threads = 0;
+	int i;
 	SDL_Rect full_src;
 	SDL_Rect full_dst;
-#ifdef USE_ASM_STRETCH
-	SDL_bool use_asm = SDL_TRUE;
-#ifdef __GNUC__
-	int u1, u2;
-#endif
-#endif /* USE_ASM_STRETCH */
 	const int bpp = dst->format->BytesPerPixel;
 
 	if ( src->format->BitsPerPixel != dst->format->BitsPerPixel ) {
@@ -254,6 +649,17 @@ int SDL_SoftStretch(SDL_Surface *src, SDL_Rect *srcrect,
 		full_dst.h = dst->h;
 		dstrect = &full_dst;
 	}
+	if ( !srcrect->w || !srcrect->h || !dstrect->w || !dstrect->h ) {
+		return(0);
+	}
+
+	/* Bilinear filtering needs channels of whole bytes, or 16 bpp pixels to unpack */
+	if ( bpp != 2 && bpp != 4 ) {
+		linear = 0;
+	}
+	if ( stretch_prepare_tables(&stretch_job, srcrect, dstrect, linear) < 0 ) {
+		return(-1);
+	}
 
 	/* Lock the destination if it's in hardware */
 	dst_locked = 0;
@@ -277,75 +683,26 @@ int SDL_SoftStretch(SDL_Surface *src, SDL_Rect *srcrect,
 		src_locked = 1;
 	}
 
-	/* Set up the data... */
-	pos = 0x10000;
-	inc = (srcrect->h << 16) / dstrect->h;
-	src_row = srcrect->y;
-	dst_row = dstrect->y;
-	dst_width = dstrect->w*bpp;
-
-#ifdef USE_ASM_STRETCH
-	/* Write the opcodes for this stretch */
-	if ( (bpp == 3) ||
-	     (generate_rowbytes(srcrect->w, dstrect->w, bpp) < 0) ) {
-		use_asm = SDL_FALSE;
-	}
-#endif
-
 	/* Perform the stretch blit */
-	for ( dst_maxrow = dst_row+dstrect->h; dst_row<dst_maxrow; ++dst_row ) {
-		dstp = (Uint8 *)dst->pixels + (dst_row*dst->pitch)
-		                            + (dstrect->x*bpp);
-		while ( pos >= 0x10000L ) {
-			srcp = (Uint8 *)src->pixels + (src_row*src->pitch)
-			                            + (srcrect->x*bpp);
-			++src_row;
-			pos -= 0x10000L;
-		}
-#ifdef USE_ASM_STRETCH
-		if (use_asm) {
-#ifdef __GNUC__
-			__asm__ __volatile__ (
-			"call *%4"
-			: "=&D" (u1), "=&S" (u2)
-			: "0" (dstp), "1" (srcp), "r" (copy_row)
-			: "memory" );
-#elif defined(_MSC_VER) || defined(__WATCOMC__)
-		{ void *code = copy_row;
-			__asm {
-				push edi
-				push esi
-	
-				mov edi, dstp
-				mov esi, srcp
-				call dword ptr code
-
-				pop esi
-				pop edi
-			}
-		}
-#else
-#error Need inline assembly for this compiler
-#endif
-		} else
-#endif
-		switch (bpp) {
-		    case 1:
-			copy_row1(srcp, srcrect->w, dstp, dstrect->w);
-			break;
-		    case 2:
-			copy_row2((Uint16 *)srcp, srcrect->w,
-			          (Uint16 *)dstp, dstrect->w);
-			break;
-		    case 3:
-			copy_row3(srcp, srcrect->w, dstp, dstrect->w);
-			break;
-		    case 4:
-			copy_row4((Uint32 *)srcp, srcrect->w,
-			          (Uint32 *)dstp, dstrect->w);
-			break;
-		}
-		pos += inc;
+	stretch_job.src = src;
+	stretch_job.dst = dst;
+	stretch_job.srcrect = *srcrect;
+	stretch_job.dstrect = *dstrect;
+	stretch_job.linear = linear;
+
+	if ( dstrect->w * dstrect->h >= STRETCH_THREADED_PIXELS ) {
+		threads = SDL_min(stretch_init_threads(), dstrect->h / 16);
+	}
+	for ( i=0; i<=threads; ++i ) {
+		stretch_workers[i].row_start = dstrect->h * i / (threads + 1);
+		stretch_workers[i].row_end = dstrect->h * (i + 1) / (threads + 1);
+	}
+	for ( i=1; i<=threads; ++i ) {
+		SDL_SemPost(stretch_workers[i].start);
+	}
+	stretch_rows(&stretch_workers[0]);
+	for ( i=1; i<=threads; ++i ) {
+		SDL_SemWait(stretch_done);
 	}
 
 	/* We need to unlock the surfaces if they're locked */
@@ -358,3 +715,18 @@ int SDL_SoftStretch(SDL_Surface *src, SDL_Rect *srcrect,
 	return(0);
 }
 
+/* Perform a stretch blit between two surfaces of the same format.
+   NOTE:  This function is not safe to call from multiple threads!
+*/
+int SDL_SoftStretch(SDL_Surface *src, SDL_Rect *srcrect,
+                    SDL_Surface *dst, SDL_Rect *dstrect)
+{
+	return stretch(src, srcrect, dst, dstrect, 0);
+}
+
+/* Same as SDL_SoftStretch(), with bilinear filtering for 16 and 32 bpp surfaces */
+int SDL_SoftStretchLinear(SDL_Surface *src, SDL_Rect *srcrect,
+                          SDL_Surface *dst, SDL_Rect *dstrect)
+{
+	return stretch(src, srcrect, dst, dstrect, 1);
+}
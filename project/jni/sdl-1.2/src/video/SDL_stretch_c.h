@@ -27,3 +27,18 @@
 extern int SDL_SoftStretch(SDL_Surface *src, SDL_Rect *srcrect,
                            SDL_Surface *dst, SDL_Rect *dstrect);
 
+/* Same as SDL_SoftStretch(), with bilinear filtering for 16 and 32 bpp surfaces */
+extern int SDL_SoftStretchLinear(SDL_Surface *src, SDL_Rect *srcrect,
+                                 SDL_Surface *dst, SDL_Rect *dstrect);
+
+/* Stops stretch worker threads, called from SDL_VideoQuit() */
+extern void SDL_StretchQuit(void);
+
+#if SDL_NEON_BLITTERS
+/* NEON row scalers from SDL_stretch_neon.c, they return the amount of pixels done */
+extern int SDL_StretchRepeatRow2NEON(const Uint16 *src, int src_w, Uint16 *dst, int factor);
+extern int SDL_StretchRepeatRow4NEON(const Uint32 *src, int src_w, Uint32 *dst, int factor);
+extern int SDL_StretchLerpRowNEON(const Uint32 *a, const Uint32 *b, Uint32 *dst, int width, int f);
+extern int SDL_StretchLinearRowNEON(const Uint32 *src, Uint32 *dst, const int *xofs, const Uint8 *xfrac, int width);
+#endif
+
@@ -0,0 +1,125 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2009 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#include "SDL_video.h"
+#include "SDL_blit.h"
+#include "SDL_stretch_c.h"
+
+/*
+ * NEON row scalers for SDL_stretch.c, selected at runtime with SDL_HasNEON().
+ * Like SDL_blit_A_neon.c, this file is compiled with -mfpu=neon on ARMv7.
+ * Each function returns the amount of pixels done, the rest is done in C.
+ */
+
+#if SDL_NEON_BLITTERS
+
+#include <arm_neon.h>
+
+/* Every source pixel is repeated 'factor' times */
+int SDL_StretchRepeatRow2NEON(const Uint16 *src, int src_w, Uint16 *dst, int factor)
+{
+	int i, j;
+	if ( factor == 2 ) {
+		for ( i=0; i+8<=src_w; i+=8, src+=8, dst+=16 ) {
+			uint16x8x2_t d;
+			d.val[0] = d.val[1] = vld1q_u16(src);
+			vst2q_u16(dst, d);
+		}
+		return i;
+	}
+	if ( factor < 8 ) {
+		return 0;
+	}
+	for ( i=0; i<src_w; ++i, dst+=factor ) {
+		uint16x8_t s = vdupq_n_u16(src[i]);
+		for ( j=0; j+8<=factor; j+=8 ) {
+			vst1q_u16(dst + j, s);
+		}
+		vst1q_u16(dst + factor - 8, s);
+	}
+	return i;
+}
+
+int SDL_StretchRepeatRow4NEON(const Uint32 *src, int src_w, Uint32 *dst, int factor)
+{
+	int i, j;
+	if ( factor == 2 ) {
+		for ( i=0; i+4<=src_w; i+=4, src+=4, dst+=8 ) {
+			uint32x4x2_t d;
+			d.val[0] = d.val[1] = vld1q_u32(src);
+			vst2q_u32(dst, d);
+		}
+		return i;
+	}
+	if ( factor < 4 ) {
+		return 0;
+	}
+	for ( i=0; i<src_w; ++i, dst+=factor ) {
+		uint32x4_t s = vdupq_n_u32(src[i]);
+		for ( j=0; j+4<=factor; j+=4 ) {
+			vst1q_u32(dst + j, s);
+		}
+		vst1q_u32(dst + factor - 4, s);
+	}
+	return i;
+}
+
+/* (a * (256 - f) + b * f) >> 8 for 8 channels, the same as lerp_pixel() in SDL_stretch.c */
+static __inline__ uint8x8_t lerp8_neon(uint8x8_t a, uint8x8_t b, uint16x8_t f)
+{
+	uint16x8_t t = vshlq_n_u16(vmovl_u8(a), 8);
+	t = vmlaq_u16(t, vsubq_u16(vmovl_u8(b), vmovl_u8(a)), f);
+	return vshrn_n_u16(t, 8);
+}
+
+int SDL_StretchLerpRowNEON(const Uint32 *a, const Uint32 *b, Uint32 *dst, int width, int f)
+{
+	const uint16x8_t f16 = vdupq_n_u16(f);
+	int i;
+	for ( i=0; i+2<=width; i+=2 ) {
+		uint8x8_t a8 = vreinterpret_u8_u32(vld1_u32(a + i));
+		uint8x8_t b8 = vreinterpret_u8_u32(vld1_u32(b + i));
+		vst1_u32(dst + i, vreinterpret_u32_u8(lerp8_neon(a8, b8, f16)));
+	}
+	return i;
+}
+
+int SDL_StretchLinearRowNEON(const Uint32 *src, Uint32 *dst, const int *xofs, const Uint8 *xfrac, int width)
+{
+	int i;
+	for ( i=0; i+2<=width; i+=2 ) {
+		uint32x2_t a = vdup_n_u32(0), b = vdup_n_u32(0);
+		uint16x4_t f0 = vdup_n_u16(xfrac[i]);
+		uint16x4_t f1 = vdup_n_u16(xfrac[i + 1]);
+		a = vld1_lane_u32(src + xofs[i], a, 0);
+		a = vld1_lane_u32(src + xofs[i + 1], a, 1);
+		b = vld1_lane_u32(src + xofs[i] + 1, b, 0);
+		b = vld1_lane_u32(src + xofs[i + 1] + 1, b, 1);
+		vst1_u32(dst + i, vreinterpret_u32_u8(lerp8_neon(vreinterpret_u8_u32(a),
+		                                                 vreinterpret_u8_u32(b),
+		                                                 vcombine_u16(f0, f1))));
+	}
+	return i;
+}
+
+#endif /* SDL_NEON_BLITTERS */
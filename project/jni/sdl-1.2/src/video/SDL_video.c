@@ -26,6 +26,7 @@
 #include "SDL.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
+#include "SDL_stretch_c.h"
 #include "SDL_pixels_c.h"
 #include "SDL_cursor_c.h"
 #include "../events/SDL_sysevents.h"
@@ -1361,6 +1362,7 @@ void SDL_VideoQuit (void)
 			SDL_PublicSurface = NULL;
 		}
 		SDL_CursorQuit();
+		SDL_StretchQuit();
 
 		/* Just in case... */
 		SDL_WM_GrabInputOff();
@@ -49,7 +49,7 @@ If you compile this code with SDL 1.3 or newer, or use in some other way, the li
 #include "unicodestuff.h"
 #include "atan2i.h"
 
-#ifndef SDL_COMPATIBILITY_HACKS_SLOW_COMPATIBLE_EVENT_QUEUE
+#if !defined(SDL_COMPATIBILITY_HACKS_SLOW_COMPATIBLE_EVENT_QUEUE) && !defined(SDL_ANDROID_LOCKFREE_EVENT_QUEUE)
 
 #if SDL_VERSION_ATLEAST(1,3,0)
 
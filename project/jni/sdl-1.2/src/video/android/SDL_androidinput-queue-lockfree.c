@@ -0,0 +1,659 @@
+/*
+Simple DirectMedia Layer
+Copyright (C) 2009-2014 Sergii Pylypenko
+
+This software is provided 'as-is', without any express or implied
+warranty.  In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not
+   claim that you wrote the original software. If you use this software
+   in a product, an acknowledgment in the product documentation would be
+   appreciated but is not required.
+2. Altered source versions must be plainly marked as such, and must not be
+   misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+/*
+This source code is distibuted under ZLIB license, however when compiling with SDL 1.2,
+which is licensed under LGPL, the resulting library, and all it's source code,
+falls under "stronger" LGPL terms, so is this file.
+If you compile this code with SDL 1.3 or newer, or use in some other way, the license stays ZLIB.
+*/
+
+#include <jni.h>
+#include <android/log.h>
+#include <sys/time.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h> // for memset()
+
+#include "SDL_config.h"
+
+#include "SDL_version.h"
+#include "SDL_mutex.h"
+#include "SDL_thread.h"
+#include "SDL_events.h"
+#if SDL_VERSION_ATLEAST(1,3,0)
+#include "SDL_touch.h"
+#include "../../events/SDL_touch_c.h"
+#endif
+
+#include "../SDL_sysvideo.h"
+#include "SDL_androidvideo.h"
+#include "SDL_androidinput.h"
+#include "unicodestuff.h"
+#include "atan2i.h"
+
+#if defined(SDL_ANDROID_LOCKFREE_EVENT_QUEUE) && !defined(SDL_COMPATIBILITY_HACKS_SLOW_COMPATIBLE_EVENT_QUEUE)
+
+#if SDL_VERSION_ATLEAST(1,3,0)
+
+#define SDL_SendKeyboardKey(state, keysym) SDL_SendKeyboardKey(state, (keysym)->sym)
+extern SDL_Window * ANDROID_CurrentWindow;
+
+#else
+
+#define SDL_SendMouseMotion(A,B,X,Y) SDL_PrivateMouseMotion(0, 0, X, Y)
+#define SDL_SendMouseButton(N, A, B) SDL_PrivateMouseButton( A, B, 0, 0 )
+#define SDL_SendKeyboardKey(state, keysym) SDL_PrivateKeyboard(state, keysym)
+
+#endif
+
+/* Events from Java threads are written to fixed-size single-producer/single-consumer rings,
+ * one ring per Java thread, so producers never wait for each other or for the main thread.
+ * A ring is given back when its thread exits. Threads which find no free ring share
+ * one more ring under a spinlock, instead of losing their events.
+ * Every event gets a sequence number when it is pushed, SDL_ANDROID_PumpEvents() drains
+ * all rings and merges them by it, so events from different threads, like a key from
+ * the UI thread and touch from the GL thread, reach SDL in the order they were pushed.
+ * Only an event which is being pushed while the rings are drained may come one pump late.
+ * Motion events which are followed by newer motion of the same pointer are skipped.
+ * Events pushed from the main thread itself are sent to SDL immediately, like in the fast queue.
+ */
+
+enum RingEventType_t { RING_MOUSE_MOTION = 1, RING_MOUSE_BUTTON, RING_KEY, RING_JOY_AXIS, RING_JOY_BUTTON,
+						RING_JOY_BALL, RING_TOUCH_BUTTON, RING_TOUCH_MOTION, RING_MOUSE_WHEEL, RING_APP_ACTIVE };
+
+typedef struct
+{
+	Uint8 type;
+	Uint8 which; // Joystick or touch pointer
+	Uint16 code; // Key, axis, ball or button
+	int x;
+	int y;
+	int value; // Pressed state, axis value, unicode or force
+	Uint32 seq; // Push order across all rings
+} RingEvent_t;
+
+enum { EVENT_RING_SIZE = 256, EVENT_RING_COUNT = 8 }; // EVENT_RING_SIZE has to be a power of 2
+
+typedef struct
+{
+	volatile Uint32 owner; // Producer thread ID, 0 if ring is free
+	volatile unsigned int head; // Written only by producer
+	volatile unsigned int tail; // Written only by consumer
+	RingEvent_t events[EVENT_RING_SIZE];
+} EventRing_t;
+
+static EventRing_t eventRings[EVENT_RING_COUNT + 1]; // The last one is shared, under sharedRingLock
+static volatile int sharedRingLock = 0;
+static volatile Uint32 eventSeq = 0;
+static pthread_key_t eventRingKey;
+static pthread_once_t eventRingKeyOnce = PTHREAD_ONCE_INIT;
+static volatile Uint32 mainThreadID = 0;
+static volatile int eventsCoalesced = 0;
+static volatile int eventsDropped = 0;
+static int oldMouseButtons = 0;
+
+static void dispatchEvent(const RingEvent_t * ev);
+
+// Called when a thread which owns a ring exits, the events it left are still drained
+static void releaseEventRing(void * ring)
+{
+	__sync_synchronize(); // The last head must be visible to the next owner
+	((EventRing_t *)ring)->owner = 0;
+}
+
+static void createEventRingKey(void)
+{
+	pthread_key_create(&eventRingKey, releaseEventRing);
+}
+
+static EventRing_t * getEventRing(Uint32 thread)
+{
+	EventRing_t * ring;
+	int i;
+
+	pthread_once(&eventRingKeyOnce, createEventRingKey);
+	ring = (EventRing_t *)pthread_getspecific(eventRingKey);
+	if( ring )
+		return ring;
+	for( i = 0; i < EVENT_RING_COUNT; i++ )
+	{
+		if( __sync_bool_compare_and_swap(&eventRings[i].owner, 0, thread) )
+		{
+			if( pthread_setspecific(eventRingKey, &eventRings[i]) != 0 )
+			{
+				eventRings[i].owner = 0;
+				break;
+			}
+			return &eventRings[i];
+		}
+	}
+	return NULL;
+}
+
+static void pushEvent(const RingEvent_t * ev)
+{
+	Uint32 thread = SDL_ThreadID();
+	EventRing_t * ring;
+	unsigned int head;
+	int shared = 0;
+
+	if( thread == mainThreadID )
+	{
+		dispatchEvent(ev);
+		return;
+	}
+
+	ring = getEventRing(thread);
+	if( !ring )
+	{
+		ring = &eventRings[EVENT_RING_COUNT];
+		shared = 1;
+		while( __sync_lock_test_and_set(&sharedRingLock, 1) )
+			;
+	}
+	head = ring->head;
+	if( head - ring->tail >= EVENT_RING_SIZE )
+		__sync_fetch_and_add(&eventsDropped, 1);
+	else
+	{
+		RingEvent_t * dst = &ring->events[head & (EVENT_RING_SIZE - 1)];
+		*dst = *ev;
+		dst->seq = __sync_fetch_and_add(&eventSeq, 1);
+		__sync_synchronize(); // Event data must be visible before the new head
+		ring->head = head + 1;
+	}
+	if( shared )
+		__sync_lock_release(&sharedRingLock);
+}
+
+static int isMotionEvent(const RingEvent_t * ev)
+{
+	return ev->type == RING_MOUSE_MOTION || ev->type == RING_TOUCH_MOTION || ev->type == RING_JOY_AXIS;
+}
+
+// Motion event may be skipped, if it's followed by another motion event of the same pointer
+// without any button or key event in between
+static int isCoalesced(const RingEvent_t * events, int count, int idx)
+{
+	const RingEvent_t * ev = &events[idx];
+	int i;
+	if( !isMotionEvent(ev) )
+		return 0;
+	for( i = idx + 1; i < count && isMotionEvent(&events[i]); i++ )
+	{
+		if( events[i].type == ev->type && events[i].which == ev->which && events[i].code == ev->code )
+			return 1;
+	}
+	return 0;
+}
+
+extern void SDL_ANDROID_PumpEvents()
+{
+	static RingEvent_t events[(EVENT_RING_COUNT + 1) * EVENT_RING_SIZE];
+	static RingEvent_t merged[(EVENT_RING_COUNT + 1) * EVENT_RING_SIZE];
+	int start[EVENT_RING_COUNT + 1], end[EVENT_RING_COUNT + 1];
+	int i, r, count = 0;
+
+	mainThreadID = SDL_ThreadID();
+
+	// Rings stay drained after their thread released them, so a ring can't be skipped
+	for( r = 0; r < EVENT_RING_COUNT + 1; r++ )
+	{
+		EventRing_t * ring = &eventRings[r];
+		unsigned int head = ring->head, tail = ring->tail;
+
+		start[r] = count;
+		__sync_synchronize(); // Read events only after reading the head
+		for( ; tail != head; tail++, count++ )
+			events[count] = ring->events[tail & (EVENT_RING_SIZE - 1)];
+		__sync_synchronize(); // Copy events before releasing ring space to producer
+		ring->tail = tail;
+		end[r] = count;
+	}
+
+	// Each ring is in push order already, merge them
+	for( i = 0; i < count; i++ )
+	{
+		int next = -1;
+		for( r = 0; r < EVENT_RING_COUNT + 1; r++ )
+		{
+			if( start[r] < end[r] && ( next < 0 ||
+				(Sint32)(events[start[r]].seq - events[start[next]].seq) < 0 ) )
+				next = r;
+		}
+		merged[i] = events[start[next]++];
+	}
+
+	for( i = 0; i < count; i++ )
+	{
+		if( isCoalesced(merged, count, i) )
+			eventsCoalesced++;
+		else
+			dispatchEvent(&merged[i]);
+	}
+
+	SDL_ANDROID_processMoveMouseWithKeyboard();
+};
+
+int SDLCALL SDL_ANDROID_GetInputQueueStats(int *coalesced, int *dropped)
+{
+	if( coalesced )
+		*coalesced = eventsCoalesced;
+	if( dropped )
+		*dropped = eventsDropped;
+	return 1;
+}
+
+static void dispatchMouseButton(int pressed, int button)
+{
+	if( ((oldMouseButtons & SDL_BUTTON(button)) != 0) != pressed )
+	{
+		oldMouseButtons = (oldMouseButtons & ~SDL_BUTTON(button)) | (pressed ? SDL_BUTTON(button) : 0);
+		SDL_SendMouseButton( ANDROID_CurrentWindow, pressed, button );
+	}
+}
+
+static void dispatchKeyboardKey(int pressed, SDL_scancode key, int unicode)
+{
+	SDL_keysym keysym;
+
+	if( SDL_ANDROID_moveMouseWithArrowKeys && (
+		key == SDL_KEY(UP) || key == SDL_KEY(DOWN) ||
+		key == SDL_KEY(LEFT) || key == SDL_KEY(RIGHT) ) )
+	{
+		if( SDL_ANDROID_moveMouseWithKbX < 0 )
+		{
+			SDL_ANDROID_moveMouseWithKbX = SDL_ANDROID_currentMouseX;
+			SDL_ANDROID_moveMouseWithKbY = SDL_ANDROID_currentMouseY;
+		}
+
+		if( pressed )
+		{
+			if( key == SDL_KEY(LEFT) )
+			{
+				if( SDL_ANDROID_moveMouseWithKbSpeedX > 0 )
+					SDL_ANDROID_moveMouseWithKbSpeedX = 0;
+				SDL_ANDROID_moveMouseWithKbSpeedX -= SDL_ANDROID_moveMouseWithKbSpeed;
+				SDL_ANDROID_moveMouseWithKbAccelX = -SDL_ANDROID_moveMouseWithKbAccel;
+				SDL_ANDROID_moveMouseWithKbAccelUpdateNeeded |= 1;
+			}
+			else if( key == SDL_KEY(RIGHT) )
+			{
+				if( SDL_ANDROID_moveMouseWithKbSpeedX < 0 )
+					SDL_ANDROID_moveMouseWithKbSpeedX = 0;
+				SDL_ANDROID_moveMouseWithKbSpeedX += SDL_ANDROID_moveMouseWithKbSpeed;
+				SDL_ANDROID_moveMouseWithKbAccelX = SDL_ANDROID_moveMouseWithKbAccel;
+				SDL_ANDROID_moveMouseWithKbAccelUpdateNeeded |= 1;
+			}
+
+			if( key == SDL_KEY(UP) )
+			{
+				if( SDL_ANDROID_moveMouseWithKbSpeedY > 0 )
+					SDL_ANDROID_moveMouseWithKbSpeedY = 0;
+				SDL_ANDROID_moveMouseWithKbSpeedY -= SDL_ANDROID_moveMouseWithKbSpeed;
+				SDL_ANDROID_moveMouseWithKbAccelY = -SDL_ANDROID_moveMouseWithKbAccel;
+				SDL_ANDROID_moveMouseWithKbAccelUpdateNeeded |= 2;
+			}
+			else if( key == SDL_KEY(DOWN) )
+			{
+				if( SDL_ANDROID_moveMouseWithKbSpeedY < 0 )
+					SDL_ANDROID_moveMouseWithKbSpeedY = 0;
+				SDL_ANDROID_moveMouseWithKbSpeedY += SDL_ANDROID_moveMouseWithKbSpeed;
+				SDL_ANDROID_moveMouseWithKbAccelY = SDL_ANDROID_moveMouseWithKbAccel;
+				SDL_ANDROID_moveMouseWithKbAccelUpdateNeeded |= 2;
+			}
+		}
+		else
+		{
+			if( key == SDL_KEY(LEFT) || key == SDL_KEY(RIGHT) )
+			{
+				SDL_ANDROID_moveMouseWithKbSpeedX = 0;
+				SDL_ANDROID_moveMouseWithKbAccelX = 0;
+				SDL_ANDROID_moveMouseWithKbAccelUpdateNeeded &= ~1;
+			}
+			if( key == SDL_KEY(UP) || key == SDL_KEY(DOWN) )
+			{
+				SDL_ANDROID_moveMouseWithKbSpeedY = 0;
+				SDL_ANDROID_moveMouseWithKbAccelY = 0;
+				SDL_ANDROID_moveMouseWithKbAccelUpdateNeeded &= ~2;
+			}
+		}
+
+		SDL_ANDROID_moveMouseWithKbX += SDL_ANDROID_moveMouseWithKbSpeedX;
+		SDL_ANDROID_moveMouseWithKbY += SDL_ANDROID_moveMouseWithKbSpeedY;
+
+		SDL_ANDROID_MainThreadPushMouseMotion(SDL_ANDROID_moveMouseWithKbX, SDL_ANDROID_moveMouseWithKbY);
+		return;
+	}
+
+	if ( key >= SDLK_MOUSE_LEFT && key <= SDLK_MOUSE_X2 )
+	{
+		SDL_ANDROID_MainThreadPushMouseButton(pressed, key - SDLK_MOUSE_LEFT + SDL_BUTTON_LEFT);
+		return;
+	}
+
+	keysym.scancode = key;
+	if ( key < SDLK_LAST )
+		keysym.scancode = SDL_android_keysym_to_scancode[key];
+	keysym.sym = key;
+	keysym.mod = KMOD_NONE;
+	keysym.unicode = 0;
+#if SDL_VERSION_ATLEAST(1,3,0)
+#else
+	if ( SDL_TranslateUNICODE )
+#endif
+		keysym.unicode = unicode;
+	if( (keysym.unicode & 0xFF80) != 0 )
+		keysym.sym = SDLK_WORLD_0;
+
+	if( pressed == SDL_RELEASED )
+		keysym.unicode = 0;
+
+	SDL_SendKeyboardKey( pressed, &keysym );
+}
+
+static void dispatchEvent(const RingEvent_t * ev)
+{
+	switch( ev->type )
+	{
+		case RING_MOUSE_MOTION:
+			SDL_SendMouseMotion( ANDROID_CurrentWindow, 0, ev->x, ev->y );
+			break;
+		case RING_MOUSE_BUTTON:
+			dispatchMouseButton( ev->value, ev->code );
+			break;
+		case RING_KEY:
+			dispatchKeyboardKey( ev->x, ev->code, ev->value );
+			break;
+		case RING_JOY_AXIS:
+			if( SDL_ANDROID_CurrentJoysticks[ev->which] )
+				SDL_PrivateJoystickAxis( SDL_ANDROID_CurrentJoysticks[ev->which], ev->code, ev->value );
+			break;
+		case RING_JOY_BUTTON:
+			if( SDL_ANDROID_CurrentJoysticks[ev->which] )
+				SDL_PrivateJoystickButton( SDL_ANDROID_CurrentJoysticks[ev->which], ev->code, ev->value );
+			break;
+		case RING_JOY_BALL:
+			if( SDL_ANDROID_CurrentJoysticks[ev->which] )
+				SDL_PrivateJoystickBall( SDL_ANDROID_CurrentJoysticks[ev->which], ev->code, ev->x, ev->y );
+			break;
+#if SDL_VERSION_ATLEAST(1,3,0)
+		case RING_TOUCH_BUTTON:
+			SDL_SendFingerDown(0, ev->which, ev->code ? 1 : 0, (float)ev->x / (float)window->w, (float)ev->y / (float)window->h, ev->value);
+			break;
+		case RING_TOUCH_MOTION:
+			SDL_SendTouchMotion(0, ev->which, 0, (float)ev->x / (float)window->w, (float)ev->y / (float)window->h, ev->value);
+			break;
+		case RING_MOUSE_WHEEL:
+			SDL_SendMouseWheel( ANDROID_CurrentWindow, ev->x, ev->y );
+			break;
+#else
+		case RING_APP_ACTIVE:
+			SDL_PrivateAppActive(ev->value, SDL_APPACTIVE|SDL_APPINPUTFOCUS|SDL_APPMOUSEFOCUS);
+			break;
+#endif
+	}
+}
+
+extern void SDL_ANDROID_MainThreadPushMouseMotion(int x, int y)
+{
+	RingEvent_t ev;
+
+	SDL_ANDROID_currentMouseX = x;
+	SDL_ANDROID_currentMouseY = y;
+
+	SDL_memset(&ev, 0, sizeof(ev));
+	ev.type = RING_MOUSE_MOTION;
+	ev.x = x;
+	ev.y = y;
+	pushEvent(&ev);
+}
+
+extern void SDL_ANDROID_MainThreadPushMouseButton(int pressed, int button)
+{
+	RingEvent_t ev;
+
+	if(pressed)
+		SDL_ANDROID_currentMouseButtons |= SDL_BUTTON(button);
+	else
+		SDL_ANDROID_currentMouseButtons &= ~(SDL_BUTTON(button));
+
+	SDL_memset(&ev, 0, sizeof(ev));
+	ev.type = RING_MOUSE_BUTTON;
+	ev.code = button;
+	ev.value = pressed;
+	pushEvent(&ev);
+}
+
+extern void SDL_ANDROID_MainThreadPushKeyboardKey(int pressed, SDL_scancode key, int unicode)
+{
+	RingEvent_t ev;
+
+	SDL_memset(&ev, 0, sizeof(ev));
+	ev.type = RING_KEY;
+	ev.code = key;
+	ev.x = pressed;
+	ev.value = unicode;
+	pushEvent(&ev);
+}
+
+extern void SDL_ANDROID_MainThreadPushJoystickAxis(int joy, int axis, int value)
+{
+	RingEvent_t ev;
+
+	if( ! ( joy < MAX_MULTITOUCH_POINTERS+1 && SDL_ANDROID_CurrentJoysticks[joy] ) )
+		return;
+
+	SDL_memset(&ev, 0, sizeof(ev));
+	ev.type = RING_JOY_AXIS;
+	ev.which = joy;
+	ev.code = axis;
+	ev.value = MAX( -32768, MIN( 32767, value ) );
+	pushEvent(&ev);
+}
+
+extern void SDL_ANDROID_MainThreadPushJoystickButton(int joy, int button, int pressed)
+{
+	RingEvent_t ev;
+
+	if( ! ( joy < MAX_MULTITOUCH_POINTERS+1 && SDL_ANDROID_CurrentJoysticks[joy] ) )
+		return;
+
+	SDL_memset(&ev, 0, sizeof(ev));
+	ev.type = RING_JOY_BUTTON;
+	ev.which = joy;
+	ev.code = button;
+	ev.value = pressed;
+	pushEvent(&ev);
+}
+
+extern void SDL_ANDROID_MainThreadPushJoystickBall(int joy, int ball, int x, int y)
+{
+	RingEvent_t ev;
+
+	if( ! ( joy < MAX_MULTITOUCH_POINTERS+1 && SDL_ANDROID_CurrentJoysticks[joy] ) )
+		return;
+
+	SDL_memset(&ev, 0, sizeof(ev));
+	ev.type = RING_JOY_BALL;
+	ev.which = joy;
+	ev.code = ball;
+	ev.x = x;
+	ev.y = y;
+	pushEvent(&ev);
+}
+
+extern void SDL_ANDROID_MainThreadPushMultitouchButton(int id, int pressed, int x, int y, int force)
+{
+#if SDL_VERSION_ATLEAST(1,3,0)
+	RingEvent_t ev;
+
+	SDL_memset(&ev, 0, sizeof(ev));
+	ev.type = RING_TOUCH_BUTTON;
+	ev.which = id;
+	ev.code = pressed;
+	ev.x = x;
+	ev.y = y;
+	ev.value = force;
+	pushEvent(&ev);
+#endif
+}
+
+extern void SDL_ANDROID_MainThreadPushMultitouchMotion(int id, int x, int y, int force)
+{
+#if SDL_VERSION_ATLEAST(1,3,0)
+	RingEvent_t ev;
+
+	SDL_memset(&ev, 0, sizeof(ev));
+	ev.type = RING_TOUCH_MOTION;
+	ev.which = id;
+	ev.x = x;
+	ev.y = y;
+	ev.value = force;
+	pushEvent(&ev);
+#endif
+}
+
+extern void SDL_ANDROID_MainThreadPushMouseWheel(int x, int y)
+{
+#if SDL_VERSION_ATLEAST(1,3,0)
+	RingEvent_t ev;
+
+	SDL_memset(&ev, 0, sizeof(ev));
+	ev.type = RING_MOUSE_WHEEL;
+	ev.x = x;
+	ev.y = y;
+	pushEvent(&ev);
+#endif
+}
+
+extern void SDL_ANDROID_MainThreadPushAppActive(int active)
+{
+#if SDL_VERSION_ATLEAST(1,3,0)
+#else
+	RingEvent_t ev;
+
+	SDL_memset(&ev, 0, sizeof(ev));
+	ev.type = RING_APP_ACTIVE;
+	ev.value = active;
+	pushEvent(&ev);
+#endif
+}
+
+enum { DEFERRED_TEXT_COUNT = 256 };
+static struct { int scancode; int unicode; int down; } deferredText[DEFERRED_TEXT_COUNT];
+static int deferredTextIdx1 = 0;
+static int deferredTextIdx2 = 0;
+static SDL_mutex * deferredTextMutex = NULL;
+
+void SDL_ANDROID_DeferredTextInput()
+{
+	if( !deferredTextMutex )
+		deferredTextMutex = SDL_CreateMutex();
+
+	SDL_mutexP(deferredTextMutex);
+
+	if( deferredTextIdx1 != deferredTextIdx2 )
+	{
+		SDL_keysym keysym;
+
+		deferredTextIdx1++;
+		if( deferredTextIdx1 >= DEFERRED_TEXT_COUNT )
+			deferredTextIdx1 = 0;
+
+		keysym = asciiToKeysym( deferredText[deferredTextIdx1].scancode, deferredText[deferredTextIdx1].unicode );
+		if( deferredText[deferredTextIdx1].down == SDL_RELEASED )
+			keysym.unicode = 0;
+
+		SDL_SendKeyboardKey( deferredText[deferredTextIdx1].down, &keysym );
+
+		if( SDL_ANDROID_isMouseUsed )
+			SDL_ANDROID_MainThreadPushMouseMotion(SDL_ANDROID_currentMouseX + (SDL_ANDROID_currentMouseX % 2 ? -1 : 1), SDL_ANDROID_currentMouseY); // Force screen redraw
+	}
+	else
+	{
+		if( SDL_ANDROID_TextInputFinished )
+		{
+			SDL_ANDROID_TextInputFinished = 0;
+			SDL_ANDROID_IsScreenKeyboardShownFlag = 0;
+		}
+	}
+
+	SDL_mutexV(deferredTextMutex);
+}
+
+extern void SDL_ANDROID_MainThreadPushText( int ascii, int unicode )
+{
+	int shiftRequired;
+
+#if SDL_VERSION_ATLEAST(1,3,0)
+	{
+		char text[32];
+		UnicodeToUtf8(unicode, text);
+		SDL_SendKeyboardText(text);
+	}
+#endif
+
+	if( !deferredTextMutex )
+		deferredTextMutex = SDL_CreateMutex();
+
+	SDL_mutexP(deferredTextMutex);
+
+	shiftRequired = checkShiftRequired(&ascii);
+
+	if( shiftRequired )
+	{
+		deferredTextIdx2++;
+		if( deferredTextIdx2 >= DEFERRED_TEXT_COUNT )
+			deferredTextIdx2 = 0;
+		deferredText[deferredTextIdx2].down = SDL_PRESSED;
+		deferredText[deferredTextIdx2].scancode = SDLK_LSHIFT;
+		deferredText[deferredTextIdx2].unicode = 0;
+	}
+	deferredTextIdx2++;
+	if( deferredTextIdx2 >= DEFERRED_TEXT_COUNT )
+		deferredTextIdx2 = 0;
+	deferredText[deferredTextIdx2].down = SDL_PRESSED;
+	deferredText[deferredTextIdx2].scancode = ascii;
+	deferredText[deferredTextIdx2].unicode = unicode;
+
+	deferredTextIdx2++;
+	if( deferredTextIdx2 >= DEFERRED_TEXT_COUNT )
+		deferredTextIdx2 = 0;
+	deferredText[deferredTextIdx2].down = SDL_RELEASED;
+	deferredText[deferredTextIdx2].scancode = ascii;
+	deferredText[deferredTextIdx2].unicode = 0;
+	if( shiftRequired )
+	{
+		deferredTextIdx2++;
+		if( deferredTextIdx2 >= DEFERRED_TEXT_COUNT )
+			deferredTextIdx2 = 0;
+		deferredText[deferredTextIdx2].down = SDL_RELEASED;
+		deferredText[deferredTextIdx2].scancode = SDLK_LSHIFT;
+		deferredText[deferredTextIdx2].unicode = 0;
+	}
+
+	SDL_mutexV(deferredTextMutex);
+}
+
+#endif
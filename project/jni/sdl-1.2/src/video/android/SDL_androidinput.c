@@ -1694,3 +1694,14 @@ JAVA_EXPORT_NAME(DemoGLSurfaceView_nativeScreenVisibleRect) (JNIEnv* env, jobjec
 		}
 	}
 }
+
+#ifndef SDL_ANDROID_LOCKFREE_EVENT_QUEUE
+int SDLCALL SDL_ANDROID_GetInputQueueStats(int *coalesced, int *dropped)
+{
+	if( coalesced )
+		*coalesced = 0;
+	if( dropped )
+		*dropped = 0;
+	return 0;
+}
+#endif
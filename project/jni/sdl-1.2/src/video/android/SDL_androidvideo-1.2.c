@@ -70,6 +70,7 @@ static void ANDROID_VideoQuit(_THIS);
 static int ANDROID_AllocHWSurface(_THIS, SDL_Surface *surface);
 static int ANDROID_LockHWSurface(_THIS, SDL_Surface *surface);
 static void ANDROID_UnlockHWSurface(_THIS, SDL_Surface *surface);
+static int ANDROID_RestoreHWSurfaceOnUse(SDL_Surface *surface);
 static void ANDROID_FreeHWSurface(_THIS, SDL_Surface *surface);
 static int ANDROID_FlipHWSurface(_THIS, SDL_Surface *surface);
 static void ANDROID_GL_SwapBuffers(_THIS);
@@ -131,8 +132,6 @@ static SDL_Rect *SDL_modelist[SDL_NUMMODES+1];
 
 //#define SDL_modelist		(this->hidden->SDL_modelist)
 
-typedef struct SDL_Texture private_hwdata;
-
 // Pointer to in-memory video surface
 int SDL_ANDROID_sFakeWindowWidth = 640;
 int SDL_ANDROID_sFakeWindowHeight = 480;
@@ -144,6 +143,361 @@ static SDL_Surface ** HwSurfaceList = NULL;
 void * glLibraryHandle = NULL;
 void * gl2LibraryHandle = NULL;
 
+// Dirty-rect texture upload for SW video surface, selected with SDL_ANDROID_DIRTY_RECTS env var before SDL_SetVideoMode():
+// 0 - always upload whole surface, 1 - upload rects passed to SDL_UpdateRects(),
+// 2 - find changed areas by comparing surface with back-buffer copy, this also works for apps which draw outside of updated rects.
+// SDL_ANDROID_DIRTY_RECTS_THRESHOLD sets screen coverage in percents, above which the whole surface is uploaded.
+enum DirtyRectsMode_t { DIRTY_RECTS_NONE = 0, DIRTY_RECTS_APP = 1, DIRTY_RECTS_BACKBUFFER = 2 };
+enum { DIRTY_RECTS_MAX = 32, DIRTY_RECTS_BAND_HEIGHT = 16 };
+#ifdef SDL_COMPATIBILITY_HACKS_PROPER_USADE_OF_SDL_UPDATERECTS
+enum { DIRTY_RECTS_DEFAULT = DIRTY_RECTS_APP };
+#else
+enum { DIRTY_RECTS_DEFAULT = DIRTY_RECTS_NONE };
+#endif
+static int DirtyRectsMode = DIRTY_RECTS_DEFAULT;
+static int DirtyRectsThreshold = 50;
+static SDL_Rect DirtyRects[DIRTY_RECTS_MAX];
+static Uint8 * DirtyRectsBackBuffer = NULL;
+static int DirtyRectsBackBufferValid = 0;
+
+// Texture atlas for small HW surfaces, disabled with SDL_ANDROID_VIDEO_ATLAS=0 env var before SDL_SetVideoMode():
+// surfaces up to HW_ATLAS_MAX_SURFACE pixels in size are packed into shared pages, one set of pages per texture format,
+// so they do not waste memory on power-of-two texture padding, and blits of different surfaces are batched by the renderer.
+// Pages are filled with shelves, slots of freed surfaces are reused, a page is freed together with its last surface.
+// Each surface has HW_ATLAS_PADDING texels around it filled with copies of its edge pixels, so linear filtering
+// does not blend in its neighbours or pixels left in a reused slot.
+enum { HW_ATLAS_PAGE_SIZE = 512, HW_ATLAS_MAX_SURFACE = 128, HW_ATLAS_PADDING = 1 };
+typedef struct
+{
+	int y, h;
+	int x; // Free space on the shelf starts here
+} HwAtlasShelf;
+typedef struct HwAtlasPage
+{
+	Uint32 format;
+	SDL_Texture * texture; // NULL if the page was left over from previous video mode
+	int blendMode; // Texture state, surfaces have their own blend mode and alpha which are applied on blit
+	Uint8 alpha;
+	int surfaces;
+	int top; // Free space below the last shelf starts here
+	int shelfCount;
+	HwAtlasShelf * shelves;
+	int freeSlotCount;
+	SDL_Rect * freeSlots;
+	struct HwAtlasPage * next;
+} HwAtlasPage;
+static HwAtlasPage * HwAtlasPages = NULL;
+static int HwAtlasEnabled = 1;
+
+// Restoring HW surfaces after OpenGL context is lost: the screen texture and surfaces used during the last
+// HwRestoreFrames frames are uploaded before the first frame is shown, the rest are uploaded when they are
+// blitted or locked for the first time. Set with SDL_ANDROID_VIDEO_RESTORE_FRAMES env var before SDL_SetVideoMode(),
+// 0 uploads all surfaces before the first frame.
+static int HwRestoreFrames = 60;
+static int HwFrame = 0;
+static int HwRestorePending = 0; // Surfaces waiting to be used
+static Uint32 HwRestoreStartTime = 0;
+static int HwRestoreMsec = 0, HwRestoreSurfaces = 0, HwRestoreLazySurfaces = 0;
+
+struct private_hwdata
+{
+	SDL_Texture * texture; // Own texture, or atlas page texture, NULL if it was lost with OpenGL context
+	HwAtlasPage * page; // NULL for own texture
+	SDL_Rect rect; // Surface pixels inside the texture
+	SDL_Rect slot; // Area reserved in atlas page, with padding
+	int blendMode;
+	Uint8 alpha;
+	Uint32 format;
+	int allowAtlas;
+	int lastUsedFrame;
+};
+
+static int ANDROID_AtlasPlace(HwAtlasPage * page, int w, int h, SDL_Rect * slot)
+{
+	int i, best = -1;
+
+	// Reuse slot of freed surface, if it's not much bigger
+	for( i = 0; i < page->freeSlotCount; i++ )
+	{
+		SDL_Rect * r = &page->freeSlots[i];
+		if( r->w >= w && r->h >= h && r->w * r->h <= w * h * 2 &&
+			( best < 0 || r->w * r->h < page->freeSlots[best].w * page->freeSlots[best].h ) )
+			best = i;
+	}
+	if( best >= 0 )
+	{
+		*slot = page->freeSlots[best];
+		page->freeSlotCount--;
+		page->freeSlots[best] = page->freeSlots[page->freeSlotCount];
+		return 0;
+	}
+
+	// Lowest shelf where the surface fits
+	for( i = 0; i < page->shelfCount; i++ )
+	{
+		HwAtlasShelf * s = &page->shelves[i];
+		if( s->h >= h && s->h <= h + h / 2 + HW_ATLAS_PADDING && s->x + w <= HW_ATLAS_PAGE_SIZE &&
+			( best < 0 || s->h < page->shelves[best].h ) )
+			best = i;
+	}
+	if( best < 0 )
+	{
+		if( page->top + h > HW_ATLAS_PAGE_SIZE )
+			return -1;
+		page->shelves = SDL_realloc( page->shelves, (page->shelfCount + 1) * sizeof(HwAtlasShelf) );
+		if( !page->shelves )
+		{
+			page->shelfCount = 0;
+			return -1;
+		}
+		best = page->shelfCount++;
+		page->shelves[best].y = page->top;
+		page->shelves[best].h = h;
+		page->shelves[best].x = 0;
+		page->top += h;
+	}
+	slot->x = page->shelves[best].x;
+	slot->y = page->shelves[best].y;
+	slot->w = w;
+	slot->h = page->shelves[best].h;
+	page->shelves[best].x += w;
+	return 0;
+}
+
+static void ANDROID_AtlasFreePage(HwAtlasPage * page)
+{
+	HwAtlasPage ** p;
+	for( p = &HwAtlasPages; *p; p = &(*p)->next )
+	{
+		if( *p == page )
+		{
+			*p = page->next;
+			break;
+		}
+	}
+	if( page->texture )
+		SDL_DestroyTexture(page->texture);
+	SDL_free(page->shelves);
+	SDL_free(page->freeSlots);
+	SDL_free(page);
+}
+
+static int ANDROID_AtlasAlloc(struct private_hwdata * hwdata, Uint32 format)
+{
+	HwAtlasPage * page;
+	int w = hwdata->rect.w + HW_ATLAS_PADDING * 2, h = hwdata->rect.h + HW_ATLAS_PADDING * 2;
+
+	for( page = HwAtlasPages; page; page = page->next )
+	{
+		if( page->format == format && ANDROID_AtlasPlace(page, w, h, &hwdata->slot) == 0 )
+			break;
+	}
+	if( !page )
+	{
+		page = SDL_calloc(1, sizeof(HwAtlasPage));
+		if( !page )
+			return -1;
+		page->format = format;
+		page->blendMode = SDL_BLENDMODE_NONE;
+		page->alpha = SDL_ALPHA_OPAQUE;
+		page->texture = SDL_CreateTexture(format, SDL_TEXTUREACCESS_STATIC, HW_ATLAS_PAGE_SIZE, HW_ATLAS_PAGE_SIZE);
+		if( !page->texture || ANDROID_AtlasPlace(page, w, h, &hwdata->slot) < 0 )
+		{
+			ANDROID_AtlasFreePage(page);
+			return -1;
+		}
+		if( SDL_ANDROID_VideoLinearFilter )
+			SDL_SetTextureScaleMode(page->texture, SDL_SCALEMODE_SLOW);
+		page->next = HwAtlasPages;
+		HwAtlasPages = page;
+		DEBUGOUT("ANDROID_AtlasAlloc() new page %p format %x", page, format);
+	}
+	page->surfaces++;
+	hwdata->page = page;
+	hwdata->texture = page->texture;
+	hwdata->rect.x = hwdata->slot.x + HW_ATLAS_PADDING;
+	hwdata->rect.y = hwdata->slot.y + HW_ATLAS_PADDING;
+	return 0;
+}
+
+// Repeats the edge pixels of a w x h image into the padding around it, pixels point to the top left of the padding
+static void ANDROID_AtlasFillPadding(Uint8 * pixels, int pitch, int bpp, int w, int h)
+{
+	int x, y;
+	for( y = HW_ATLAS_PADDING; y < HW_ATLAS_PADDING + h; y++ )
+	{
+		Uint8 * row = pixels + y * pitch;
+		for( x = 0; x < HW_ATLAS_PADDING; x++ )
+		{
+			SDL_memcpy(row + x * bpp, row + HW_ATLAS_PADDING * bpp, bpp);
+			SDL_memcpy(row + (HW_ATLAS_PADDING + w + x) * bpp, row + (HW_ATLAS_PADDING + w - 1) * bpp, bpp);
+		}
+	}
+	for( y = 0; y < HW_ATLAS_PADDING; y++ )
+	{
+		SDL_memcpy(pixels + y * pitch, pixels + HW_ATLAS_PADDING * pitch, (w + HW_ATLAS_PADDING * 2) * bpp);
+		SDL_memcpy(pixels + (HW_ATLAS_PADDING + h + y) * pitch, pixels + (HW_ATLAS_PADDING + h - 1) * pitch,
+					(w + HW_ATLAS_PADDING * 2) * bpp);
+	}
+}
+
+static void ANDROID_AtlasFree(struct private_hwdata * hwdata)
+{
+	HwAtlasPage * page = hwdata->page;
+
+	page->surfaces--;
+	if( page->surfaces <= 0 )
+	{
+		ANDROID_AtlasFreePage(page);
+		return;
+	}
+	page->freeSlots = SDL_realloc( page->freeSlots, (page->freeSlotCount + 1) * sizeof(SDL_Rect) );
+	if( !page->freeSlots )
+	{
+		page->freeSlotCount = 0;
+		return;
+	}
+	page->freeSlots[page->freeSlotCount++] = hwdata->slot;
+}
+
+// Textures of previous video mode are destroyed together with the window, surfaces still on these pages keep them alive
+static void ANDROID_AtlasDetachPages()
+{
+	while( HwAtlasPages )
+	{
+		HwAtlasPage * page = HwAtlasPages;
+		HwAtlasPages = page->next;
+		page->texture = NULL;
+		page->next = NULL;
+	}
+}
+
+static int ANDROID_CreateHWTexture(struct private_hwdata * hwdata)
+{
+	int w = hwdata->rect.w, h = hwdata->rect.h;
+
+	if( hwdata->allowAtlas && HwAtlasEnabled && w <= HW_ATLAS_MAX_SURFACE && h <= HW_ATLAS_MAX_SURFACE &&
+		ANDROID_AtlasAlloc(hwdata, hwdata->format) == 0 )
+		return 0;
+
+	hwdata->rect.x = 0;
+	hwdata->rect.y = 0;
+	hwdata->texture = SDL_CreateTexture(hwdata->format, SDL_TEXTUREACCESS_STATIC, w, h);
+	if( !hwdata->texture )
+		return -1;
+	if( SDL_ANDROID_VideoLinearFilter )
+		SDL_SetTextureScaleMode(hwdata->texture, SDL_SCALEMODE_SLOW);
+	SDL_SetTextureBlendMode(hwdata->texture, hwdata->blendMode);
+	SDL_SetTextureAlphaMod(hwdata->texture, hwdata->alpha);
+	return 0;
+}
+
+static void ANDROID_DestroyHWTexture(struct private_hwdata * hwdata)
+{
+	if( hwdata->page )
+		ANDROID_AtlasFree(hwdata);
+	else if( hwdata->texture )
+		SDL_DestroyTexture(hwdata->texture);
+	hwdata->page = NULL;
+	hwdata->texture = NULL;
+}
+
+static struct private_hwdata * ANDROID_CreateHWData(Uint32 format, int w, int h, int allowAtlas)
+{
+	struct private_hwdata * hwdata = SDL_calloc(1, sizeof(struct private_hwdata));
+	if( !hwdata )
+		return NULL;
+	hwdata->rect.w = w;
+	hwdata->rect.h = h;
+	hwdata->blendMode = SDL_BLENDMODE_NONE;
+	hwdata->alpha = SDL_ALPHA_OPAQUE;
+	hwdata->format = format;
+	hwdata->allowAtlas = allowAtlas;
+	hwdata->lastUsedFrame = HwFrame;
+
+	if( ANDROID_CreateHWTexture(hwdata) < 0 )
+	{
+		SDL_free(hwdata);
+		return NULL;
+	}
+	return hwdata;
+}
+
+static void ANDROID_DestroyHWData(struct private_hwdata * hwdata)
+{
+	if( !hwdata->texture && HwRestorePending > 0 )
+		HwRestorePending--;
+	ANDROID_DestroyHWTexture(hwdata);
+	SDL_free(hwdata);
+}
+
+static int ANDROID_SetHWDataBlendMode(struct private_hwdata * hwdata, int blendMode)
+{
+	hwdata->blendMode = blendMode;
+	if( hwdata->page || !hwdata->texture )
+		return 0;
+	return SDL_SetTextureBlendMode(hwdata->texture, blendMode);
+}
+
+static int ANDROID_SetHWDataAlphaMod(struct private_hwdata * hwdata, Uint8 alpha)
+{
+	hwdata->alpha = alpha;
+	if( hwdata->page || !hwdata->texture )
+		return 0;
+	return SDL_SetTextureAlphaMod(hwdata->texture, alpha);
+}
+
+// Pipelined multithreaded video, selected with SDL_ANDROID_VIDEO_PIPELINE env var set to 1 or 2:
+// SDL_Flip() copies the frame to a free shadow buffer and returns immediately, video thread uploads and shows it
+// while application renders next frame. Application waits only if video thread is the specified amount of frames behind.
+enum { VIDEO_PIPELINE_MAX_DEPTH = 2 };
+typedef struct
+{
+	int depth; // 0 - pipeline disabled
+	Uint8 * pixels[VIDEO_PIPELINE_MAX_DEPTH];
+	int numrects[VIDEO_PIPELINE_MAX_DEPTH];
+	SDL_Rect rects[VIDEO_PIPELINE_MAX_DEPTH][DIRTY_RECTS_MAX];
+	Uint32 submitTime[VIDEO_PIPELINE_MAX_DEPTH];
+	int head; // Next buffer to be filled by application
+	int queued; // Buffers waiting for video thread
+	int frames;
+	Uint32 latencyTotal;
+	Uint32 latencyMax;
+} videoPipeline_t;
+static videoPipeline_t videoPipeline;
+
+static void ANDROID_VideoPipelineFree()
+{
+	int i;
+	for( i = 0; i < VIDEO_PIPELINE_MAX_DEPTH; i++ )
+	{
+		if( videoPipeline.pixels[i] )
+			SDL_free(videoPipeline.pixels[i]);
+	}
+	SDL_memset(&videoPipeline, 0, sizeof(videoPipeline));
+}
+
+static void ANDROID_VideoPipelineAlloc(int size)
+{
+	int i, depth = 0;
+	if( getenv("SDL_ANDROID_VIDEO_PIPELINE") )
+		depth = SDL_min(atoi(getenv("SDL_ANDROID_VIDEO_PIPELINE")), VIDEO_PIPELINE_MAX_DEPTH);
+	if( depth <= 0 || ! SDL_ANDROID_VideoMultithreaded || SDL_ANDROID_CompatibilityHacks )
+		return;
+	for( i = 0; i < depth; i++ )
+	{
+		videoPipeline.pixels[i] = SDL_malloc(size);
+		if( ! videoPipeline.pixels[i] )
+		{
+			__android_log_print(ANDROID_LOG_INFO, "libSDL", "Couldn't allocate buffers for pipelined video, falling back to synchronous video thread");
+			ANDROID_VideoPipelineFree();
+			return;
+		}
+	}
+	videoPipeline.depth = depth;
+	__android_log_print(ANDROID_LOG_INFO, "libSDL", "SDL_SetVideoMode(): pipelined video with %d frames queue", depth);
+}
+
 static Uint32 SDL_VideoThreadID = 0;
 int SDL_ANDROID_InsideVideoThread()
 {
@@ -390,6 +744,25 @@ SDL_Surface *ANDROID_SetVideoMode(_THIS, SDL_Surface *current,
 	HwSurfaceCount = 0;
 	HwSurfaceList = NULL;
 	DEBUGOUT("ANDROID_SetVideoMode() HwSurfaceCount %d HwSurfaceList %p", HwSurfaceCount, HwSurfaceList);
+	ANDROID_AtlasDetachPages();
+	if( getenv("SDL_ANDROID_VIDEO_ATLAS") )
+		HwAtlasEnabled = atoi(getenv("SDL_ANDROID_VIDEO_ATLAS"));
+	if( getenv("SDL_ANDROID_VIDEO_RESTORE_FRAMES") )
+		HwRestoreFrames = atoi(getenv("SDL_ANDROID_VIDEO_RESTORE_FRAMES"));
+	// HwRestorePending is not reset: surfaces of the previous mode that still wait for their texture
+	// are restored on first use or freed later, and count down then
+
+	// Each mode starts from the default, the fallback after a failed back-buffer allocation is only for the mode it failed in
+	DirtyRectsMode = DIRTY_RECTS_DEFAULT;
+	if( getenv("SDL_ANDROID_DIRTY_RECTS") )
+		DirtyRectsMode = atoi(getenv("SDL_ANDROID_DIRTY_RECTS"));
+	if( getenv("SDL_ANDROID_DIRTY_RECTS_THRESHOLD") )
+		DirtyRectsThreshold = atoi(getenv("SDL_ANDROID_DIRTY_RECTS_THRESHOLD"));
+	if( DirtyRectsBackBuffer )
+		SDL_free(DirtyRectsBackBuffer);
+	DirtyRectsBackBuffer = NULL;
+	DirtyRectsBackBufferValid = 0;
+	ANDROID_VideoPipelineFree();
 	
 	if( ! sdl_opengl )
 	{
@@ -473,7 +846,18 @@ SDL_Surface *ANDROID_SetVideoMode(_THIS, SDL_Surface *current,
 				return(NULL);
 			}
 			SDL_memset(current->pixels, 0, width * height * SDL_ANDROID_BYTESPERPIXEL);
-			current->hwdata = (struct private_hwdata *)SDL_CreateTexture(PixelFormatEnum, SDL_TEXTUREACCESS_STATIC, width, height);
+			if( DirtyRectsMode == DIRTY_RECTS_BACKBUFFER )
+			{
+				DirtyRectsBackBuffer = SDL_malloc(width * height * SDL_ANDROID_BYTESPERPIXEL);
+				if( ! DirtyRectsBackBuffer )
+				{
+					__android_log_print(ANDROID_LOG_INFO, "libSDL", "Couldn't allocate back-buffer for dirty rects, uploading whole screen each frame");
+					DirtyRectsMode = DIRTY_RECTS_NONE;
+				}
+			}
+			__android_log_print(ANDROID_LOG_INFO, "libSDL", "SDL_SetVideoMode(): dirty rects mode %d threshold %d%%", DirtyRectsMode, DirtyRectsThreshold);
+			ANDROID_VideoPipelineAlloc(width * height * SDL_ANDROID_BYTESPERPIXEL);
+			current->hwdata = ANDROID_CreateHWData(PixelFormatEnum, width, height, 0);
 			if( !current->hwdata ) {
 				__android_log_print(ANDROID_LOG_INFO, "libSDL", "Couldn't allocate texture for SDL_CurrentVideoSurface");
 				SDL_free(current->pixels);
@@ -481,8 +865,6 @@ SDL_Surface *ANDROID_SetVideoMode(_THIS, SDL_Surface *current,
 				SDL_OutOfMemory();
 				return(NULL);
 			}
-			if( SDL_ANDROID_VideoLinearFilter )
-				SDL_SetTextureScaleMode((SDL_Texture *)current->hwdata, SDL_SCALEMODE_SLOW);
 
 			// Register main video texture to be recreated when needed
 			HwSurfaceCount++;
@@ -545,12 +927,19 @@ void ANDROID_VideoQuit(_THIS)
 		if( SDL_CurrentVideoSurface )
 		{
 			if( SDL_CurrentVideoSurface->hwdata )
-				SDL_DestroyTexture((struct SDL_Texture *)SDL_CurrentVideoSurface->hwdata);
+				ANDROID_DestroyHWData(SDL_CurrentVideoSurface->hwdata);
+			SDL_CurrentVideoSurface->hwdata = NULL; // SDL_VideoQuit() will call ANDROID_FreeHWSurface() on it
 			if( SDL_CurrentVideoSurface->pixels )
 				SDL_free(SDL_CurrentVideoSurface->pixels);
 			SDL_CurrentVideoSurface->pixels = NULL;
 		}
 		SDL_CurrentVideoSurface = NULL;
+		if( DirtyRectsBackBuffer )
+			SDL_free(DirtyRectsBackBuffer);
+		DirtyRectsBackBuffer = NULL;
+		DirtyRectsBackBufferValid = 0;
+		ANDROID_VideoPipelineFree();
+		ANDROID_AtlasDetachPages();
 		if(SDL_VideoWindow)
 			SDL_DestroyWindow(SDL_VideoWindow);
 		SDL_VideoWindow = NULL;
@@ -629,7 +1018,7 @@ static int ANDROID_AllocHWSurface(_THIS, SDL_Surface *surface)
 	}
 	SDL_memset(surface->pixels, 0, surface->h*surface->pitch);
 
-	surface->hwdata = (struct private_hwdata *)SDL_CreateTexture(format, SDL_TEXTUREACCESS_STATIC, surface->w, surface->h);
+	surface->hwdata = ANDROID_CreateHWData(format, surface->w, surface->h, 1);
 	if( !surface->hwdata ) {
 		SDL_free(surface->pixels);
 		surface->pixels = NULL;
@@ -637,13 +1026,10 @@ static int ANDROID_AllocHWSurface(_THIS, SDL_Surface *surface)
 		return(-1);
 	}
 
-	if( SDL_ANDROID_VideoLinearFilter )
-		SDL_SetTextureScaleMode((SDL_Texture *)surface->hwdata, SDL_SCALEMODE_SLOW);
-
 	if( surface->format->Amask )
 	{
-		SDL_SetTextureAlphaMod((struct SDL_Texture *)surface->hwdata, SDL_ALPHA_OPAQUE);
-		SDL_SetTextureBlendMode((struct SDL_Texture *)surface->hwdata, SDL_BLENDMODE_BLEND);
+		ANDROID_SetHWDataAlphaMod(surface->hwdata, SDL_ALPHA_OPAQUE);
+		ANDROID_SetHWDataBlendMode(surface->hwdata, SDL_BLENDMODE_BLEND);
 	}
 	
 	surface->flags |= SDL_HWSURFACE | SDL_HWACCEL;
@@ -670,7 +1056,8 @@ static void ANDROID_FreeHWSurface(_THIS, SDL_Surface *surface)
 
 	if( !surface->hwdata )
 		return;
-	SDL_DestroyTexture((struct SDL_Texture *)surface->hwdata);
+	ANDROID_DestroyHWData(surface->hwdata);
+	surface->hwdata = NULL;
 
 	DEBUGOUT("ANDROID_FreeHWSurface() surface %p w %d h %d in HwSurfaceCount %d HwSurfaceList %p", surface, surface->w, surface->h, HwSurfaceCount, HwSurfaceList);
 
@@ -717,14 +1104,12 @@ static int ANDROID_LockHWSurface(_THIS, SDL_Surface *surface)
 		}
 		if( ! SDL_CurrentVideoSurface->hwdata )
 		{
-			SDL_CurrentVideoSurface->hwdata = (struct private_hwdata *)SDL_CreateTexture(PixelFormatEnum, SDL_TEXTUREACCESS_STATIC, SDL_ANDROID_sFakeWindowWidth, SDL_ANDROID_sFakeWindowHeight);
+			SDL_CurrentVideoSurface->hwdata = ANDROID_CreateHWData(PixelFormatEnum, SDL_ANDROID_sFakeWindowWidth, SDL_ANDROID_sFakeWindowHeight, 0);
 			if( !SDL_CurrentVideoSurface->hwdata ) {
 				__android_log_print(ANDROID_LOG_INFO, "libSDL", "Couldn't allocate texture for SDL_CurrentVideoSurface");
 				SDL_OutOfMemory();
 				return(-1);
 			}
-			if( SDL_ANDROID_VideoLinearFilter )
-				SDL_SetTextureScaleMode((SDL_Texture *)SDL_CurrentVideoSurface->hwdata, SDL_SCALEMODE_SLOW);
 			// Register main video texture to be recreated when needed
 			HwSurfaceCount++;
 			HwSurfaceList = SDL_realloc( HwSurfaceList, HwSurfaceCount * sizeof(SDL_Surface *) );
@@ -749,6 +1134,10 @@ static int ANDROID_LockHWSurface(_THIS, SDL_Surface *surface)
 	if( !surface->hwdata )
 		return(-1);
 
+	surface->hwdata->lastUsedFrame = HwFrame;
+	if( !surface->hwdata->texture && ANDROID_RestoreHWSurfaceOnUse(surface) < 0 )
+		return(-1);
+
 	// Extra check not necessary
 	/*
 	if( SDL_CurrentVideoSurface->format->BitsPerPixel == surface->format->BitsPerPixel &&
@@ -770,22 +1159,13 @@ static int ANDROID_LockHWSurface(_THIS, SDL_Surface *surface)
 	return(0);
 }
 
-static void ANDROID_UnlockHWSurface(_THIS, SDL_Surface *surface)
+// Surfaces are converted to texture format when uploaded, HW surfaces without alpha are stored in RGBA5551 texture to support colorkey
+static int ANDROID_HWSurfaceNeedsConversion(SDL_Surface *surface)
 {
 	SDL_PixelFormat format;
 	Uint32 hwformat = PixelFormatEnumColorkey;
 	int bpp;
-	SDL_Surface * converted = NULL;
 
-	if( !SDL_ANDROID_InsideVideoThread() )
-	{
-		__android_log_print(ANDROID_LOG_INFO, "libSDL", "Error: calling %s not from the main thread!", __PRETTY_FUNCTION__);
-		return;
-	}
-
-	if( !surface->hwdata )
-		return;
-	
 	if( surface->format->Amask )
 		hwformat = PixelFormatEnumAlpha;
 		
@@ -801,74 +1181,150 @@ static void ANDROID_UnlockHWSurface(_THIS, SDL_Surface *surface)
 	format.BitsPerPixel = bpp;
 	
 	// TODO: support 24bpp and 32bpp
-	if( format.BitsPerPixel == surface->format->BitsPerPixel &&
+	return !( format.BitsPerPixel == surface->format->BitsPerPixel &&
 		format.Rmask == surface->format->Rmask &&
 		format.Gmask == surface->format->Gmask &&
 		format.Bmask == surface->format->Bmask &&
-		format.Amask == surface->format->Amask )
+		format.Amask == surface->format->Amask );
+}
+
+// Write surface pixels in texture format to dst, which may point inside a bigger buffer, like an atlas page
+static void ANDROID_ConvertHWSurfacePixels(SDL_Surface *surface, Uint8 *dst, int dstpitch)
+{
+	Uint16 x, y;
+
+	if( !ANDROID_HWSurfaceNeedsConversion(surface) )
 	{
-		converted = surface; // No need for conversion
+		for( y = 0; y < surface->h; y++ )
+			SDL_memcpy( dst + dstpitch * y, (Uint8 *)surface->pixels + surface->pitch * y, surface->w * surface->format->BytesPerPixel );
+		return;
 	}
-	else
-	{
-		Uint16 x, y;
-
-		converted = SDL_CreateRGBSurface(SDL_SWSURFACE, surface->w, surface->h, format.BitsPerPixel,
-											format.Rmask, format.Gmask, format.Bmask, format.Amask);
-		if( !converted ) {
-			SDL_OutOfMemory();
-			return;
-		}
 
-		#define CONVERT_RGB565_RGBA5551( pixel ) (0x1 | ( (pixel & 0xFFC0) | ( (pixel & 0x1F) << 1 ) ))
-		
-		if( surface->flags & SDL_SRCCOLORKEY )
+	#define CONVERT_RGB565_RGBA5551( pixel ) (0x1 | ( (pixel & 0xFFC0) | ( (pixel & 0x1F) << 1 ) ))
+	
+	if( surface->flags & SDL_SRCCOLORKEY )
+	{
+		DEBUGOUT("ANDROID_UnlockHWSurface() CONVERT_RGB565_RGBA5551 + colorkey");
+		for( y = 0; y < surface->h; y++ )
 		{
-			DEBUGOUT("ANDROID_UnlockHWSurface() CONVERT_RGB565_RGBA5551 + colorkey");
-			for( y = 0; y < surface->h; y++ )
+			Uint16* src = (Uint16 *)( surface->pixels + surface->pitch * y );
+			Uint16* dstrow = (Uint16 *)( dst + dstpitch * y );
+			Uint16 w = surface->w;
+			Uint16 key = surface->format->colorkey;
+			Uint16 pixel;
+			for( x = 0; x < w; x++, src++, dstrow++ )
 			{
-				Uint16* src = (Uint16 *)( surface->pixels + surface->pitch * y );
-				Uint16* dst = (Uint16 *)( converted->pixels + converted->pitch * y );
-				Uint16 w = surface->w;
-				Uint16 key = surface->format->colorkey;
-				Uint16 pixel;
-				for( x = 0; x < w; x++, src++, dst++ )
-				{
-					pixel = *src;
-					*dst = (pixel == key) ? 0 : CONVERT_RGB565_RGBA5551( pixel );
-				}
+				pixel = *src;
+				*dstrow = (pixel == key) ? 0 : CONVERT_RGB565_RGBA5551( pixel );
 			}
 		}
-		else
+	}
+	else
+	{
+		DEBUGOUT("ANDROID_UnlockHWSurface() CONVERT_RGB565_RGBA5551");
+		for( y = 0; y < surface->h; y++ )
 		{
-			DEBUGOUT("ANDROID_UnlockHWSurface() CONVERT_RGB565_RGBA5551");
-			for( y = 0; y < surface->h; y++ )
+			Uint16* src = (Uint16 *)( surface->pixels + surface->pitch * y );
+			Uint16* dstrow = (Uint16 *)( dst + dstpitch * y );
+			Uint16 w = surface->w;
+			Uint16 pixel;
+			for( x = 0; x < w; x++, src++, dstrow++ )
 			{
-				Uint16* src = (Uint16 *)( surface->pixels + surface->pitch * y );
-				Uint16* dst = (Uint16 *)( converted->pixels + converted->pitch * y );
-				Uint16 w = surface->w;
-				Uint16 pixel;
-				for( x = 0; x < w; x++, src++, dst++ )
-				{
-					pixel = *src;
-					*dst = CONVERT_RGB565_RGBA5551( pixel );
-				}
+				pixel = *src;
+				*dstrow = CONVERT_RGB565_RGBA5551( pixel );
 			}
 		}
 	}
+}
+
+// Creates texture for HW surface which lost it together with OpenGL context, and fills it with surface pixels,
+// surfaces in atlas pages are left for ANDROID_AtlasUploadPages() unless uploadAtlas is set
+static int ANDROID_RestoreHWSurface(SDL_Surface *surface, int uploadAtlas)
+{
+	if( ANDROID_CreateHWTexture(surface->hwdata) < 0 )
+	{
+		SDL_OutOfMemory();
+		return -1;
+	}
+	if( HwRestorePending > 0 )
+		HwRestorePending--;
+	if( !surface->hwdata->page || uploadAtlas )
+		ANDROID_UnlockHWSurface(NULL, surface);
+	return 0;
+}
+
+static int ANDROID_RestoreHWSurfaceOnUse(SDL_Surface *surface)
+{
+	if( ANDROID_RestoreHWSurface(surface, 1) < 0 )
+		return -1;
+	HwRestoreLazySurfaces++;
+	if( HwRestorePending == 0 )
+		__android_log_print(ANDROID_LOG_INFO, "libSDL", "Restored all HW surfaces %d ms after OpenGL context was recreated, %d of them on first use",
+							SDL_GetTicks() - HwRestoreStartTime, HwRestoreLazySurfaces);
+	return 0;
+}
+
+static void ANDROID_UnlockHWSurface(_THIS, SDL_Surface *surface)
+{
+	Uint8 * pixels;
+	int pitch;
+
+	if( !SDL_ANDROID_InsideVideoThread() )
+	{
+		__android_log_print(ANDROID_LOG_INFO, "libSDL", "Error: calling %s not from the main thread!", __PRETTY_FUNCTION__);
+		return;
+	}
+
+	if( !surface->hwdata )
+		return;
+	if( !surface->hwdata->texture )
+	{
+		ANDROID_RestoreHWSurfaceOnUse(surface); // Uploads pixels, calling us again
+		return;
+	}
+
+	if( surface->hwdata->page )
+	{
+		// Atlas surfaces are uploaded together with their padding
+		SDL_Rect rect = surface->hwdata->rect;
+		int bpp = SDL_BYTESPERPIXEL(surface->hwdata->format);
+		rect.x -= HW_ATLAS_PADDING;
+		rect.y -= HW_ATLAS_PADDING;
+		rect.w += HW_ATLAS_PADDING * 2;
+		rect.h += HW_ATLAS_PADDING * 2;
+		pitch = rect.w * bpp;
+		pixels = SDL_malloc(rect.h * pitch);
+		if( !pixels ) {
+			SDL_OutOfMemory();
+			return;
+		}
+		ANDROID_ConvertHWSurfacePixels(surface, pixels + HW_ATLAS_PADDING * pitch + HW_ATLAS_PADDING * bpp, pitch);
+		ANDROID_AtlasFillPadding(pixels, pitch, bpp, surface->w, surface->h);
+		SDL_UpdateTexture(surface->hwdata->texture, &rect, pixels, pitch);
+		SDL_free(pixels);
+		return;
+	}
+
+	pixels = surface->pixels;
+	pitch = surface->pitch;
+	if( ANDROID_HWSurfaceNeedsConversion(surface) )
+	{
+		pitch = surface->w * SDL_ANDROID_BYTESPERPIXEL;
+		pixels = SDL_malloc(surface->h * pitch);
+		if( !pixels ) {
+			SDL_OutOfMemory();
+			return;
+		}
+		ANDROID_ConvertHWSurfacePixels(surface, pixels, pitch);
+	}
 
-	SDL_Rect rect;
-	rect.x = 0;
-	rect.y = 0;
-	rect.w = surface->w;
-	rect.h = surface->h;
-	SDL_UpdateTexture((struct SDL_Texture *)surface->hwdata, &rect, converted->pixels, converted->pitch);
+	SDL_UpdateTexture(surface->hwdata->texture, &surface->hwdata->rect, pixels, pitch);
 
 	if( surface == SDL_CurrentVideoSurface ) // Special case
-		SDL_RenderCopy((struct SDL_Texture *)SDL_CurrentVideoSurface->hwdata, NULL, NULL);
+		SDL_RenderCopy(SDL_CurrentVideoSurface->hwdata->texture, NULL, NULL);
 	
-	if( converted != surface )
-		SDL_FreeSurface(converted);
+	if( pixels != surface->pixels )
+		SDL_free(pixels);
 }
 
 // We're only blitting HW surface to screen, no other options provided (and if you need them your app designed wrong)
@@ -890,8 +1346,37 @@ int ANDROID_HWBlit(SDL_Surface* src, SDL_Rect* srcrect, SDL_Surface* dst, SDL_Re
 		__android_log_print(ANDROID_LOG_INFO, "libSDL", "ANDROID_HWBlit(): reading from screen surface not supported");
 		return(-1);
 	}
-	
-	return SDL_RenderCopy((struct SDL_Texture *)src->hwdata, srcrect, dstrect);
+
+	src->hwdata->lastUsedFrame = HwFrame;
+	if( !src->hwdata->texture && ANDROID_RestoreHWSurfaceOnUse(src) < 0 )
+		return(-1);
+
+	if( src->hwdata->page )
+	{
+		// Surface shares texture with other surfaces, apply its state and shift source rect to its place on the page
+		HwAtlasPage * page = src->hwdata->page;
+		SDL_Rect rect = src->hwdata->rect;
+		if( page->blendMode != src->hwdata->blendMode )
+		{
+			SDL_SetTextureBlendMode(page->texture, src->hwdata->blendMode);
+			page->blendMode = src->hwdata->blendMode;
+		}
+		if( page->alpha != src->hwdata->alpha )
+		{
+			SDL_SetTextureAlphaMod(page->texture, src->hwdata->alpha);
+			page->alpha = src->hwdata->alpha;
+		}
+		if( srcrect )
+		{
+			rect.x += srcrect->x;
+			rect.y += srcrect->y;
+			rect.w = srcrect->w;
+			rect.h = srcrect->h;
+		}
+		return SDL_RenderCopy(page->texture, &rect, dstrect);
+	}
+
+	return SDL_RenderCopy(src->hwdata->texture, srcrect, dstrect);
 };
 
 static int ANDROID_CheckHWBlit(_THIS, SDL_Surface *src, SDL_Surface *dst)
@@ -950,7 +1435,7 @@ static int ANDROID_SetHWColorKey(_THIS, SDL_Surface *surface, Uint32 key)
 
 	ANDROID_UnlockHWSurface(this, surface); // Convert surface using colorkey
 
-	SDL_SetTextureBlendMode((struct SDL_Texture *)surface->hwdata, SDL_BLENDMODE_BLEND);
+	ANDROID_SetHWDataBlendMode(surface->hwdata, SDL_BLENDMODE_BLEND);
 
 	return 0;
 };
@@ -969,17 +1454,155 @@ static int ANDROID_SetHWAlpha(_THIS, SDL_Surface *surface, Uint8 value)
 	surface->flags |= SDL_SRCALPHA;
 
 	if( value == SDL_ALPHA_OPAQUE && ! (surface->flags & SDL_SRCCOLORKEY) )
-		SDL_SetTextureBlendMode((struct SDL_Texture *)surface->hwdata, SDL_BLENDMODE_NONE);
+		ANDROID_SetHWDataBlendMode(surface->hwdata, SDL_BLENDMODE_NONE);
 	else
-		SDL_SetTextureBlendMode((struct SDL_Texture *)surface->hwdata, SDL_BLENDMODE_BLEND);
+		ANDROID_SetHWDataBlendMode(surface->hwdata, SDL_BLENDMODE_BLEND);
 	
-	return SDL_SetTextureAlphaMod((struct SDL_Texture *)surface->hwdata, value);
+	return ANDROID_SetHWDataAlphaMod(surface->hwdata, value);
 };
 
-static void ANDROID_FlipHWSurfaceInternal(int numrects, SDL_Rect *rects)
+static int ANDROID_RectArea(const SDL_Rect *r)
+{
+	return (int)r->w * (int)r->h;
+}
+
+static void ANDROID_RectUnion(const SDL_Rect *a, const SDL_Rect *b, SDL_Rect *out)
+{
+	int x1 = SDL_min(a->x, b->x), y1 = SDL_min(a->y, b->y);
+	int x2 = SDL_max(a->x + a->w, b->x + b->w), y2 = SDL_max(a->y + a->h, b->y + b->h);
+	out->x = x1;
+	out->y = y1;
+	out->w = x2 - x1;
+	out->h = y2 - y1;
+}
+
+// Clips rect to the video surface and adds it to DirtyRects[], merging it with another rect
+// if their union is not bigger than both rects, or if the list is full. Returns new amount of rects.
+static int ANDROID_AddDirtyRect(int count, const SDL_Rect *rect)
+{
+	SDL_Rect r, u;
+	int i, best = -1, bestGrowth = 0;
+	int x1 = SDL_max(rect->x, 0), y1 = SDL_max(rect->y, 0);
+	int x2 = SDL_min(rect->x + rect->w, SDL_CurrentVideoSurface->w);
+	int y2 = SDL_min(rect->y + rect->h, SDL_CurrentVideoSurface->h);
+
+	if( x2 <= x1 || y2 <= y1 )
+		return count;
+	r.x = x1;
+	r.y = y1;
+	r.w = x2 - x1;
+	r.h = y2 - y1;
+
+	for( i = 0; i < count; i++ )
+	{
+		int growth;
+		ANDROID_RectUnion(&DirtyRects[i], &r, &u);
+		growth = ANDROID_RectArea(&u) - ANDROID_RectArea(&DirtyRects[i]) - ANDROID_RectArea(&r);
+		if( best < 0 || growth < bestGrowth )
+		{
+			best = i;
+			bestGrowth = growth;
+		}
+	}
+
+	if( best >= 0 && ( bestGrowth <= 0 || count >= DIRTY_RECTS_MAX ) )
+	{
+		// Merged rect may now overlap other rects, so take it out of the list and add it again
+		ANDROID_RectUnion(&DirtyRects[best], &r, &u);
+		count--;
+		DirtyRects[best] = DirtyRects[count];
+		return ANDROID_AddDirtyRect(count, &u);
+	}
+
+	DirtyRects[count] = r;
+	return count + 1;
+}
+
+// Compares video surface with the back-buffer copy in horizontal bands, adds changed areas to DirtyRects[],
+// and copies them to the back-buffer. Returns new amount of rects.
+static int ANDROID_DiffBackBuffer(int count)
+{
+	SDL_Surface *surface = SDL_CurrentVideoSurface;
+	int bpp = surface->format->BytesPerPixel;
+	int rowBytes = surface->w * bpp;
+	int y, y0;
+
+	for( y0 = 0; y0 < surface->h; y0 += DIRTY_RECTS_BAND_HEIGHT )
+	{
+		int y1 = SDL_min(y0 + DIRTY_RECTS_BAND_HEIGHT, surface->h);
+		int minx = rowBytes, maxx = 0, miny = y1, maxy = y0;
+		for( y = y0; y < y1; y++ )
+		{
+			const Uint8 *src = (const Uint8 *)surface->pixels + y * surface->pitch;
+			Uint8 *dst = DirtyRectsBackBuffer + y * rowBytes;
+			int x1 = 0, x2 = rowBytes;
+			if( SDL_memcmp(src, dst, rowBytes) == 0 )
+				continue;
+			while( src[x1] == dst[x1] )
+				x1++;
+			while( src[x2 - 1] == dst[x2 - 1] )
+				x2--;
+			SDL_memcpy(dst + x1, src + x1, x2 - x1);
+			minx = SDL_min(minx, x1);
+			maxx = SDL_max(maxx, x2);
+			miny = SDL_min(miny, y);
+			maxy = y + 1;
+		}
+		if( maxy > miny )
+		{
+			SDL_Rect r;
+			r.x = minx / bpp;
+			r.y = miny;
+			r.w = (maxx + bpp - 1) / bpp - r.x;
+			r.h = maxy - miny;
+			count = ANDROID_AddDirtyRect(count, &r);
+		}
+	}
+	return count;
+}
+
+// Returns amount of rects in DirtyRects[] to upload to the screen texture, 0 to upload whole surface, -1 if nothing changed
+static int ANDROID_CollectDirtyRects(int numrects, SDL_Rect *rects)
+{
+	int i, count = 0, area = 0;
+
+	if( DirtyRectsMode == DIRTY_RECTS_BACKBUFFER && DirtyRectsBackBuffer )
+	{
+		if( ! DirtyRectsBackBufferValid )
+		{
+			SDL_Surface *surface = SDL_CurrentVideoSurface;
+			int rowBytes = surface->w * surface->format->BytesPerPixel;
+			for( i = 0; i < surface->h; i++ )
+				SDL_memcpy(DirtyRectsBackBuffer + i * rowBytes, (Uint8 *)surface->pixels + i * surface->pitch, rowBytes);
+			DirtyRectsBackBufferValid = 1;
+			return 0;
+		}
+		count = ANDROID_DiffBackBuffer(0);
+	}
+	else if( DirtyRectsMode == DIRTY_RECTS_APP && numrects > 0 )
+	{
+		for( i = 0; i < numrects; i++ )
+			count = ANDROID_AddDirtyRect(count, &rects[i]);
+	}
+	else
+		return 0;
+
+	if( count == 0 )
+		return -1;
+	for( i = 0; i < count; i++ )
+		area += ANDROID_RectArea(&DirtyRects[i]);
+	if( area * 100 >= DirtyRectsThreshold * SDL_CurrentVideoSurface->w * SDL_CurrentVideoSurface->h )
+		return 0;
+	return count;
+}
+
+// Uploads screen texture from pixels, which are either SDL_CurrentVideoSurface->pixels or it's copy, and draws it
+static void ANDROID_FlipHWSurfacePixels(const Uint8 *pixels, int numrects, SDL_Rect *rects)
 {
 	//__android_log_print(ANDROID_LOG_INFO, "libSDL", "ANDROID_FlipHWSurface()");
-	if( SDL_CurrentVideoSurface->hwdata && SDL_CurrentVideoSurface->pixels && ! ( SDL_CurrentVideoSurface->flags & SDL_HWSURFACE ) )
+	HwFrame++;
+	if( SDL_CurrentVideoSurface->hwdata && SDL_CurrentVideoSurface->hwdata->texture &&
+		SDL_CurrentVideoSurface->pixels && ! ( SDL_CurrentVideoSurface->flags & SDL_HWSURFACE ) )
 	{
 		SDL_Rect rect;
 		rect.x = 0;
@@ -987,22 +1610,22 @@ static void ANDROID_FlipHWSurfaceInternal(int numrects, SDL_Rect *rects)
 		rect.w = SDL_CurrentVideoSurface->w;
 		rect.h = SDL_CurrentVideoSurface->h;
 		if(numrects == 0)
-			SDL_UpdateTexture((struct SDL_Texture *)SDL_CurrentVideoSurface->hwdata, &rect, SDL_CurrentVideoSurface->pixels, SDL_CurrentVideoSurface->pitch);
-		else
+			SDL_UpdateTexture(SDL_CurrentVideoSurface->hwdata->texture, &rect, pixels, SDL_CurrentVideoSurface->pitch);
+		else if(numrects > 0)
 		{
 			int i;
 			for(i = 0; i < numrects; i++)
 			{
 				//__android_log_print(ANDROID_LOG_INFO, "libSDL", "SDL_UpdateTexture: rect %d: %04d:%04d:%04d:%04d", i, rects[i].x, rects[i].y, rects[i].w, rects[i].h);
-				SDL_UpdateTexture((struct SDL_Texture *)SDL_CurrentVideoSurface->hwdata, &rects[i],
-					SDL_CurrentVideoSurface->pixels + rects[i].y * SDL_CurrentVideoSurface->pitch +
+				SDL_UpdateTexture(SDL_CurrentVideoSurface->hwdata->texture, &rects[i],
+					pixels + rects[i].y * SDL_CurrentVideoSurface->pitch +
 					rects[i].x * SDL_CurrentVideoSurface->format->BytesPerPixel,
 					SDL_CurrentVideoSurface->pitch);
 			}
 		}
 
 		if( !SDL_ANDROID_SystemBarAndKeyboardShown )
-			SDL_RenderCopy((struct SDL_Texture *)SDL_CurrentVideoSurface->hwdata, &rect, &rect);
+			SDL_RenderCopy(SDL_CurrentVideoSurface->hwdata->texture, &rect, &rect);
 		else
 		{
 			int x, y;
@@ -1025,14 +1648,16 @@ static void ANDROID_FlipHWSurfaceInternal(int numrects, SDL_Rect *rects)
 			dstrect.x = SDL_ANDROID_ScreenVisibleRect.x * SDL_ANDROID_sFakeWindowWidth / SDL_ANDROID_sRealWindowWidth;
 			dstrect.y = SDL_ANDROID_ScreenVisibleRect.y * SDL_ANDROID_sFakeWindowHeight / SDL_ANDROID_sRealWindowHeight;
 			//__android_log_print(ANDROID_LOG_INFO, "SDL", "SDL_Flip: %04d:%04d:%04d:%04d -> %04d:%04d:%04d:%04d vis %04d:%04d:%04d:%04d", rect.x, rect.y, rect.w, rect.h, dstrect.x, dstrect.y, dstrect.w, dstrect.h, SDL_ANDROID_ScreenVisibleRect.x, SDL_ANDROID_ScreenVisibleRect.y, SDL_ANDROID_ScreenVisibleRect.w, SDL_ANDROID_ScreenVisibleRect.h);
-			SDL_RenderCopy((struct SDL_Texture *)SDL_CurrentVideoSurface->hwdata, &rect, &dstrect);
+			SDL_RenderCopy(SDL_CurrentVideoSurface->hwdata->texture, &rect, &dstrect);
 		}
+		SDL_RenderFlush(); // Renderer queues quads, draw them before drawing over them with direct GL calls
 
 		if( SDL_ANDROID_ShowScreenUnderFinger == ZOOM_MAGNIFIER )
 		{
 			SDL_Rect dstrect = SDL_ANDROID_ShowScreenUnderFingerRect;
 			rect = SDL_ANDROID_ShowScreenUnderFingerRectSrc;
-			SDL_RenderCopy((struct SDL_Texture *)SDL_CurrentVideoSurface->hwdata, &rect, &dstrect);
+			SDL_RenderCopy(SDL_CurrentVideoSurface->hwdata->texture, &rect, &dstrect);
+			SDL_RenderFlush();
 			int buttons = SDL_GetMouseState(NULL, NULL);
 			// Do it old-fashioned way with direct GL calls
 			glPushMatrix();
@@ -1098,6 +1723,11 @@ static void ANDROID_FlipHWSurfaceInternal(int numrects, SDL_Rect *rects)
 	}
 };
 
+static void ANDROID_FlipHWSurfaceInternal(int numrects, SDL_Rect *rects)
+{
+	ANDROID_FlipHWSurfacePixels(SDL_CurrentVideoSurface->pixels, numrects, rects);
+}
+
 static int ANDROID_FlipHWSurface(_THIS, SDL_Surface *surface)
 {
 	if( !SDL_ANDROID_InsideVideoThread() )
@@ -1112,7 +1742,10 @@ static int ANDROID_FlipHWSurface(_THIS, SDL_Surface *surface)
 		return -1;
 	}
 
-	ANDROID_FlipHWSurfaceInternal(0, NULL);
+	if( DirtyRectsMode == DIRTY_RECTS_BACKBUFFER )
+		ANDROID_FlipHWSurfaceInternal(ANDROID_CollectDirtyRects(0, NULL), DirtyRects);
+	else
+		ANDROID_FlipHWSurfaceInternal(0, NULL);
 
 	SDL_ANDROID_CallJavaSwapBuffers();
 
@@ -1133,11 +1766,8 @@ static void ANDROID_UpdateRects(_THIS, int numrects, SDL_Rect *rects)
 		return;
 	}
 
-#ifdef SDL_COMPATIBILITY_HACKS_PROPER_USADE_OF_SDL_UPDATERECTS
-	ANDROID_FlipHWSurfaceInternal(numrects, rects); // Fails for fheroes2, I'll add a compatibility option later.
-#else
-	ANDROID_FlipHWSurfaceInternal(0, NULL);
-#endif
+	// Uploading only updated rects fails for fheroes2, which draws outside of them, use DIRTY_RECTS_BACKBUFFER mode for such apps
+	ANDROID_FlipHWSurfaceInternal(ANDROID_CollectDirtyRects(numrects, rects), DirtyRects);
 
 	SDL_ANDROID_CallJavaSwapBuffers();
 }
@@ -1169,14 +1799,56 @@ void SDL_ANDROID_VideoContextLost()
 		int i;
 		for( i = 0; i < HwSurfaceCount; i++ )
 		{
-			SDL_DestroyTexture((struct SDL_Texture *)HwSurfaceList[i]->hwdata);
-			HwSurfaceList[i]->hwdata = NULL;
+			// Surface keeps its blend mode and alpha, and gets new texture when the context is recreated
+			if( HwSurfaceList[i]->hwdata && HwSurfaceList[i]->hwdata->texture )
+			{
+				ANDROID_DestroyHWTexture(HwSurfaceList[i]->hwdata);
+				HwRestorePending++;
+			}
 		}
 	}
 };
 
 extern DECLSPEC int SDL_ANDROID_ScreenKeyboardUpdateToNewVideoMode(int oldx, int oldy, int newx, int newy);
 
+int SDL_ANDROID_FlushRenderer()
+{
+	SDL_RenderFlush();
+	return !sdl_opengl;
+}
+
+// Re-fill atlas pages with graphics, each page is uploaded with one call
+static void ANDROID_AtlasUploadPages()
+{
+	HwAtlasPage * page;
+	int i;
+
+	for( page = HwAtlasPages; page; page = page->next )
+	{
+		int pitch = HW_ATLAS_PAGE_SIZE * SDL_BYTESPERPIXEL(page->format);
+		Uint8 * pixels = SDL_calloc(HW_ATLAS_PAGE_SIZE, pitch);
+		if( !pixels )
+		{
+			SDL_OutOfMemory();
+			return;
+		}
+		for( i = 0; i < HwSurfaceCount; i++ )
+		{
+			struct private_hwdata * hwdata = HwSurfaceList[i]->hwdata;
+			if( hwdata && hwdata->page == page )
+			{
+				ANDROID_ConvertHWSurfacePixels(HwSurfaceList[i], pixels + hwdata->rect.y * pitch +
+												hwdata->rect.x * SDL_BYTESPERPIXEL(page->format), pitch);
+				ANDROID_AtlasFillPadding(pixels + (hwdata->rect.y - HW_ATLAS_PADDING) * pitch +
+										(hwdata->rect.x - HW_ATLAS_PADDING) * SDL_BYTESPERPIXEL(page->format),
+										pitch, SDL_BYTESPERPIXEL(page->format), hwdata->rect.w, hwdata->rect.h);
+			}
+		}
+		SDL_UpdateTexture(page->texture, NULL, pixels, pitch);
+		SDL_free(pixels);
+	}
+}
+
 void SDL_ANDROID_VideoContextRecreated()
 {
 	int i;
@@ -1205,39 +1877,25 @@ void SDL_ANDROID_VideoContextRecreated()
 		// Re-apply our custom 4:3 screen aspect ratio
 		glViewport(0, 0, SDL_ANDROID_sRealWindowWidth, SDL_ANDROID_sRealWindowHeight);
 		glOrthof(0, SDL_ANDROID_sRealWindowWidth, SDL_ANDROID_sWindowHeight, 0, 0, 1);
+		HwRestoreStartTime = SDL_GetTicks();
+		HwRestoreSurfaces = 0;
+		HwRestoreLazySurfaces = 0;
 		for( i = 0; i < HwSurfaceCount; i++ )
 		{
-			// Allocate HW texture
-			Uint32 format = PixelFormatEnumColorkey; // 1-bit alpha for color key, every surface will have colorkey so it's easier for us
-			int flags = HwSurfaceList[i]->flags;
-			if( HwSurfaceList[i]->format->Amask )
-				format = PixelFormatEnumAlpha;
-			if( HwSurfaceList[i] == SDL_CurrentVideoSurface )
-				format = PixelFormatEnum;
-			HwSurfaceList[i]->hwdata = (struct private_hwdata *)SDL_CreateTexture(format, SDL_TEXTUREACCESS_STATIC, HwSurfaceList[i]->w, HwSurfaceList[i]->h);
-			if( !HwSurfaceList[i]->hwdata )
-			{
-				SDL_OutOfMemory();
-				return;
-			}
-			if( SDL_ANDROID_VideoLinearFilter )
-				SDL_SetTextureScaleMode((SDL_Texture *)HwSurfaceList[i]->hwdata, SDL_SCALEMODE_SLOW);
-			if (flags & SDL_SRCALPHA)
-			{
-				int alpha = HwSurfaceList[i]->format->alpha;
-				ANDROID_SetHWAlpha(NULL, HwSurfaceList[i], alpha);
-				ANDROID_UnlockHWSurface(NULL, HwSurfaceList[i]); // Re-fill texture with graphics
-			}
-			else if (flags & SDL_SRCCOLORKEY)
-			{
-				int colorkey = HwSurfaceList[i]->format->colorkey;
-				ANDROID_SetHWColorKey(NULL, HwSurfaceList[i], colorkey);
-			}
-			else
-			{
-				ANDROID_UnlockHWSurface(NULL, HwSurfaceList[i]); // Re-fill texture with graphics
-			}
+			struct private_hwdata * hwdata = HwSurfaceList[i]->hwdata;
+			if( !hwdata || hwdata->texture )
+				continue;
+			if( HwSurfaceList[i] != SDL_CurrentVideoSurface && HwRestoreFrames > 0 &&
+				HwFrame - hwdata->lastUsedFrame >= HwRestoreFrames )
+				continue; // Not used recently, restore it on first use
+			if( ANDROID_RestoreHWSurface(HwSurfaceList[i], 0) == 0 )
+				HwRestoreSurfaces++;
 		}
+		ANDROID_AtlasUploadPages();
+		HwRestoreMsec = SDL_GetTicks() - HwRestoreStartTime;
+		__android_log_print(ANDROID_LOG_INFO, "libSDL", "Restored %d HW surfaces in %d ms, %d surfaces will be restored on first use",
+							HwRestoreSurfaces, HwRestoreMsec, HwRestorePending);
+		DirtyRectsBackBufferValid = 0;
 		SDL_ANDROID_CallJavaSwapBuffers(); // Swap buffers once to force screen redraw
 	}
 };
@@ -1300,7 +1958,26 @@ void SDL_ANDROID_MultiThreadedVideoLoop()
 		SDL_mutexP(videoThread.mutex);
 		videoThread.threadReady = 1;
 		SDL_CondSignal(videoThread.cond2);
-		ret = SDL_CondWaitTimeout(videoThread.cond, videoThread.mutex, SDL_ANDROID_CompatibilityHacks ? nextUpdateDelay : 1000);
+		ret = 0;
+		if( ! videoPipeline.queued && ! videoThread.execute )
+			ret = SDL_CondWaitTimeout(videoThread.cond, videoThread.mutex, SDL_ANDROID_CompatibilityHacks ? nextUpdateDelay : 1000);
+		// Show queued frames before executing other commands, because SDL_SetVideoMode() will free their buffers
+		while( videoPipeline.queued > 0 )
+		{
+			int slot = (videoPipeline.head + videoPipeline.depth - videoPipeline.queued) % videoPipeline.depth;
+			Uint32 latency;
+			SDL_mutexV(videoThread.mutex);
+			ANDROID_FlipHWSurfacePixels(videoPipeline.pixels[slot], videoPipeline.numrects[slot], videoPipeline.rects[slot]);
+			SDL_ANDROID_CallJavaSwapBuffers();
+			latency = SDL_GetTicks() - videoPipeline.submitTime[slot];
+			SDL_mutexP(videoThread.mutex);
+			videoPipeline.queued--;
+			videoPipeline.frames++;
+			videoPipeline.latencyTotal += latency;
+			if( videoPipeline.latencyMax < latency )
+				videoPipeline.latencyMax = latency;
+			SDL_CondSignal(videoThread.cond2);
+		}
 		if( videoThread.execute )
 		{
 			videoThread.threadReady = 0;
@@ -1326,7 +2003,10 @@ void SDL_ANDROID_MultiThreadedVideoLoop()
 					}
 					else
 					{
-						ANDROID_FlipHWSurfaceInternal(videoThread.numrects, videoThread.rects);
+						if( DirtyRectsMode == DIRTY_RECTS_NONE )
+							ANDROID_FlipHWSurfaceInternal(videoThread.numrects, videoThread.rects);
+						else
+							ANDROID_FlipHWSurfaceInternal(ANDROID_CollectDirtyRects(videoThread.numrects, videoThread.rects), DirtyRects);
 						swapBuffersNeeded = 1;
 					}
 					break;
@@ -1340,7 +2020,10 @@ void SDL_ANDROID_MultiThreadedVideoLoop()
 					}
 					else
 					{
-						ANDROID_FlipHWSurfaceInternal(0, NULL);
+						if( DirtyRectsMode == DIRTY_RECTS_BACKBUFFER )
+							ANDROID_FlipHWSurfaceInternal(ANDROID_CollectDirtyRects(0, NULL), DirtyRects);
+						else
+							ANDROID_FlipHWSurfaceInternal(0, NULL);
 						swapBuffersNeeded = 1;
 					}
 					break;
@@ -1422,8 +2105,81 @@ void ANDROID_VideoQuitMT(_THIS)
 	SDL_mutexV(videoThread.mutex);
 }
 
+// Called from application thread, copies the frame to the free shadow buffer and queues it to the video thread
+static void ANDROID_VideoPipelineSubmit(int numrects, SDL_Rect *rects)
+{
+	SDL_Surface *surface = SDL_CurrentVideoSurface;
+	int slot;
+
+	SDL_mutexP(videoThread.mutex);
+	while( videoPipeline.queued >= videoPipeline.depth )
+		SDL_CondWaitTimeout(videoThread.cond2, videoThread.mutex, 1000);
+	slot = videoPipeline.head;
+	SDL_mutexV(videoThread.mutex);
+
+	// Video thread does not touch free buffers, so we may fill it without holding the lock
+	numrects = ANDROID_CollectDirtyRects(numrects, rects);
+	if( numrects > 0 )
+	{
+		// The video thread uploads only the dirty rects from the slot, so the rest of it may stay stale
+		int i, y;
+		SDL_memcpy(videoPipeline.rects[slot], DirtyRects, numrects * sizeof(SDL_Rect));
+		for( i = 0; i < numrects; i++ )
+		{
+			int offset = DirtyRects[i].y * surface->pitch + DirtyRects[i].x * surface->format->BytesPerPixel;
+			int rowBytes = DirtyRects[i].w * surface->format->BytesPerPixel;
+			for( y = 0; y < DirtyRects[i].h; y++, offset += surface->pitch )
+				SDL_memcpy(videoPipeline.pixels[slot] + offset, (Uint8 *)surface->pixels + offset, rowBytes);
+		}
+	}
+	else if( numrects == 0 )
+		SDL_memcpy(videoPipeline.pixels[slot], surface->pixels, surface->h * surface->pitch);
+	videoPipeline.numrects[slot] = numrects;
+
+	SDL_mutexP(videoThread.mutex);
+	videoPipeline.submitTime[slot] = SDL_GetTicks();
+	videoPipeline.head = (videoPipeline.head + 1) % videoPipeline.depth;
+	videoPipeline.queued++;
+	SDL_CondSignal(videoThread.cond);
+	SDL_mutexV(videoThread.mutex);
+}
+
+int SDLCALL SDL_ANDROID_GetVideoRestoreStats(int *restoreMs, int *restoredSurfaces, int *pendingSurfaces, int *lazyRestoredSurfaces)
+{
+	if( restoreMs )
+		*restoreMs = HwRestoreMsec;
+	if( restoredSurfaces )
+		*restoredSurfaces = HwRestoreSurfaces;
+	if( pendingSurfaces )
+		*pendingSurfaces = HwRestorePending;
+	if( lazyRestoredSurfaces )
+		*lazyRestoredSurfaces = HwRestoreLazySurfaces;
+	return HwRestoreFrames > 0;
+}
+
+int SDLCALL SDL_ANDROID_GetVideoPipelineStats(int *frames, int *avgLatencyMs, int *maxLatencyMs)
+{
+	int active;
+	SDL_mutexP(videoThread.mutex);
+	active = videoPipeline.depth;
+	if( frames )
+		*frames = videoPipeline.frames;
+	if( avgLatencyMs )
+		*avgLatencyMs = videoPipeline.frames ? videoPipeline.latencyTotal / videoPipeline.frames : 0;
+	if( maxLatencyMs )
+		*maxLatencyMs = videoPipeline.latencyMax;
+	SDL_mutexV(videoThread.mutex);
+	return active;
+}
+
 void ANDROID_UpdateRectsMT(_THIS, int numrects, SDL_Rect *rects)
 {
+	if( videoPipeline.depth > 0 )
+	{
+		ANDROID_VideoPipelineSubmit(numrects, rects);
+		return;
+	}
+
 	SDL_mutexP(videoThread.mutex);
 	while( ! videoThread.threadReady )
 		SDL_CondWaitTimeout(videoThread.cond2, videoThread.mutex, 1000);
@@ -1440,6 +2196,12 @@ void ANDROID_UpdateRectsMT(_THIS, int numrects, SDL_Rect *rects)
 
 int ANDROID_FlipHWSurfaceMT(_THIS, SDL_Surface *surface)
 {
+	if( videoPipeline.depth > 0 )
+	{
+		ANDROID_VideoPipelineSubmit(0, NULL);
+		return 0;
+	}
+
 	SDL_mutexP(videoThread.mutex);
 	while( ! videoThread.threadReady )
 		SDL_CondWaitTimeout(videoThread.cond2, videoThread.mutex, 1000);
@@ -121,6 +121,11 @@ int SDL_ANDROID_CallJavaSwapBuffers()
 
 	if( !glContextLost )
 	{
+#if ! SDL_VERSION_ATLEAST(1,3,0)
+		// Draw sprites queued by the renderer before anything is drawn over them
+		SDL_ANDROID_FlushRenderer();
+		SDL_ANDROID_RenderStatsNextFrame();
+#endif
 		// Clear part of screen not used by SDL - on Android the screen contains garbage after each frame
 		if( SDL_ANDROID_ForceClearScreenRectAmount > 0 )
 		{
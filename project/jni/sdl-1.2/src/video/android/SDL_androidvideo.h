@@ -65,6 +65,8 @@ extern int SDL_ANDROID_ForceClearScreenRectAmount;
 extern int SDL_ANDROID_ShowScreenUnderFinger;
 extern SDL_Rect SDL_ANDROID_ShowScreenUnderFingerRect, SDL_ANDROID_ShowScreenUnderFingerRectSrc;
 extern int SDL_ANDROID_CallJavaSwapBuffers();
+extern int SDL_ANDROID_FlushRenderer(); // Returns 1 if GL state belongs to SDL renderer, 0 if the app uses OpenGL itself
+extern void SDL_ANDROID_RenderStatsNextFrame();
 extern void SDL_ANDROID_CallJavaShowScreenKeyboard(const char * oldText, char * outBuf, int outBufLen);
 extern void SDL_ANDROID_CallJavaHideScreenKeyboard();
 extern void SDL_ANDROID_CallJavaSetScreenKeyboardHintMessage(const char *hint);
@@ -117,6 +117,8 @@ static int GLES_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
                            const SDL_Rect * srcrect,
                            const SDL_Rect * dstrect);
 static void GLES_RenderPresent(SDL_Renderer * renderer);
+static int GLES_RenderFlush(SDL_Renderer * renderer);
+static void GLES_FlushBatch(SDL_Renderer * renderer);
 static void GLES_DestroyTexture(SDL_Renderer * renderer,
                                 SDL_Texture * texture);
 static void GLES_DestroyRenderer(SDL_Renderer * renderer);
@@ -144,12 +146,25 @@ SDL_RenderDriver GL_ES_RenderDriver = {
      0}
 };
 
+/* Max amount of textured quads queued before they are drawn, 6 vertices per quad */
+#define GLES_BATCH_QUADS 512
+
 typedef struct
 {
     SDL_GLContext context;
     SDL_bool updateSize;
     int blendMode;
 
+    /* Shadow copy of GL state, to skip redundant calls, -1 if unknown */
+    int texturing;
+    GLint boundTexture;
+    GLfloat color[4];
+    GLint unpackAlignment;
+
+    /* Staging buffer for uploading texture sub-rects, OpenGL ES has no GL_UNPACK_ROW_LENGTH */
+    void *staging;
+    int stagingSize;
+
 #ifndef APIENTRY
 #define APIENTRY
 #endif
@@ -157,6 +172,16 @@ typedef struct
     SDL_bool useDrawTexture;
     SDL_bool GL_OES_draw_texture_supported;
 
+    /* RenderCopy() calls with the same texture and state are drawn with one glDrawArrays() */
+    SDL_bool useBatch;
+    SDL_Texture *batchTexture;
+    int batchBlendMode;
+    int batchScaleMode;
+    GLfloat batchColor[4];
+    int batchQuads;
+    GLshort batchVertices[GLES_BATCH_QUADS * 12];
+    GLfloat batchTexCoords[GLES_BATCH_QUADS * 12];
+
     /* OpenGL ES functions */
 #define SDL_PROC(ret,func,params) ret (APIENTRY *func) params;
 #include "SDL_glesfuncs.h"
@@ -175,8 +200,20 @@ typedef struct
     void *pixels;
     int pitch;
     SDL_DirtyRectList dirty;
+    GLint filter;
 } GLES_TextureData;
 
+/* Per-frame statistics, see SDL_ANDROID_GetRenderStats() */
+static SDL_bool statsBatchActive = SDL_FALSE;
+static int statsDrawCalls = 0;
+static int statsCopies = 0;
+static int statsLastDrawCalls = 0;
+static int statsLastCopies = 0;
+static int statsSkippedCalls = 0;
+static int statsUploadBytes = 0;
+static int statsLastSkippedCalls = 0;
+static int statsLastUploadBytes = 0;
+
 static void
 GLES_SetError(const char *prefix, GLenum result)
 {
@@ -223,6 +260,112 @@ GLES_LoadFunctions(GLES_RenderData * data)
     return 0;
 }
 
+/* Forget cached GL state, when somebody else may have changed it */
+static void
+GLES_InvalidateState(GLES_RenderData * data)
+{
+    data->blendMode = -1;
+    data->texturing = -1;
+    data->boundTexture = -1;
+    data->color[0] = -1.0f;
+    data->unpackAlignment = -1;
+}
+
+static void
+GLES_SetTexturing(GLES_RenderData * data, SDL_bool enabled)
+{
+    if (data->texturing == enabled) {
+        statsSkippedCalls++;
+        return;
+    }
+    if (enabled) {
+        data->glEnable(GL_TEXTURE_2D);
+    } else {
+        data->glDisable(GL_TEXTURE_2D);
+    }
+    data->texturing = enabled;
+}
+
+static void
+GLES_BindTexture(GLES_RenderData * data, GLenum type, GLuint texture)
+{
+    if (data->boundTexture == (GLint) texture) {
+        statsSkippedCalls++;
+        return;
+    }
+    data->glBindTexture(type, texture);
+    data->boundTexture = texture;
+}
+
+static void
+GLES_SetColor(GLES_RenderData * data, GLfloat r, GLfloat g, GLfloat b,
+              GLfloat a)
+{
+    if (data->color[0] == r && data->color[1] == g &&
+        data->color[2] == b && data->color[3] == a) {
+        statsSkippedCalls++;
+        return;
+    }
+    data->glColor4f(r, g, b, a);
+    data->color[0] = r;
+    data->color[1] = g;
+    data->color[2] = b;
+    data->color[3] = a;
+}
+
+static void
+GLES_SetUnpackAlignment(GLES_RenderData * data, GLint alignment)
+{
+    if (data->unpackAlignment == alignment) {
+        statsSkippedCalls++;
+        return;
+    }
+    data->glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    data->unpackAlignment = alignment;
+}
+
+static void *
+GLES_GetStagingBuffer(GLES_RenderData * data, int size)
+{
+    if (size > data->stagingSize) {
+        void *staging = SDL_realloc(data->staging, size);
+        if (!staging) {
+            SDL_OutOfMemory();
+            return NULL;
+        }
+        data->staging = staging;
+        data->stagingSize = size;
+    }
+    return data->staging;
+}
+
+/* Upload rect of pixels with the given pitch, repacking rows into the staging buffer if needed */
+static void
+GLES_UploadRect(GLES_RenderData * data, GLES_TextureData * texturedata,
+                const SDL_Rect * rect, const void *pixels, int pitch, int bpp)
+{
+    const void *src = pixels;
+    int i;
+
+    if (rect->w * bpp != pitch) {
+        Uint8 *dst = (Uint8 *) GLES_GetStagingBuffer(data, rect->w * rect->h * bpp);
+        if (!dst) {
+            return;
+        }
+        src = dst;
+        for (i = 0; i < rect->h; i++) {
+            SDL_memcpy(dst, pixels, rect->w * bpp);
+            dst += rect->w * bpp;
+            pixels = (const Uint8 *) pixels + pitch;
+        }
+    }
+
+    data->glTexSubImage2D(texturedata->type, 0, rect->x, rect->y, rect->w,
+                          rect->h, texturedata->format,
+                          texturedata->formattype, src);
+    statsUploadBytes += rect->w * rect->h * bpp;
+}
+
 SDL_Renderer *
 GLES_CreateRenderer(SDL_Window * window, Uint32 flags)
 {
@@ -273,6 +416,7 @@ GLES_CreateRenderer(SDL_Window * window, Uint32 flags)
     renderer->RenderFillRects = GLES_RenderFillRects;
     renderer->RenderCopy = GLES_RenderCopy;
     renderer->RenderPresent = GLES_RenderPresent;
+    renderer->RenderFlush = GLES_RenderFlush;
     renderer->DestroyTexture = GLES_DestroyTexture;
     renderer->DestroyRenderer = GLES_DestroyRenderer;
     renderer->info = GL_ES_RenderDriver.info;
@@ -342,13 +486,20 @@ GLES_CreateRenderer(SDL_Window * window, Uint32 flags)
 #endif
 #endif
 
+    /* Batching replaces glDrawTexiOES(), it is one draw call per frame instead of one per sprite */
+    data->useBatch = SDL_TRUE;
+    if (SDL_getenv("SDL_ANDROID_VIDEO_BATCH") && SDL_atoi(SDL_getenv("SDL_ANDROID_VIDEO_BATCH")) == 0) {
+        data->useBatch = SDL_FALSE;
+    }
+    statsBatchActive = data->useBatch;
+
     data->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &value);
     renderer->info.max_texture_width = value;
     data->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &value);
     renderer->info.max_texture_height = value;
 
     /* Set up parameters for rendering */
-    data->blendMode = -1;
+    GLES_InvalidateState(data);
     data->glDisable(GL_DEPTH_TEST);
     data->glDisable(GL_CULL_FACE);
     data->updateSize = SDL_TRUE;
@@ -368,10 +519,13 @@ GLES_ActivateRenderer(SDL_Renderer * renderer)
     }
 
     /* Set up parameters for rendering */
-    data->blendMode = -1;
+    GLES_InvalidateState(data);
     data->glDisable(GL_DEPTH_TEST);
     data->glDisable(GL_CULL_FACE);
     data->updateSize = SDL_TRUE;
+    /* Queued quads may belong to the lost GL context */
+    data->batchQuads = 0;
+    data->batchTexture = NULL;
 
     if (data->updateSize) {
         data->glMatrixMode(GL_PROJECTION);
@@ -476,7 +630,7 @@ GLES_CreateTexture(SDL_Renderer * renderer, SDL_Texture * texture)
     texture->driverdata = data;
 
     renderdata->glGetError();
-    renderdata->glEnable(GL_TEXTURE_2D);
+    GLES_SetTexturing(renderdata, SDL_TRUE);
     renderdata->glGenTextures(1, &data->texture);
 
     data->type = GL_TEXTURE_2D;
@@ -491,7 +645,8 @@ GLES_CreateTexture(SDL_Renderer * renderer, SDL_Texture * texture)
 
     data->format = format;
     data->formattype = type;
-    renderdata->glBindTexture(data->type, data->texture);
+    data->filter = GL_NEAREST;
+    GLES_BindTexture(renderdata, data->type, data->texture);
     renderdata->glTexParameteri(data->type, GL_TEXTURE_MIN_FILTER,
                                 GL_NEAREST);
     renderdata->glTexParameteri(data->type, GL_TEXTURE_MAG_FILTER,
@@ -503,7 +658,6 @@ GLES_CreateTexture(SDL_Renderer * renderer, SDL_Texture * texture)
 
     renderdata->glTexImage2D(data->type, 0, internalFormat, texture_w,
                              texture_h, 0, format, type, NULL);
-    renderdata->glDisable(GL_TEXTURE_2D);
 
     result = renderdata->glGetError();
     if (result != GL_NO_ERROR) {
@@ -545,8 +699,8 @@ SetupTextureUpdate(GLES_RenderData * renderdata, SDL_Texture * texture,
                    int pitch)
 {
     GLES_TextureData *data = (GLES_TextureData *) texture->driverdata;
-    renderdata->glBindTexture(data->type, data->texture);
-    renderdata->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    GLES_BindTexture(renderdata, data->type, data->texture);
+    GLES_SetUnpackAlignment(renderdata, 1);
 }
 
 static int
@@ -604,37 +758,18 @@ GLES_UpdateTexture(SDL_Renderer * renderer, SDL_Texture * texture,
     GLES_RenderData *renderdata = (GLES_RenderData *) renderer->driverdata;
     GLES_TextureData *data = (GLES_TextureData *) texture->driverdata;
     GLenum result;
-    int bpp = SDL_BYTESPERPIXEL(texture->format);
-    void * temp_buffer;
-    void * temp_ptr;
-    int i;
-
-    renderdata->glGetError();
-    renderdata->glEnable(data->type);
-    SetupTextureUpdate(renderdata, texture, pitch);
 
-    if( rect->w * bpp == pitch ) {
-         temp_buffer = (void *)pixels; /* No need to reformat */
-    } else {
-         /* Reformatting of mem area required */
-         temp_buffer = SDL_malloc(rect->w * rect->h * bpp);
-         temp_ptr = temp_buffer;
-         for (i = 0; i < rect->h; i++) {
-             SDL_memcpy(temp_ptr, pixels, rect->w * bpp);
-             temp_ptr += rect->w * bpp;
-             pixels += pitch;
-         }
+    if (renderdata->batchTexture == texture) {
+        GLES_FlushBatch(renderer);
     }
 
-    renderdata->glTexSubImage2D(data->type, 0, rect->x, rect->y, rect->w,
-                                rect->h, data->format, data->formattype,
-                                temp_buffer);
+    renderdata->glGetError();
+    GLES_SetTexturing(renderdata, SDL_TRUE);
+    SetupTextureUpdate(renderdata, texture, pitch);
 
-    if( temp_buffer != pixels ) {
-        SDL_free(temp_buffer);
-    }
+    GLES_UploadRect(renderdata, data, rect, pixels, pitch,
+                    SDL_BYTESPERPIXEL(texture->format));
 
-    renderdata->glDisable(data->type);
     result = renderdata->glGetError();
     if (result != GL_NO_ERROR) {
         GLES_SetError("glTexSubImage2D()", result);
@@ -713,7 +848,80 @@ GLES_SetBlendMode(GLES_RenderData * data, int blendMode, int isprimitive)
             break;
         }
         data->blendMode = blendMode;
+    } else {
+        statsSkippedCalls++;
+    }
+}
+
+/* Filters are texture object state, so they are cached per texture, the texture must be bound */
+static void
+GLES_SetScaleMode(GLES_RenderData * data, GLES_TextureData * texturedata,
+                  int scaleMode)
+{
+    GLint filter;
+
+    switch (scaleMode) {
+    case SDL_SCALEMODE_SLOW:
+    case SDL_SCALEMODE_BEST:
+        filter = GL_LINEAR;
+        break;
+    default:
+        filter = GL_NEAREST;
+        break;
+    }
+    if (texturedata->filter == filter) {
+        statsSkippedCalls += 2;
+        return;
     }
+    data->glTexParameteri(texturedata->type, GL_TEXTURE_MIN_FILTER, filter);
+    data->glTexParameteri(texturedata->type, GL_TEXTURE_MAG_FILTER, filter);
+    texturedata->filter = filter;
+}
+
+/* Draw the quads queued by GLES_RenderCopy() */
+static void
+GLES_FlushBatch(SDL_Renderer * renderer)
+{
+    GLES_RenderData *data = (GLES_RenderData *) renderer->driverdata;
+    SDL_Window *window = renderer->window;
+    GLES_TextureData *texturedata;
+
+    if (data->batchQuads == 0) {
+        return;
+    }
+    texturedata = (GLES_TextureData *) data->batchTexture->driverdata;
+
+    GLES_SetTexturing(data, SDL_TRUE);
+    GLES_BindTexture(data, texturedata->type, texturedata->texture);
+    GLES_SetColor(data, data->batchColor[0], data->batchColor[1],
+                  data->batchColor[2], data->batchColor[3]);
+    GLES_SetBlendMode(data, data->batchBlendMode, 0);
+    GLES_SetScaleMode(data, texturedata, data->batchScaleMode);
+
+    /* The backend changes the modelview matrix between frames, so set our own */
+    data->glPushMatrix();
+    data->glLoadIdentity();
+#if SDL_VIDEO_RENDER_RESIZE
+    data->glOrthof(0.0, (GLfloat) window->display->desktop_mode.w, (GLfloat) window->display->desktop_mode.h,
+                   0.0, 0.0, 1.0);
+#else
+    data->glOrthof(0.0, (GLfloat) window->w, (GLfloat) window->h,
+                   0.0, 0.0, 1.0);
+#endif
+
+    data->glVertexPointer(2, GL_SHORT, 0, data->batchVertices);
+    data->glEnableClientState(GL_VERTEX_ARRAY);
+    data->glTexCoordPointer(2, GL_FLOAT, 0, data->batchTexCoords);
+    data->glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    data->glDrawArrays(GL_TRIANGLES, 0, data->batchQuads * 6);
+    data->glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    data->glDisableClientState(GL_VERTEX_ARRAY);
+
+    data->glPopMatrix();
+
+    statsDrawCalls++;
+    data->batchQuads = 0;
+    data->batchTexture = NULL;
 }
 
 static int
@@ -724,12 +932,15 @@ GLES_RenderDrawPoints(SDL_Renderer * renderer, const SDL_Point * points,
     int i;
     GLshort *vertices;
 
+    GLES_FlushBatch(renderer);
+
     GLES_SetBlendMode(data, renderer->blendMode, 1);
 
-    data->glColor4f((GLfloat) renderer->r * inv255f,
-                    (GLfloat) renderer->g * inv255f,
-                    (GLfloat) renderer->b * inv255f,
-                    (GLfloat) renderer->a * inv255f);
+    GLES_SetTexturing(data, SDL_FALSE);
+    GLES_SetColor(data, (GLfloat) renderer->r * inv255f,
+                  (GLfloat) renderer->g * inv255f,
+                  (GLfloat) renderer->b * inv255f,
+                  (GLfloat) renderer->a * inv255f);
 
     vertices = SDL_stack_alloc(GLshort, count*2);
     for (i = 0; i < count; ++i) {
@@ -739,6 +950,7 @@ GLES_RenderDrawPoints(SDL_Renderer * renderer, const SDL_Point * points,
     data->glVertexPointer(2, GL_SHORT, 0, vertices);
     data->glEnableClientState(GL_VERTEX_ARRAY);
     data->glDrawArrays(GL_POINTS, 0, count);
+    statsDrawCalls++;
     data->glDisableClientState(GL_VERTEX_ARRAY);
     SDL_stack_free(vertices);
 
@@ -753,12 +965,15 @@ GLES_RenderDrawLines(SDL_Renderer * renderer, const SDL_Point * points,
     int i;
     GLshort *vertices;
 
+    GLES_FlushBatch(renderer);
+
     GLES_SetBlendMode(data, renderer->blendMode, 1);
 
-    data->glColor4f((GLfloat) renderer->r * inv255f,
-                    (GLfloat) renderer->g * inv255f,
-                    (GLfloat) renderer->b * inv255f,
-                    (GLfloat) renderer->a * inv255f);
+    GLES_SetTexturing(data, SDL_FALSE);
+    GLES_SetColor(data, (GLfloat) renderer->r * inv255f,
+                  (GLfloat) renderer->g * inv255f,
+                  (GLfloat) renderer->b * inv255f,
+                  (GLfloat) renderer->a * inv255f);
 
     vertices = SDL_stack_alloc(GLshort, count*2);
     for (i = 0; i < count; ++i) {
@@ -775,6 +990,7 @@ GLES_RenderDrawLines(SDL_Renderer * renderer, const SDL_Point * points,
     } else {
         data->glDrawArrays(GL_LINE_STRIP, 0, count);
     }
+    statsDrawCalls++;
     data->glDisableClientState(GL_VERTEX_ARRAY);
     SDL_stack_free(vertices);
 
@@ -788,12 +1004,15 @@ GLES_RenderDrawRects(SDL_Renderer * renderer, const SDL_Rect ** rects,
     GLES_RenderData *data = (GLES_RenderData *) renderer->driverdata;
     int i;
 
+    GLES_FlushBatch(renderer);
+
     GLES_SetBlendMode(data, renderer->blendMode, 1);
 
-    data->glColor4f((GLfloat) renderer->r * inv255f,
-                    (GLfloat) renderer->g * inv255f,
-                    (GLfloat) renderer->b * inv255f,
-                    (GLfloat) renderer->a * inv255f);
+    GLES_SetTexturing(data, SDL_FALSE);
+    GLES_SetColor(data, (GLfloat) renderer->r * inv255f,
+                  (GLfloat) renderer->g * inv255f,
+                  (GLfloat) renderer->b * inv255f,
+                  (GLfloat) renderer->a * inv255f);
 
     data->glEnableClientState(GL_VERTEX_ARRAY);
     for (i = 0; i < count; ++i) {
@@ -815,6 +1034,7 @@ GLES_RenderDrawRects(SDL_Renderer * renderer, const SDL_Rect ** rects,
         data->glVertexPointer(2, GL_SHORT, 0, vertices);
         data->glDrawArrays(GL_LINE_LOOP, 0, 4);
     }
+    statsDrawCalls += count;
     data->glDisableClientState(GL_VERTEX_ARRAY);
 
     return 0;
@@ -827,12 +1047,15 @@ GLES_RenderFillRects(SDL_Renderer * renderer, const SDL_Rect ** rects,
     GLES_RenderData *data = (GLES_RenderData *) renderer->driverdata;
     int i;
 
+    GLES_FlushBatch(renderer);
+
     GLES_SetBlendMode(data, renderer->blendMode, 1);
 
-    data->glColor4f((GLfloat) renderer->r * inv255f,
-                    (GLfloat) renderer->g * inv255f,
-                    (GLfloat) renderer->b * inv255f,
-                    (GLfloat) renderer->a * inv255f);
+    GLES_SetTexturing(data, SDL_FALSE);
+    GLES_SetColor(data, (GLfloat) renderer->r * inv255f,
+                  (GLfloat) renderer->g * inv255f,
+                  (GLfloat) renderer->b * inv255f,
+                  (GLfloat) renderer->a * inv255f);
 
     data->glEnableClientState(GL_VERTEX_ARRAY);
     for (i = 0; i < count; ++i) {
@@ -854,6 +1077,7 @@ GLES_RenderFillRects(SDL_Renderer * renderer, const SDL_Rect ** rects,
         data->glVertexPointer(2, GL_SHORT, 0, vertices);
         data->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
     }
+    statsDrawCalls += count;
     data->glDisableClientState(GL_VERTEX_ARRAY);
 
     return 0;
@@ -868,11 +1092,9 @@ GLES_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
     GLES_TextureData *texturedata = (GLES_TextureData *) texture->driverdata;
     int minx, miny, maxx, maxy;
     GLfloat minu, maxu, minv, maxv;
-    int i;
-    void *temp_buffer;          /* used for reformatting dirty rect pixels */
-    void *temp_ptr;
+    GLfloat color[4];
 
-    data->glEnable(GL_TEXTURE_2D);
+    statsCopies++;
 
     if (texturedata->dirty.list) {
         SDL_DirtyRect *dirty;
@@ -880,73 +1102,103 @@ GLES_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
         int bpp = SDL_BYTESPERPIXEL(texture->format);
         int pitch = texturedata->pitch;
 
+        /* Quads already queued must be drawn with the old texture contents */
+        if (data->batchTexture == texture) {
+            GLES_FlushBatch(renderer);
+        }
+
+        GLES_SetTexturing(data, SDL_TRUE);
         SetupTextureUpdate(data, texture, pitch);
 
-        data->glBindTexture(texturedata->type, texturedata->texture);
         for (dirty = texturedata->dirty.list; dirty; dirty = dirty->next) {
             SDL_Rect *rect = &dirty->rect;
             pixels =
                 (void *) ((Uint8 *) texturedata->pixels + rect->y * pitch +
                           rect->x * bpp);
-            /*      There is no GL_UNPACK_ROW_LENGTH in OpenGLES 
-               we must do this reformatting ourselves(!)
-
-               maybe it'd be a good idea to keep a temp buffer around
-               for this purpose rather than allocating it each time
-             */
-            if( rect->x == 0 && rect->w * bpp == pitch ) {
-                temp_buffer = pixels; /* Updating whole texture, no need to reformat */
-            } else {
-                temp_buffer = SDL_malloc(rect->w * rect->h * bpp);
-                temp_ptr = temp_buffer;
-                for (i = 0; i < rect->h; i++) {
-                    SDL_memcpy(temp_ptr, pixels, rect->w * bpp);
-                    temp_ptr += rect->w * bpp;
-                    pixels += pitch;
-                }
-            }
-
-            data->glTexSubImage2D(texturedata->type, 0, rect->x, rect->y,
-                                  rect->w, rect->h, texturedata->format,
-                                  texturedata->formattype, temp_buffer);
-
-            if( temp_buffer != pixels ) {
-                SDL_free(temp_buffer);
-            }
+            GLES_UploadRect(data, texturedata, rect, pixels, pitch, bpp);
         }
         SDL_ClearDirtyRects(&texturedata->dirty);
     }
 
-    data->glBindTexture(texturedata->type, texturedata->texture);
-
     if (texture->modMode) {
-        data->glColor4f((GLfloat) texture->r * inv255f,
-                        (GLfloat) texture->g * inv255f,
-                        (GLfloat) texture->b * inv255f,
-                        (GLfloat) texture->a * inv255f);
+        color[0] = (GLfloat) texture->r * inv255f;
+        color[1] = (GLfloat) texture->g * inv255f;
+        color[2] = (GLfloat) texture->b * inv255f;
+        color[3] = (GLfloat) texture->a * inv255f;
     } else {
-        data->glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+        color[0] = color[1] = color[2] = color[3] = 1.0f;
     }
 
-    GLES_SetBlendMode(data, texture->blendMode, 0);
+    if (data->useBatch) {
+        GLshort *vertices;
+        GLfloat *texCoords;
+
+        if (data->batchTexture != texture ||
+            data->batchBlendMode != texture->blendMode ||
+            data->batchScaleMode != texture->scaleMode ||
+            SDL_memcmp(data->batchColor, color, sizeof(color)) != 0 ||
+            data->batchQuads >= GLES_BATCH_QUADS) {
+            GLES_FlushBatch(renderer);
+            data->batchTexture = texture;
+            data->batchBlendMode = texture->blendMode;
+            data->batchScaleMode = texture->scaleMode;
+            SDL_memcpy(data->batchColor, color, sizeof(color));
+        }
 
-    switch (texture->scaleMode) {
-    case SDL_SCALEMODE_NONE:
-    case SDL_SCALEMODE_FAST:
-        data->glTexParameteri(texturedata->type, GL_TEXTURE_MIN_FILTER,
-                              GL_NEAREST);
-        data->glTexParameteri(texturedata->type, GL_TEXTURE_MAG_FILTER,
-                              GL_NEAREST);
-        break;
-    case SDL_SCALEMODE_SLOW:
-    case SDL_SCALEMODE_BEST:
-        data->glTexParameteri(texturedata->type, GL_TEXTURE_MIN_FILTER,
-                              GL_LINEAR);
-        data->glTexParameteri(texturedata->type, GL_TEXTURE_MAG_FILTER,
-                              GL_LINEAR);
-        break;
+        minx = dstrect->x;
+        miny = dstrect->y;
+        maxx = dstrect->x + dstrect->w;
+        maxy = dstrect->y + dstrect->h;
+
+        minu = (GLfloat) srcrect->x / texture->w;
+        minu *= texturedata->texw;
+        maxu = (GLfloat) (srcrect->x + srcrect->w) / texture->w;
+        maxu *= texturedata->texw;
+        minv = (GLfloat) srcrect->y / texture->h;
+        minv *= texturedata->texh;
+        maxv = (GLfloat) (srcrect->y + srcrect->h) / texture->h;
+        maxv *= texturedata->texh;
+
+        /* Two triangles, so quads do not have to be adjacent like in a strip */
+        vertices = data->batchVertices + data->batchQuads * 12;
+        texCoords = data->batchTexCoords + data->batchQuads * 12;
+
+        vertices[0] = minx;
+        vertices[1] = miny;
+        vertices[2] = maxx;
+        vertices[3] = miny;
+        vertices[4] = minx;
+        vertices[5] = maxy;
+        vertices[6] = maxx;
+        vertices[7] = miny;
+        vertices[8] = maxx;
+        vertices[9] = maxy;
+        vertices[10] = minx;
+        vertices[11] = maxy;
+
+        texCoords[0] = minu;
+        texCoords[1] = minv;
+        texCoords[2] = maxu;
+        texCoords[3] = minv;
+        texCoords[4] = minu;
+        texCoords[5] = maxv;
+        texCoords[6] = maxu;
+        texCoords[7] = minv;
+        texCoords[8] = maxu;
+        texCoords[9] = maxv;
+        texCoords[10] = minu;
+        texCoords[11] = maxv;
+
+        data->batchQuads++;
+        return 0;
     }
 
+    GLES_SetTexturing(data, SDL_TRUE);
+    GLES_BindTexture(data, texturedata->type, texturedata->texture);
+    GLES_SetColor(data, color[0], color[1], color[2], color[3]);
+    GLES_SetBlendMode(data, texture->blendMode, 0);
+    GLES_SetScaleMode(data, texturedata, texture->scaleMode);
+
     if (data->GL_OES_draw_texture_supported && data->useDrawTexture) {
         /* this code is a little funny because the viewport is upside down vs SDL's coordinate system */
         SDL_Window *window = renderer->window;
@@ -965,6 +1217,7 @@ GLES_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
                             window->h - dstrect->y - dstrect->h,
 #endif
                             0, dstrect->w, dstrect->h);
+        statsDrawCalls++;
     } else {
 
         minx = dstrect->x;
@@ -1007,31 +1260,51 @@ GLES_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
         data->glTexCoordPointer(2, GL_FLOAT, 0, texCoords);
         data->glEnableClientState(GL_TEXTURE_COORD_ARRAY);
         data->glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        statsDrawCalls++;
         data->glDisableClientState(GL_TEXTURE_COORD_ARRAY);
         data->glDisableClientState(GL_VERTEX_ARRAY);
     }
 
-    data->glDisable(GL_TEXTURE_2D);
-
     return 0;
 }
 
 static void
 GLES_RenderPresent(SDL_Renderer * renderer)
 {
+    GLES_RenderFlush(renderer);
     SDL_GL_SwapWindow(renderer->window);
 }
 
+/* Caller draws with OpenGL directly after this, leave texturing disabled like it expects */
+static int
+GLES_RenderFlush(SDL_Renderer * renderer)
+{
+    GLES_RenderData *data = (GLES_RenderData *) renderer->driverdata;
+
+    GLES_FlushBatch(renderer);
+    GLES_SetTexturing(data, SDL_FALSE);
+    GLES_InvalidateState(data);
+    return 0;
+}
+
 static void
 GLES_DestroyTexture(SDL_Renderer * renderer, SDL_Texture * texture)
 {
+    GLES_RenderData *renderdata = (GLES_RenderData *) renderer->driverdata;
     GLES_TextureData *data = (GLES_TextureData *) texture->driverdata;
 
     if (!data) {
         return;
     }
+    if (renderdata->batchTexture == texture) {
+        GLES_FlushBatch(renderer);
+    }
     if (data->texture) {
         glDeleteTextures(1, &data->texture);
+        /* Deleting bound texture binds 0, and the name may be reused */
+        if (renderdata->boundTexture == (GLint) data->texture) {
+            renderdata->boundTexture = -1;
+        }
     }
     if (data->pixels) {
         SDL_free(data->pixels);
@@ -1050,11 +1323,53 @@ GLES_DestroyRenderer(SDL_Renderer * renderer)
         if (data->context) {
             SDL_GL_DeleteContext(data->context);
         }
+        if (data->staging) {
+            SDL_free(data->staging);
+        }
         SDL_free(data);
     }
     SDL_free(renderer);
 }
 
+#ifdef ANDROID
+void
+SDL_ANDROID_RenderStatsNextFrame(void)
+{
+    statsLastDrawCalls = statsDrawCalls;
+    statsLastCopies = statsCopies;
+    statsLastSkippedCalls = statsSkippedCalls;
+    statsLastUploadBytes = statsUploadBytes;
+    statsDrawCalls = 0;
+    statsCopies = 0;
+    statsSkippedCalls = 0;
+    statsUploadBytes = 0;
+}
+
+int SDLCALL
+SDL_ANDROID_GetRenderStats(int *drawCalls, int *copies)
+{
+    if (drawCalls) {
+        *drawCalls = statsLastDrawCalls;
+    }
+    if (copies) {
+        *copies = statsLastCopies;
+    }
+    return statsBatchActive;
+}
+
+int SDLCALL
+SDL_ANDROID_GetRenderStateStats(int *skippedCalls, int *uploadedBytes)
+{
+    if (skippedCalls) {
+        *skippedCalls = statsLastSkippedCalls;
+    }
+    if (uploadedBytes) {
+        *uploadedBytes = statsLastUploadBytes;
+    }
+    return 1;
+}
+#endif
+
 #endif /* SDL_VIDEO_RENDER_OGL_ES */
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -119,6 +119,7 @@ struct SDL_Renderer
     int (*RenderWritePixels) (SDL_Renderer * renderer, const SDL_Rect * rect,
                               Uint32 format, const void * pixels, int pitch);
     void (*RenderPresent) (SDL_Renderer * renderer);
+    int (*RenderFlush) (SDL_Renderer * renderer);
     void (*DestroyTexture) (SDL_Renderer * renderer, SDL_Texture * texture);
 
     void (*DestroyRenderer) (SDL_Renderer * renderer);
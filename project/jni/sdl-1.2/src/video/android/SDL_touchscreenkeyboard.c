@@ -84,6 +84,10 @@ typedef struct
     GLuint id;
     GLfloat w;
     GLfloat h;
+    GLshort x; // Position of the image inside the atlas texture
+    GLshort y;
+    GLfloat texW; // Size of the atlas texture
+    GLfloat texH;
 } GLTexture_t;
 
 static GLTexture_t arrowImages[9];
@@ -96,6 +100,20 @@ static int sunTheme = 0;
 static int joystickTouchPoints[MAX_JOYSTICKS*2];
 static int floatingScreenJoystick = 0;
 
+// Buttons are queued while drawing, and sent to OpenGL all at once
+enum { MAX_QUADS = 32 };
+static struct ScreenKbQuad_t
+{
+	GLTexture_t * tex;
+	SDL_Rect src, dest;
+	Uint8 flipX, flipY;
+	GLubyte color[4];
+}
+quads[MAX_QUADS];
+static int quadsCount = 0;
+// The SDL renderer sets up GL state again after we've drawn, so we do not need to save and restore it
+static int glStateOwnedBySdl = 0;
+
 static void R_DumpOpenGlState(void);
 
 static inline int InsideRect(const SDL_Rect * r, int x, int y)
@@ -153,70 +171,178 @@ oldGlState;
 
 static inline void beginDrawingTex()
 {
+#if ! SDL_VERSION_ATLEAST(1,3,0)
+	glStateOwnedBySdl = SDL_ANDROID_FlushRenderer();
+#endif
+
+	if( !glStateOwnedBySdl )
+	{
 #ifndef SDL_TOUCHSCREEN_KEYBOARD_SAVE_RESTORE_OPENGL_STATE
-	// Make the video somehow work on emulator
-	oldGlState.texture2d = GL_TRUE;
-	oldGlState.texunitId = GL_TEXTURE0;
-	oldGlState.clientTexunitId = GL_TEXTURE0;
-	oldGlState.textureId = 0;
-	oldGlState.texEnvMode = GL_MODULATE;
-	oldGlState.blend = GL_TRUE;
-	oldGlState.blend1 = GL_SRC_ALPHA;
-	oldGlState.blend2 = GL_ONE_MINUS_SRC_ALPHA;
-	oldGlState.colorArray = GL_FALSE;
+		// Make the video somehow work on emulator
+		oldGlState.texture2d = GL_TRUE;
+		oldGlState.texunitId = GL_TEXTURE0;
+		oldGlState.clientTexunitId = GL_TEXTURE0;
+		oldGlState.textureId = 0;
+		oldGlState.texEnvMode = GL_MODULATE;
+		oldGlState.blend = GL_TRUE;
+		oldGlState.blend1 = GL_SRC_ALPHA;
+		oldGlState.blend2 = GL_ONE_MINUS_SRC_ALPHA;
+		oldGlState.colorArray = GL_FALSE;
 #else
-	// Save OpenGL state
-	// This code does not work on 1.6 emulator, and on some older devices
-	// However GLES 1.1 spec defines all theese values, so it's a device fault for not implementing them
-	oldGlState.texture2d = glIsEnabled(GL_TEXTURE_2D);
-	glGetIntegerv(GL_ACTIVE_TEXTURE, &oldGlState.texunitId);
-	glGetIntegerv(GL_CLIENT_ACTIVE_TEXTURE, &oldGlState.clientTexunitId);
+		// Save OpenGL state of the application
+		// This code does not work on 1.6 emulator, and on some older devices
+		// However GLES 1.1 spec defines all theese values, so it's a device fault for not implementing them
+		oldGlState.texture2d = glIsEnabled(GL_TEXTURE_2D);
+		glGetIntegerv(GL_ACTIVE_TEXTURE, &oldGlState.texunitId);
+		glGetIntegerv(GL_CLIENT_ACTIVE_TEXTURE, &oldGlState.clientTexunitId);
 #endif
 
-	//R_DumpOpenGlState();
+		//R_DumpOpenGlState();
 
-	/*
-	glActiveTexture(GL_TEXTURE1);
-	glClientActiveTexture(GL_TEXTURE1);
-	glDisable(GL_TEXTURE_2D);
-	glDisableClientState(GL_COLOR_ARRAY);
-	glDisableClientState(GL_NORMAL_ARRAY);
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	*/
-
-	glActiveTexture(GL_TEXTURE0);
-	glClientActiveTexture(GL_TEXTURE0);
+		glActiveTexture(GL_TEXTURE0);
+		glClientActiveTexture(GL_TEXTURE0);
 
 #ifdef SDL_TOUCHSCREEN_KEYBOARD_SAVE_RESTORE_OPENGL_STATE
-	glGetIntegerv(GL_TEXTURE_BINDING_2D, &oldGlState.textureId);
-	glGetFloatv(GL_CURRENT_COLOR, &(oldGlState.color[0]));
-	glGetTexEnviv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, &oldGlState.texEnvMode);
-	oldGlState.blend = glIsEnabled(GL_BLEND);
-	glGetIntegerv(GL_BLEND_SRC, &oldGlState.blend1);
-	glGetIntegerv(GL_BLEND_DST, &oldGlState.blend2);
-	glGetBooleanv(GL_COLOR_ARRAY, &oldGlState.colorArray);
-	// It's very unlikely that some app will use GL_TEXTURE_CROP_RECT_OES, so just skip it
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &oldGlState.textureId);
+		glGetFloatv(GL_CURRENT_COLOR, &(oldGlState.color[0]));
+		glGetTexEnviv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, &oldGlState.texEnvMode);
+		oldGlState.blend = glIsEnabled(GL_BLEND);
+		glGetIntegerv(GL_BLEND_SRC, &oldGlState.blend1);
+		glGetIntegerv(GL_BLEND_DST, &oldGlState.blend2);
+		glGetBooleanv(GL_COLOR_ARRAY, &oldGlState.colorArray);
+		// It's very unlikely that some app will use GL_TEXTURE_CROP_RECT_OES, so just skip it
 #endif
+		glDisable(GL_CULL_FACE);
+		glDisableClientState(GL_COLOR_ARRAY);
+	}
 
 	glEnable(GL_TEXTURE_2D);
 	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 	glEnable(GL_BLEND);
-	glDisable(GL_CULL_FACE);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glDisableClientState(GL_COLOR_ARRAY);
-	//static const GLfloat color[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-	//glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, color);
-	//glDisable(GL_DEPTH_TEST);
-	//glDisable(GL_ALPHA_TEST);
-	//glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-	//glDisableClientState(GL_NORMAL_ARRAY);
-	//glDisableClientState(GL_VERTEX_ARRAY);
-	//glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	if( glStateOwnedBySdl )
+	{
+		// Same coordinates as glDrawTexiOES(), with Y axis pointing down
+		glPushMatrix();
+		glLoadIdentity();
+		glOrthof( 0.0f, SDL_ANDROID_sRealWindowWidth, SDL_ANDROID_sRealWindowHeight, 0.0f, 0.0f, 1.0f );
+	}
+}
+
+static void drawQueuedTex()
+{
+	int i, start;
+
+	if( quadsCount <= 0 )
+		return;
+
+	if( glStateOwnedBySdl )
+	{
+		// All buttons in one vertex array, one draw call for each atlas texture, which is usually just one
+		static GLshort vertices[MAX_QUADS * 12];
+		static GLfloat texCoords[MAX_QUADS * 12];
+		static GLubyte colors[MAX_QUADS * 24];
+
+		for( i = 0; i < quadsCount; i++ )
+		{
+			struct ScreenKbQuad_t * q = &quads[i];
+			GLshort x1 = q->dest.x, y1 = q->dest.y, x2 = q->dest.x + q->dest.w, y2 = q->dest.y + q->dest.h;
+			GLfloat u1 = ( q->tex->x + q->src.x ) / q->tex->texW;
+			GLfloat v1 = ( q->tex->y + q->src.y ) / q->tex->texH;
+			GLfloat u2 = ( q->tex->x + q->src.x + q->src.w ) / q->tex->texW;
+			GLfloat v2 = ( q->tex->y + q->src.y + q->src.h ) / q->tex->texH;
+			GLfloat t;
+			GLshort * v = &vertices[i * 12];
+			GLfloat * tc = &texCoords[i * 12];
+			int ii;
+
+			if( q->flipX )
+			{
+				t = u1; u1 = u2; u2 = t;
+			}
+			if( q->flipY )
+			{
+				t = v1; v1 = v2; v2 = t;
+			}
+			// Two triangles: top-left, top-right, bottom-left and bottom-left, top-right, bottom-right
+			v[0] = x1; v[1] = y1; v[2] = x2; v[3] = y1; v[4] = x1; v[5] = y2;
+			v[6] = x1; v[7] = y2; v[8] = x2; v[9] = y1; v[10] = x2; v[11] = y2;
+			tc[0] = u1; tc[1] = v1; tc[2] = u2; tc[3] = v1; tc[4] = u1; tc[5] = v2;
+			tc[6] = u1; tc[7] = v2; tc[8] = u2; tc[9] = v1; tc[10] = u2; tc[11] = v2;
+			for( ii = 0; ii < 6; ii++ )
+				memcpy(&colors[i * 24 + ii * 4], q->color, 4);
+		}
+
+		glVertexPointer(2, GL_SHORT, 0, vertices);
+		glTexCoordPointer(2, GL_FLOAT, 0, texCoords);
+		glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+
+		for( start = 0, i = 1; i <= quadsCount; i++ )
+		{
+			if( i < quadsCount && quads[i].tex->id == quads[start].tex->id )
+				continue;
+			glBindTexture(GL_TEXTURE_2D, quads[start].tex->id);
+			glDrawArrays(GL_TRIANGLES, start * 6, (i - start) * 6);
+			start = i;
+		}
+
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+	}
+	else
+	{
+		// The application owns vertex array pointers, and we cannot restore them without glGet*(), so use glDrawTexiOES()
+		GLuint boundTexture = 0;
+
+		for( i = 0; i < quadsCount; i++ )
+		{
+			struct ScreenKbQuad_t * q = &quads[i];
+			GLint cropRect[4];
+
+			if( q->tex->id != boundTexture )
+			{
+				boundTexture = q->tex->id;
+				glBindTexture(GL_TEXTURE_2D, boundTexture);
+			}
+			glColor4ub(q->color[0], q->color[1], q->color[2], q->color[3]);
+
+			cropRect[0] = q->tex->x + q->src.x;
+			cropRect[1] = q->tex->y + q->src.y + q->src.h;
+			cropRect[2] = q->src.w;
+			cropRect[3] = -q->src.h;
+			if( q->flipX )
+			{
+				cropRect[0] += cropRect[2];
+				cropRect[2] = -cropRect[2];
+			}
+			if( q->flipY )
+			{
+				cropRect[1] += cropRect[3];
+				cropRect[3] = -cropRect[3];
+			}
+			glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_CROP_RECT_OES, cropRect);
+			glDrawTexiOES(q->dest.x, SDL_ANDROID_sRealWindowHeight - q->dest.y - q->dest.h, 0, q->dest.w, q->dest.h);
+		}
+	}
+
+	quadsCount = 0;
 }
 
 static inline void endDrawingTex()
 {
+	drawQueuedTex();
+
+	if( glStateOwnedBySdl )
+	{
+		glPopMatrix();
+		return;
+	}
+
 	// Restore OpenGL state
 	if( oldGlState.texture2d == GL_FALSE )
 		glDisable(GL_TEXTURE_2D);
@@ -232,43 +358,39 @@ static inline void endDrawingTex()
 		glEnableClientState(GL_COLOR_ARRAY);
 }
 
+static inline GLubyte colorToByte(float c)
+{
+	return c <= 0.0f ? 0 : c >= 1.0f ? 255 : (GLubyte)(c * 255.0f);
+}
+
 static inline void drawCharTexFlip(GLTexture_t * tex, SDL_Rect * src, SDL_Rect * dest, int flipX, int flipY, float r, float g, float b, float a)
 {
-	GLint cropRect[4];
+	struct ScreenKbQuad_t * q;
 
-	if( !dest->h || !dest->w )
+	if( !dest->h || !dest->w || !tex->id )
 		return;
 
-	glBindTexture(GL_TEXTURE_2D, tex->id);
-
-	glColor4f(r, g, b, a);
+	if( quadsCount >= MAX_QUADS )
+		drawQueuedTex();
 
+	q = &quads[quadsCount++];
+	q->tex = tex;
 	if(src)
-	{
-		cropRect[0] = src->x;
-		cropRect[1] = tex->h - src->y;
-		cropRect[2] = src->w;
-		cropRect[3] = -src->h;
-	}
+		q->src = *src;
 	else
 	{
-		cropRect[0] = 0;
-		cropRect[1] = tex->h;
-		cropRect[2] = tex->w;
-		cropRect[3] = -tex->h;
-	}
-	if(flipX)
-	{
-		cropRect[0] += cropRect[2];
-		cropRect[2] = -cropRect[2];
-	}
-	if(flipY)
-	{
-		cropRect[1] += cropRect[3];
-		cropRect[3] = -cropRect[3];
+		q->src.x = 0;
+		q->src.y = 0;
+		q->src.w = tex->w;
+		q->src.h = tex->h;
 	}
-	glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_CROP_RECT_OES, cropRect);
-	glDrawTexiOES(dest->x, SDL_ANDROID_sRealWindowHeight - dest->y - dest->h, 0, dest->w, dest->h);
+	q->dest = *dest;
+	q->flipX = flipX;
+	q->flipY = flipY;
+	q->color[0] = colorToByte(r);
+	q->color[1] = colorToByte(g);
+	q->color[2] = colorToByte(b);
+	q->color[3] = colorToByte(a);
 }
 
 static inline void drawCharTex(GLTexture_t * tex, SDL_Rect * src, SDL_Rect * dest, float r, float g, float b, float a)
@@ -821,60 +943,249 @@ power_of_2(int input)
     return value;
 }
 
-static int setupScreenKeyboardButtonTexture( GLTexture_t * data, Uint8 * charBuf )
+// Theme images are packed into as few textures as possible, usually into just one.
+// With linear filtering each image has THEME_IMAGE_PADDING texels around it filled with copies
+// of its edge pixels, so the filter does not blend in its neighbours in the atlas.
+enum { MAX_THEME_IMAGES = 32, THEME_IMAGE_PADDING = 1 };
+
+typedef struct
 {
-	int w, h, format, bpp;
-	int texture_w, texture_h;
-
-	memcpy(&w, charBuf, sizeof(int));
-	memcpy(&h, charBuf + sizeof(int), sizeof(int));
-	memcpy(&format, charBuf + 2*sizeof(int), sizeof(int));
-	w = ntohl(w);
-	h = ntohl(h);
-	format = ntohl(format);
-	bpp = 2;
-	if(format == 2)
-		bpp = 4;
-
-	texture_w = power_of_2(w);
-	texture_h = power_of_2(h);
-	data->w = w;
-	data->h = h;
+	int w, h, format;
+	const Uint8 * pixels;
+	int page, x, y;
+	GLuint id;
+	int texW, texH;
+} ScreenKbImage_t;
+
+static inline int imageBpp( int format )
+{
+	return format == 2 ? 4 : 2;
+}
 
-	glEnable(GL_TEXTURE_2D);
+static inline GLenum imageGlType( int format )
+{
+	return format == 2 ? GL_UNSIGNED_BYTE : (format ? GL_UNSIGNED_SHORT_4_4_4_4 : GL_UNSIGNED_SHORT_5_5_5_1);
+}
 
-	glGenTextures(1, &data->id);
-	glBindTexture(GL_TEXTURE_2D, data->id);
-	//__android_log_print(ANDROID_LOG_INFO, "libSDL", "On-screen keyboard generated OpenGL texture ID %d", data->id);
+// Shelf packing, tallest images first, returns the amount of pages
+static int packScreenKeyboardImages( ScreenKbImage_t * images, int count, int pageW, int maxSize, int padding, int * pagesH )
+{
+	int order[MAX_THEME_IMAGES];
+	int i, ii, page = 0, x = 0, y = 0, shelfH = 0;
 
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture_w, texture_h, 0, GL_RGBA,
-					bpp == 4 ? GL_UNSIGNED_BYTE : (format ? GL_UNSIGNED_SHORT_4_4_4_4 : GL_UNSIGNED_SHORT_5_5_5_1), NULL);
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-	
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA,
-						bpp == 4 ? GL_UNSIGNED_BYTE : (format ? GL_UNSIGNED_SHORT_4_4_4_4 : GL_UNSIGNED_SHORT_5_5_5_1),
-						charBuf + 3*sizeof(int) );
+	for( i = 0; i < count; i++ )
+	{
+		for( ii = i; ii > 0 && images[order[ii - 1]].h < images[i].h; ii-- )
+			order[ii] = order[ii - 1];
+		order[ii] = i;
+	}
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	for( i = 0; i < count; i++ )
+	{
+		ScreenKbImage_t * img = &images[order[i]];
+		int w = img->w + padding * 2, h = img->h + padding * 2;
+		if( img->page < 0 )
+			continue;
+		if( x + w > pageW )
+		{
+			x = 0;
+			y += shelfH;
+			shelfH = 0;
+		}
+		if( y + h > maxSize )
+		{
+			pagesH[page++] = power_of_2(y);
+			x = 0;
+			y = 0;
+			shelfH = 0;
+		}
+		img->page = page;
+		img->x = x + padding;
+		img->y = y + padding;
+		x += w;
+		if( shelfH < h )
+			shelfH = h;
+	}
+	pagesH[page] = power_of_2(y + shelfH);
+	return page + 1;
+}
+
+static void copyScreenKeyboardImage( const ScreenKbImage_t * img, Uint8 * dst, int dstPitch, int dstFormat )
+{
+	int bpp = imageBpp(img->format);
+	const Uint8 * src = img->pixels;
+	int x, y;
 
-	if( SDL_ANDROID_VideoLinearFilter )
+	for( y = 0; y < img->h; y++, src += img->w * bpp, dst += dstPitch )
 	{
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		if( dstFormat == img->format )
+		{
+			memcpy(dst, src, img->w * bpp);
+			continue;
+		}
+		// Theme images in different formats, convert them all to RGBA8888
+		for( x = 0; x < img->w; x++ )
+		{
+			Uint8 * d = dst + x * 4;
+			Uint16 p;
+			if( img->format == 2 )
+			{
+				memcpy(d, src + x * 4, 4);
+				continue;
+			}
+			memcpy(&p, src + x * 2, 2);
+			if( img->format )
+			{
+				d[0] = ( ( p >> 12 ) & 0xf ) * 17;
+				d[1] = ( ( p >> 8 ) & 0xf ) * 17;
+				d[2] = ( ( p >> 4 ) & 0xf ) * 17;
+				d[3] = ( p & 0xf ) * 17;
+			}
+			else
+			{
+				d[0] = ( ( p >> 11 ) & 0x1f ) * 255 / 31;
+				d[1] = ( ( p >> 6 ) & 0x1f ) * 255 / 31;
+				d[2] = ( ( p >> 1 ) & 0x1f ) * 255 / 31;
+				d[3] = ( p & 1 ) ? 255 : 0;
+			}
+		}
 	}
-	else
+}
+
+// Repeats the edge pixels of a w x h image into the padding around it, pixels point to the top left of the padding
+static void fillScreenKeyboardImagePadding( Uint8 * pixels, int pitch, int bpp, int w, int h, int padding )
+{
+	int x, y;
+	for( y = padding; y < padding + h; y++ )
+	{
+		Uint8 * row = pixels + y * pitch;
+		for( x = 0; x < padding; x++ )
+		{
+			memcpy(row + x * bpp, row + padding * bpp, bpp);
+			memcpy(row + (padding + w + x) * bpp, row + (padding + w - 1) * bpp, bpp);
+		}
+	}
+	for( y = 0; y < padding; y++ )
+	{
+		memcpy(pixels + y * pitch, pixels + padding * pitch, (w + padding * 2) * bpp);
+		memcpy(pixels + (padding + h + y) * pitch, pixels + (padding + h - 1) * pitch, (w + padding * 2) * bpp);
+	}
+}
+
+static void setupScreenKeyboardAtlas( ScreenKbImage_t * images, int count )
+{
+	int pagesH[MAX_THEME_IMAGES];
+	int i, page, pages = 0, bestPages = 0, pageW, bestW = 0, maxW = 1, format, bpp;
+	int padding = SDL_ANDROID_VideoLinearFilter ? THEME_IMAGE_PADDING : 0;
+	GLint maxSize = 0;
+	Uint64 area, bestArea = 0;
+
+	if( count <= 0 )
+		return;
+
+#if ! SDL_VERSION_ATLEAST(1,3,0)
+	SDL_ANDROID_FlushRenderer(); // Renderer caches GL state, it has to know that we change it
+#endif
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+	if( maxSize < 64 )
+		maxSize = 64;
+
+	format = images[0].format;
+	for( i = 0; i < count; i++ )
+	{
+		images[i].id = 0;
+		images[i].page = 0;
+		if( images[i].w + padding * 2 > maxSize || images[i].h + padding * 2 > maxSize )
+		{
+			__android_log_print(ANDROID_LOG_ERROR, "libSDL", "On-screen keyboard image %d is %dx%d, bigger than max texture size %d", i, images[i].w, images[i].h, maxSize);
+			images[i].page = -1;
+			continue;
+		}
+		if( maxW < images[i].w + padding * 2 )
+			maxW = images[i].w + padding * 2;
+		if( images[i].format != format )
+			format = 2;
+	}
+	bpp = imageBpp(format);
+
+	// Try all page widths, the one with the least pages wins, then the one with the least memory
+	for( pageW = power_of_2(maxW); pageW <= maxSize; pageW *= 2 )
+	{
+		pages = packScreenKeyboardImages(images, count, pageW, maxSize, padding, pagesH);
+		for( area = 0, page = 0; page < pages; page++ )
+			area += (Uint64) pageW * pagesH[page];
+		if( !bestW || pages < bestPages || ( pages == bestPages && area < bestArea ) )
+		{
+			bestW = pageW;
+			bestPages = pages;
+			bestArea = area;
+		}
+	}
+	pages = packScreenKeyboardImages(images, count, bestW, maxSize, padding, pagesH);
+
+	glEnable(GL_TEXTURE_2D);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for( page = 0; page < pages; page++ )
 	{
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		Uint8 * buf = (Uint8 *) SDL_calloc(1, bestW * pagesH[page] * bpp);
+		GLuint id = 0;
+
+		if( !buf )
+			break;
+		for( i = 0; i < count; i++ )
+		{
+			if( images[i].page != page )
+				continue;
+			copyScreenKeyboardImage(&images[i], buf + (images[i].y * bestW + images[i].x) * bpp, bestW * bpp, format);
+			fillScreenKeyboardImagePadding(buf + ((images[i].y - padding) * bestW + images[i].x - padding) * bpp,
+											bestW * bpp, bpp, images[i].w, images[i].h, padding);
+		}
+
+		glGenTextures(1, &id);
+		glBindTexture(GL_TEXTURE_2D, id);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, bestW, pagesH[page], 0, GL_RGBA, imageGlType(format), buf);
+		SDL_free(buf);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		if( SDL_ANDROID_VideoLinearFilter )
+		{
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		}
+		else
+		{
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		}
+
+		for( i = 0; i < count; i++ )
+		{
+			if( images[i].page != page )
+				continue;
+			images[i].id = id;
+			images[i].texW = bestW;
+			images[i].texH = pagesH[page];
+		}
+		__android_log_print(ANDROID_LOG_INFO, "libSDL", "On-screen keyboard atlas texture %d: %dx%d", page, bestW, pagesH[page]);
 	}
 
 	glDisable(GL_TEXTURE_2D);
+}
 
-	return 3*sizeof(int) + w * h * bpp;
+static void setupScreenKeyboardButtonTexture( GLTexture_t * data, const ScreenKbImage_t * image )
+{
+	data->id = image->id;
+	data->w = image->w;
+	data->h = image->h;
+	data->x = image->x;
+	data->y = image->y;
+	data->texW = image->texW;
+	data->texH = image->texH;
 }
 
-static int setupScreenKeyboardButtonLegacy( int buttonID, Uint8 * charBuf )
+static void setupScreenKeyboardButtonLegacy( int buttonID, const ScreenKbImage_t * image )
 {
 	GLTexture_t * data = NULL;
 
@@ -889,15 +1200,15 @@ static int setupScreenKeyboardButtonLegacy( int buttonID, Uint8 * charBuf )
 	else if( buttonID < 28 )
 		data = &(arrowImages[buttonID - 24 + 5]); // Diagonal arrows
 	else // Error, array too big
-		return 12; // Return value bigger than zero to iterate it
+		return;
 
-	return setupScreenKeyboardButtonTexture(data, charBuf);
+	setupScreenKeyboardButtonTexture(data, image);
 }
 
-static int setupScreenKeyboardButtonSun( int buttonID, Uint8 * charBuf )
+static void setupScreenKeyboardButtonSun( int buttonID, const ScreenKbImage_t * image )
 {
 	GLTexture_t * data = NULL;
-	int i, ret;
+	int i;
 
 	if( buttonID == 0 )
 		data = &(arrowImages[0]);
@@ -908,9 +1219,9 @@ static int setupScreenKeyboardButtonSun( int buttonID, Uint8 * charBuf )
 	if( buttonID == 9 )
 		data = &mousePointer;
 	else if( buttonID > 9 ) // Error, array too big
-		return 12; // Return value bigger than zero to iterate it
+		return;
 
-	ret = setupScreenKeyboardButtonTexture(data, charBuf);
+	setupScreenKeyboardButtonTexture(data, image);
 
 	for( i = 1; i <=4; i++ )
 		arrowImages[i] = arrowImages[0];
@@ -923,27 +1234,22 @@ static int setupScreenKeyboardButtonSun( int buttonID, Uint8 * charBuf )
 
 	buttonImages[BUTTON_TEXT_INPUT*2] = buttonImages[10];
 	buttonImages[BUTTON_TEXT_INPUT*2+1] = buttonImages[10];
-
-	return ret;
 }
 
-static int setupScreenKeyboardButton( int buttonID, Uint8 * charBuf, int count )
+static void setupScreenKeyboardButton( int buttonID, const ScreenKbImage_t * image, int count )
 {
 	if( count == 24 || count == 28)
 	{
 		sunTheme = 0;
-		return setupScreenKeyboardButtonLegacy(buttonID, charBuf);
+		setupScreenKeyboardButtonLegacy(buttonID, image);
 	}
 	else if( count == 10 )
 	{
 		sunTheme = 1;
-		return setupScreenKeyboardButtonSun(buttonID, charBuf);
+		setupScreenKeyboardButtonSun(buttonID, image);
 	}
 	else
-	{
 		__android_log_print(ANDROID_LOG_FATAL, "libSDL", "On-screen keyboard buton img count = %d, should be 10 or 24 or 28", count);
-		return 12; // Return value bigger than zero to iterate it
-	}
 }
 
 
@@ -953,13 +1259,30 @@ JAVA_EXPORT_NAME(Settings_nativeSetupScreenKeyboardButtons) ( JNIEnv*  env, jobj
 	jboolean isCopy = JNI_TRUE;
 	int len = (*env)->GetArrayLength(env, charBufJava);
 	Uint8 * charBuf = (Uint8 *) (*env)->GetByteArrayElements(env, charBufJava, &isCopy);
-	int but, pos, count;
+	ScreenKbImage_t images[MAX_THEME_IMAGES];
+	int but, pos, count, imagesCount = 0;
 	memcpy(&count, charBuf, sizeof(int));
 	count = ntohl(count);
-	
-	for( but = 0, pos = sizeof(int); pos < len; but ++ )
-		pos += setupScreenKeyboardButton( but, charBuf + pos, count );
-	
+
+	for( pos = sizeof(int); pos + 3 * (int)sizeof(int) <= len && imagesCount < MAX_THEME_IMAGES; imagesCount++ )
+	{
+		ScreenKbImage_t * img = &images[imagesCount];
+		memcpy(&img->w, charBuf + pos, sizeof(int));
+		memcpy(&img->h, charBuf + pos + sizeof(int), sizeof(int));
+		memcpy(&img->format, charBuf + pos + 2*sizeof(int), sizeof(int));
+		img->w = ntohl(img->w);
+		img->h = ntohl(img->h);
+		img->format = ntohl(img->format);
+		img->pixels = charBuf + pos + 3*sizeof(int);
+		pos += 3*sizeof(int) + img->w * img->h * imageBpp(img->format);
+		if( img->w <= 0 || img->h <= 0 || pos > len )
+			break;
+	}
+
+	setupScreenKeyboardAtlas(images, imagesCount);
+	for( but = 0; but < imagesCount; but ++ )
+		setupScreenKeyboardButton( but, &images[but], count );
+
 	(*env)->ReleaseByteArrayElements(env, charBufJava, (jbyte *)charBuf, 0);
 }
 
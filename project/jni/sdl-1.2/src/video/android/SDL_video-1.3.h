@@ -1273,6 +1273,13 @@ extern DECLSPEC int SDLCALL SDL_RenderWritePixels(const SDL_Rect * rect,
  */
 extern DECLSPEC void SDLCALL SDL_RenderPresent(void);
 
+/**
+ *  \brief Draw everything the renderer queued, before drawing with OpenGL directly.
+ *
+ *  \return 0 on success, or -1 if there is no rendering context current.
+ */
+extern DECLSPEC int SDLCALL SDL_RenderFlush(void);
+
 /**
  *  \brief Destroy the specified texture.
  *  
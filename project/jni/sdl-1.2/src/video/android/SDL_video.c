@@ -2954,6 +2954,25 @@ SDL_RenderPresent(void)
     renderer->RenderPresent(renderer);
 }
 
+int
+SDL_RenderFlush(void)
+{
+    SDL_Renderer *renderer;
+
+    /* Do not create a renderer, OpenGL apps call this on every frame too */
+    if (!_this) {
+        return -1;
+    }
+    renderer = SDL_CurrentRenderer;
+    if (!renderer) {
+        return -1;
+    }
+    if (!renderer->RenderFlush) {
+        return 0;
+    }
+    return renderer->RenderFlush(renderer);
+}
+
 void
 SDL_DestroyTexture(SDL_Texture * texture)
 {
@@ -144,6 +144,31 @@ extern DECLSPEC int SDLCALL Mix_AllocateChannels(int numchans);
  */
 extern DECLSPEC int SDLCALL Mix_QuerySpec(int *frequency,Uint16 *format,int *channels);
 
+/* Get timing of the mixer audio callback since the previous call, or since Mix_OpenAudio().
+   callbacks is the amount of audio buffers mixed, durations are in microseconds,
+   overBudget is the amount of callbacks which took longer than playing one audio buffer,
+   which means audio underruns. Any pointer may be NULL.
+   Returns 0 if the audio is not opened.
+ */
+extern DECLSPEC int SDLCALL Mix_GetCallbackStats(int *callbacks, int *avgMicroseconds, int *maxMicroseconds, int *overBudget);
+
+/* Decode streamed music (WAV, MOD, MIDI, Ogg, FLAC and MP3 with libmad) ahead
+   in a separate thread, into a buffer of the given length in milliseconds,
+   so a slow decoder does not make the audio callback late. A few hundred
+   milliseconds is enough, 0 decodes the music in the audio callback, which
+   is the default. Takes effect on the next Mix_OpenAudio(); volume changes
+   and fading still apply immediately.
+   If ms is negative, returns the current setting, otherwise the previous one.
+ */
+extern DECLSPEC int SDLCALL Mix_SetMusicDecodeAhead(int ms);
+
+/* Get timing of the music decode thread since the previous call, or since Mix_OpenAudio().
+   underruns is the amount of audio callbacks which found less decoded music than they needed,
+   durations are in microseconds, for decoding one audio buffer. Any pointer may be NULL.
+   Returns 0 if the music is not decoded ahead.
+ */
+extern DECLSPEC int SDLCALL Mix_GetMusicDecodeStats(int *underruns, int *avgMicroseconds, int *maxMicroseconds);
+
 /* Load a wave file or a music (.mod .s3m .it .xm) file */
 extern DECLSPEC Mix_Chunk * SDLCALL Mix_LoadWAV_RW(SDL_RWops *src, int freesrc);
 #define Mix_LoadWAV(file)	Mix_LoadWAV_RW(SDL_RWFromFile(file, "rb"), 1)
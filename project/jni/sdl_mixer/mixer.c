@@ -25,6 +25,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/time.h>
 
 #include "SDL_mutex.h"
 #include "SDL_endian.h"
@@ -82,6 +83,25 @@ static struct _Mix_Channel {
 
 static effect_info *posteffects = NULL;
 
+/* Channel effects work on a copy of the samples, each channel has its own
+   copy buffer of one audio callback size, so the audio thread never allocates memory. */
+static Uint8 *effect_scratch = NULL;
+static int effect_scratch_size = 0;
+static int effect_scratch_channels = 0;
+
+#if !SDL_VERSION_ATLEAST(1, 3, 0)
+/* Channels are collected here, and mixed together by SDL_MixAudioMulti() */
+static SDL_MixAudioSource *mix_sources = NULL;
+static int mix_sources_max = 0;
+static int mix_sources_count = 0;
+#endif
+
+/* Audio callback duration, in microseconds */
+static int callback_count = 0;
+static Uint32 callback_time_total = 0;
+static int callback_time_max = 0;
+static int callback_over_budget = 0;
+
 static int num_channels;
 static int reserved_channels = 0;
 
@@ -231,7 +251,75 @@ static void _Mix_channel_done_playing(int channel)
 }
 
 
-static void *Mix_DoEffects(int chan, void *snd, int len)
+/* Resize channel copy buffers, must be called with audio locked or stopped */
+static int alloc_mix_buffers(int channels, int size)
+{
+	Uint8 *scratch = (Uint8 *) realloc(effect_scratch, channels * size);
+	if (scratch == NULL && channels > 0) {
+		Mix_SetError("Out of memory");
+		return(-1);
+	}
+	effect_scratch = scratch;
+	effect_scratch_size = size;
+	effect_scratch_channels = channels;
+#if !SDL_VERSION_ATLEAST(1, 3, 0)
+	{
+		/* Usually a channel plays one chunk, or the end and the start of a looped chunk */
+		SDL_MixAudioSource *sources = (SDL_MixAudioSource *) realloc(mix_sources,
+		                              (channels * 2 + 1) * sizeof(SDL_MixAudioSource));
+		if (sources == NULL) {
+			Mix_SetError("Out of memory");
+			return(-1);
+		}
+		mix_sources = sources;
+		mix_sources_max = channels * 2 + 1;
+	}
+#endif
+	return(0);
+}
+
+static void free_mix_buffers(void)
+{
+	free(effect_scratch);
+	effect_scratch = NULL;
+	effect_scratch_size = 0;
+	effect_scratch_channels = 0;
+#if !SDL_VERSION_ATLEAST(1, 3, 0)
+	free(mix_sources);
+	mix_sources = NULL;
+	mix_sources_max = 0;
+#endif
+}
+
+static void flush_channels(Uint8 *stream, int len)
+{
+#if !SDL_VERSION_ATLEAST(1, 3, 0)
+	SDL_MixAudioMulti(stream, len, mix_sources, mix_sources_count);
+	mix_sources_count = 0;
+#endif
+}
+
+/* Add part of a channel to the stream, starting at index */
+static void mix_channel_data(Uint8 *stream, int len, int index, Uint8 *data, int mixable, int volume)
+{
+#if SDL_VERSION_ATLEAST(1, 3, 0)
+	SDL_MixAudio(stream+index, data, mixable, volume);
+#else
+	SDL_MixAudioSource *source;
+
+	if (mix_sources_count >= mix_sources_max) {
+		flush_channels(stream, len);
+	}
+	source = &mix_sources[mix_sources_count++];
+	source->src = data;
+	source->offset = index;
+	source->len = mixable;
+	source->volume = volume;
+#endif
+}
+
+/* index is the position of the samples in the stream, each part of the stream has its own copy buffer */
+static void *Mix_DoEffects(int chan, void *snd, int len, int index)
 {
 	int posteffect = (chan == MIX_CHANNEL_POST);
 	effect_info *e = ((posteffect) ? posteffects : mix_channel[chan].effects);
@@ -240,11 +328,17 @@ static void *Mix_DoEffects(int chan, void *snd, int len)
 	if (e != NULL) {    /* are there any registered effects? */
 		/* if this is the postmix, we can just overwrite the original. */
 		if (!posteffect) {
-			buf = malloc(len);
-			if (buf == NULL) {
-				return(snd);
+			/* SDL always asks for one audio buffer of mixer.size bytes,
+			   a larger callback gets a temporary copy like before */
+			if (chan < effect_scratch_channels && index + len <= effect_scratch_size) {
+				buf = effect_scratch + chan * effect_scratch_size + index;
+			} else {
+				buf = malloc(len);
+				if (buf == NULL) {
+					return(snd);
+				}
 			}
-		    memcpy(buf, snd, len);
+			memcpy(buf, snd, len);
 		}
 
 		for (; e != NULL; e = e->next) {
@@ -254,17 +348,43 @@ static void *Mix_DoEffects(int chan, void *snd, int len)
 		}
 	}
 
-	/* be sure to free() the return value if != snd ... */
+	/* the return value points to the channel copy buffer if != snd,
+	   or to a temporary copy that mix_channel_effects() frees */
 	return(buf);
 }
 
+/* Run the effects of a channel on part of its samples and add them to the stream */
+static void mix_channel_effects(Uint8 *stream, int len, int chan, Uint8 *snd, int mixable, int index, int volume)
+{
+	Uint8 *mix_input = Mix_DoEffects(chan, snd, mixable, index);
+
+	mix_channel_data(stream, len, index, mix_input, mixable, volume);
+	if (mix_input != snd && (mix_input < effect_scratch ||
+	    mix_input >= effect_scratch + effect_scratch_channels * effect_scratch_size)) {
+		/* mixed sources are kept until the flush, so flush before freeing */
+		flush_channels(stream, len);
+		free(mix_input);
+	}
+}
+
+
+/* Tell the app a channel is done in the audio callback. Its hook may free
+   any chunk, so the sources queued so far are mixed first */
+static void mix_channel_done_playing(Uint8 *stream, int len, int channel)
+{
+	flush_channels(stream, len);
+	_Mix_channel_done_playing(channel);
+}
 
 /* Mixing function */
 static void mix_channels(void *udata, Uint8 *stream, int len)
 {
-	Uint8 *mix_input;
 	int i, mixable, volume = SDL_MIX_MAXVOLUME;
 	Uint32 sdl_ticks;
+	struct timeval start_time, end_time;
+	int duration;
+
+	gettimeofday(&start_time, NULL);
 
 #if SDL_VERSION_ATLEAST(1, 3, 0)
 	/* Need to initialize the stream in SDL 1.3+ */
@@ -285,7 +405,7 @@ static void mix_channels(void *udata, Uint8 *stream, int len)
 				mix_channel[i].playing = 0;
 				mix_channel[i].fading = MIX_NO_FADING;
 				mix_channel[i].expire = 0;
-				_Mix_channel_done_playing(i);
+				mix_channel_done_playing(stream, len, i);
 			} else if ( mix_channel[i].fading != MIX_NO_FADING ) {
 				Uint32 ticks = sdl_ticks - mix_channel[i].ticks_fade;
 				if( ticks > mix_channel[i].fade_length ) {
@@ -293,7 +413,7 @@ static void mix_channels(void *udata, Uint8 *stream, int len)
 					if( mix_channel[i].fading == MIX_FADING_OUT ) {
 						mix_channel[i].playing = 0;
 						mix_channel[i].expire = 0;
-						_Mix_channel_done_playing(i);
+						mix_channel_done_playing(stream, len, i);
 					}
 					mix_channel[i].fading = MIX_NO_FADING;
 				} else {
@@ -316,10 +436,7 @@ static void mix_channels(void *udata, Uint8 *stream, int len)
 						mixable = remaining;
 					}
 
-					mix_input = Mix_DoEffects(i, mix_channel[i].samples, mixable);
-					SDL_MixAudio(stream+index,mix_input,mixable,volume);
-					if (mix_input != mix_channel[i].samples)
-						free(mix_input);
+					mix_channel_effects(stream, len, i, mix_channel[i].samples, mixable, index, volume);
 
 					mix_channel[i].samples += mixable;
 					mix_channel[i].playing -= mixable;
@@ -327,7 +444,7 @@ static void mix_channels(void *udata, Uint8 *stream, int len)
 
 					/* rcg06072001 Alert app if channel is done playing. */
 					if (!mix_channel[i].playing && !mix_channel[i].looping) {
-						_Mix_channel_done_playing(i);
+						mix_channel_done_playing(stream, len, i);
 					}
 				}
 
@@ -340,10 +457,7 @@ static void mix_channels(void *udata, Uint8 *stream, int len)
 						remaining = alen;
 					}
 
-					mix_input = Mix_DoEffects(i, mix_channel[i].chunk->abuf, remaining);
-					SDL_MixAudio(stream+index, mix_input, remaining, volume);
-					if (mix_input != mix_channel[i].chunk->abuf)
-						free(mix_input);
+					mix_channel_effects(stream, len, i, mix_channel[i].chunk->abuf, remaining, index, volume);
 
 					--mix_channel[i].looping;
 					mix_channel[i].samples = mix_channel[i].chunk->abuf + remaining;
@@ -359,12 +473,29 @@ static void mix_channels(void *udata, Uint8 *stream, int len)
 		}
 	}
 
+	flush_channels(stream, len);
+
 	/* rcg06122001 run posteffects... */
-	Mix_DoEffects(MIX_CHANNEL_POST, stream, len);
+	Mix_DoEffects(MIX_CHANNEL_POST, stream, len, 0);
 
 	if ( mix_postmix ) {
 		mix_postmix(mix_postmix_data, stream, len);
 	}
+
+	gettimeofday(&end_time, NULL);
+	duration = (end_time.tv_sec - start_time.tv_sec) * 1000000 + (end_time.tv_usec - start_time.tv_usec);
+	if ( duration < 0 ) {
+		duration = 0;
+	}
+	++callback_count;
+	callback_time_total += duration;
+	if ( duration > callback_time_max ) {
+		callback_time_max = duration;
+	}
+	/* The callback has to finish before the audio buffer it fills is played */
+	if ( (Sint64)duration * mixer.freq > (Sint64)mixer.samples * 1000000 ) {
+		++callback_over_budget;
+	}
 }
 
 #if 0
@@ -419,6 +550,18 @@ int Mix_OpenAudio(int frequency, Uint16 format, int nchannels, int chunksize)
 
 	num_channels = MIX_CHANNELS;
 	mix_channel = (struct _Mix_Channel *) malloc(num_channels * sizeof(struct _Mix_Channel));
+	if ( alloc_mix_buffers(num_channels, mixer.size) < 0 ) {
+		free(mix_channel);
+		mix_channel = NULL;
+		free_mix_buffers();
+		close_music();
+		SDL_CloseAudio();
+		return(-1);
+	}
+	callback_count = 0;
+	callback_time_total = 0;
+	callback_time_max = 0;
+	callback_over_budget = 0;
 
 	/* Clear out the audio channels */
 	for ( i=0; i<num_channels; ++i ) {
@@ -472,6 +615,10 @@ int Mix_AllocateChannels(int numchans)
 		}
 	}
 	SDL_LockAudio();
+	if ( alloc_mix_buffers(numchans, mixer.size) < 0 ) {
+		SDL_UnlockAudio();
+		return(num_channels);
+	}
 	mix_channel = (struct _Mix_Channel *) realloc(mix_channel, numchans * sizeof(struct _Mix_Channel));
 	if ( numchans > num_channels ) {
 		/* Initialize the new channels */
@@ -495,6 +642,30 @@ int Mix_AllocateChannels(int numchans)
 	return(num_channels);
 }
 
+/* Return audio callback timing, and reset it */
+int Mix_GetCallbackStats(int *callbacks, int *avgMicroseconds, int *maxMicroseconds, int *overBudget)
+{
+	SDL_LockAudio();
+	if ( callbacks ) {
+		*callbacks = callback_count;
+	}
+	if ( avgMicroseconds ) {
+		*avgMicroseconds = callback_count ? (int)(callback_time_total / callback_count) : 0;
+	}
+	if ( maxMicroseconds ) {
+		*maxMicroseconds = callback_time_max;
+	}
+	if ( overBudget ) {
+		*overBudget = callback_over_budget;
+	}
+	callback_count = 0;
+	callback_time_total = 0;
+	callback_time_max = 0;
+	callback_over_budget = 0;
+	SDL_UnlockAudio();
+	return(audio_opened);
+}
+
 /* Return the actual mixer parameters */
 int Mix_QuerySpec(int *frequency, Uint16 *format, int *channels)
 {
@@ -1099,6 +1270,7 @@ void Mix_CloseAudio(void)
 			SDL_CloseAudio();
 			free(mix_channel);
 			mix_channel = NULL;
+			free_mix_buffers();
 
 			/* rcg06042009 report available decoders at runtime. */
 			free(chunk_decoders);
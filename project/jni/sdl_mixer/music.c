@@ -26,9 +26,12 @@
 #include <string.h>
 #include <ctype.h>
 #include <assert.h>
+#include <sys/time.h>
 #include "SDL_endian.h"
 #include "SDL_audio.h"
 #include "SDL_timer.h"
+#include "SDL_thread.h"
+#include "SDL_mutex.h"
 
 #include "SDL_mixer.h"
 
@@ -130,6 +133,38 @@ static int native_midi_ok;
 /* Used to calculate fading steps */
 static int ms_per_step;
 
+/* Decode-ahead mode: a thread decodes the music into a ring in the mixer
+   format, and music_mixer() only copies it out, so a decoder which is slow
+   once in a while does not make the audio callback late. The ring has one
+   writer and one reader, the decoder state and music_playing are guarded by
+   music_decode_lock, which is taken after the audio lock. The decode thread
+   lets go of the lock while it decodes and sets music_decoding instead, and
+   music_lock() waits for that without the audio lock. The audio callback
+   never takes music_decode_lock: when the music has ended or faded out it
+   sets music_ring_halt, and the decode thread halts the music. */
+static int music_decode_ahead_ms = 0;
+static Uint8 *music_ring = NULL;
+static Uint32 music_ring_size = 0;
+static volatile Uint32 music_ring_head = 0;
+static volatile Uint32 music_ring_tail = 0;
+static volatile int music_ring_eof = 0;
+static volatile int music_ring_halt = 0;
+static int music_ring_started = 0;
+static int music_mix_volume = MIX_MAX_VOLUME;
+static Uint8 music_silence = 0;
+static Uint8 *music_decode_buf = NULL;
+static int music_decode_len = 0;
+static SDL_mutex *music_decode_lock = NULL;
+static SDL_cond *music_decode_done = NULL;
+static int music_decoding = 0;
+static SDL_sem *music_decode_wake = NULL;
+static SDL_Thread *music_decode_thread = NULL;
+static volatile int music_decode_quit = 0;
+static int music_decode_underruns = 0;
+static int music_decode_count = 0;
+static Uint32 music_decode_time_total = 0;
+static int music_decode_time_max = 0;
+
 /* rcg06042009 report available decoders at runtime. */
 static const char **music_decoders = NULL;
 static int num_decoders = 0;
@@ -160,10 +195,14 @@ static void add_music_decoder(const char *decoder)
 /* Local low-level functions prototypes */
 static void music_internal_initialize_volume(void);
 static void music_internal_volume(int volume);
+static void music_internal_decoder_volume(Mix_Music *music, int volume);
 static int  music_internal_play(Mix_Music *music, double position);
+static int  music_internal_start(Mix_Music *music);
+static int  music_internal_stop(Mix_Music *music);
 static int  music_internal_position(double position);
 static int  music_internal_playing();
 static void music_internal_halt(void);
+static void music_decode_flush(void);
 
 
 /* Support for hooking when the music has finished */
@@ -176,6 +215,72 @@ void Mix_HookMusicFinished(void (*music_finished)(void))
 	SDL_UnlockAudio();
 }
 
+/* Lock out both the audio callback and the decode thread */
+static void music_lock(void)
+{
+	SDL_LockAudio();
+	if ( music_decode_lock ) {
+		SDL_mutexP(music_decode_lock);
+		/* Wait for the decoder with the audio unlocked, or the callback
+		   would wait for it too */
+		while ( music_decoding ) {
+			SDL_UnlockAudio();
+			SDL_CondWait(music_decode_done, music_decode_lock);
+			SDL_mutexV(music_decode_lock);
+			SDL_LockAudio();
+			SDL_mutexP(music_decode_lock);
+		}
+	}
+}
+
+static void music_unlock(void)
+{
+	if ( music_decode_lock ) {
+		SDL_mutexV(music_decode_lock);
+	}
+	SDL_UnlockAudio();
+}
+
+/* Music types which decode into the stream, so they can be decoded ahead */
+static int music_can_decode_ahead(Mix_Music *music)
+{
+	if ( !music_ring ) {
+		return 0;
+	}
+	switch (music->type) {
+#ifdef WAV_MUSIC
+	    case MUS_WAV:
+#endif
+#ifdef MOD_MUSIC
+	    case MUS_MOD:
+#endif
+#ifdef OGG_MUSIC
+	    case MUS_OGG:
+#endif
+#ifdef FLAC_MUSIC
+	    case MUS_FLAC:
+#endif
+#ifdef MP3_MAD_MUSIC
+	    case MUS_MP3_MAD:
+#endif
+		return 1;
+#ifdef MID_MUSIC
+	    case MUS_MID:
+#ifdef USE_NATIVE_MIDI
+		if ( native_midi_ok ) {
+			return 0;
+		}
+#endif
+#ifdef USE_TIMIDITY_MIDI
+		return timidity_ok;
+#endif
+		return 0;
+#endif
+	    default:
+		return 0;
+	}
+}
+
 
 /* If music isn't playing, halt it if no looping is required, restart it */
 /* otherwhise. NOP if the music is playing */
@@ -207,12 +312,116 @@ static int music_halt_or_loop (void)
 
 
 
+/* Decode some of the playing music into the stream, returns the amount of
+   bytes left unfilled when the music has ended */
+static int music_play_some(Uint8 *stream, int len)
+{
+	int left = 0;
+
+	switch (music_playing->type) {
+#ifdef CMD_MUSIC
+		case MUS_CMD:
+			/* The playing is done externally */
+			break;
+#endif
+#ifdef WAV_MUSIC
+		case MUS_WAV:
+			left = WAVStream_PlaySome(stream, len);
+			break;
+#endif
+#ifdef MOD_MUSIC
+		case MUS_MOD:
+			left = MOD_playAudio(music_playing->data.module, stream, len);
+			break;
+#endif
+#ifdef MID_MUSIC
+#ifdef USE_TIMIDITY_MIDI
+		case MUS_MID:
+			if ( timidity_ok ) {
+				int samples = len / samplesize;
+  				Timidity_PlaySome(stream, samples);
+			}
+			break;
+#endif
+#endif
+#ifdef OGG_MUSIC
+		case MUS_OGG:
+			
+			left = OGG_playAudio(music_playing->data.ogg, stream, len);
+			break;
+#endif
+#ifdef FLAC_MUSIC
+		case MUS_FLAC:
+			left = FLAC_playAudio(music_playing->data.flac, stream, len);
+			break;
+#endif
+#ifdef MP3_MUSIC
+		case MUS_MP3:
+			left = (len - smpeg.SMPEG_playAudio(music_playing->data.mp3, stream, len));
+			break;
+#endif
+#ifdef MP3_MAD_MUSIC
+		case MUS_MP3_MAD:
+			left = mad_getSamples(music_playing->data.mp3_mad, stream, len);
+			break;
+#endif
+		default:
+			/* Unknown music type?? */
+			break;
+	}
+	return left;
+}
+
+/* Copy the decoded music from the ring, in the audio callback */
+static void music_mix_ring(Uint8 *stream, int len)
+{
+	Uint32 tail = music_ring_tail, head, pos, part;
+	int eof = music_ring_eof, mixable = len;
+
+	/* The decode thread sets the end after the last audio, so read it first */
+	__sync_synchronize();
+	head = music_ring_head;
+	__sync_synchronize(); // Read the audio only after reading the head
+	if ( (Uint32)mixable > head - tail ) {
+		mixable = head - tail;
+	}
+	pos = tail & (music_ring_size - 1);
+	part = mixable;
+	if ( part > music_ring_size - pos ) {
+		part = music_ring_size - pos;
+	}
+	/* The stream is silent yet, like in the decoders */
+	if ( music_mix_volume == MIX_MAX_VOLUME ) {
+		memcpy(stream, music_ring + pos, part);
+		memcpy(stream + part, music_ring, mixable - part);
+	} else {
+		SDL_MixAudio(stream, music_ring + pos, part, music_mix_volume);
+		SDL_MixAudio(stream + part, music_ring, mixable - part, music_mix_volume);
+	}
+	__sync_synchronize(); // Copy the audio before giving the space back to the decode thread
+	music_ring_tail = tail + mixable;
+	SDL_SemPost(music_decode_wake);
+
+	if ( mixable > 0 ) {
+		music_ring_started = 1;
+	}
+	if ( mixable < len ) {
+		if ( eof ) {
+			/* The music has been played to the end, with all its loops */
+			music_ring_halt = 1;
+			SDL_SemPost(music_decode_wake);
+		} else if ( music_ring_started ) {
+			++music_decode_underruns;
+		}
+	}
+}
+
 /* Mixing function */
 void music_mixer(void *udata, Uint8 *stream, int len)
 {
 	int left = 0;
 
-	if ( music_playing && music_active ) {
+	if ( music_playing && music_active && !music_ring_halt ) {
 		/* Handle fading */
 		if ( music_playing->fading != MIX_NO_FADING ) {
 			if ( music_playing->fade_step++ < music_playing->fade_steps ) {
@@ -228,6 +437,12 @@ void music_mixer(void *udata, Uint8 *stream, int len)
 				music_internal_volume(volume);
 			} else {
 				if ( music_playing->fading == MIX_FADING_OUT ) {
+					if ( music_can_decode_ahead(music_playing) ) {
+						/* The decode thread may be in the decoder */
+						music_ring_halt = 1;
+						SDL_SemPost(music_decode_wake);
+						return;
+					}
 					music_internal_halt();
 					if ( music_finished_hook ) {
 						music_finished_hook();
@@ -237,62 +452,16 @@ void music_mixer(void *udata, Uint8 *stream, int len)
 				music_playing->fading = MIX_NO_FADING;
 			}
 		}
-		
+
+		if ( music_can_decode_ahead(music_playing) ) {
+			music_mix_ring(stream, len);
+			return;
+		}
+
 		if (music_halt_or_loop() == 0)
 			return;
 		
-		
-		switch (music_playing->type) {
-#ifdef CMD_MUSIC
-			case MUS_CMD:
-				/* The playing is done externally */
-				break;
-#endif
-#ifdef WAV_MUSIC
-			case MUS_WAV:
-				left = WAVStream_PlaySome(stream, len);
-				break;
-#endif
-#ifdef MOD_MUSIC
-			case MUS_MOD:
-				left = MOD_playAudio(music_playing->data.module, stream, len);
-				break;
-#endif
-#ifdef MID_MUSIC
-#ifdef USE_TIMIDITY_MIDI
-			case MUS_MID:
-				if ( timidity_ok ) {
-					int samples = len / samplesize;
-  					Timidity_PlaySome(stream, samples);
-				}
-				break;
-#endif
-#endif
-#ifdef OGG_MUSIC
-			case MUS_OGG:
-				
-				left = OGG_playAudio(music_playing->data.ogg, stream, len);
-				break;
-#endif
-#ifdef FLAC_MUSIC
-			case MUS_FLAC:
-				left = FLAC_playAudio(music_playing->data.flac, stream, len);
-				break;
-#endif
-#ifdef MP3_MUSIC
-			case MUS_MP3:
-				left = (len - smpeg.SMPEG_playAudio(music_playing->data.mp3, stream, len));
-				break;
-#endif
-#ifdef MP3_MAD_MUSIC
-			case MUS_MP3_MAD:
-				left = mad_getSamples(music_playing->data.mp3_mad, stream, len);
-				break;
-#endif
-			default:
-				/* Unknown music type?? */
-				break;
-		}
+		left = music_play_some(stream, len);
 	}
 
 	/* Handle seamless music looping */
@@ -301,6 +470,241 @@ void music_mixer(void *udata, Uint8 *stream, int len)
 	}
 }
 
+/* Decode the playing music into buf, in the decode thread, looping it the
+   same way music_mixer() does. Returns the amount of bytes decoded, and sets
+   *eof when the music has ended. */
+static int music_decode_some(Uint8 *buf, int len, int *eof)
+{
+	int done = 0, left;
+
+	memset(buf, music_silence, len);
+	while ( done < len ) {
+		if ( !music_internal_playing() ) {
+			if ( music_loops && --music_loops ) {
+				/* Restart the decoder only, the callback owns the fading and the volume */
+				music_internal_stop(music_playing);
+				music_internal_start(music_playing);
+				music_internal_position(0.0);
+			} else {
+				*eof = 1;
+				break;
+			}
+		}
+		left = music_play_some(buf + done, len - done);
+		if ( left == len - done ) {
+			break;
+		}
+		done = len - left;
+	}
+	return done;
+}
+
+/* Halts the music music_mixer() has played to the end or faded out, in the
+   decode thread, in the callback's stead */
+static void music_decode_halt(void)
+{
+	int halted = 0;
+
+	SDL_LockAudio();
+	SDL_mutexP(music_decode_lock);
+	/* Unless the music was changed since */
+	if ( music_ring_halt && music_playing ) {
+		music_internal_halt();
+		music_decode_flush();
+		halted = 1;
+	}
+	music_ring_halt = 0;
+	SDL_mutexV(music_decode_lock);
+	if ( halted && music_finished_hook ) {
+		music_finished_hook();
+	}
+	SDL_UnlockAudio();
+}
+
+static int music_decode_thread_func(void *unused)
+{
+	struct timeval start_time, end_time;
+
+	while ( !music_decode_quit ) {
+		Uint32 head, pos, part;
+		int decoded = 0, eof = 0, duration;
+
+		if ( music_ring_halt ) {
+			music_decode_halt();
+		}
+		SDL_mutexP(music_decode_lock);
+		/* Only now: music_decode_flush() may have reset the ring while we waited */
+		head = music_ring_head;
+		if ( music_playing && !music_ring_eof && music_can_decode_ahead(music_playing) &&
+		     music_ring_size - (head - music_ring_tail) >= (Uint32)music_decode_len ) {
+			/* music_lock() waits for music_decoding, so the music and
+			   the ring stay as they are until the lock is taken again */
+			music_decoding = 1;
+			SDL_mutexV(music_decode_lock);
+			gettimeofday(&start_time, NULL);
+			decoded = music_decode_some(music_decode_buf, music_decode_len, &eof);
+			gettimeofday(&end_time, NULL);
+			SDL_mutexP(music_decode_lock);
+			music_decoding = 0;
+			SDL_CondBroadcast(music_decode_done);
+			duration = (end_time.tv_sec - start_time.tv_sec) * 1000000 + (end_time.tv_usec - start_time.tv_usec);
+			++music_decode_count;
+			music_decode_time_total += duration;
+			if ( duration > music_decode_time_max ) {
+				music_decode_time_max = duration;
+			}
+
+			__sync_synchronize(); // Write to the ring only after reading the tail
+			pos = head & (music_ring_size - 1);
+			part = decoded;
+			if ( part > music_ring_size - pos ) {
+				part = music_ring_size - pos;
+			}
+			memcpy(music_ring + pos, music_decode_buf, part);
+			memcpy(music_ring, music_decode_buf + part, decoded - part);
+			__sync_synchronize(); // The audio must be visible before the new head
+			music_ring_head = head + decoded;
+			if ( eof ) {
+				__sync_synchronize();
+				music_ring_eof = 1;
+			}
+		}
+		SDL_mutexV(music_decode_lock);
+
+		/* Wait for the callback to free some space, or for new music */
+		if ( !decoded ) {
+			SDL_SemWait(music_decode_wake);
+		}
+	}
+	return 0;
+}
+
+/* Forget the decoded audio after the music is changed, with both the audio
+   callback and the decode thread locked out */
+static void music_decode_flush(void)
+{
+	if ( !music_ring ) {
+		return;
+	}
+	music_ring_head = music_ring_tail = 0;
+	music_ring_eof = 0;
+	music_ring_halt = 0;
+	music_ring_started = 0;
+	SDL_SemPost(music_decode_wake);
+}
+
+static void music_decode_start(SDL_AudioSpec *mixer)
+{
+	Uint32 size = (Uint32)music_decode_ahead_ms * mixer->freq / 1000 *
+	              mixer->channels * ((mixer->format & 0xFF) / 8);
+
+	music_decode_len = mixer->size;
+	/* The ring is a power of two, and holds at least two audio buffers */
+	for ( music_ring_size = 1024; music_ring_size < size || music_ring_size < 2 * mixer->size; music_ring_size *= 2 )
+		;
+	music_ring = (Uint8 *)malloc(music_ring_size);
+	music_decode_buf = (Uint8 *)malloc(music_decode_len);
+	music_decode_lock = SDL_CreateMutex();
+	music_decode_done = SDL_CreateCond();
+	music_decode_wake = SDL_CreateSemaphore(0);
+	music_ring_head = music_ring_tail = 0;
+	music_ring_eof = 0;
+	music_ring_halt = 0;
+	music_decoding = 0;
+	music_ring_started = 0;
+	music_mix_volume = MIX_MAX_VOLUME;
+	music_decode_quit = 0;
+	music_decode_underruns = 0;
+	music_decode_count = 0;
+	music_decode_time_total = 0;
+	music_decode_time_max = 0;
+	if ( music_ring && music_decode_buf && music_decode_lock && music_decode_done && music_decode_wake ) {
+		music_decode_thread = SDL_CreateThread(music_decode_thread_func, NULL);
+	}
+	if ( !music_decode_thread ) {
+		/* Not fatal, decode in the audio callback as usual */
+		SDL_LockAudio();
+		free(music_ring);
+		music_ring = NULL;
+		SDL_UnlockAudio();
+		free(music_decode_buf);
+		music_decode_buf = NULL;
+		if ( music_decode_lock ) {
+			SDL_DestroyMutex(music_decode_lock);
+			music_decode_lock = NULL;
+		}
+		if ( music_decode_done ) {
+			SDL_DestroyCond(music_decode_done);
+			music_decode_done = NULL;
+		}
+		if ( music_decode_wake ) {
+			SDL_DestroySemaphore(music_decode_wake);
+			music_decode_wake = NULL;
+		}
+	}
+}
+
+static void music_decode_stop(void)
+{
+	Uint8 *ring;
+
+	if ( !music_decode_thread ) {
+		return;
+	}
+	music_decode_quit = 1;
+	SDL_SemPost(music_decode_wake);
+	SDL_WaitThread(music_decode_thread, NULL);
+	music_decode_thread = NULL;
+
+	/* The audio callback may still run until SDL_CloseAudio() */
+	SDL_LockAudio();
+	ring = music_ring;
+	music_ring = NULL;
+	SDL_UnlockAudio();
+	free(ring);
+	free(music_decode_buf);
+	music_decode_buf = NULL;
+	SDL_DestroyMutex(music_decode_lock);
+	music_decode_lock = NULL;
+	SDL_DestroyCond(music_decode_done);
+	music_decode_done = NULL;
+	SDL_DestroySemaphore(music_decode_wake);
+	music_decode_wake = NULL;
+}
+
+int Mix_SetMusicDecodeAhead(int ms)
+{
+	int prev_ms = music_decode_ahead_ms;
+
+	if ( ms >= 0 ) {
+		music_decode_ahead_ms = ms;
+	}
+	return(prev_ms);
+}
+
+int Mix_GetMusicDecodeStats(int *underruns, int *avgMicroseconds, int *maxMicroseconds)
+{
+	int retval = (music_ring != NULL);
+
+	music_lock();
+	if ( underruns ) {
+		*underruns = music_decode_underruns;
+	}
+	if ( avgMicroseconds ) {
+		*avgMicroseconds = music_decode_count ? (int)(music_decode_time_total / music_decode_count) : 0;
+	}
+	if ( maxMicroseconds ) {
+		*maxMicroseconds = music_decode_time_max;
+	}
+	music_decode_underruns = 0;
+	music_decode_count = 0;
+	music_decode_time_total = 0;
+	music_decode_time_max = 0;
+	music_unlock();
+
+	return(retval);
+}
+
 /* Initialize the music players with a certain desired audio format */
 int open_music(SDL_AudioSpec *mixer)
 {
@@ -361,6 +765,11 @@ int open_music(SDL_AudioSpec *mixer)
 	/* Calculate the number of ms for each callback */
 	ms_per_step = (int) (((float)mixer->samples * 1000.0) / mixer->freq);
 
+	music_silence = mixer->silence;
+	if ( music_decode_ahead_ms > 0 ) {
+		music_decode_start(mixer);
+	}
+
 	return(0);
 }
 
@@ -552,19 +961,20 @@ void Mix_FreeMusic(Mix_Music *music)
 {
 	if ( music ) {
 		/* Stop the music if it's currently playing */
-		SDL_LockAudio();
+		music_lock();
 		if ( music == music_playing ) {
 			/* Wait for any fade out to finish */
 			while ( music->fading == MIX_FADING_OUT ) {
-				SDL_UnlockAudio();
+				music_unlock();
 				SDL_Delay(100);
-				SDL_LockAudio();
+				music_lock();
 			}
 			if ( music == music_playing ) {
 				music_internal_halt();
+				music_decode_flush();
 			}
 		}
-		SDL_UnlockAudio();
+		music_unlock();
 		switch (music->type) {
 #ifdef CMD_MUSIC
 			case MUS_CMD:
@@ -642,24 +1052,13 @@ Mix_MusicType Mix_GetMusicType(const Mix_Music *music)
 	return(type);
 }
 
-/* Play a music chunk.  Returns 0, or -1 if there was an error.
+/* Start the decoder of the music from the beginning.  Returns 0, or -1 if
+   the music type is unknown.
  */
-static int music_internal_play(Mix_Music *music, double position)
+static int music_internal_start(Mix_Music *music)
 {
 	int retval = 0;
 
-	/* Note the music we're playing */
-	if ( music_playing ) {
-		music_internal_halt();
-	}
-	music_playing = music;
-
-	/* Set the initial volume */
-	if ( music->type != MUS_MOD ) {
-		music_internal_initialize_volume();
-	}
-
-	/* Set up for playback */
 	switch (music->type) {
 #ifdef CMD_MUSIC
 	    case MUS_CMD:
@@ -674,8 +1073,6 @@ static int music_internal_play(Mix_Music *music, double position)
 #ifdef MOD_MUSIC
 	    case MUS_MOD:
 		MOD_play(music->data.module);
-		/* Player_SetVolume() does nothing before Player_Start() */
-		music_internal_initialize_volume();
 		break;
 #endif
 #ifdef MID_MUSIC
@@ -706,7 +1103,7 @@ static int music_internal_play(Mix_Music *music, double position)
 	    case MUS_MP3:
 		smpeg.SMPEG_enableaudio(music->data.mp3,1);
 		smpeg.SMPEG_enablevideo(music->data.mp3,0);
-		smpeg.SMPEG_play(music_playing->data.mp3);
+		smpeg.SMPEG_play(music->data.mp3);
 		break;
 #endif
 #ifdef MP3_MAD_MUSIC
@@ -720,6 +1117,38 @@ static int music_internal_play(Mix_Music *music, double position)
 		break;
 	}
 
+	/* When decoding ahead, the decoder plays at full volume, and
+	   music_mixer() applies the volume to the decoded audio */
+	if ( retval == 0 && music_can_decode_ahead(music) ) {
+		music_internal_decoder_volume(music, MIX_MAX_VOLUME);
+	}
+	return(retval);
+}
+
+/* Play a music chunk.  Returns 0, or -1 if there was an error.
+ */
+static int music_internal_play(Mix_Music *music, double position)
+{
+	int retval = 0;
+
+	/* Note the music we're playing */
+	if ( music_playing ) {
+		music_internal_halt();
+	}
+	music_playing = music;
+
+	/* Set the initial volume */
+	if ( music->type != MUS_MOD ) {
+		music_internal_initialize_volume();
+	}
+
+	/* Set up for playback */
+	retval = music_internal_start(music);
+	if ( music->type == MUS_MOD ) {
+		/* Player_SetVolume() does nothing before Player_Start() */
+		music_internal_initialize_volume();
+	}
+
 	/* Set the playback position, note any errors if an offset is used */
 	if ( retval == 0 ) {
 		if ( position > 0.0 ) {
@@ -758,17 +1187,18 @@ int Mix_FadeInMusicPos(Mix_Music *music, int loops, int ms, double position)
 	music->fade_steps = ms/ms_per_step;
 
 	/* Play the puppy */
-	SDL_LockAudio();
+	music_lock();
 	/* If the current music is fading out, wait for the fade to complete */
 	while ( music_playing && (music_playing->fading == MIX_FADING_OUT) ) {
-		SDL_UnlockAudio();
+		music_unlock();
 		SDL_Delay(100);
-		SDL_LockAudio();
+		music_lock();
 	}
 	music_active = 1;
 	music_loops = loops;
 	retval = music_internal_play(music, position);
-	SDL_UnlockAudio();
+	music_decode_flush();
+	music_unlock();
 
 	return(retval);
 }
@@ -828,17 +1258,18 @@ int Mix_SetMusicPosition(double position)
 {
 	int retval;
 
-	SDL_LockAudio();
+	music_lock();
 	if ( music_playing ) {
 		retval = music_internal_position(position);
 		if ( retval < 0 ) {
 			Mix_SetError("Position not implemented for music type");
 		}
+		music_decode_flush();
 	} else {
 		Mix_SetError("Music isn't playing");
 		retval = -1;
 	}
-	SDL_UnlockAudio();
+	music_unlock();
 
 	return(retval);
 }
@@ -856,7 +1287,17 @@ static void music_internal_initialize_volume(void)
 /* Set the music volume */
 static void music_internal_volume(int volume)
 {
-	switch (music_playing->type) {
+	if ( music_can_decode_ahead(music_playing) ) {
+		music_mix_volume = volume;
+	} else {
+		music_internal_decoder_volume(music_playing, volume);
+	}
+}
+
+/* Set the volume of the decoder of the music */
+static void music_internal_decoder_volume(Mix_Music *music, int volume)
+{
+	switch (music->type) {
 #ifdef CMD_MUSIC
 	    case MUS_CMD:
 		MusicCMD_SetVolume(volume);
@@ -869,7 +1310,7 @@ static void music_internal_volume(int volume)
 #endif
 #ifdef MOD_MUSIC
 	    case MUS_MOD:
-		MOD_setvolume(music_playing->data.module, volume);
+		MOD_setvolume(music->data.module, volume);
 		break;
 #endif
 #ifdef MID_MUSIC
@@ -888,22 +1329,22 @@ static void music_internal_volume(int volume)
 #endif
 #ifdef OGG_MUSIC
 	    case MUS_OGG:
-		OGG_setvolume(music_playing->data.ogg, volume);
+		OGG_setvolume(music->data.ogg, volume);
 		break;
 #endif
 #ifdef FLAC_MUSIC
 	    case MUS_FLAC:
-		FLAC_setvolume(music_playing->data.flac, volume);
+		FLAC_setvolume(music->data.flac, volume);
 		break;
 #endif
 #ifdef MP3_MUSIC
 	    case MUS_MP3:
-		smpeg.SMPEG_setvolume(music_playing->data.mp3,(int)(((float)volume/(float)MIX_MAX_VOLUME)*100.0));
+		smpeg.SMPEG_setvolume(music->data.mp3,(int)(((float)volume/(float)MIX_MAX_VOLUME)*100.0));
 		break;
 #endif
 #ifdef MP3_MAD_MUSIC
 	    case MUS_MP3_MAD:
-		mad_setVolume(music_playing->data.mp3_mad, volume);
+		mad_setVolume(music->data.mp3_mad, volume);
 		break;
 #endif
 	    default:
@@ -923,6 +1364,8 @@ int Mix_VolumeMusic(int volume)
 		volume = SDL_MIX_MAXVOLUME;
 	}
 	music_volume = volume;
+	/* Decoded ahead music only has music_mix_volume, the others are
+	   decoded in the callback */
 	SDL_LockAudio();
 	if ( music_playing ) {
 		music_internal_volume(music_volume);
@@ -934,10 +1377,23 @@ int Mix_VolumeMusic(int volume)
 /* Halt playing of music */
 static void music_internal_halt(void)
 {
-	switch (music_playing->type) {
+	if ( music_internal_stop(music_playing) < 0 ) {
+		/* Unknown music type?? */
+		return;
+	}
+	music_playing->fading = MIX_NO_FADING;
+	music_playing = NULL;
+}
+
+/* Stop the decoder of the music.  Returns 0, or -1 if the music type is
+   unknown.
+ */
+static int music_internal_stop(Mix_Music *music)
+{
+	switch (music->type) {
 #ifdef CMD_MUSIC
 	    case MUS_CMD:
-		MusicCMD_Stop(music_playing->data.cmd);
+		MusicCMD_Stop(music->data.cmd);
 		break;
 #endif
 #ifdef WAV_MUSIC
@@ -947,7 +1403,7 @@ static void music_internal_halt(void)
 #endif
 #ifdef MOD_MUSIC
 	    case MUS_MOD:
-		MOD_stop(music_playing->data.module);
+		MOD_stop(music->data.module);
 		break;
 #endif
 #ifdef MID_MUSIC
@@ -966,38 +1422,38 @@ static void music_internal_halt(void)
 #endif
 #ifdef OGG_MUSIC
 	    case MUS_OGG:
-		OGG_stop(music_playing->data.ogg);
+		OGG_stop(music->data.ogg);
 		break;
 #endif
 #ifdef FLAC_MUSIC
 	    case MUS_FLAC:
-		FLAC_stop(music_playing->data.flac);
+		FLAC_stop(music->data.flac);
 		break;
 #endif
 #ifdef MP3_MUSIC
 	    case MUS_MP3:
-		smpeg.SMPEG_stop(music_playing->data.mp3);
+		smpeg.SMPEG_stop(music->data.mp3);
 		break;
 #endif
 #ifdef MP3_MAD_MUSIC
 	    case MUS_MP3_MAD:
-		mad_stop(music_playing->data.mp3_mad);
+		mad_stop(music->data.mp3_mad);
 		break;
 #endif
 	    default:
 		/* Unknown music type?? */
-		return;
+		return(-1);
 	}
-	music_playing->fading = MIX_NO_FADING;
-	music_playing = NULL;
+	return(0);
 }
 int Mix_HaltMusic(void)
 {
-	SDL_LockAudio();
+	music_lock();
 	if ( music_playing ) {
 		music_internal_halt();
+		music_decode_flush();
 	}
-	SDL_UnlockAudio();
+	music_unlock();
 
 	return(0);
 }
@@ -1153,7 +1609,13 @@ int Mix_PlayingMusic(void)
 
 	SDL_LockAudio();
 	if ( music_playing ) {
-		playing = music_internal_playing();
+		/* Decoded ahead music plays until music_mixer() runs out of the
+		   decoded audio, and the decode thread halts it then */
+		if ( music_can_decode_ahead(music_playing) ) {
+			playing = !music_ring_halt;
+		} else {
+			playing = music_internal_playing();
+		}
 	}
 	SDL_UnlockAudio();
 
@@ -1195,6 +1657,7 @@ int Mix_GetSynchroValue(void)
 void close_music(void)
 {
 	Mix_HaltMusic();
+	music_decode_stop();
 #ifdef CMD_MUSIC
 	Mix_SetMusicCMD(NULL);
 #endif
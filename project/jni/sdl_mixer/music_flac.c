@@ -484,13 +484,15 @@ static void FLAC_getsome(FLAC_music *music)
 			free (cvt->buf);
 		}
 		cvt->buf = (Uint8 *)malloc (music->flac_data.data_len * cvt->len_mult);
+		SDL_FreeAudioCVTStream (music->cvt_stream);
+		music->cvt_stream = SDL_NewAudioCVTStream (cvt, music->flac_data.data_len);
 		music->section = section;
 	}
 	if (cvt->buf) {
 		memcpy (cvt->buf, music->flac_data.data, music->flac_data.data_read);
 		if (cvt->needed) {
 			cvt->len = music->flac_data.data_read;
-			SDL_ConvertAudio (cvt);
+			SDL_ConvertAudioStream (music->cvt_stream, cvt);
 		}
 		else {
 			cvt->len_cvt = music->flac_data.data_read;
@@ -559,6 +561,8 @@ void FLAC_delete(FLAC_music *music)
 			free (music->cvt.buf);
 		}
 
+		SDL_FreeAudioCVTStream (music->cvt_stream);
+
 		free (music);
 	}
 }
@@ -592,6 +596,7 @@ void FLAC_jump_to_time(FLAC_music *music, double time)
 				SDL_SetError
 					("Seeking of FLAC stream failed: libFLAC seek failed.");
 			}
+			SDL_ResetAudioCVTStream (music->cvt_stream);
 		}
 		else {
 			SDL_SetError
@@ -54,6 +54,7 @@ typedef struct {
 	FLAC_Data flac_data;
 	SDL_RWops *rwops;
 	SDL_AudioCVT cvt;
+	SDL_AudioCVTStream *cvt_stream;
 	int len_available;
 	Uint8 *snd_available;
 } FLAC_music;
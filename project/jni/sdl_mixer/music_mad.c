@@ -63,6 +63,7 @@ mad_openFileRW(SDL_RWops *rw, SDL_AudioSpec *mixer) {
 	mp3_mad->output_begin = 0;
 	mp3_mad->output_end = 0;
 	mp3_mad->mixer = *mixer;
+	mp3_mad->cvt_stream = NULL;
   }
   return mp3_mad;
 }
@@ -76,6 +77,7 @@ mad_closeFile(mad_data *mp3_mad) {
   if (mp3_mad->freerw) {
 	SDL_FreeRW(mp3_mad->rw);
   }
+  SDL_FreeAudioCVTStream(mp3_mad->cvt_stream);
   free(mp3_mad);
 }
 
@@ -204,6 +206,7 @@ decode_frame(mad_data *mp3_mad) {
 	   In particular, it tells us enough to set up the convert
 	   structure now. */
 	SDL_BuildAudioCVT(&mp3_mad->cvt, AUDIO_S16, pcm->channels, mp3_mad->frame.header.samplerate, mp3_mad->mixer.format, mp3_mad->mixer.channels, mp3_mad->mixer.freq);
+	mp3_mad->cvt_stream = SDL_NewAudioCVTStream(&mp3_mad->cvt, MAD_OUTPUT_BUFFER_SIZE);
   }
 
   /* pcm->samplerate contains the sampling frequency */
@@ -268,9 +271,11 @@ mad_getSamples(mad_data *mp3_mad, Uint8 *stream, int len) {
 		mp3_mad->cvt.buf = mp3_mad->output_buffer;
 		mp3_mad->cvt.len = mp3_mad->output_end;
 		
-		mp3_mad->output_end = (int)(mp3_mad->output_end * mp3_mad->cvt.len_ratio);
+		SDL_ConvertAudioStream(mp3_mad->cvt_stream, &mp3_mad->cvt);
+		/* Rate conversion by a ratio that is not a power of two
+		   gives a sample more or less than len * len_ratio */
+		mp3_mad->output_end = mp3_mad->cvt.needed ? mp3_mad->cvt.len_cvt : mp3_mad->cvt.len;
 		/*assert(mp3_mad->output_end <= MAD_OUTPUT_BUFFER_SIZE);*/
-		SDL_ConvertAudio(&mp3_mad->cvt);
 	  }
 	}
 
@@ -300,6 +305,7 @@ mad_seek(mad_data *mp3_mad, double position) {
   int_part = (int)position;
   mad_timer_set(&target, int_part, 
 				(int)((position - int_part) * 1000000), 1000000);
+  SDL_ResetAudioCVTStream(mp3_mad->cvt_stream);
 
   if (mad_timer_compare(mp3_mad->next_frame_start, target) > 0) {
 	/* In order to seek backwards in a VBR file, we have to rewind and
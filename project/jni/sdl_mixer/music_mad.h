@@ -54,6 +54,7 @@ typedef struct {
   int output_begin, output_end;
   SDL_AudioSpec mixer;
   SDL_AudioCVT cvt;
+  SDL_AudioCVTStream *cvt_stream;
 
   unsigned char input_buffer[MAD_INPUT_BUFFER_SIZE + MAD_BUFFER_GUARD];
   unsigned char output_buffer[MAD_OUTPUT_BUFFER_SIZE];
@@ -162,13 +162,15 @@ static void OGG_getsome(OGG_music *music)
 			free(cvt->buf);
 		}
 		cvt->buf = (Uint8 *)malloc(sizeof(data)*cvt->len_mult);
+		SDL_FreeAudioCVTStream(music->cvt_stream);
+		music->cvt_stream = SDL_NewAudioCVTStream(cvt, sizeof(data));
 		music->section = section;
 	}
 	if ( cvt->buf ) {
 		memcpy(cvt->buf, data, len);
 		if ( cvt->needed ) {
 			cvt->len = len;
-			SDL_ConvertAudio(cvt);
+			SDL_ConvertAudioStream(music->cvt_stream, cvt);
 		} else {
 			cvt->len_cvt = len;
 		}
@@ -221,6 +223,7 @@ void OGG_delete(OGG_music *music)
 		if ( music->cvt.buf ) {
 			free(music->cvt.buf);
 		}
+		SDL_FreeAudioCVTStream(music->cvt_stream);
 		vorbis.ov_clear(&music->vf);
 		free(music);
 	}
@@ -230,6 +233,7 @@ void OGG_delete(OGG_music *music)
 void OGG_jump_to_time(OGG_music *music, double time)
 {
        vorbis.ov_time_seek( &music->vf, time );
+       SDL_ResetAudioCVTStream( music->cvt_stream );
 }
 
 #endif /* OGG_MUSIC */
@@ -38,6 +38,7 @@ typedef struct {
 	OggVorbis_File vf;
 	int section;
 	SDL_AudioCVT cvt;
+	SDL_AudioCVTStream *cvt_stream;
 	int len_available;
 	Uint8 *snd_available;
 } OGG_music;
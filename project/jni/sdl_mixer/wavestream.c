@@ -35,6 +35,9 @@
 #include "SDL_mixer.h"
 #include "wavestream.h"
 
+/* Frames of the file converted at a time when the rate differs */
+#define WAVSTREAM_CVT_FRAMES	1024
+
 /*
     Taken with permission from SDL_wave.h, part of the SDL library,
     available at: http://www.libsdl.org/
@@ -162,6 +165,19 @@ WAVStream *WAVStream_LoadSong_RW(SDL_RWops *rw, const char *magic)
 		SDL_BuildAudioCVT(&wave->cvt,
 			wavespec.format, wavespec.channels, wavespec.freq,
 			mixer.format, mixer.channels, mixer.freq);
+		wave->frame_size = (wavespec.format & 0xFF) / 8 * wavespec.channels;
+		if ( wave->cvt.needed ) {
+			int len = WAVSTREAM_CVT_FRAMES * wave->frame_size;
+			wave->cvt.buf = (Uint8 *)malloc(len * wave->cvt.len_mult);
+			wave->cvt_stream = SDL_NewAudioCVTStream(&wave->cvt, len);
+			if ( wave->cvt.buf == NULL || wave->cvt_stream == NULL ) {
+				Mix_SetError("Out of memory");
+				free(wave->cvt.buf);
+				SDL_FreeAudioCVTStream(wave->cvt_stream);
+				free(wave);
+				return(NULL);
+			}
+		}
 	}
 	return(wave);
 }
@@ -170,6 +186,8 @@ WAVStream *WAVStream_LoadSong_RW(SDL_RWops *rw, const char *magic)
 void WAVStream_Start(WAVStream *wave)
 {
 	SDL_RWseek (wave->rw, wave->start, RW_SEEK_SET);
+	wave->cvt_left = 0;
+	SDL_ResetAudioCVTStream(wave->cvt_stream);
 	music = wave;
 }
 
@@ -179,41 +197,44 @@ int WAVStream_PlaySome(Uint8 *stream, int len)
 	long pos;
 	int left = 0;
 
-	if ( music && ((pos=SDL_RWtell(music->rw)) < music->stop) ) {
+	if ( music && (((pos=SDL_RWtell(music->rw)) < music->stop) ||
+	                music->cvt_left) ) {
 		if ( music->cvt.needed ) {
-			int original_len;
-
-			original_len=(int)((double)len/music->cvt.len_ratio);
-			if ( music->cvt.len != original_len ) {
-				int worksize;
-				if ( music->cvt.buf != NULL ) {
-					free(music->cvt.buf);
+			/* The file is converted a chunk at a time, and what is
+			   left of a chunk is mixed first in the next call */
+			int mixed = 0, original_len, mixable;
+
+			while ( mixed < len ) {
+				if ( music->cvt_left == 0 ) {
+					pos = SDL_RWtell(music->rw);
+					original_len = WAVSTREAM_CVT_FRAMES * music->frame_size;
+					if ( (music->stop - pos) < original_len ) {
+						original_len = (int)(music->stop - pos);
+					}
+					if ( original_len <= 0 ) {
+						break;
+					}
+					original_len = SDL_RWread(music->rw, music->cvt.buf,1,original_len);
+					/* Filters expect whole frames */
+					original_len -= original_len % music->frame_size;
+					if ( original_len <= 0 ) {
+						break;
+					}
+					music->cvt.len = original_len;
+					SDL_ConvertAudioStream(music->cvt_stream, &music->cvt);
+					music->cvt_left = music->cvt.len_cvt;
 				}
-				worksize = original_len*music->cvt.len_mult;
-				music->cvt.buf=(Uint8 *)malloc(worksize);
-				if ( music->cvt.buf == NULL ) {
-					return 0;
+				mixable = len - mixed;
+				if ( mixable > music->cvt_left ) {
+					mixable = music->cvt_left;
 				}
-				music->cvt.len = original_len;
-			}
-			if ( (music->stop - pos) < original_len ) {
-				left = (original_len - (music->stop - pos));
-				original_len -= left;
-				left = (int)((double)left*music->cvt.len_ratio);
-			}
-			original_len = SDL_RWread(music->rw, music->cvt.buf,1,original_len);
-			/* At least at the time of writing, SDL_ConvertAudio()
-			   does byte-order swapping starting at the end of the
-			   buffer. Thus, if we are reading 16-bit samples, we
-			   had better make damn sure that we get an even
-			   number of bytes, or we'll get garbage.
-			 */
-			if ( (music->cvt.src_format & 0x0010) && (original_len & 1) ) {
-				original_len--;
+				SDL_MixAudio(stream + mixed, music->cvt.buf +
+				             music->cvt.len_cvt - music->cvt_left,
+				             mixable, wavestream_volume);
+				music->cvt_left -= mixable;
+				mixed += mixable;
 			}
-			music->cvt.len = original_len;
-			SDL_ConvertAudio(&music->cvt);
-			SDL_MixAudio(stream, music->cvt.buf, music->cvt.len_cvt, wavestream_volume);
+			left = len - mixed;
 		} else {
 			Uint8 *data;
 			if ( (music->stop - pos) < len ) {
@@ -249,6 +270,7 @@ void WAVStream_FreeSong(WAVStream *wave)
 		if ( wave->cvt.buf ) {
 			free(wave->cvt.buf);
 		}
+		SDL_FreeAudioCVTStream(wave->cvt_stream);
 		free(wave);
 	}
 }
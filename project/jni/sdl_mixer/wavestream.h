@@ -32,6 +32,9 @@ typedef struct {
 	long  start;
 	long  stop;
 	SDL_AudioCVT cvt;
+	SDL_AudioCVTStream *cvt_stream;
+	int frame_size;
+	int cvt_left;	/* converted bytes at the end of cvt.buf not mixed yet */
 } WAVStream;
 
 /* Initialize the WAVStream player, with the given mixer settings